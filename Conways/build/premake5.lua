@@ -14,6 +14,12 @@ newoption
     default = "opengl33"
 }
 
+newoption
+{
+    trigger = "with-zstd",
+    description = "compress .snap snapshots with zstd (needs libzstd)"
+}
+
 function download_progress(total, current)
     local ratio = current / total;
     ratio = math.min(math.max(ratio, 0), 1);
@@ -171,8 +177,9 @@ if (downloadRaylib) then
         
         includedirs { "../src" }
         includedirs { "../include" }
+        includedirs { "../core" }
 
-        links {"raylib"}
+        links {"raylib", "conways-core"}
 
         cdialect "C17"
         cppdialect "C++17"
@@ -185,19 +192,22 @@ if (downloadRaylib) then
 
         filter "action:vs*"
             defines{"_WINSOCK_DEPRECATED_NO_WARNINGS", "_CRT_SECURE_NO_WARNINGS"}
-            dependson {"raylib"}
-            links {"raylib.lib"}
+            dependson {"raylib", "conways-core"}
+            links {"raylib.lib", "conways-core.lib"}
             characterset ("Unicode")
             buildoptions { "/Zc:__cplusplus" }
 
         filter "system:windows"
             defines{"_WIN32"}
-            links {"winmm", "gdi32", "opengl32"}
+            links {"winmm", "gdi32", "opengl32", "psapi"}
             libdirs {"../bin/%{cfg.buildcfg}"}
 
         filter "system:linux"
             links {"pthread", "m", "dl", "rt", "X11"}
 
+        filter "options:with-zstd"
+            links {"zstd"}
+
         filter "system:macosx"
             links {"OpenGL.framework", "Cocoa.framework", "IOKit.framework", "CoreFoundation.framework", "CoreAudio.framework", "CoreVideo.framework", "AudioToolbox.framework"}
 
@@ -234,3 +244,87 @@ if (downloadRaylib) then
             compileas "Objective-C"
 
         filter{}
+
+    -- Núcleo de simulação em CPU, sem dependência de raylib/OpenGL
+    project "conways-core"
+        kind "StaticLib"
+        location "build_files/"
+        targetdir "../bin/%{cfg.buildcfg}"
+
+        language "C++"
+        cppdialect "C++17"
+
+        vpaths
+        {
+            ["Header Files/*"] = { "../core/**.h" },
+            ["Source Files/*"] = { "../core/**.cpp" },
+        }
+        files {"../core/**.h", "../core/**.cpp"}
+        includedirs { "../core" }
+        flags { "ShadowedVariables"}
+
+        filter "action:vs*"
+            defines{"_CRT_SECURE_NO_WARNINGS"}
+            buildoptions { "/Zc:__cplusplus" }
+
+        filter "options:with-zstd"
+            defines {"CONWAYS_WITH_ZSTD"}
+
+        -- Kernels SIMD: cada arquivo compila com a sua ISA e o kernel é
+        -- escolhido em tempo de execução (kernel_dispatch.cpp)
+        filter { "platforms:x86", "files:../core/kernel_sse2.cpp", "action:not vs*" }
+            buildoptions { "-msse2" }
+
+        filter { "platforms:x64 or x86", "files:../core/kernel_avx2.cpp", "action:not vs*" }
+            buildoptions { "-mavx2" }
+
+        filter { "platforms:x64", "files:../core/kernel_avx512.cpp", "action:not vs*" }
+            buildoptions { "-mavx512f" }
+
+        filter { "platforms:x64 or x86", "files:../core/kernel_avx2.cpp", "action:vs*" }
+            buildoptions { "/arch:AVX2" }
+
+        filter { "platforms:x64", "files:../core/kernel_avx512.cpp", "action:vs*" }
+            buildoptions { "/arch:AVX512" }
+
+        filter{}
+
+-- Ferramentas de linha de comando que só usam o conways-core
+function headless_tool(name, source)
+    project (name)
+        kind "ConsoleApp"
+        location "build_files/"
+        targetdir "../bin/%{cfg.buildcfg}"
+
+        language "C++"
+        cppdialect "C++17"
+
+        files { source }
+        includedirs { "../core" }
+        links { "conways-core" }
+        flags { "ShadowedVariables"}
+
+        filter "action:vs*"
+            defines{"_CRT_SECURE_NO_WARNINGS"}
+            dependson {"conways-core"}
+            buildoptions { "/Zc:__cplusplus" }
+
+        filter "system:linux"
+            links {"pthread", "rt"}
+
+        filter "system:windows"
+            links {"psapi"}
+
+        filter "options:with-zstd"
+            links {"zstd"}
+
+        filter{}
+end
+
+    headless_tool("conways-cli", "../tools/cli.cpp")
+    headless_tool("conways-kernel-bench", "../tools/kernel_bench.cpp")
+    headless_tool("conways-bench", "../tools/bench.cpp")
+    headless_tool("conways-eca", "../tools/eca.cpp")
+    headless_tool("conways-sweep", "../tools/sweep.cpp")
+    headless_tool("conways-domain", "../tools/domain.cpp")
+    headless_tool("conways-search", "../tools/search.cpp")
@@ -0,0 +1,196 @@
+#include "bench.h"
+
+#include "seed.h"
+#include "simulation.h"
+
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace life {
+
+namespace {
+
+const char *const kRPentomino[] = {".OO", "OO.", ".O."};
+
+const char *const kGosperGun[] = {
+    "........................O...........",
+    "......................O.O...........",
+    "............OO......OO............OO",
+    "...........O...O....OO............OO",
+    "OO........O.....O...OO..............",
+    "OO........O...O.OO....O.O...........",
+    "..........O.....O.......O...........",
+    "...........O...O....................",
+    "............OO......................",
+};
+
+// Espaço entre canhões do campo: os planadores de um chegam ao próximo
+// depois de algumas centenas de gerações
+constexpr int kGunSpacingX = 64;
+constexpr int kGunSpacingY = 48;
+
+template <size_t N>
+void Stamp(Grid &grid, const char *const (&rows)[N], int x, int y) {
+    for (size_t r = 0; r < N; r++)
+        for (int c = 0; rows[r][c]; c++)
+            if (rows[r][c] == 'O')
+                grid.set((x + c) % grid.width(), (y + (int)r) % grid.height(),
+                         true);
+}
+
+void JsonString(FILE *out, const std::string &text) {
+    fputc('"', out);
+    for (char c : text) {
+        if (c == '"' || c == '\\')
+            fprintf(out, "\\%c", c);
+        else if ((unsigned char)c < 0x20)
+            fprintf(out, "\\u%04x", c);
+        else
+            fputc(c, out);
+    }
+    fputc('"', out);
+}
+
+} // namespace
+
+const char *BenchWorkloadName(BenchWorkload workload) {
+    switch (workload) {
+    case BenchWorkload::RPentomino:
+        return "r-pentomino";
+    case BenchWorkload::GosperField:
+        return "gosper-field";
+    case BenchWorkload::Soup:
+        return "soup";
+    case BenchWorkload::SettledSoup:
+        return "settled-soup";
+    }
+    return "?";
+}
+
+bool ParseBenchWorkload(const char *name, BenchWorkload &workload) {
+    const BenchWorkload workloads[] = {
+        BenchWorkload::RPentomino, BenchWorkload::GosperField,
+        BenchWorkload::Soup, BenchWorkload::SettledSoup};
+    for (BenchWorkload candidate : workloads) {
+        if (!strcmp(name, BenchWorkloadName(candidate))) {
+            workload = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+Grid MakeBenchGrid(BenchWorkload workload, int width, int height,
+                   int settleGenerations, ThreadPool *pool) {
+    Grid grid(width, height);
+    switch (workload) {
+    case BenchWorkload::RPentomino:
+        Stamp(grid, kRPentomino, width / 2 - 1, height / 2 - 1);
+        break;
+    case BenchWorkload::GosperField:
+        for (int y = 0; y + 9 <= height; y += kGunSpacingY)
+            for (int x = 0; x + 36 <= width; x += kGunSpacingX)
+                Stamp(grid, kGosperGun, x, y);
+        break;
+    case BenchWorkload::Soup:
+    case BenchWorkload::SettledSoup: {
+        SeedOptions seed;
+        seed.seed = 42;
+        SeedGrid(grid, seed, pool);
+        break;
+    }
+    }
+
+    if (workload == BenchWorkload::SettledSoup && settleGenerations > 0) {
+        Simulation sim(std::move(grid));
+        sim.setThreadCount(pool ? pool->threadCount() : 1);
+        sim.step((uint64_t)settleGenerations);
+        grid = sim.grid();
+    }
+    return grid;
+}
+
+uint64_t PeakRssBytes() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters,
+                             sizeof(counters)))
+        return counters.PeakWorkingSetSize;
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#if defined(__APPLE__)
+    return (uint64_t)usage.ru_maxrss; // bytes no macOS
+#else
+    return (uint64_t)usage.ru_maxrss * 1024; // KB no Linux
+#endif
+#endif
+}
+
+double Percentile(std::vector<double> samples, double p) {
+    if (samples.empty())
+        return 0.0;
+    std::sort(samples.begin(), samples.end());
+    double position = p * (samples.size() - 1);
+    size_t below = (size_t)position;
+    size_t above = std::min(below + 1, samples.size() - 1);
+    double fraction = position - below;
+    return samples[below] + (samples[above] - samples[below]) * fraction;
+}
+
+void WriteBenchJson(FILE *out, const std::string &label, const char *isa,
+                    int threads, const std::vector<BenchResult> &results) {
+    char date[32];
+    time_t now = time(nullptr);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+
+    fprintf(out, "{\n  \"suite\": \"conways-bench\",\n  \"version\": 1,\n");
+    fprintf(out, "  \"label\": ");
+    JsonString(out, label);
+    fprintf(out, ",\n  \"date\": \"%s\",\n  \"isa\": \"%s\",\n", date, isa);
+    fprintf(out, "  \"threads\": %d,\n  \"results\": [", threads);
+
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult &r = results[i];
+        double cells = (double)r.width * r.height;
+        fprintf(out, "%s\n    {\"workload\": \"%s\", \"engine\": \"%s\", ",
+                i ? "," : "", r.workload.c_str(), r.engine.c_str());
+        fprintf(out, "\"width\": %d, \"height\": %d, \"cells\": %.0f", r.width,
+                r.height, cells);
+        if (!r.skipped.empty()) {
+            fprintf(out, ", \"skipped\": ");
+            JsonString(out, r.skipped);
+            fprintf(out, "}");
+            continue;
+        }
+
+        double updates = cells * r.generations;
+        fprintf(out,
+                ", \"generations\": %llu, \"seconds\": %.6f, "
+                "\"cells_per_second\": %.6e, \"ns_per_cell\": %.6f, ",
+                (unsigned long long)r.generations, r.seconds,
+                r.seconds > 0.0 ? updates / r.seconds : 0.0,
+                updates > 0.0 ? r.seconds * 1e9 / updates : 0.0);
+        fprintf(out,
+                "\"step_ns\": {\"p50\": %.0f, \"p99\": %.0f, \"max\": %.0f}, ",
+                Percentile(r.stepSeconds, 0.5) * 1e9,
+                Percentile(r.stepSeconds, 0.99) * 1e9,
+                Percentile(r.stepSeconds, 1.0) * 1e9);
+        fprintf(out, "\"population\": %llu, \"peak_rss_bytes\": %llu}",
+                (unsigned long long)r.population,
+                (unsigned long long)r.peakRssBytes);
+    }
+    fprintf(out, "\n  ]\n}\n");
+}
+
+} // namespace life
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "grid.h"
+#include "thread_pool.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace life {
+
+// Cargas fixas do conways-bench e do "Conways --bench" (GPU), para comparar
+// motores e commits com o mesmo trabalho
+enum class BenchWorkload { RPentomino, GosperField, Soup, SettledSoup };
+
+const char *BenchWorkloadName(BenchWorkload workload);
+bool ParseBenchWorkload(const char *name, BenchWorkload &workload);
+
+// Grade inicial da carga. A sopa tem 25% de células vivas com semente fixa;
+// a sopa assentada é a mesma sopa depois de settleGenerations gerações.
+Grid MakeBenchGrid(BenchWorkload workload, int width, int height,
+                   int settleGenerations = 1000, ThreadPool *pool = nullptr);
+
+// Uma execução (carga x tamanho x motor). stepSeconds tem a latência de cada
+// geração medida; um resultado com skipped não rodou.
+struct BenchResult {
+    std::string workload;
+    std::string engine;
+    int width = 0;
+    int height = 0;
+    uint64_t generations = 0;
+    double seconds = 0.0;
+    std::vector<double> stepSeconds;
+    uint64_t population = 0; // população final
+    uint64_t peakRssBytes = 0;
+    std::string skipped;
+};
+
+// Pico de memória residente do processo até agora (0 se desconhecido)
+uint64_t PeakRssBytes();
+
+// Percentil p (0..1) por interpolação entre as amostras ordenadas
+double Percentile(std::vector<double> samples, double p);
+
+// JSON com cells/s, ns/célula, p50/p99 da latência e pico de RSS
+void WriteBenchJson(FILE *out, const std::string &label, const char *isa,
+                    int threads, const std::vector<BenchResult> &results);
+
+} // namespace life
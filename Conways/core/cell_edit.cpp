@@ -0,0 +1,135 @@
+#include "cell_edit.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace life {
+
+namespace {
+
+int Wrap(int value, int size) { return ((value % size) + size) % size; }
+
+uint64_t LowBits(int count) {
+    return count >= 64 ? ~0ull : (1ull << count) - 1;
+}
+
+// Até 64 bits de src a partir do bit `start` (zeros além de `words`)
+uint64_t Extract(const uint64_t *src, int words, int start) {
+    int w = start >> 6;
+    int shift = start & 63;
+    uint64_t bits = w < words ? src[w] >> shift : 0;
+    if (shift && w + 1 < words)
+        bits |= src[w + 1] << (64 - shift);
+    return bits;
+}
+
+// bits (já cortados ao comprimento) a partir da célula `start` da linha. Os
+// bits que transbordam para a palavra seguinte só existem se cabem na
+// largura, então nunca passam da última palavra.
+void Apply(uint64_t *row, int start, uint64_t bits, bool set) {
+    int w = start >> 6;
+    int shift = start & 63;
+    uint64_t low = bits << shift;
+    uint64_t high = shift ? bits >> (64 - shift) : 0;
+    if (set) {
+        row[w] |= low;
+        if (high)
+            row[w + 1] |= high;
+    } else {
+        row[w] &= ~low;
+        if (high)
+            row[w + 1] &= ~high;
+    }
+}
+
+// Células [from, from + length) do padrão (ou todas acesas, sem padrão) para
+// [to, to + length) da linha; to + length <= largura
+void ApplySpan(uint64_t *row, int to, const uint64_t *src, int srcWords,
+               int from, int length, bool set) {
+    for (int done = 0; done < length; done += 64) {
+        uint64_t bits = LowBits(length - done);
+        if (src)
+            bits &= Extract(src, srcWords, from + done);
+        if (bits)
+            Apply(row, to + done, bits, set);
+    }
+}
+
+// Uma linha de `length` células começando em x, dando a volta na borda
+void ApplyRow(uint64_t *row, int width, int x, const uint64_t *src,
+              int srcWords, int length, bool set) {
+    int to = Wrap(x, width);
+    for (int from = 0; from < length;) {
+        int span = std::min(length - from, width - to);
+        ApplySpan(row, to, src, srcWords, from, span, set);
+        from += span;
+        to = 0;
+    }
+}
+
+} // namespace
+
+CellEdit CellEdit::Fill(int x, int y, int width, int height) {
+    CellEdit edit;
+    edit.op = Op::Fill;
+    edit.x = x;
+    edit.y = y;
+    edit.width = width;
+    edit.height = height;
+    return edit;
+}
+
+CellEdit CellEdit::Clear(int x, int y, int width, int height) {
+    CellEdit edit = Fill(x, y, width, height);
+    edit.op = Op::Clear;
+    return edit;
+}
+
+CellEdit CellEdit::Stamp(std::shared_ptr<const Grid> pattern, int x, int y) {
+    CellEdit edit;
+    edit.op = Op::Stamp;
+    edit.x = x;
+    edit.y = y;
+    edit.pattern = std::move(pattern);
+    return edit;
+}
+
+CellEdit CellEdit::Erase(std::shared_ptr<const Grid> pattern, int x, int y) {
+    CellEdit edit = Stamp(std::move(pattern), x, y);
+    edit.op = Op::Erase;
+    return edit;
+}
+
+void ApplyCellEdit(Grid &grid, const CellEdit &edit) {
+    if (grid.width() <= 0 || grid.height() <= 0)
+        return;
+    bool set = edit.op == CellEdit::Op::Fill || edit.op == CellEdit::Op::Stamp;
+    // Maior que a grade, daria a volta sobre si mesmo: fica só a parte que
+    // cabe
+    if (edit.op == CellEdit::Op::Fill || edit.op == CellEdit::Op::Clear) {
+        int width = std::min(edit.width, grid.width());
+        int height = std::min(edit.height, grid.height());
+        if (width <= 0)
+            return;
+        for (int py = 0; py < height; py++)
+            ApplyRow(grid.row(Wrap(edit.y + py, grid.height())), grid.width(),
+                     edit.x, nullptr, 0, width, set);
+        return;
+    }
+
+    const Grid *pattern = edit.pattern.get();
+    if (!pattern)
+        return;
+    int width = std::min(pattern->width(), grid.width());
+    int height = std::min(pattern->height(), grid.height());
+    for (int py = 0; py < height; py++) {
+        const uint64_t *src = pattern->row(py);
+        if (std::all_of(src, src + pattern->words(),
+                        [](uint64_t w) { return w == 0; }))
+            continue;
+        ApplyRow(grid.row(Wrap(edit.y + py, grid.height())), grid.width(),
+                 edit.x, src, pattern->words(), width, set);
+    }
+}
+
+} // namespace life
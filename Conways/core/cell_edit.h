@@ -0,0 +1,38 @@
+#pragma once
+
+#include "grid.h"
+
+#include <cstdint>
+#include <memory>
+
+namespace life {
+
+// Uma edição de células, aplicada direto nas palavras da grade: OR para
+// acender, AND-NOT para apagar, 64 células por operação. Como paste(), as
+// coordenadas dão a volta nas bordas.
+struct CellEdit {
+    enum class Op : uint8_t {
+        Fill,  // acende o retângulo
+        Clear, // apaga o retângulo
+        Stamp, // acende as células vivas do padrão (OR)
+        Erase, // apaga as células vivas do padrão (AND-NOT)
+    };
+
+    Op op = Op::Fill;
+    int x = 0; // canto superior esquerdo
+    int y = 0;
+    int width = 0; // retângulo
+    int height = 0;
+    // Stamp e Erase. Compartilhado: carimbar o mesmo padrão mil vezes não
+    // copia a grade dele.
+    std::shared_ptr<const Grid> pattern;
+
+    static CellEdit Fill(int x, int y, int width, int height);
+    static CellEdit Clear(int x, int y, int width, int height);
+    static CellEdit Stamp(std::shared_ptr<const Grid> pattern, int x, int y);
+    static CellEdit Erase(std::shared_ptr<const Grid> pattern, int x, int y);
+};
+
+void ApplyCellEdit(Grid &grid, const CellEdit &edit);
+
+} // namespace life
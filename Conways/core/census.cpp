@@ -0,0 +1,795 @@
+#include "census.h"
+
+#include "bits.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <utility>
+
+namespace life {
+
+// Forma de um objeto no canto do seu retângulo: bit x da linha y
+struct Census::Shape {
+    int width = 0;
+    int height = 0;
+    std::vector<uint64_t> rows;
+
+    bool operator==(const Shape &other) const {
+        return width == other.width && height == other.height &&
+               rows == other.rows;
+    }
+    bool operator<(const Shape &other) const {
+        if (width != other.width)
+            return width < other.width;
+        if (height != other.height)
+            return height < other.height;
+        return rows < other.rows;
+    }
+
+    uint64_t hash() const {
+        uint64_t h = MulFold((uint64_t)width << 32 | (uint32_t)height,
+                             0x9E3779B97F4A7C15ull);
+        for (uint64_t row : rows)
+            h = MulFold(h ^ row, 0xe7037ed1a0b428dbull);
+        // 0 e 1 marcam objetos vazios e grandes demais
+        return h < 2 ? h + 2 : h;
+    }
+
+    int cells() const {
+        int count = 0;
+        for (uint64_t row : rows)
+            count += Popcount(row);
+        return count;
+    }
+};
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using Shape = Census::Shape;
+
+// Formas até 64x64: uma palavra por linha
+constexpr int kMaxSide = 64;
+constexpr uint64_t kEmptyKey = 0;
+constexpr uint64_t kOversizedKey = 1;
+
+// Corrida de células vivas [x0, x1] da linha y
+struct Run {
+    int32_t y;
+    int32_t x0;
+    int32_t x1;
+};
+
+struct Point {
+    int x;
+    int y;
+};
+
+int CountRuns(const uint64_t *row, int words) {
+    int count = 0;
+    uint64_t carry = 0;
+    for (int w = 0; w < words; w++) {
+        uint64_t value = row[w];
+        count += Popcount(value & ~(value << 1 | carry));
+        carry = value >> 63;
+    }
+    return count;
+}
+
+// Os bits além de width são zero, então nenhuma corrida passa da borda
+void ListRuns(const uint64_t *row, int words, int y, Run *out) {
+    int open = -1; // x0 da corrida que continua na palavra seguinte
+    for (int w = 0; w < words; w++) {
+        uint64_t value = row[w];
+        int bit = 0;
+        while (bit < 64) {
+            uint64_t rest = (open < 0 ? value : ~value) >> bit;
+            if (!rest)
+                break;
+            bit += CountTrailingZeros(rest);
+            if (open < 0) {
+                open = w * 64 + bit;
+            } else {
+                *out++ = {y, open, w * 64 + bit - 1};
+                open = -1;
+            }
+        }
+    }
+    if (open >= 0)
+        *out = {y, open, words * 64 - 1};
+}
+
+// Union-find com as raízes sempre no menor índice: parent[i] <= i
+uint32_t Find(std::vector<uint32_t> &parent, uint32_t i) {
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+void Union(std::vector<uint32_t> &parent, uint32_t a, uint32_t b) {
+    a = Find(parent, a);
+    b = Find(parent, b);
+    if (a < b)
+        parent[b] = a;
+    else if (b < a)
+        parent[a] = b;
+}
+
+// Une as corridas [a0, a1) e [b0, b1) de duas linhas com células a até
+// reach colunas umas das outras (reach 1: se tocam, inclusive na diagonal)
+void UnionRows(std::vector<uint32_t> &parent, const std::vector<Run> &runs,
+               uint32_t a0, uint32_t a1, uint32_t b0, uint32_t b1,
+               int reach) {
+    uint32_t a = a0;
+    uint32_t b = b0;
+    while (a < a1 && b < b1) {
+        const Run &above = runs[a];
+        const Run &below = runs[b];
+        if (above.x1 + reach >= below.x0 && below.x1 + reach >= above.x0)
+            Union(parent, a, b);
+        if (above.x1 < below.x1)
+            a++;
+        else
+            b++;
+    }
+}
+
+// Distância com wrap em [-n/2, n/2]
+int Wrap(int d, int n) {
+    d %= n;
+    if (d < 0)
+        d += n;
+    return d > n / 2 ? d - n : d;
+}
+
+Shape CanonicalShape(const std::vector<Point> &points, int width,
+                     int height) {
+    Shape best;
+    for (int t = 0; t < 8; t++) {
+        bool transpose = t & 4;
+        Shape shape;
+        shape.width = transpose ? height : width;
+        shape.height = transpose ? width : height;
+        shape.rows.assign(shape.height, 0);
+        for (const Point &p : points) {
+            int x = t & 1 ? width - 1 - p.x : p.x;
+            int y = t & 2 ? height - 1 - p.y : p.y;
+            if (transpose)
+                std::swap(x, y);
+            shape.rows[y] |= 1ull << x;
+        }
+        if (t == 0 || shape < best)
+            best = std::move(shape);
+    }
+    return best;
+}
+
+Shape Canonical(const Shape &shape) {
+    std::vector<Point> points;
+    for (int y = 0; y < shape.height; y++)
+        for (uint64_t row = shape.rows[y]; row; row &= row - 1)
+            points.push_back({CountTrailingZeros(row), y});
+    return CanonicalShape(points, shape.width, shape.height);
+}
+
+// "OO/OO": linhas separadas por '/', 'O' viva
+Shape ParseShape(const char *cells) {
+    Shape shape;
+    shape.rows.push_back(0);
+    int x = 0;
+    for (const char *c = cells; *c; c++) {
+        if (*c == '/') {
+            shape.rows.push_back(0);
+            x = 0;
+            continue;
+        }
+        if (*c == 'O')
+            shape.rows.back() |= 1ull << x;
+        x++;
+        shape.width = std::max(shape.width, x);
+    }
+    shape.height = (int)shape.rows.size();
+    return shape;
+}
+
+template <class Body>
+void ForRows(ThreadPool *pool, int rows, int grain, const Body &body) {
+    if (!pool)
+        body(0, rows);
+    else
+        pool->parallelFor(0, rows, grain, body);
+}
+
+// Componentes das corridas: duas corridas ficam juntas quando têm células
+// a até reach linhas e colunas de distância, com o wrap do toro. Cada faixa
+// de grain linhas é rotulada em paralelo; como toda união aponta para o
+// menor índice, uma faixa nunca escreve nas corridas de outra, e as bordas
+// das faixas são costuradas depois.
+struct Components {
+    std::vector<uint32_t> of; // componente de cada corrida
+    uint32_t count = 0;
+};
+
+Components Label(const std::vector<Run> &runs,
+                 const std::vector<uint32_t> &rowFirst, int width,
+                 int reach, ThreadPool *pool, int grain) {
+    int height = (int)rowFirst.size() - 1;
+    std::vector<uint32_t> parent(runs.size());
+    auto unionRows = [&](int a, int b) {
+        UnionRows(parent, runs, rowFirst[a], rowFirst[a + 1], rowFirst[b],
+                  rowFirst[b + 1], reach);
+    };
+
+    ForRows(pool, height, grain, [&](int y0, int y1) {
+        for (int y = y0; y < y1; y++) {
+            for (uint32_t i = rowFirst[y]; i < rowFirst[y + 1]; i++) {
+                parent[i] = i;
+                if (i > rowFirst[y] && runs[i - 1].x1 + reach >= runs[i].x0)
+                    Union(parent, i - 1, i);
+            }
+            for (int d = 1; d <= reach && y - d >= y0; d++)
+                unionRows(y - d, y);
+        }
+    });
+
+    for (int b = pool ? grain : height; b < height; b += grain)
+        for (int d = 1; d <= reach; d++)
+            for (int y = b; y < b + d && y < height; y++)
+                if (y - d >= 0)
+                    unionRows(y - d, y);
+    for (int d = 1; d <= reach; d++)
+        for (int y = 0; y < d && y < height; y++)
+            unionRows((y - d + height * reach) % height, y);
+    for (int y = 0; y < height; y++) {
+        if (rowFirst[y] == rowFirst[y + 1])
+            continue;
+        uint32_t last = rowFirst[y + 1] - 1;
+        for (int d = -reach; d <= reach; d++) {
+            int other = ((y + d) % height + height) % height;
+            uint32_t first = rowFirst[other];
+            if (first < rowFirst[other + 1] &&
+                runs[first].x0 + width - runs[last].x1 <= reach)
+                Union(parent, last, first);
+        }
+    }
+
+    // Com parent[i] <= i, uma passada em ordem achata tudo e numera
+    Components components;
+    components.of.resize(runs.size());
+    for (uint32_t i = 0; i < runs.size(); i++) {
+        if (parent[i] == i) {
+            components.of[i] = components.count++;
+        } else {
+            parent[i] = parent[parent[i]];
+            components.of[i] = components.of[parent[i]];
+        }
+    }
+    return components;
+}
+
+// Forma canônica das células da grade cobertas pelas corridas de um objeto.
+// As coordenadas são tomadas em relação à primeira corrida, com wrap, então
+// um objeto que cruza a borda do toro fica inteiro.
+uint64_t ObjectShape(const Grid &grid, const std::vector<Run> &runs,
+                     const uint32_t *order, size_t count,
+                     std::vector<Point> &points, Shape *shape) {
+    points.clear();
+    const Run &first = runs[order[0]];
+    int minX = 0;
+    int minY = 0;
+    int maxX = 0;
+    int maxY = 0;
+    for (size_t i = 0; i < count; i++) {
+        const Run &run = runs[order[i]];
+        const uint64_t *row = grid.row(run.y);
+        int y = Wrap(run.y - first.y, grid.height());
+        for (int w = run.x0 >> 6; w <= run.x1 >> 6; w++) {
+            uint64_t value = row[w];
+            if (w == run.x0 >> 6)
+                value &= ~0ull << (run.x0 & 63);
+            if (w == run.x1 >> 6 && (run.x1 & 63) != 63)
+                value &= (2ull << (run.x1 & 63)) - 1;
+            for (; value; value &= value - 1) {
+                int x = Wrap(w * 64 + CountTrailingZeros(value) - first.x0,
+                             grid.width());
+                if (points.empty()) {
+                    minX = maxX = x;
+                    minY = maxY = y;
+                }
+                minX = std::min(minX, x);
+                maxX = std::max(maxX, x);
+                minY = std::min(minY, y);
+                maxY = std::max(maxY, y);
+                points.push_back({x, y});
+            }
+        }
+    }
+    if (points.empty())
+        return kEmptyKey;
+    if (maxX - minX >= kMaxSide || maxY - minY >= kMaxSide)
+        return kOversizedKey;
+    for (Point &p : points) {
+        p.x -= minX;
+        p.y -= minY;
+    }
+    Shape canonical = CanonicalShape(points, maxX - minX + 1,
+                                     maxY - minY + 1);
+    uint64_t key = canonical.hash();
+    if (shape)
+        *shape = std::move(canonical);
+    return key;
+}
+
+// A janela com as células vivas das linhas [y0, y1) de field, se ela cabe
+// numa Shape e fica a 2 células da borda (onde o wrap do campo entraria)
+bool Window(const Grid &field, int y0, int y1, Shape &shape, int &left,
+            int &top) {
+    top = -1;
+    int bottom = -1;
+    uint64_t low = 0;
+    uint64_t high = 0;
+    for (int y = y0; y < y1; y++) {
+        const uint64_t *row = field.row(y);
+        if (!(row[0] | row[1]))
+            continue;
+        top = top < 0 ? y : top;
+        bottom = y;
+        low |= row[0];
+        high |= row[1];
+    }
+    if (top < 0)
+        return false;
+    left = low ? CountTrailingZeros(low) : 64 + CountTrailingZeros(high);
+    int right = high ? 64 + HighestBit(high) : HighestBit(low);
+    if (top < 2 || left < 2 || bottom > field.height() - 3 ||
+        right > field.width() - 3 || right - left >= kMaxSide ||
+        bottom - top >= kMaxSide)
+        return false;
+
+    shape.width = right - left + 1;
+    shape.height = bottom - top + 1;
+    shape.rows.clear();
+    for (int y = top; y <= bottom; y++) {
+        const uint64_t *row = field.row(y);
+        uint64_t value = left < 64 ? row[0] >> left : row[1] >> (left - 64);
+        if (left > 0 && left < 64)
+            value |= row[1] << (64 - left);
+        shape.rows.push_back(value);
+    }
+    return true;
+}
+
+// Evolui a forma isolada até ela repetir, a menos de translação, num campo
+// de 128x128 com folga para uma nave andar maxPeriod / 2 células. Só as
+// linhas em volta da forma são calculadas. keys recebe o hash canônico de
+// cada fase.
+CensusEntry Evolve(const Shape &shape, const Rule &rule, RowKernel kernel,
+                   int maxPeriod, const char *name,
+                   std::vector<uint64_t> &keys) {
+    constexpr int kField = 2 * kMaxSide;
+    constexpr int kOffset = kMaxSide / 2;
+    Grid fields[2] = {Grid(kField, kField), Grid(kField, kField)};
+    for (int y = 0; y < shape.height; y++)
+        for (uint64_t row = shape.rows[y]; row; row &= row - 1)
+            fields[0].set(kOffset + CountTrailingZeros(row), kOffset + y,
+                          true);
+    // Linhas de cada campo que podem ter células vivas
+    int used[2][2] = {{kOffset, kOffset + shape.height}, {0, 0}};
+    int current = 0;
+    int top = kOffset;
+    int bottom = kOffset + shape.height;
+
+    CensusEntry entry;
+    entry.cells = shape.cells();
+    std::vector<Shape> phases = {shape};
+    for (int generation = 1; generation <= maxPeriod; generation++) {
+        Grid &src = fields[current];
+        Grid &dst = fields[current ^ 1];
+        int y0 = top - 1;
+        int y1 = bottom + 1;
+        src.prepareHalo(y0 - 1, y1 + 1);
+        for (int y = y0; y < y1; y++)
+            kernel(src.row(y - 1), src.row(y), src.row(y + 1), dst.row(y), 2,
+                   rule);
+        int *stale = used[current ^ 1];
+        for (int y = stale[0]; y < stale[1]; y++)
+            if (y < y0 || y >= y1)
+                dst.row(y)[0] = dst.row(y)[1] = 0;
+        stale[0] = y0;
+        stale[1] = y1;
+        current ^= 1;
+
+        Shape next;
+        int left;
+        if (!Window(dst, y0, y1, next, left, top))
+            break;
+        bottom = top + next.height;
+        if (next == shape) {
+            // A classe junta as 8 simetrias, então o sentido em que esta
+            // orientação anda não vale para as outras: fica só o módulo
+            int ax = std::abs(left - kOffset);
+            int ay = std::abs(top - kOffset);
+            entry.period = generation;
+            entry.dx = std::max(ax, ay);
+            entry.dy = std::min(ax, ay);
+            break;
+        }
+        phases.push_back(std::move(next));
+    }
+
+    // O nome não pode depender da fase em que o objeto foi visto primeiro
+    keys = {shape.hash()};
+    if (entry.period > 0) {
+        keys.clear();
+        for (const Shape &phase : phases) {
+            keys.push_back(Canonical(phase).hash());
+            entry.cells = std::min(entry.cells, phase.cells());
+        }
+        if (entry.dx || entry.dy)
+            entry.kind = ObjectKind::Spaceship;
+        else if (entry.period > 1)
+            entry.kind = ObjectKind::Oscillator;
+        else
+            entry.kind = ObjectKind::StillLife;
+    }
+    if (name) {
+        entry.name = name;
+        return entry;
+    }
+
+    // De propósito diferente dos apgcodes (xs4_33, ...), que o hash não é
+    uint32_t code = (uint32_t)*std::min_element(keys.begin(), keys.end());
+    char text[48];
+    switch (entry.kind) {
+    case ObjectKind::StillLife:
+        snprintf(text, sizeof(text), "still_c%d_%08x", entry.cells, code);
+        break;
+    case ObjectKind::Oscillator:
+        snprintf(text, sizeof(text), "osc_p%d_%08x", entry.period, code);
+        break;
+    case ObjectKind::Spaceship:
+        snprintf(text, sizeof(text), "ship_p%d_%08x", entry.period, code);
+        break;
+    default:
+        snprintf(text, sizeof(text), "unstable_%08x", code);
+        break;
+    }
+    entry.name = text;
+    return entry;
+}
+
+// "c/4 diagonal", "c/2 orthogonal", "(2,1)c/6 oblique"
+std::string Speed(const CensusEntry &entry) {
+    char text[48];
+    if (entry.dy != 0 && entry.dy != entry.dx) {
+        snprintf(text, sizeof(text), "(%d,%d)c/%d oblique", entry.dx,
+                 entry.dy, entry.period);
+        return text;
+    }
+    int divisor = std::gcd(entry.dx, entry.period);
+    int cells = entry.dx / divisor;
+    int generations = entry.period / divisor;
+    const char *direction = entry.dy ? "diagonal" : "orthogonal";
+    if (cells == 1)
+        snprintf(text, sizeof(text), "c/%d %s", generations, direction);
+    else
+        snprintf(text, sizeof(text), "%dc/%d %s", cells, generations,
+                 direction);
+    return text;
+}
+
+} // namespace
+
+const char *ObjectKindName(ObjectKind kind) {
+    switch (kind) {
+    case ObjectKind::StillLife:
+        return "still life";
+    case ObjectKind::Oscillator:
+        return "oscillator";
+    case ObjectKind::Spaceship:
+        return "spaceship";
+    case ObjectKind::Unstable:
+        return "unstable";
+    case ObjectKind::Oversized:
+        return "oversized";
+    }
+    return "?";
+}
+
+std::string DescribeCensusEntry(const CensusEntry &entry) {
+    char text[96];
+    switch (entry.kind) {
+    case ObjectKind::StillLife:
+    case ObjectKind::Unstable:
+        snprintf(text, sizeof(text), "%s, %d cells", ObjectKindName(entry.kind),
+                 entry.cells);
+        break;
+    case ObjectKind::Oscillator:
+        snprintf(text, sizeof(text), "p%d oscillator, %d cells", entry.period,
+                 entry.cells);
+        break;
+    case ObjectKind::Spaceship:
+        snprintf(text, sizeof(text), "p%d spaceship, %s, %d cells",
+                 entry.period, Speed(entry).c_str(), entry.cells);
+        break;
+    case ObjectKind::Oversized:
+        snprintf(text, sizeof(text), "larger than 64x64, not classified");
+        break;
+    }
+    return text;
+}
+
+void PrintCensus(FILE *out, const CensusResult &result, size_t limit) {
+    fprintf(out, "Census: %llu objects, %llu cells, %zu kinds in %.3f s\n",
+            (unsigned long long)result.objects,
+            (unsigned long long)result.cells, result.entries.size(),
+            result.seconds);
+    for (size_t i = 0; i < result.entries.size() && i < limit; i++) {
+        const CensusEntry &entry = result.entries[i];
+        fprintf(out, "  %10llu  %-20s %s\n", (unsigned long long)entry.count,
+                entry.name.c_str(), DescribeCensusEntry(entry).c_str());
+    }
+    if (result.entries.size() > limit)
+        fprintf(out, "  ... %zu more kinds\n", result.entries.size() - limit);
+}
+
+Census::Census(const Rule &rule, const CensusOptions &options)
+    : rule_(rule), options_(options) {
+    kernel_ = GetRowKernel(DetectKernelIsa(), RuleKernelFor(rule_));
+    CensusEntry oversized;
+    oversized.name = "oversized";
+    oversized.kind = ObjectKind::Oversized;
+    add(oversized, {kOversizedKey});
+    // A tabela só vale para o Life; nas outras regras tudo recebe código
+    if (rule_ != Rule())
+        return;
+
+    addKnown("block", "OO/OO");
+    addKnown("beehive", ".OO./O..O/.OO.");
+    addKnown("loaf", ".OO./O..O/.O.O/..O.");
+    addKnown("boat", "OO./O.O/.O.");
+    addKnown("ship", "OO./O.O/.OO");
+    addKnown("tub", ".O./O.O/.O.");
+    addKnown("pond", ".OO./O..O/O..O/.OO.");
+    addKnown("long-boat", "OO../O.O./.O.O/..O.");
+    addKnown("barge", ".O../O.O./.O.O/..O.");
+    addKnown("mango", ".OO../O..O./.O..O/..OO.");
+    addKnown("aircraft-carrier", "OO../O..O/..OO");
+    addKnown("snake", "OO.O/O.OO");
+    addKnown("eater", "OO../O.O./..O./..OO");
+    addKnown("blinker", "OOO");
+    addKnown("toad", ".OOO/OOO.");
+    addKnown("beacon", "OO../OO../..OO/..OO");
+    addKnown("clock", "..O./O.O./.O.O/.O..");
+    addKnown("pulsar", "..OOO...OOO../............./"
+                       "O....O.O....O/O....O.O....O/O....O.O....O/"
+                       "..OOO...OOO../............./..OOO...OOO../"
+                       "O....O.O....O/O....O.O....O/O....O.O....O/"
+                       "............./..OOO...OOO..");
+    addKnown("pentadecathlon", "..O....O../OO.OOOO.OO/..O....O..");
+    addKnown("glider", ".O./..O/OOO");
+    addKnown("lwss", ".O..O/O..../O...O/OOOO.");
+    addKnown("mwss", "...O../.O...O/O...../O....O/OOOOO.");
+    addKnown("hwss", "...OO../.O....O/O....../O.....O/OOOOOO.");
+}
+
+void Census::addKnown(const char *name, const char *cells) {
+    Shape shape = Canonical(ParseShape(cells));
+    std::vector<uint64_t> keys;
+    if (!byShape_.count(shape.hash()))
+        add(Evolve(shape, rule_, kernel_, options_.maxPeriod, name, keys),
+            keys);
+}
+
+size_t Census::knownShapes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return byShape_.size();
+}
+
+int Census::add(const CensusEntry &entry,
+                const std::vector<uint64_t> &keys) {
+    int index = (int)classes_.size();
+    classes_.push_back(entry);
+    for (uint64_t key : keys)
+        byShape_.emplace(key, index);
+    return index;
+}
+
+CensusResult Census::take(Simulation &simulation) {
+    ProfileScope scope(ProfileZone::Census);
+    auto start = Clock::now();
+    CensusResult result;
+
+    const Simulation &view = simulation;
+    std::shared_ptr<const Grid> current = simulation.share();
+    const Grid &grid = *current;
+    int height = grid.height();
+    int words = grid.words();
+    ThreadPool *pool = simulation.threadPool();
+    int threads = pool ? pool->threadCount() : 1;
+    int grain = std::max(1, height / (threads * 4));
+
+    // As fases seguintes só servem para juntar os pedaços de um objeto
+    Grid merged = grid;
+    for (int phase = 1; phase < options_.phases; phase++) {
+        simulation.step();
+        const Grid &next = view.grid();
+        ForRows(pool, height, grain, [&](int y0, int y1) {
+            for (int y = y0; y < y1; y++) {
+                uint64_t *out = merged.row(y);
+                const uint64_t *in = next.row(y);
+                for (int w = 0; w < words; w++)
+                    out[w] |= in[w];
+            }
+        });
+    }
+
+    // Corridas por linha, em paralelo; o prefixo dá a posição de cada linha
+    std::vector<uint32_t> rowFirst(height + 1, 0);
+    ForRows(pool, height, grain, [&](int y0, int y1) {
+        for (int y = y0; y < y1; y++)
+            rowFirst[y + 1] = (uint32_t)CountRuns(merged.row(y), words);
+    });
+    for (int y = 0; y < height; y++)
+        rowFirst[y + 1] += rowFirst[y];
+    uint32_t total = rowFirst[height];
+    std::vector<Run> runs(total);
+    ForRows(pool, height, grain, [&](int y0, int y1) {
+        for (int y = y0; y < y1; y++)
+            ListRuns(merged.row(y), words, y, runs.data() + rowFirst[y]);
+    });
+
+    // Objetos são as peças conexas; peças a até 2 células umas das outras
+    // formam um grupo, que só é contado inteiro quando alguma peça sozinha
+    // não se sustenta (os quadrantes de um pulsar, por exemplo)
+    Components pieces = Label(runs, rowFirst, grid.width(), 1, pool, grain);
+    Components groups = Label(runs, rowFirst, grid.width(), 2, pool, grain);
+    uint32_t objects = pieces.count;
+
+    // Corridas agrupadas por peça
+    std::vector<uint32_t> pieceFirst(objects + 1, 0);
+    std::vector<uint32_t> groupOf(objects);
+    for (uint32_t i = 0; i < total; i++) {
+        pieceFirst[pieces.of[i] + 1]++;
+        groupOf[pieces.of[i]] = groups.of[i];
+    }
+    for (uint32_t o = 0; o < objects; o++)
+        pieceFirst[o + 1] += pieceFirst[o];
+    std::vector<uint32_t> order(total);
+    {
+        std::vector<uint32_t> next(pieceFirst.begin(), pieceFirst.end() - 1);
+        for (uint32_t i = 0; i < total; i++)
+            order[next[pieces.of[i]]++] = i;
+    }
+
+    std::vector<uint64_t> keys(objects);
+    int objectGrain = std::max(1, (int)objects / (threads * 8));
+    ForRows(pool, (int)objects, objectGrain, [&](int o0, int o1) {
+        std::vector<Point> points;
+        for (int o = o0; o < o1; o++)
+            keys[o] = ObjectShape(grid, runs, order.data() + pieceFirst[o],
+                                  pieceFirst[o + 1] - pieceFirst[o], points,
+                                  nullptr);
+    });
+
+    // Formas novas: uma peça de cada, evoluídas em paralelo fora do mutex
+    std::vector<uint32_t> unknown;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::unordered_map<uint64_t, uint32_t> seen;
+        for (uint32_t o = 0; o < objects; o++)
+            if (keys[o] != kEmptyKey && !byShape_.count(keys[o]) &&
+                seen.emplace(keys[o], o).second)
+                unknown.push_back(o);
+    }
+    std::vector<CensusEntry> evolved(unknown.size());
+    std::vector<std::vector<uint64_t>> phaseKeys(unknown.size());
+    ForRows(pool, (int)unknown.size(), 1, [&](int i0, int i1) {
+        std::vector<Point> scratch;
+        for (int i = i0; i < i1; i++) {
+            uint32_t o = unknown[i];
+            Shape shape;
+            ObjectShape(grid, runs, order.data() + pieceFirst[o],
+                        pieceFirst[o + 1] - pieceFirst[o], scratch, &shape);
+            evolved[i] = Evolve(shape, rule_, kernel_, options_.maxPeriod,
+                                nullptr, phaseKeys[i]);
+        }
+    });
+
+    std::vector<uint64_t> counts;
+    std::vector<Point> points;
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < unknown.size(); i++)
+        if (!byShape_.count(keys[unknown[i]])) // outra thread pode ter visto
+            add(evolved[i], phaseKeys[i]);
+
+    // Classe de uma forma; só a de um grupo inteiro ainda pode ser nova
+    auto classOf = [&](uint64_t key, const uint32_t *list, size_t count) {
+        auto found = byShape_.find(key);
+        if (found != byShape_.end())
+            return found->second;
+        Shape shape;
+        std::vector<uint64_t> shapeKeys;
+        ObjectShape(grid, runs, list, count, points, &shape);
+        return add(Evolve(shape, rule_, kernel_, options_.maxPeriod, nullptr,
+                          shapeKeys),
+                   shapeKeys);
+    };
+    auto tally = [&](int index) {
+        if ((size_t)index >= counts.size())
+            counts.resize(index + 1, 0);
+        counts[index]++;
+        result.objects++;
+    };
+
+    // Peças em ordem de grupo
+    std::vector<uint32_t> groupFirst(groups.count + 1, 0);
+    for (uint32_t o = 0; o < objects; o++)
+        groupFirst[groupOf[o] + 1]++;
+    for (uint32_t g = 0; g < groups.count; g++)
+        groupFirst[g + 1] += groupFirst[g];
+    std::vector<uint32_t> byGroup(objects);
+    for (uint32_t o = 0; o < objects; o++)
+        byGroup[groupFirst[groupOf[o]]++] = o;
+    std::vector<int> classes;
+    std::vector<uint32_t> groupRuns;
+    // O fill deixou em groupFirst[g] o fim do grupo g
+    uint32_t first = 0;
+    for (uint32_t g = 0; g < groups.count; g++) {
+        uint32_t last = groupFirst[g];
+
+        classes.clear();
+        bool whole = false;
+        for (uint32_t i = first; i < last; i++) {
+            uint32_t o = byGroup[i];
+            if (keys[o] == kEmptyKey)
+                continue;
+            int index = classOf(keys[o], order.data() + pieceFirst[o],
+                                pieceFirst[o + 1] - pieceFirst[o]);
+            classes.push_back(index);
+            whole = whole || classes_[index].kind == ObjectKind::Unstable;
+        }
+        if (whole && classes.size() > 1) {
+            groupRuns.clear();
+            for (uint32_t i = first; i < last; i++) {
+                uint32_t o = byGroup[i];
+                groupRuns.insert(groupRuns.end(), order.begin() + pieceFirst[o],
+                                 order.begin() + pieceFirst[o + 1]);
+            }
+            uint64_t key = ObjectShape(grid, runs, groupRuns.data(),
+                                       groupRuns.size(), points, nullptr);
+            tally(classOf(key, groupRuns.data(), groupRuns.size()));
+        } else {
+            for (int index : classes)
+                tally(index);
+        }
+        first = last;
+    }
+
+    for (size_t i = 0; i < counts.size(); i++) {
+        if (!counts[i])
+            continue;
+        CensusEntry entry = classes_[i];
+        entry.count = counts[i];
+        result.entries.push_back(std::move(entry));
+    }
+    std::sort(result.entries.begin(), result.entries.end(),
+              [](const CensusEntry &a, const CensusEntry &b) {
+                  if (a.count != b.count)
+                      return a.count > b.count;
+                  return a.name < b.name;
+              });
+
+    result.cells = grid.population();
+    result.seconds = std::chrono::duration<double>(Clock::now() - start)
+                         .count();
+    return result;
+}
+
+} // namespace life
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "rule.h"
+#include "simulation.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace life {
+
+enum class ObjectKind { StillLife, Oscillator, Spaceship, Unstable, Oversized };
+
+const char *ObjectKindName(ObjectKind kind);
+
+struct CensusOptions {
+    // Gerações somadas (OR) antes de separar os objetos. Com 2, as metades
+    // de um beacon, que só se tocam numa das fases, contam como um objeto.
+    int phases = 2;
+    // Maior período procurado para um objeto que não está na tabela
+    int maxPeriod = 64;
+};
+
+// Um tipo de objeto e quantos apareceram
+struct CensusEntry {
+    // O nome da tabela ("block", "glider", ...) ou, fora dela, um código:
+    // still_c<células> para still lifes, osc_p<período> para osciladores,
+    // ship_p<período> para naves, seguido do hash da forma. Não são
+    // apgcodes: o hash só vale dentro deste programa.
+    std::string name;
+    ObjectKind kind = ObjectKind::Unstable;
+    int period = 0; // 0 se não repetiu em maxPeriod gerações
+    // Deslocamento por período (naves), sem sinal e com dx >= dy: a classe
+    // junta as 8 simetrias, então não diz para que lado cada uma anda
+    int dx = 0;
+    int dy = 0;
+    int cells = 0; // na menor fase
+    uint64_t count = 0;
+};
+
+struct CensusResult {
+    std::vector<CensusEntry> entries; // os mais comuns primeiro
+    uint64_t objects = 0;
+    uint64_t cells = 0;
+    double seconds = 0.0;
+};
+
+// "p2 oscillator, 3 cells", "p4 spaceship, c/4 diagonal, 5 cells", ...
+std::string DescribeCensusEntry(const CensusEntry &entry);
+// Tabela com os `limit` tipos mais comuns
+void PrintCensus(FILE *out, const CensusResult &result, size_t limit = 30);
+
+// Recenseamento dos objetos de uma grade assentada. Os componentes conexos
+// (vizinhança de 8, com o wrap do toro) saem de um union-find sobre as
+// corridas de células vivas de cada linha, rotulado em faixas paralelas no
+// pool da simulação e costurado nas bordas das faixas. Cada objeto é
+// reduzido à forma canônica entre as 8 simetrias e classificado pelo hash
+// dela: primeiro na tabela de objetos conhecidos (só para B3/S23), depois
+// num cache das formas já vistas. As formas novas são evoluídas isoladas,
+// em paralelo, até repetirem, o que dá o período, o deslocamento e as
+// outras fases, que vão todas para o cache.
+//
+// Um Census pode ser usado por várias threads ao mesmo tempo (as sopas de
+// uma varredura, por exemplo): só o cache é compartilhado, sob um mutex.
+class Census {
+public:
+    explicit Census(const Rule &rule = Rule(),
+                    const CensusOptions &options = CensusOptions());
+
+    // Recenseia a geração atual. Com phases > 1 a simulação anda
+    // phases - 1 gerações. Precisa ter a regra do Census.
+    CensusResult take(Simulation &simulation);
+
+    const Rule &rule() const { return rule_; }
+    // Formas diferentes já classificadas
+    size_t knownShapes() const;
+
+    struct Shape; // forma de um objeto (census.cpp)
+
+private:
+    // Registra a classe sob as formas de todas as fases; com o mutex_
+    int add(const CensusEntry &entry, const std::vector<uint64_t> &keys);
+    void addKnown(const char *name, const char *cells);
+
+    Rule rule_;
+    RowKernel kernel_ = nullptr;
+    CensusOptions options_;
+    mutable std::mutex mutex_;
+    std::vector<CensusEntry> classes_; // com count 0
+    std::unordered_map<uint64_t, int> byShape_; // hash canônico -> classe
+};
+
+} // namespace life
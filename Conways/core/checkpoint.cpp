@@ -0,0 +1,250 @@
+#include "checkpoint.h"
+
+#include "profiler.h"
+#include "simulation.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <utility>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace life {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+bool Fail(std::string *error, const std::string &message) {
+    if (error)
+        *error = message;
+    return false;
+}
+
+// <prefixo>-<geração>.snap, com a geração em 20 dígitos para ordenar
+std::string FileName(const std::string &prefix, uint64_t generation) {
+    char digits[32];
+    snprintf(digits, sizeof(digits), "%020llu",
+             (unsigned long long)generation);
+    return prefix + "-" + digits + ".snap";
+}
+
+bool ParseFileName(const std::string &name, const std::string &prefix,
+                   const char *suffix, uint64_t &generation) {
+    std::string head = prefix + "-";
+    size_t suffixLength = strlen(suffix);
+    if (name.size() <= head.size() + suffixLength ||
+        name.compare(0, head.size(), head) != 0 ||
+        name.compare(name.size() - suffixLength, suffixLength, suffix) != 0)
+        return false;
+
+    generation = 0;
+    for (size_t i = head.size(); i < name.size() - suffixLength; i++) {
+        if (name[i] < '0' || name[i] > '9')
+            return false;
+        generation = generation * 10 + (name[i] - '0');
+    }
+    return true;
+}
+
+// Checkpoints do diretório, do mais novo para o mais velho
+std::vector<std::pair<uint64_t, fs::path>> List(const std::string &directory,
+                                                const std::string &prefix,
+                                                const char *suffix) {
+    std::vector<std::pair<uint64_t, fs::path>> found;
+    std::error_code ec;
+    for (fs::directory_iterator it(directory, ec), end; !ec && it != end;
+         it.increment(ec)) {
+        uint64_t generation;
+        if (ParseFileName(it->path().filename().string(), prefix, suffix,
+                          generation))
+            found.emplace_back(generation, it->path());
+    }
+    std::sort(found.begin(), found.end(),
+              [](const auto &a, const auto &b) { return a.first > b.first; });
+    return found;
+}
+
+// Garante que o rename chegou ao disco (no Windows o rename já é durável)
+void SyncDirectory(const std::string &directory) {
+#if !defined(_WIN32)
+    int fd = open(directory.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        fsync(fd);
+        close(fd);
+    }
+#else
+    (void)directory;
+#endif
+}
+
+} // namespace
+
+Checkpointer::Checkpointer(Options options) : options_(std::move(options)) {
+    writer_ = std::thread([this] { writerLoop(); });
+}
+
+Checkpointer::~Checkpointer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    writer_.join();
+}
+
+bool Checkpointer::maybeCheckpoint(const Simulation &sim) {
+    uint64_t generation = sim.generation();
+    uint64_t every = options_.everyGenerations;
+    auto now = std::chrono::steady_clock::now();
+
+    if (!started_) {
+        // A contagem começa na primeira chamada (ou na geração retomada)
+        started_ = true;
+        lastSubmit_ = now;
+        nextGeneration_ = every ? (generation / every + 1) * every : 0;
+        return false;
+    }
+
+    bool due = every && generation >= nextGeneration_;
+    if (options_.everySeconds > 0.0 &&
+        std::chrono::duration<double>(now - lastSubmit_).count() >=
+            options_.everySeconds)
+        due = true;
+    if (!due)
+        return false;
+
+    submit(sim.share(), generation);
+    lastSubmit_ = now;
+    if (every)
+        nextGeneration_ = (generation / every + 1) * every;
+    return true;
+}
+
+void Checkpointer::submit(std::shared_ptr<const Grid> grid,
+                          uint64_t generation) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (pending_)
+            stats_.dropped++;
+        pending_ = std::move(grid);
+        pendingGeneration_ = generation;
+    }
+    wake_.notify_one();
+}
+
+void Checkpointer::flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_.wait(lock, [this] { return !pending_ && !writing_; });
+}
+
+Checkpointer::Stats Checkpointer::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void Checkpointer::writerLoop() {
+    SetProfileThreadName("checkpoint");
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        wake_.wait(lock, [this] { return stop_ || pending_; });
+        if (!pending_)
+            break;
+
+        std::shared_ptr<const Grid> grid = std::move(pending_);
+        uint64_t generation = pendingGeneration_;
+        writing_ = true;
+        lock.unlock();
+
+        auto start = std::chrono::steady_clock::now();
+        std::string error;
+        bool ok;
+        {
+            ProfileScope scope(ProfileZone::Checkpoint);
+            ok = write(*grid, generation, &error);
+        }
+        // Solta o buffer para a simulação poder reaproveitá-lo
+        grid.reset();
+        double seconds = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+
+        lock.lock();
+        writing_ = false;
+        if (ok) {
+            stats_.written++;
+            stats_.lastGeneration = generation;
+            stats_.lastWriteSeconds = seconds;
+        } else {
+            stats_.failed++;
+            stats_.lastError = error;
+        }
+        idle_.notify_all();
+    }
+}
+
+bool Checkpointer::write(const Grid &grid, uint64_t generation,
+                         std::string *error) {
+    std::error_code ec;
+    fs::create_directories(options_.directory, ec);
+    if (ec)
+        return Fail(error, "não foi possível criar " + options_.directory);
+
+    fs::path path = fs::path(options_.directory) /
+                    FileName(options_.prefix, generation);
+    fs::path temporary = path;
+    temporary += ".tmp";
+
+    SnapshotOptions snapshot = options_.snapshot;
+    snapshot.sync = true;
+    if (!SaveSnapshot(temporary.string().c_str(), grid, generation, snapshot,
+                      error)) {
+        fs::remove(temporary, ec);
+        return false;
+    }
+
+    fs::rename(temporary, path, ec);
+    if (ec) {
+        fs::remove(temporary, ec);
+        return Fail(error, "não foi possível renomear para " + path.string());
+    }
+    SyncDirectory(options_.directory);
+    prune();
+    return true;
+}
+
+void Checkpointer::prune() {
+    std::error_code ec;
+    auto found = List(options_.directory, options_.prefix, ".snap");
+    for (size_t i = std::max(options_.keep, 1); i < found.size(); i++)
+        fs::remove(found[i].second, ec);
+    // Restos de uma gravação interrompida
+    for (const auto &stale :
+         List(options_.directory, options_.prefix, ".snap.tmp"))
+        fs::remove(stale.second, ec);
+}
+
+bool Checkpointer::FindLatest(const std::string &directory,
+                              const std::string &prefix, std::string &path,
+                              uint64_t *generation) {
+    for (const auto &candidate : List(directory, prefix, ".snap")) {
+        // Só valida o cabeçalho e o tamanho: o mapeamento não lê os dados
+        Grid grid;
+        SnapshotInfo info;
+        if (LoadSnapshot(candidate.second.string().c_str(), grid, &info)) {
+            path = candidate.second.string();
+            if (generation)
+                *generation = info.generation;
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace life
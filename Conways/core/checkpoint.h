@@ -0,0 +1,92 @@
+#pragma once
+
+#include "grid.h"
+#include "snapshot.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace life {
+
+class Simulation;
+
+// Grava checkpoints (.snap) numa thread própria. O loop da simulação só
+// entrega uma referência à geração atual (Simulation::share()), sem cópia, e
+// nunca espera o disco: se um checkpoint chega enquanto outro está sendo
+// gravado, ele substitui o que estava pendente.
+//
+// Cada arquivo é gravado como <prefixo>-<geração>.snap.tmp, sincronizado com
+// fsync e só então renomeado para .snap. Um crash deixa no máximo um .tmp
+// incompleto (apagado na próxima gravação), e os .snap são sempre íntegros.
+class Checkpointer {
+public:
+    struct Options {
+        std::string directory = "checkpoints";
+        std::string prefix = "checkpoint";
+        uint64_t everyGenerations = 0; // 0 desliga
+        double everySeconds = 0.0;     // 0 desliga
+        int keep = 2;                  // checkpoints mantidos no diretório
+        SnapshotOptions snapshot;
+    };
+
+    struct Stats {
+        uint64_t written = 0;
+        uint64_t dropped = 0; // pendentes substituídos por um mais novo
+        uint64_t failed = 0;
+        uint64_t lastGeneration = 0;
+        double lastWriteSeconds = 0.0;
+        std::string lastError;
+    };
+
+    explicit Checkpointer(Options options);
+    // Grava o que estiver pendente antes de terminar
+    ~Checkpointer();
+
+    Checkpointer(const Checkpointer &) = delete;
+    Checkpointer &operator=(const Checkpointer &) = delete;
+
+    // Entrega a geração atual se já passou o intervalo de gerações ou de
+    // tempo desde o último checkpoint. Barato quando não é hora.
+    bool maybeCheckpoint(const Simulation &sim);
+    void submit(std::shared_ptr<const Grid> grid, uint64_t generation);
+    // Espera gravar tudo o que foi entregue
+    void flush();
+
+    Stats stats() const;
+    const Options &options() const { return options_; }
+
+    // Checkpoint mais recente do diretório que abre sem erro
+    static bool FindLatest(const std::string &directory,
+                           const std::string &prefix, std::string &path,
+                           uint64_t *generation = nullptr);
+
+private:
+    void writerLoop();
+    bool write(const Grid &grid, uint64_t generation, std::string *error);
+    void prune();
+
+    Options options_;
+
+    // Só usados pela thread da simulação
+    bool started_ = false;
+    uint64_t nextGeneration_ = 0;
+    std::chrono::steady_clock::time_point lastSubmit_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable idle_;
+    std::shared_ptr<const Grid> pending_;
+    uint64_t pendingGeneration_ = 0;
+    bool writing_ = false;
+    bool stop_ = false;
+    Stats stats_;
+
+    std::thread writer_;
+};
+
+} // namespace life
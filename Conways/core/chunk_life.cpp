@@ -0,0 +1,399 @@
+#include "chunk_life.h"
+
+#include "bits.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace life {
+
+namespace {
+
+uint64_t Key(int32_t cx, int32_t cy) {
+    return (uint64_t)(uint32_t)cx << 32 | (uint32_t)cy;
+}
+
+size_t Hash(uint64_t key) {
+    return (size_t)MulFold(key, 0x9E3779B97F4A7C15ull);
+}
+
+// Coordenada de chunk da célula (divisão arredondando para baixo)
+int32_t ChunkOf(int64_t cell) {
+    return (int32_t)(cell >> ChunkLife::kChunkBits);
+}
+
+const uint64_t kEmptyRows[ChunkLife::kChunkSize] = {};
+
+} // namespace
+
+ChunkLife::ChunkLife(KernelIsa isa) {
+    isa_ = GetRowKernel(isa) ? isa : KernelIsa::Scalar;
+    kernel_ = GetRowKernel(isa_, RuleKernelFor(rule_));
+}
+
+ChunkLife::ChunkLife(const Grid &grid, KernelIsa isa) : ChunkLife(isa) {
+    load(grid);
+}
+
+uint32_t ChunkLife::find(int32_t cx, int32_t cy) const {
+    if (slots_.empty())
+        return kNone;
+    uint64_t key = Key(cx, cy);
+    size_t mask = slots_.size() - 1;
+    for (size_t i = Hash(key) & mask;; i = (i + 1) & mask) {
+        const Slot &slot = slots_[i];
+        if (slot.chunk == kNone)
+            return kNone;
+        if (slot.key == key)
+            return slot.chunk;
+    }
+}
+
+void ChunkLife::insert(uint64_t key, uint32_t index) {
+    // Carga de no máximo 1/2: as sequências de sondagem ficam curtas
+    if ((mapUsed_ + 1) * 2 > slots_.size())
+        growMap();
+    size_t mask = slots_.size() - 1;
+    size_t i = Hash(key) & mask;
+    while (slots_[i].chunk != kNone)
+        i = (i + 1) & mask;
+    slots_[i] = {key, index};
+    mapUsed_++;
+}
+
+void ChunkLife::erase(uint64_t key) {
+    size_t mask = slots_.size() - 1;
+    size_t i = Hash(key) & mask;
+    while (slots_[i].key != key || slots_[i].chunk == kNone)
+        i = (i + 1) & mask;
+
+    // Puxa para o buraco cada item seguinte cuja posição de origem não fica
+    // entre o buraco e ele
+    for (size_t j = (i + 1) & mask; slots_[j].chunk != kNone;
+         j = (j + 1) & mask) {
+        size_t home = Hash(slots_[j].key) & mask;
+        bool between = i <= j ? home > i && home <= j : home > i || home <= j;
+        if (!between) {
+            slots_[i] = slots_[j];
+            i = j;
+        }
+    }
+    slots_[i].chunk = kNone;
+    mapUsed_--;
+}
+
+void ChunkLife::growMap() {
+    std::vector<Slot> old = std::move(slots_);
+    slots_.assign(std::max<size_t>(64, old.size() * 2), Slot{0, kNone});
+    mapUsed_ = 0;
+    for (const Slot &slot : old)
+        if (slot.chunk != kNone)
+            insert(slot.key, slot.chunk);
+}
+
+uint32_t ChunkLife::acquire(int32_t cx, int32_t cy) {
+    if (free_.empty()) {
+        // Um bloco novo; os chunks nunca mudam de endereço
+        uint32_t first = (uint32_t)blocks_.size() * kBlockChunks;
+        blocks_.push_back(std::make_unique<Chunk[]>(kBlockChunks));
+        for (int i = kBlockChunks - 1; i >= 0; i--)
+            free_.push_back(first + i);
+    }
+    uint32_t index = free_.back();
+    free_.pop_back();
+
+    Chunk &c = chunk(index);
+    memset(c.cells, 0, sizeof(c.cells));
+    c.cx = cx;
+    c.cy = cy;
+    c.live = (uint32_t)live_.size();
+    c.needed = false;
+    live_.push_back(index);
+    insert(Key(cx, cy), index);
+    created_++;
+    return index;
+}
+
+void ChunkLife::release(uint32_t index) {
+    Chunk &c = chunk(index);
+    erase(Key(c.cx, c.cy));
+    uint32_t last = live_.back();
+    live_[c.live] = last;
+    chunk(last).live = c.live;
+    live_.pop_back();
+    free_.push_back(index);
+    released_++;
+}
+
+uint32_t ChunkLife::need(int32_t cx, int32_t cy) {
+    uint32_t index = find(cx, cy);
+    if (index == kNone)
+        index = acquire(cx, cy);
+    chunk(index).needed = true;
+    return index;
+}
+
+// Garante os vizinhos que uma borda viva pode alcançar neste passo e
+// devolve ao pool os chunks vazios que ficaram sem uso
+void ChunkLife::expand() {
+    for (uint32_t index : live_)
+        chunk(index).needed = false;
+
+    // Os chunks criados aqui entram no fim de live_, vazios
+    size_t count = live_.size();
+    for (size_t i = 0; i < count; i++) {
+        Chunk &c = chunk(live_[i]);
+        const uint64_t *rows = c.cells[phase_];
+        uint64_t any = 0;
+        uint64_t left = 0;
+        uint64_t right = 0;
+        for (int y = 0; y < kChunkSize; y++) {
+            any |= rows[y];
+            left |= rows[y] & 1;
+            right |= rows[y] >> 63;
+        }
+        if (!any)
+            continue;
+        c.needed = true;
+
+        int32_t cx = c.cx;
+        int32_t cy = c.cy;
+        uint64_t top = rows[0];
+        uint64_t bottom = rows[kChunkSize - 1];
+        if (top)
+            need(cx, cy - 1);
+        if (bottom)
+            need(cx, cy + 1);
+        if (left)
+            need(cx - 1, cy);
+        if (right)
+            need(cx + 1, cy);
+        if (top & 1)
+            need(cx - 1, cy - 1);
+        if (top >> 63)
+            need(cx + 1, cy - 1);
+        if (bottom & 1)
+            need(cx - 1, cy + 1);
+        if (bottom >> 63)
+            need(cx + 1, cy + 1);
+    }
+
+    // De trás para frente: release() traz o último para a posição i
+    for (size_t i = live_.size(); i-- > 0;)
+        if (!chunk(live_[i]).needed)
+            release(live_[i]);
+}
+
+// Calcula a próxima geração do chunk com as bordas dos vizinhos como halo,
+// num bloco de 66 linhas x 3 palavras (oeste, o chunk, leste)
+void ChunkLife::stepChunk(uint32_t index) {
+    Chunk &c = chunk(index);
+    const uint64_t *around[3][3];
+    for (int dy = -1; dy <= 1; dy++) {
+        for (int dx = -1; dx <= 1; dx++) {
+            uint32_t neighbor =
+                dx || dy ? find(c.cx + dx, c.cy + dy) : index;
+            around[dy + 1][dx + 1] = neighbor == kNone
+                                         ? kEmptyRows
+                                         : chunk(neighbor).cells[phase_];
+        }
+    }
+
+    constexpr int last = kChunkSize - 1;
+    uint64_t local[kChunkSize + 2][3];
+    for (int dx = 0; dx < 3; dx++) {
+        local[0][dx] = around[0][dx][last];
+        for (int y = 0; y < kChunkSize; y++)
+            local[y + 1][dx] = around[1][dx][y];
+        local[kChunkSize + 1][dx] = around[2][dx][0];
+    }
+
+    uint64_t *out = c.cells[phase_ ^ 1];
+    for (int y = 0; y < kChunkSize; y++)
+        kernel_(local[y] + 1, local[y + 1] + 1, local[y + 2] + 1, out + y, 1,
+                rule_);
+}
+
+void ChunkLife::step(uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+        ProfileScope scope(ProfileZone::Step);
+        expand();
+        if (live_.empty()) {
+            // O plano vazio continua vazio
+            generation_ += n - i;
+            return;
+        }
+
+        auto body = [this](int begin, int end) {
+            ProfileScope band(ProfileZone::Band);
+            for (int k = begin; k < end; k++)
+                stepChunk(live_[k]);
+        };
+        int count = (int)live_.size();
+        if (!pool_ || count < 2)
+            body(0, count);
+        else
+            pool_->parallelFor(
+                0, count, std::max(1, count / (4 * pool_->threadCount())),
+                body);
+
+        phase_ ^= 1;
+        generation_++;
+    }
+}
+
+void ChunkLife::load(const Grid &grid) {
+    clear();
+    for (int y = 0; y < grid.height(); y++) {
+        const uint64_t *row = grid.row(y);
+        // A palavra w da grade é exatamente a coluna de chunks w
+        for (int w = 0; w < grid.words(); w++) {
+            if (!row[w])
+                continue;
+            int32_t cy = ChunkOf(y);
+            uint32_t index = find(w, cy);
+            if (index == kNone)
+                index = acquire(w, cy);
+            chunk(index).cells[phase_][y & (kChunkSize - 1)] = row[w];
+        }
+    }
+}
+
+void ChunkLife::clear() {
+    for (uint32_t index : live_)
+        free_.push_back(index);
+    released_ += live_.size();
+    live_.clear();
+    std::fill(slots_.begin(), slots_.end(), Slot{0, kNone});
+    mapUsed_ = 0;
+    generation_ = 0;
+}
+
+bool ChunkLife::get(int64_t x, int64_t y) const {
+    uint32_t index = find(ChunkOf(x), ChunkOf(y));
+    if (index == kNone)
+        return false;
+    const uint64_t *rows = chunk(index).cells[phase_];
+    return (rows[y & (kChunkSize - 1)] >> (x & (kChunkSize - 1))) & 1;
+}
+
+void ChunkLife::set(int64_t x, int64_t y, bool alive) {
+    int32_t cx = ChunkOf(x);
+    int32_t cy = ChunkOf(y);
+    uint32_t index = find(cx, cy);
+    if (index == kNone) {
+        if (!alive)
+            return;
+        index = acquire(cx, cy);
+    }
+    // Um chunk que ficou vazio volta ao pool no próximo passo
+    uint64_t &row = chunk(index).cells[phase_][y & (kChunkSize - 1)];
+    uint64_t bit = 1ull << (x & (kChunkSize - 1));
+    row = alive ? row | bit : row & ~bit;
+}
+
+bool ChunkLife::setRule(const Rule &rule) {
+    if (rule.birth & 1)
+        return false;
+    rule_ = rule;
+    kernel_ = GetRowKernel(isa_, RuleKernelFor(rule_));
+    return true;
+}
+
+void ChunkLife::setThreadCount(int threads) {
+    pool_.reset();
+    if (threads != 1)
+        pool_ = std::make_unique<ThreadPool>(threads);
+    if (pool_ && pool_->threadCount() == 1)
+        pool_.reset();
+}
+
+void ChunkLife::writeTo(Grid &grid, int64_t x0, int64_t y0) const {
+    grid.clear();
+    for (uint32_t index : live_) {
+        const Chunk &c = chunk(index);
+        // Posição do chunk na grade: a palavra w com deslocamento shift
+        int64_t gx = (int64_t)c.cx * kChunkSize - x0;
+        int64_t gy = (int64_t)c.cy * kChunkSize - y0;
+        if (gx <= -kChunkSize || gx >= grid.width() || gy <= -kChunkSize ||
+            gy >= grid.height())
+            continue;
+        int64_t w = gx >> 6;
+        int shift = (int)(gx & 63);
+        for (int y = 0; y < kChunkSize; y++) {
+            int64_t row = gy + y;
+            uint64_t value = c.cells[phase_][y];
+            if (!value || row < 0 || row >= grid.height())
+                continue;
+            uint64_t *out = grid.row((int)row);
+            if (w >= 0 && w < grid.words())
+                out[w] |= value << shift;
+            if (shift && w + 1 >= 0 && w + 1 < grid.words())
+                out[w + 1] |= value >> (64 - shift);
+        }
+    }
+    grid.clearPadding();
+}
+
+bool ChunkLife::bounds(int64_t &x0, int64_t &y0, int64_t &x1,
+                       int64_t &y1) const {
+    bool found = false;
+    for (uint32_t index : live_) {
+        const Chunk &c = chunk(index);
+        const uint64_t *rows = c.cells[phase_];
+        uint64_t columns = 0;
+        int top = kChunkSize;
+        int bottom = -1;
+        for (int y = 0; y < kChunkSize; y++) {
+            if (!rows[y])
+                continue;
+            columns |= rows[y];
+            top = std::min(top, y);
+            bottom = y;
+        }
+        if (!columns)
+            continue;
+        int64_t baseX = (int64_t)c.cx * kChunkSize;
+        int64_t baseY = (int64_t)c.cy * kChunkSize;
+        int64_t left = baseX + CountTrailingZeros(columns);
+        int64_t right = baseX + HighestBit(columns) + 1;
+        if (!found) {
+            x0 = left;
+            x1 = right;
+            y0 = baseY + top;
+            y1 = baseY + bottom + 1;
+            found = true;
+            continue;
+        }
+        x0 = std::min(x0, left);
+        x1 = std::max(x1, right);
+        y0 = std::min(y0, baseY + top);
+        y1 = std::max(y1, baseY + bottom + 1);
+    }
+    return found;
+}
+
+uint64_t ChunkLife::population() const {
+    uint64_t population = 0;
+    for (uint32_t index : live_) {
+        const uint64_t *rows = chunk(index).cells[phase_];
+        for (int y = 0; y < kChunkSize; y++)
+            population += Popcount(rows[y]);
+    }
+    return population;
+}
+
+ChunkLife::Stats ChunkLife::stats() const {
+    Stats stats;
+    stats.chunks = live_.size();
+    stats.pooled = free_.size();
+    stats.mapSlots = slots_.size();
+    stats.bytes = blocks_.size() * kBlockChunks * sizeof(Chunk) +
+                  slots_.size() * sizeof(Slot);
+    stats.created = created_;
+    stats.released = released_;
+    return stats;
+}
+
+} // namespace life
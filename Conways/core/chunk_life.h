@@ -0,0 +1,126 @@
+#pragma once
+
+#include "grid.h"
+#include "kernel.h"
+#include "rule.h"
+#include "thread_pool.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace life {
+
+// Plano ilimitado em chunks de 64x64 células, uma palavra por linha, no
+// mesmo layout de bits da Grid. Os chunks ficam num mapa de endereçamento
+// aberto indexado pela coordenada do chunk e vêm de um pool: blocos de
+// chunks alocados uma vez, com uma lista livre, sem um nó de heap por
+// célula como o SparseLife.
+//
+// Antes de cada passo, todo chunk com células vivas numa borda garante o
+// vizinho daquele lado (e o da diagonal, pelos cantos); um chunk vazio que
+// nenhum vizinho precisa volta para o pool. Assim a memória acompanha a
+// área ativa, e um glider atravessa o plano com uns 4 chunks. Cada chunk é
+// calculado com o kernel de linha da Simulation, com as bordas dos 8
+// vizinhos como halo.
+//
+// As coordenadas de chunk são de 32 bits: o plano vai até ±2^37 células.
+class ChunkLife {
+public:
+    static constexpr int kChunkBits = 6;
+    static constexpr int kChunkSize = 1 << kChunkBits;
+
+    struct Stats {
+        size_t chunks = 0;    // em uso
+        size_t pooled = 0;    // livres no pool
+        size_t mapSlots = 0;  // capacidade do mapa
+        size_t bytes = 0;     // pool + mapa
+        uint64_t created = 0; // chunks tirados do pool desde o começo
+        uint64_t released = 0;
+    };
+
+    explicit ChunkLife(KernelIsa isa = DetectKernelIsa());
+    // A grade no plano, com a célula (0, 0) na origem
+    explicit ChunkLife(const Grid &grid, KernelIsa isa = DetectKernelIsa());
+
+    void load(const Grid &grid);
+    void clear();
+
+    bool get(int64_t x, int64_t y) const;
+    void set(int64_t x, int64_t y, bool alive);
+
+    // Como no HashLife, regras com B0 não cabem no plano ilimitado
+    bool setRule(const Rule &rule);
+    const Rule &rule() const { return rule_; }
+
+    // threads <= 0 usa todos os núcleos; 1 roda na thread que chama step()
+    void setThreadCount(int threads);
+    int threadCount() const { return pool_ ? pool_->threadCount() : 1; }
+
+    void step(uint64_t n = 1);
+
+    // Copia a região [x0, x0 + width) x [y0, y0 + height) para a grade
+    void writeTo(Grid &grid, int64_t x0, int64_t y0) const;
+    // Retângulo [x0, x1) x [y0, y1) das células vivas; false se não há
+    bool bounds(int64_t &x0, int64_t &y0, int64_t &x1, int64_t &y1) const;
+
+    uint64_t generation() const { return generation_; }
+    uint64_t population() const;
+    Stats stats() const;
+
+private:
+    static constexpr uint32_t kNone = 0xFFFFFFFFu;
+    static constexpr int kBlockChunks = 64;
+
+    struct alignas(64) Chunk {
+        // Duas gerações; a atual é cells[phase_]
+        uint64_t cells[2][kChunkSize];
+        int32_t cx;
+        int32_t cy;
+        uint32_t live; // posição em live_
+        bool needed;
+    };
+
+    struct Slot {
+        uint64_t key;
+        uint32_t chunk; // kNone: vazio
+    };
+
+    Chunk &chunk(uint32_t index) {
+        return blocks_[index / kBlockChunks][index % kBlockChunks];
+    }
+    const Chunk &chunk(uint32_t index) const {
+        return blocks_[index / kBlockChunks][index % kBlockChunks];
+    }
+
+    // Mapa de endereçamento aberto com sondagem linear. A remoção puxa de
+    // volta os itens seguintes da sequência, sem lápides.
+    uint32_t find(int32_t cx, int32_t cy) const;
+    void insert(uint64_t key, uint32_t index);
+    void erase(uint64_t key);
+    void growMap();
+
+    uint32_t acquire(int32_t cx, int32_t cy);
+    void release(uint32_t index);
+    uint32_t need(int32_t cx, int32_t cy);
+    void expand();
+    void stepChunk(uint32_t index);
+
+    std::vector<std::unique_ptr<Chunk[]>> blocks_;
+    std::vector<uint32_t> free_;
+    std::vector<uint32_t> live_;
+    std::vector<Slot> slots_;
+    size_t mapUsed_ = 0;
+    int phase_ = 0;
+
+    Rule rule_;
+    KernelIsa isa_ = KernelIsa::Scalar;
+    RowKernel kernel_ = nullptr;
+    std::unique_ptr<ThreadPool> pool_;
+    uint64_t generation_ = 0;
+    uint64_t created_ = 0;
+    uint64_t released_ = 0;
+};
+
+} // namespace life
@@ -0,0 +1,64 @@
+#include "cycle.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace life {
+
+uint64_t HashRows(const Grid &grid, int y0, int y1) {
+    int words = grid.words();
+    uint64_t hash = 0;
+    for (int y = y0; y < y1; y++) {
+        const uint64_t *row = grid.row(y);
+        uint64_t base = (uint64_t)y * words;
+        for (int w = 0; w < words; w++)
+            hash ^= HashWord(base + w, row[w]);
+    }
+    return hash;
+}
+
+uint64_t HashGrid(const Grid &grid, ThreadPool *pool) {
+    if (!pool)
+        return HashRows(grid, 0, grid.height());
+    std::atomic<uint64_t> hash{0};
+    int grain = std::max(1, grid.height() / (4 * pool->threadCount()));
+    pool->parallelFor(0, grid.height(), grain, [&](int y0, int y1) {
+        hash.fetch_xor(HashRows(grid, y0, y1), std::memory_order_relaxed);
+    });
+    return hash.load();
+}
+
+CycleDetector::CycleDetector(int maxPeriod)
+    : ring_(std::max(0, maxPeriod)) {}
+
+void CycleDetector::reset() {
+    count_ = 0;
+    period_ = 0;
+    start_ = 0;
+    confirmed_ = false;
+}
+
+bool CycleDetector::observe(uint64_t generation, uint64_t hash) {
+    if (period_ || ring_.empty())
+        return period_ != 0;
+    if (count_ && generation != last_ + 1)
+        count_ = 0;
+    if (!count_)
+        first_ = generation;
+
+    uint64_t size = ring_.size();
+    uint64_t back = std::min(count_, size);
+    for (uint64_t p = 1; p <= back; p++) {
+        if (ring_[(generation - p) % size] == hash) {
+            period_ = p;
+            start_ = generation - p;
+            return true;
+        }
+    }
+    ring_[generation % size] = hash;
+    count_++;
+    last_ = generation;
+    return false;
+}
+
+} // namespace life
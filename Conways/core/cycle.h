@@ -0,0 +1,70 @@
+#pragma once
+
+#include "bits.h"
+#include "grid.h"
+#include "thread_pool.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace life {
+
+// Contribuição da palavra index (contada linha a linha, sem o halo) com
+// valor value para o hash da grade. O hash é o XOR de todas, então trocar
+// uma palavra custa dois HashWord, e palavras zeradas não contam: a grade
+// vazia tem hash 0.
+inline uint64_t HashWord(uint64_t index, uint64_t value) {
+    uint64_t h = MulFold(value ^ 0xa0761d6478bd642full,
+                         index ^ 0xe7037ed1a0b428dbull);
+    return h & (0 - (uint64_t)(value != 0));
+}
+
+// XOR dos HashWord das linhas [y0, y1)
+uint64_t HashRows(const Grid &grid, int y0, int y1);
+// Hash da grade inteira, calculado do zero
+uint64_t HashGrid(const Grid &grid, ThreadPool *pool = nullptr);
+
+// Guarda os hashes das últimas maxPeriod gerações num anel e acusa o
+// primeiro candidato a ciclo: a geração g com o mesmo hash de g - p, para o
+// menor p <= maxPeriod. Um hash igual pode ser colisão, então o candidato só
+// vira ciclo quando quem tem as grades confere e chama confirm(); reject()
+// descarta a colisão.
+class CycleDetector {
+public:
+    explicit CycleDetector(int maxPeriod = 0);
+
+    int maxPeriod() const { return (int)ring_.size(); }
+
+    // Registra o hash de uma geração e devolve true se há candidato. Um
+    // salto na contagem recomeça o histórico; com um candidato, não muda
+    // mais até confirm(), reject() ou reset().
+    bool observe(uint64_t generation, uint64_t hash);
+    void confirm() { confirmed_ = period_ != 0; }
+    // Colisão: esquece o candidato e recomeça o histórico
+    void reject() { reset(); }
+    // Esquece o histórico e o ciclo (depois de uma edição)
+    void reset();
+
+    // Só depois de confirm(); period() e start() já valem no candidato
+    bool found() const { return confirmed_; }
+    bool pending() const { return period_ != 0 && !confirmed_; }
+    bool empty() const { return count_ == 0; }
+    uint64_t lastGeneration() const { return last_; }
+    uint64_t period() const { return period_; }
+    // Primeira geração do ciclo (o transiente, contado da geração 0). É
+    // exata se o histórico começou antes dela; senão é um limite superior.
+    uint64_t start() const { return start_; }
+    bool startExact() const { return start_ > first_ || first_ == 0; }
+    uint64_t detectedAt() const { return start_ + period_; }
+
+private:
+    std::vector<uint64_t> ring_; // hash da geração g em g % maxPeriod
+    uint64_t count_ = 0;
+    uint64_t first_ = 0;
+    uint64_t last_ = 0;
+    uint64_t period_ = 0;
+    uint64_t start_ = 0;
+    bool confirmed_ = false;
+};
+
+} // namespace life
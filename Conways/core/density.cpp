@@ -0,0 +1,144 @@
+#include "density.h"
+
+#include "bits.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace life {
+
+// body(y0, y1) sobre [0, rows), no pool se houver
+template <class Body>
+static void ForRows(ThreadPool *pool, int rows, const Body &body) {
+    if (!pool || rows < 2) {
+        body(0, rows);
+        return;
+    }
+    int grain = std::max(1, rows / (4 * pool->threadCount()));
+    pool->parallelFor(0, rows, grain, body);
+}
+
+void DensityPyramid::update(std::shared_ptr<const Grid> grid,
+                            ThreadPool *pool) {
+    const Grid &next = *grid;
+    bool full = !grid_ || grid_->width() != next.width() ||
+                grid_->height() != next.height();
+    if (full) {
+        levels_.clear();
+        int width = (next.width() + kBaseBlock - 1) / kBaseBlock;
+        int height = (next.height() + kBaseBlock - 1) / kBaseBlock;
+        for (;;) {
+            Level level;
+            level.width = width;
+            level.height = height;
+            level.counts.assign((size_t)width * height, 0);
+            level.dirty.assign((size_t)width * height, 1);
+            levels_.push_back(std::move(level));
+            if (width <= 1 && height <= 1)
+                break;
+            width = (width + 1) / 2;
+            height = (height + 1) / 2;
+        }
+    }
+
+    // Nível 0: cada palavra de 8 linhas dá 8 blocos, um por byte. O XOR com
+    // a grade anterior diz quais bytes mudaram.
+    const Grid *previous = full ? nullptr : grid_.get();
+    Level &base = levels_[0];
+    ForRows(pool, base.height, [&](int by0, int by1) {
+        const uint64_t *rows[kBaseBlock];
+        const uint64_t *before[kBaseBlock];
+        for (int by = by0; by < by1; by++) {
+            int y0 = by * kBaseBlock;
+            int n = std::min(kBaseBlock, next.height() - y0);
+            for (int i = 0; i < n; i++) {
+                rows[i] = next.row(y0 + i);
+                before[i] = previous ? previous->row(y0 + i) : nullptr;
+            }
+            uint32_t *counts = &base.counts[(size_t)by * base.width];
+            uint8_t *dirty = &base.dirty[(size_t)by * base.width];
+            for (int w = 0; w < next.words(); w++) {
+                int bx0 = w * 8;
+                int bx1 = std::min(bx0 + 8, base.width);
+                uint64_t changed = ~0ull;
+                if (previous) {
+                    changed = 0;
+                    for (int i = 0; i < n; i++)
+                        changed |= rows[i][w] ^ before[i][w];
+                    // O caso comum: nada mudou nas 8 linhas da palavra
+                    if (!changed) {
+                        std::fill(dirty + bx0, dirty + bx1, 0);
+                        continue;
+                    }
+                }
+                uint64_t sums = 0;
+                for (int i = 0; i < n; i++)
+                    sums += BytePopcounts(rows[i][w]);
+                for (int bx = bx0; bx < bx1; bx++) {
+                    int shift = 8 * (bx - bx0);
+                    counts[bx] = (uint32_t)(sums >> shift) & 0xff;
+                    dirty[bx] = ((changed >> shift) & 0xff) != 0;
+                }
+            }
+        }
+    });
+
+    // Níveis de cima: só os blocos com algum filho sujo são somados de novo
+    for (size_t l = 1; l < levels_.size(); l++) {
+        const Level &child = levels_[l - 1];
+        Level &level = levels_[l];
+        ForRows(pool, level.height, [&](int by0, int by1) {
+            for (int by = by0; by < by1; by++) {
+                int cy0 = 2 * by;
+                int cy1 = std::min(cy0 + 2, child.height);
+                // Linhas dos filhos; a de baixo pode não existir na borda
+                const uint8_t *dirty0 =
+                    &child.dirty[(size_t)cy0 * child.width];
+                const uint8_t *dirty1 =
+                    cy1 > cy0 + 1 ? dirty0 + child.width : dirty0;
+                const uint32_t *counts0 =
+                    &child.counts[(size_t)cy0 * child.width];
+                const uint32_t *counts1 =
+                    cy1 > cy0 + 1 ? counts0 + child.width : nullptr;
+                uint32_t *counts = &level.counts[(size_t)by * level.width];
+                uint8_t *dirty = &level.dirty[(size_t)by * level.width];
+                for (int bx = 0; bx < level.width; bx++) {
+                    int cx0 = 2 * bx;
+                    int cx1 = std::min(cx0 + 2, child.width);
+                    uint8_t changed = dirty0[cx0] | dirty1[cx0] |
+                                      dirty0[cx1 - 1] | dirty1[cx1 - 1];
+                    dirty[bx] = changed;
+                    if (!changed)
+                        continue;
+                    uint32_t count = counts0[cx0];
+                    if (cx1 > cx0 + 1)
+                        count += counts0[cx0 + 1];
+                    if (counts1) {
+                        count += counts1[cx0];
+                        if (cx1 > cx0 + 1)
+                            count += counts1[cx0 + 1];
+                    }
+                    counts[bx] = count;
+                }
+            }
+        });
+    }
+    grid_ = std::move(grid);
+}
+
+bool DensityPyramid::anyDirty(int level, int x0, int y0, int x1,
+                              int y1) const {
+    const Level &l = levels_[level];
+    x0 = std::max(x0, 0);
+    y0 = std::max(y0, 0);
+    x1 = std::min(x1, l.width);
+    y1 = std::min(y1, l.height);
+    for (int y = y0; y < y1; y++) {
+        const uint8_t *row = &l.dirty[(size_t)y * l.width];
+        if (std::find(row + x0, row + x1, 1) != row + x1)
+            return true;
+    }
+    return false;
+}
+
+} // namespace life
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "grid.h"
+#include "thread_pool.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace life {
+
+// Pirâmide de população para desenhar a grade de longe. O nível 0 conta as
+// células vivas de blocos de 8x8 (um byte de 8 linhas: popcount por byte
+// das palavras), e cada nível seguinte soma 2x2 blocos do anterior, até um
+// bloco só. update() guarda a grade recebida e marca como sujo todo bloco
+// cujas células mudaram desde a anterior, em todos os níveis, para quem
+// desenha reenviar só o que mudou.
+class DensityPyramid {
+public:
+    static constexpr int kBaseBlock = 8;
+
+    // Uma passada pelas palavras da grade (comparando com a anterior) e
+    // pelos blocos dos níveis; sem a grade anterior, ou com outro tamanho,
+    // tudo fica sujo
+    void update(std::shared_ptr<const Grid> grid, ThreadPool *pool = nullptr);
+
+    const std::shared_ptr<const Grid> &grid() const { return grid_; }
+    int levels() const { return (int)levels_.size(); }
+    // Lado do bloco do nível, em células
+    int blockSize(int level) const { return kBaseBlock << level; }
+    // Tamanho do nível em blocos (os da borda podem ficar incompletos)
+    int width(int level) const { return levels_[level].width; }
+    int height(int level) const { return levels_[level].height; }
+
+    // Linha by do nível: contagens e a marca de sujo de cada bloco
+    const uint32_t *counts(int level, int by) const {
+        const Level &l = levels_[level];
+        return &l.counts[(size_t)by * l.width];
+    }
+    const uint8_t *dirty(int level, int by) const {
+        const Level &l = levels_[level];
+        return &l.dirty[(size_t)by * l.width];
+    }
+    // Algum bloco do retângulo [x0, x1) x [y0, y1) do nível está sujo
+    bool anyDirty(int level, int x0, int y0, int x1, int y1) const;
+
+private:
+    struct Level {
+        int width = 0;
+        int height = 0;
+        std::vector<uint32_t> counts;
+        std::vector<uint8_t> dirty;
+    };
+
+    std::vector<Level> levels_;
+    std::shared_ptr<const Grid> grid_;
+};
+
+} // namespace life
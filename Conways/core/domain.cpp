@@ -0,0 +1,306 @@
+#include "domain.h"
+
+#include "bits.h"
+#include "cycle.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+namespace life {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+bool Fail(std::string *error, const std::string &message) {
+    if (error)
+        *error = message;
+    return false;
+}
+
+double Seconds(Clock::time_point start, Clock::time_point end) {
+    return std::chrono::duration<double>(end - start).count();
+}
+
+} // namespace
+
+int DomainStripBegin(int height, int ranks, int rank) {
+    return (int)((int64_t)height * rank / ranks);
+}
+
+size_t DomainHaloBytes(const DomainOptions &options) {
+    return (size_t)options.halo * ((options.width + 63) / 64) *
+           sizeof(uint64_t);
+}
+
+bool CheckDomainOptions(const DomainOptions &options, std::string *error) {
+    if (options.width <= 0 || options.height <= 0)
+        return Fail(error, "tamanho de grade inválido");
+    // Sem células de sobra na última palavra, o wrap horizontal é só o halo
+    // da Grid
+    if (options.width % 64 != 0)
+        return Fail(error, "a largura precisa ser múltiplo de 64");
+    if (options.ranks < 1 || options.rank < 0 ||
+        options.rank >= options.ranks)
+        return Fail(error, "rank inválido");
+    if (options.halo < 1)
+        return Fail(error, "o halo precisa ter pelo menos 1 linha");
+    // A menor faixa é a de height / ranks linhas
+    if (options.height / options.ranks < options.halo)
+        return Fail(error, "faixas de " +
+                               std::to_string(options.height /
+                                              options.ranks) +
+                               " linhas não cabem um halo de " +
+                               std::to_string(options.halo));
+    return true;
+}
+
+DomainWorker::DomainWorker(const DomainOptions &options, const Grid &strip,
+                           std::unique_ptr<HaloChannel> up,
+                           std::unique_ptr<HaloChannel> down)
+    : width_(options.width),
+      words_((options.width + 63) / 64),
+      y0_(DomainStripBegin(options.height, options.ranks, options.rank)),
+      rows_(DomainStripBegin(options.height, options.ranks,
+                             options.rank + 1) -
+            y0_),
+      halo_(options.halo), rule_(options.rule),
+      up_(std::move(up)), down_(std::move(down)) {
+    kernel_ = GetRowKernel(options.isa, RuleKernelFor(rule_));
+    if (!kernel_)
+        kernel_ = GetRowKernel(KernelIsa::Scalar, RuleKernelFor(rule_));
+    if (options.threads != 1)
+        pool_ = std::make_unique<ThreadPool>(options.threads);
+    if (pool_ && pool_->threadCount() == 1)
+        pool_.reset();
+
+    for (Grid &buffer : buffers_)
+        buffer = Grid(width_, rows_ + 2 * halo_);
+    for (int y = 0; y < rows_; y++)
+        std::copy(strip.row(y), strip.row(y) + words_, row(0, y));
+
+    size_t words = (size_t)halo_ * words_;
+    sendUp_.resize(words);
+    sendDown_.resize(words);
+    fromUp_.resize(words);
+    fromDown_.resize(words);
+    if (up_) {
+        sender_ = std::thread([this] { sendLoop(); });
+        receiver_ = std::thread([this] { receiveLoop(); });
+    }
+    startExchange();
+}
+
+DomainWorker::~DomainWorker() {
+    finishExchange(nullptr);
+    if (!up_)
+        return;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    sender_.join();
+    receiver_.join();
+}
+
+// Gera as linhas [y0, y1) da geração `level` da rodada a partir da anterior
+void DomainWorker::stepRows(int level, int y0, int y1) {
+    if (y0 >= y1)
+        return;
+    int src = (current_ + level - 1) & 1;
+    int dst = (current_ + level) & 1;
+    // Antes das bandas: vizinhas escreveriam o mesmo halo de borda
+    buffers_[src].prepareHalo(y0 - 1 + halo_, y1 + 1 + halo_);
+
+    auto body = [&](int b0, int b1) {
+        ProfileScope scope(ProfileZone::Band);
+        for (int y = b0; y < b1; y++)
+            kernel_(row(src, y - 1), row(src, y), row(src, y + 1),
+                    row(dst, y), words_, rule_);
+    };
+    if (!pool_) {
+        body(y0, y1);
+        return;
+    }
+    int threads = pool_->threadCount();
+    pool_->parallelFor(y0, y1, std::max(1, (y1 - y0 + threads - 1) / threads),
+                       body);
+}
+
+// Copia as linhas de borda da geração atual e entrega às threads de envio
+// e recepção. Com um rank só o halo é a própria faixa e sai na hora.
+void DomainWorker::startExchange() {
+    ProfileScope scope(ProfileZone::Halo);
+    int b = current_;
+    if (!up_) {
+        for (int i = 0; i < halo_; i++) {
+            std::copy(row(b, rows_ - halo_ + i),
+                      row(b, rows_ - halo_ + i) + words_, row(b, i - halo_));
+            std::copy(row(b, i), row(b, i) + words_, row(b, rows_ + i));
+        }
+        return;
+    }
+
+    for (int i = 0; i < halo_; i++) {
+        std::copy(row(b, i), row(b, i) + words_,
+                  sendUp_.data() + (size_t)i * words_);
+        std::copy(row(b, rows_ - halo_ + i),
+                  row(b, rows_ - halo_ + i) + words_,
+                  sendDown_.data() + (size_t)i * words_);
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        round_++;
+        pending_ = true;
+    }
+    wake_.notify_all();
+}
+
+// Espera a troca iniciada por startExchange() e copia o que chegou para o
+// halo da geração atual
+bool DomainWorker::finishExchange(std::string *error) {
+    ProfileScope scope(ProfileZone::Halo);
+    std::string failure;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!pending_)
+            return true;
+        done_.wait(lock, [this] {
+            return sent_ == round_ && received_ == round_;
+        });
+        pending_ = false;
+        failure = error_;
+    }
+    if (!failure.empty())
+        return Fail(error, failure);
+
+    int b = current_;
+    for (int i = 0; i < halo_; i++) {
+        const uint64_t *above = fromUp_.data() + (size_t)i * words_;
+        const uint64_t *below = fromDown_.data() + (size_t)i * words_;
+        std::copy(above, above + words_, row(b, i - halo_));
+        std::copy(below, below + words_, row(b, rows_ + i));
+    }
+    stats_.exchanges++;
+    stats_.bytesSent += 2 * up_->messageBytes();
+    return true;
+}
+
+// O envio e a recepção ficam em threads separadas: um lado que espera o
+// vizinho ler nunca impede este processo de ler o que o vizinho mandou
+void DomainWorker::sendLoop() {
+    SetProfileThreadName("halo send");
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        wake_.wait(lock, [this] { return stop_ || sent_ < round_; });
+        if (sent_ == round_)
+            return;
+        bool failed = !error_.empty();
+        lock.unlock();
+
+        std::string error;
+        if (!failed && (!up_->send(sendUp_.data(), &error) ||
+                        !down_->send(sendDown_.data(), &error)))
+            error = "envio do halo: " + error;
+
+        lock.lock();
+        if (!error.empty() && error_.empty())
+            error_ = error;
+        sent_++;
+        done_.notify_all();
+    }
+}
+
+void DomainWorker::receiveLoop() {
+    SetProfileThreadName("halo receive");
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        wake_.wait(lock, [this] { return stop_ || received_ < round_; });
+        if (received_ == round_)
+            return;
+        bool failed = !error_.empty();
+        lock.unlock();
+
+        std::string error;
+        if (!failed && (!up_->receive(fromUp_.data(), &error) ||
+                        !down_->receive(fromDown_.data(), &error)))
+            error = "recepção do halo: " + error;
+
+        lock.lock();
+        if (!error.empty() && error_.empty())
+            error_ = error;
+        received_++;
+        done_.notify_all();
+    }
+}
+
+// Cada rodada anda até `halo` gerações. Na geração j da rodada valem as
+// linhas [j - halo, rows + halo - j); as [j, rows - j) só dependem das
+// linhas próprias do início da rodada e saem antes do halo chegar. Com dois
+// buffers, a geração j + 1 sobrescreve a j - 1 só no miolo, que as bordas
+// da geração j não leem.
+bool DomainWorker::step(uint64_t n, std::string *error) {
+    while (n > 0) {
+        int levels = (int)std::min<uint64_t>(n, (uint64_t)halo_);
+        Clock::time_point start = Clock::now();
+        {
+            ProfileScope scope(ProfileZone::Step);
+            for (int j = 1; j <= levels; j++)
+                stepRows(j, j, std::max(j, rows_ - j));
+        }
+        Clock::time_point interior = Clock::now();
+        if (!finishExchange(error))
+            return false;
+        Clock::time_point arrived = Clock::now();
+        {
+            ProfileScope scope(ProfileZone::Step);
+            for (int j = 1; j <= levels; j++) {
+                stepRows(j, j - halo_, j);
+                stepRows(j, std::max(j, rows_ - j), rows_ + halo_ - j);
+            }
+        }
+        current_ = (current_ + levels) & 1;
+        generation_ += (uint64_t)levels;
+        n -= (uint64_t)levels;
+        startExchange();
+
+        Clock::time_point end = Clock::now();
+        stats_.computeSeconds += Seconds(start, interior) +
+                                 Seconds(arrived, end);
+        stats_.waitSeconds += Seconds(interior, arrived);
+    }
+    return true;
+}
+
+uint64_t DomainWorker::population() const {
+    uint64_t population = 0;
+    for (int y = 0; y < rows_; y++) {
+        const uint64_t *r = row(current_, y);
+        for (int w = 0; w < words_; w++)
+            population += (uint64_t)Popcount(r[w]);
+    }
+    return population;
+}
+
+uint64_t DomainWorker::hash() const {
+    uint64_t hash = 0;
+    for (int y = 0; y < rows_; y++) {
+        const uint64_t *r = row(current_, y);
+        uint64_t index = (uint64_t)(y0_ + y) * words_;
+        for (int w = 0; w < words_; w++)
+            hash ^= HashWord(index + w, r[w]);
+    }
+    return hash;
+}
+
+Grid DomainWorker::strip() const {
+    Grid strip(width_, rows_);
+    for (int y = 0; y < rows_; y++)
+        std::copy(row(current_, y), row(current_, y) + words_, strip.row(y));
+    return strip;
+}
+
+} // namespace life
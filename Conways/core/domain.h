@@ -0,0 +1,133 @@
+#pragma once
+
+#include "grid.h"
+#include "halo_channel.h"
+#include "kernel.h"
+#include "rule.h"
+#include "thread_pool.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace life {
+
+// Grade toroidal dividida em faixas horizontais, uma por processo (rank).
+// A faixa do rank r tem as linhas [DomainStripBegin(r), DomainStripBegin(r+1))
+// e a largura inteira, então o wrap horizontal é local; o vertical passa pelos
+// vizinhos r - 1 (acima) e r + 1 (abaixo), com o último ligado ao primeiro.
+struct DomainOptions {
+    int width = 0;  // múltiplo de 64
+    int height = 0; // da grade inteira
+    int ranks = 1;
+    int rank = 0;
+    // Linhas de halo de cada lado. Com halo k a faixa anda k gerações entre
+    // duas trocas, recalculando a cada geração a parte do halo que ainda
+    // vale; toda faixa precisa ter pelo menos k linhas.
+    int halo = 1;
+    int threads = 1; // como em Simulation::setThreadCount
+    Rule rule;
+    KernelIsa isa = DetectKernelIsa();
+};
+
+int DomainStripBegin(int height, int ranks, int rank);
+// Tamanho de uma mensagem de halo: halo linhas da faixa
+size_t DomainHaloBytes(const DomainOptions &options);
+bool CheckDomainOptions(const DomainOptions &options, std::string *error);
+
+// Um rank. Cada rodada de k gerações calcula primeiro o miolo da faixa, as
+// linhas que em k gerações não dependem do halo (um trapézio que encolhe uma
+// linha de cada lado por geração), enquanto o halo da rodada ainda está
+// chegando; só então espera a troca e completa as bordas. As linhas que vão
+// para os vizinhos são copiadas e enviadas por threads próprias (uma envia,
+// outra recebe) assim que a rodada termina, e a troca corre junto com o
+// miolo da rodada seguinte.
+class DomainWorker {
+public:
+    struct Stats {
+        double computeSeconds = 0.0;
+        double waitSeconds = 0.0; // esperando o halo depois do miolo
+        uint64_t exchanges = 0;
+        uint64_t bytesSent = 0;
+    };
+
+    // strip: as linhas próprias, já semeadas. up e down ligam aos ranks
+    // r - 1 e r + 1; com um rank só ficam nulos e o halo vem da própria
+    // faixa.
+    DomainWorker(const DomainOptions &options, const Grid &strip,
+                 std::unique_ptr<HaloChannel> up,
+                 std::unique_ptr<HaloChannel> down);
+    // Termina a troca em andamento
+    ~DomainWorker();
+
+    DomainWorker(const DomainWorker &) = delete;
+    DomainWorker &operator=(const DomainWorker &) = delete;
+
+    // Todos os ranks precisam dar os mesmos passos
+    bool step(uint64_t n, std::string *error);
+
+    int firstRow() const { return y0_; }
+    int rows() const { return rows_; }
+    uint64_t generation() const { return generation_; }
+    uint64_t population() const;
+    // XOR dos HashWord da faixa com os índices da grade inteira: o XOR dos
+    // hashes de todos os ranks é o HashGrid da grade toda
+    uint64_t hash() const;
+    // Cópia das linhas próprias
+    Grid strip() const;
+    const Stats &stats() const { return stats_; }
+
+private:
+    void stepRows(int level, int y0, int y1);
+    void startExchange();
+    bool finishExchange(std::string *error);
+    void sendLoop();
+    void receiveLoop();
+
+    // Linha y da faixa (0 é a primeira própria; o halo vai de -halo a
+    // rows + halo) no buffer b
+    uint64_t *row(int b, int y) { return buffers_[b].row(y + halo_); }
+    const uint64_t *row(int b, int y) const {
+        return buffers_[b].row(y + halo_);
+    }
+
+    int width_;
+    int words_;
+    int y0_;
+    int rows_;
+    int halo_;
+    Rule rule_;
+    RowKernel kernel_;
+    std::unique_ptr<ThreadPool> pool_;
+
+    Grid buffers_[2];
+    int current_ = 0;
+    uint64_t generation_ = 0;
+    Stats stats_;
+
+    std::unique_ptr<HaloChannel> up_;
+    std::unique_ptr<HaloChannel> down_;
+    // Linhas que saem (cima, baixo) e que chegam (de cima, de baixo)
+    std::vector<uint64_t> sendUp_;
+    std::vector<uint64_t> sendDown_;
+    std::vector<uint64_t> fromUp_;
+    std::vector<uint64_t> fromDown_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    uint64_t round_ = 0; // trocas iniciadas
+    uint64_t sent_ = 0;  // trocas enviadas
+    uint64_t received_ = 0;
+    bool pending_ = false;
+    bool stop_ = false;
+    std::string error_;
+    std::thread sender_;
+    std::thread receiver_;
+};
+
+} // namespace life
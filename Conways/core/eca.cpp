@@ -0,0 +1,329 @@
+#include "eca.h"
+
+#include "bits.h"
+#include "grid.h"
+#include "seed.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+#if defined(CONWAYS_WITH_ZSTD)
+#include <zstd.h>
+#endif
+
+namespace life {
+
+static bool Fail(std::string *error, const std::string &message) {
+    if (error)
+        *error = message;
+    return false;
+}
+
+namespace {
+
+// Novo estado de 64 células a partir dos vizinhos da esquerda (l), do
+// centro (c) e da direita (r). m[v] é 0 ou ~0 conforme o bit v da regra.
+inline uint64_t ApplyRule(const uint64_t m[8], uint64_t l, uint64_t c,
+                          uint64_t r) {
+    uint64_t q0 = m[0] ^ ((m[0] ^ m[1]) & r); // l = 0, c = 0
+    uint64_t q1 = m[2] ^ ((m[2] ^ m[3]) & r); // l = 0, c = 1
+    uint64_t q2 = m[4] ^ ((m[4] ^ m[5]) & r); // l = 1, c = 0
+    uint64_t q3 = m[6] ^ ((m[6] ^ m[7]) & r); // l = 1, c = 1
+    uint64_t h0 = q0 ^ ((q0 ^ q1) & c);
+    uint64_t h1 = q2 ^ ((q2 ^ q3) & c);
+    return h0 ^ ((h0 ^ h1) & l);
+}
+
+// A palavra cur com as vizinhas prev e next
+inline uint64_t StepWord(const uint64_t m[8], uint64_t prev, uint64_t cur,
+                         uint64_t next) {
+    uint64_t l = cur << 1 | prev >> 63;
+    uint64_t r = cur >> 1 | next << 63;
+    return ApplyRule(m, l, cur, r);
+}
+
+inline bool Cell(const uint64_t *row, int x) {
+    return row[x >> 6] >> (x & 63) & 1;
+}
+
+inline void SetCell(uint64_t *row, int x, bool alive) {
+    uint64_t bit = uint64_t(1) << (x & 63);
+    row[x >> 6] = alive ? row[x >> 6] | bit : row[x >> 6] & ~bit;
+}
+
+uint8_t ReverseBits8(uint8_t b) {
+    b = (uint8_t)((b & 0xf0) >> 4 | (b & 0x0f) << 4);
+    b = (uint8_t)((b & 0xcc) >> 2 | (b & 0x33) << 2);
+    return (uint8_t)((b & 0xaa) >> 1 | (b & 0x55) << 1);
+}
+
+void InitialRow(const EcaOptions &options, std::vector<uint64_t> &row) {
+    std::fill(row.begin(), row.end(), 0);
+    if (!options.random) {
+        SetCell(row.data(), options.width / 2, true);
+        return;
+    }
+    Grid grid(options.width, 1);
+    SeedOptions seed;
+    seed.seed = options.seed;
+    seed.density = options.density;
+    SeedGrid(grid, seed);
+    std::copy(grid.row(0), grid.row(0) + grid.words(), row.begin());
+}
+
+// Entropia de Shannon das janelas de 8 células (todas as posições, com
+// wrap), dividida por 8
+double BlockEntropy(const uint64_t *row, int width) {
+    uint32_t histogram[256] = {};
+    unsigned window = 0;
+    for (int j = 0; j < 8; j++)
+        window |= (unsigned)Cell(row, j % width) << j;
+    for (int x = 0; x < width; x++) {
+        histogram[window]++;
+        window = window >> 1 | (unsigned)Cell(row, (x + 8) % width) << 7;
+    }
+    double entropy = 0.0;
+    for (uint32_t count : histogram) {
+        if (count) {
+            double p = (double)count / width;
+            entropy -= p * std::log2(p);
+        }
+    }
+    return entropy / 8.0;
+}
+
+} // namespace
+
+void StepEcaRow(int rule, EcaBoundary boundary, int width,
+                const uint64_t *in, uint64_t *out) {
+    int words = (width + 63) / 64;
+    int tail = width & 63;
+    uint64_t m[8];
+    for (int v = 0; v < 8; v++)
+        m[v] = 0 - (uint64_t)(rule >> v & 1);
+
+    // Vizinhos fora da linha: a palavra antes da primeira (só o bit 63 é
+    // lido) e a célula width, que cai dentro da última palavra quando width
+    // não é múltiplo de 64. No modo Fixed ficam em 0 e as pontas são
+    // restauradas no fim.
+    uint64_t west = 0, east = 0;
+    if (boundary == EcaBoundary::Periodic) {
+        west = (uint64_t)Cell(in, width - 1) << 63;
+        east = in[0] & 1;
+    }
+    uint64_t last = in[words - 1];
+    uint64_t after = east;
+    if (tail) {
+        last |= east << tail;
+        after = 0;
+    }
+
+    if (words == 1) {
+        out[0] = StepWord(m, west, last, after);
+    } else {
+        out[0] = StepWord(m, west, in[0], in[1]);
+        for (int i = 1; i < words - 1; i++)
+            out[i] = StepWord(m, in[i - 1], in[i], in[i + 1]);
+        out[words - 1] = StepWord(m, in[words - 2], last, after);
+    }
+    if (tail)
+        out[words - 1] &= (uint64_t(1) << tail) - 1;
+
+    if (boundary == EcaBoundary::Fixed) {
+        SetCell(out, 0, Cell(in, 0));
+        SetCell(out, width - 1, Cell(in, width - 1));
+    }
+}
+
+#if defined(CONWAYS_WITH_ZSTD)
+
+struct EcaDiagramWriter::Zstd {
+    ZSTD_CStream *stream = nullptr;
+    std::vector<char> out = std::vector<char>(ZSTD_CStreamOutSize());
+
+    ~Zstd() { ZSTD_freeCStream(stream); }
+};
+
+#else
+
+struct EcaDiagramWriter::Zstd {};
+
+#endif
+
+EcaDiagramWriter::EcaDiagramWriter() = default;
+
+EcaDiagramWriter::~EcaDiagramWriter() { close(); }
+
+static bool EndsWith(const std::string &text, const char *suffix) {
+    size_t n = strlen(suffix);
+    return text.size() >= n && text.compare(text.size() - n, n, suffix) == 0;
+}
+
+bool EcaDiagramWriter::open(const std::string &path, int width,
+                            uint64_t rows, std::string *error) {
+    close();
+    bool compressed = EndsWith(path, ".zst");
+#if defined(CONWAYS_WITH_ZSTD)
+    if (compressed) {
+        zstd_.reset(new Zstd);
+        zstd_->stream = ZSTD_createCStream();
+        if (!zstd_->stream ||
+            ZSTD_isError(ZSTD_initCStream(zstd_->stream, 3))) {
+            zstd_.reset();
+            return Fail(error, "não foi possível iniciar o zstd");
+        }
+    }
+#else
+    if (compressed)
+        return Fail(error, "compilado sem suporte a zstd");
+#endif
+    file_ = fopen(path.c_str(), "wb");
+    if (!file_) {
+        zstd_.reset();
+        return Fail(error, "não foi possível criar " + path);
+    }
+    failed_ = false;
+    line_.assign((width + 7) / 8, 0);
+
+    std::string header = "P4\n" + std::to_string(width) + " " +
+                         std::to_string(rows) + "\n";
+    return write(header.data(), header.size()) ||
+           Fail(error, "falha ao gravar " + path);
+}
+
+bool EcaDiagramWriter::write(const void *data, size_t size) {
+    if (failed_)
+        return false;
+#if defined(CONWAYS_WITH_ZSTD)
+    if (zstd_) {
+        ZSTD_inBuffer in = {data, size, 0};
+        while (in.pos < in.size) {
+            ZSTD_outBuffer out = {zstd_->out.data(), zstd_->out.size(), 0};
+            size_t result = ZSTD_compressStream(zstd_->stream, &out, &in);
+            if (ZSTD_isError(result) ||
+                fwrite(out.dst, 1, out.pos, file_) != out.pos)
+                return !(failed_ = true);
+        }
+        return true;
+    }
+#endif
+    if (fwrite(data, 1, size, file_) != size)
+        failed_ = true;
+    return !failed_;
+}
+
+bool EcaDiagramWriter::writeRow(const uint64_t *row) {
+    if (!file_)
+        return false;
+    // O PBM guarda a célula mais à esquerda no bit mais alto de cada byte
+    for (size_t b = 0; b < line_.size(); b++)
+        line_[b] = ReverseBits8((uint8_t)(row[b >> 3] >> (b & 7) * 8));
+    return write(line_.data(), line_.size());
+}
+
+bool EcaDiagramWriter::close(std::string *error) {
+    if (!file_)
+        return true;
+#if defined(CONWAYS_WITH_ZSTD)
+    if (zstd_ && !failed_) {
+        size_t remaining;
+        do {
+            ZSTD_outBuffer out = {zstd_->out.data(), zstd_->out.size(), 0};
+            remaining = ZSTD_endStream(zstd_->stream, &out);
+            if (ZSTD_isError(remaining) ||
+                fwrite(out.dst, 1, out.pos, file_) != out.pos) {
+                failed_ = true;
+                break;
+            }
+        } while (remaining);
+    }
+#endif
+    zstd_.reset();
+    if (fclose(file_) != 0)
+        failed_ = true;
+    file_ = nullptr;
+    return !failed_ || Fail(error, "falha ao gravar o diagrama");
+}
+
+bool RunEca(const EcaOptions &options, EcaResult &result,
+            EcaDiagramWriter *writer, std::string *error) {
+    if (options.rule < 0 || options.rule > 255)
+        return Fail(error, "a regra deve estar entre 0 e 255");
+    if (options.width < 1)
+        return Fail(error, "largura inválida");
+    if (options.density < 0.0f || options.density > 1.0f)
+        return Fail(error, "a densidade deve estar entre 0 e 1");
+
+    auto start = std::chrono::steady_clock::now();
+    int words = (options.width + 63) / 64;
+    std::vector<uint64_t> initial(words);
+    InitialRow(options, initial);
+    std::vector<uint64_t> cur = initial, next(words), saved = initial;
+    auto step = [&](std::vector<uint64_t> &row) {
+        StepEcaRow(options.rule, options.boundary, options.width, row.data(),
+                   next.data());
+        row.swap(next);
+    };
+
+    result = EcaResult();
+    if (writer && !writer->writeRow(cur.data()))
+        return Fail(error, "falha ao gravar o diagrama");
+
+    // Brent: saved é a linha da última potência de 2; lam é a distância dela
+    // até a linha atual. O primeiro lam em que as duas coincidem é o período.
+    uint64_t power = 1, lam = 1;
+    while (result.generations < options.generations) {
+        step(cur);
+        result.generations++;
+        if (writer && !writer->writeRow(cur.data()))
+            return Fail(error, "falha ao gravar o diagrama");
+        if (result.period)
+            continue;
+        if (cur == saved) {
+            result.period = lam;
+            if (options.stopAtCycle && !writer)
+                break;
+            continue;
+        }
+        if (power == lam) {
+            saved = cur;
+            power *= 2;
+            lam = 0;
+        }
+        lam++;
+    }
+
+    if (result.period) {
+        // Transiente: a primeira linha igual à que está period gerações
+        // adiante
+        std::vector<uint64_t> &a = saved, &b = cur;
+        a = initial;
+        b = initial;
+        for (uint64_t g = 0; g < result.period; g++)
+            step(b);
+        while (a != b) {
+            step(a);
+            step(b);
+            result.transient++;
+        }
+        // b está no início do ciclo; avança até a fase da última linha
+        uint64_t phase =
+            (result.generations - result.transient) % result.period;
+        for (uint64_t g = 0; g < phase; g++)
+            step(b);
+    }
+
+    result.density = 0.0;
+    for (int i = 0; i < words; i++)
+        result.density += Popcount(cur[i]);
+    result.density /= options.width;
+    result.entropy = BlockEntropy(cur.data(), options.width);
+    result.seconds = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+    return true;
+}
+
+} // namespace life
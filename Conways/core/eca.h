@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace life {
+
+// Autômato celular elementar (as 256 regras de Wolfram), o mesmo do
+// Web/ElementaryCellularAutomaton. Uma linha tem 64 células por palavra,
+// com o bit i da palavra j sendo a célula j * 64 + i, como no Grid.
+enum class EcaBoundary {
+    Periodic, // a linha fecha num anel
+    Fixed,    // as células das pontas não mudam, como no game.js
+};
+
+// Calcula a próxima linha: o bit (4 * esquerda + 2 * centro + direita) da
+// regra é o novo estado. Todas as regras usam a mesma árvore de seleções
+// bit a bit, 64 células por vez. out não pode ser in.
+void StepEcaRow(int rule, EcaBoundary boundary, int width,
+                const uint64_t *in, uint64_t *out);
+
+// Diagrama espaço-tempo em PBM binário (P4), uma linha por geração, gravado
+// enquanto a simulação roda, então cabem milhões de linhas sem guardar
+// nenhuma. Um caminho terminado em ".zst" sai comprimido com zstd em fluxo
+// (precisa do build com --with-zstd).
+class EcaDiagramWriter {
+public:
+    EcaDiagramWriter();
+    ~EcaDiagramWriter();
+
+    bool open(const std::string &path, int width, uint64_t rows,
+              std::string *error = nullptr);
+    bool writeRow(const uint64_t *row);
+    // Termina o fluxo e fecha; devolve false se alguma escrita falhou
+    bool close(std::string *error = nullptr);
+
+private:
+    struct Zstd;
+
+    bool write(const void *data, size_t size);
+
+    FILE *file_ = nullptr;
+    bool failed_ = false;
+    std::vector<uint8_t> line_;
+    std::unique_ptr<Zstd> zstd_;
+};
+
+struct EcaOptions {
+    int rule = 30;
+    int width = 4096;
+    uint64_t generations = 4096;
+    EcaBoundary boundary = EcaBoundary::Periodic;
+    // Linha inicial: uma célula viva no meio (como no game.js) ou aleatória,
+    // com o mesmo hash de contador do SeedGrid
+    bool random = false;
+    uint64_t seed = 0;
+    float density = 0.5f;
+    // Para no primeiro ciclo, quando não há diagrama sendo gravado
+    bool stopAtCycle = true;
+};
+
+struct EcaResult {
+    uint64_t generations = 0; // geradas de fato
+    double density = 0.0;     // da última linha
+    // Entropia dos blocos de 8 células da última linha, em bits por célula
+    // (0 = uniforme, 1 = aleatória)
+    double entropy = 0.0;
+    // Primeiro ciclo: a linha transient + period é igual à linha transient.
+    // period = 0 se nenhum ciclo apareceu nas gerações rodadas.
+    uint64_t period = 0;
+    uint64_t transient = 0;
+    double seconds = 0.0;
+};
+
+// Roda uma regra a partir de uma linha inicial. O ciclo é detectado pelo
+// algoritmo de Brent, com memória constante (uma linha guardada), e o
+// transiente por uma segunda passada curta. writer pode ser nulo.
+bool RunEca(const EcaOptions &options, EcaResult &result,
+            EcaDiagramWriter *writer = nullptr, std::string *error = nullptr);
+
+} // namespace life
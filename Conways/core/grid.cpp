@@ -0,0 +1,131 @@
+#include "grid.h"
+
+#include "bits.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace life {
+
+Grid::Grid(int width, int height)
+    : width_(width), height_(height), words_((width + 63) / 64),
+      stride_(words_ + 2), data_((size_t)stride_ * height, 0) {
+    base_ = data_.data();
+}
+
+Grid::Grid(const Grid &other)
+    : width_(other.width_), height_(other.height_), words_(other.words_),
+      stride_(other.stride_),
+      data_(other.base_,
+            other.base_ + (size_t)other.stride_ * other.height_) {
+    base_ = data_.data();
+}
+
+Grid::Grid(Grid &&other) noexcept { swap(other); }
+
+Grid &Grid::operator=(const Grid &other) {
+    if (this != &other) {
+        Grid copy(other);
+        swap(copy);
+    }
+    return *this;
+}
+
+Grid &Grid::operator=(Grid &&other) noexcept {
+    Grid moved(std::move(other));
+    swap(moved);
+    return *this;
+}
+
+Grid Grid::Wrap(int width, int height, uint64_t *data,
+                std::shared_ptr<void> storage) {
+    Grid grid;
+    grid.width_ = width;
+    grid.height_ = height;
+    grid.words_ = (width + 63) / 64;
+    grid.stride_ = grid.words_ + 2;
+    grid.base_ = data;
+    grid.storage_ = std::move(storage);
+    return grid;
+}
+
+void Grid::swap(Grid &other) noexcept {
+    std::swap(width_, other.width_);
+    std::swap(height_, other.height_);
+    std::swap(words_, other.words_);
+    std::swap(stride_, other.stride_);
+    std::swap(base_, other.base_);
+    data_.swap(other.data_);
+    storage_.swap(other.storage_);
+}
+
+bool Grid::get(int x, int y) const {
+    return (row(y)[x >> 6] >> (x & 63)) & 1;
+}
+
+void Grid::set(int x, int y, bool alive) {
+    uint64_t bit = 1ull << (x & 63);
+    uint64_t &word = row(y)[x >> 6];
+    if (alive)
+        word |= bit;
+    else
+        word &= ~bit;
+}
+
+void Grid::prepareHalo(int y0, int y1) {
+    int lastBit = (width_ - 1) & 63;
+    int last = words_ - 1;
+    bool aligned = (width_ & 63) == 0;
+    for (int y = y0; y < y1; y++) {
+        uint64_t *r = row(y);
+        r[-1] = ((r[last] >> lastBit) & 1) << 63;
+        // Vizinho leste da célula width-1, se ela é o bit 63
+        r[words_] = aligned ? r[0] & 1 : 0;
+    }
+}
+
+void Grid::clearPadding(int y0, int y1) {
+    int tail = width_ & 63;
+    if (tail == 0)
+        return;
+    uint64_t mask = (1ull << tail) - 1;
+    for (int y = y0; y < y1; y++)
+        row(y)[words_ - 1] &= mask;
+}
+
+void Grid::clear() {
+    std::fill(base_, base_ + (size_t)stride_ * height_, 0);
+}
+
+void Grid::paste(const Grid &pattern, int x, int y) {
+    for (int py = 0; py < pattern.height(); py++) {
+        int gy = ((y + py) % height_ + height_) % height_;
+        for (int px = 0; px < pattern.width(); px++) {
+            if (pattern.get(px, py)) {
+                int gx = ((x + px) % width_ + width_) % width_;
+                set(gx, gy, true);
+            }
+        }
+    }
+}
+
+uint64_t Grid::population() const {
+    uint64_t total = 0;
+    for (int y = 0; y < height_; y++) {
+        const uint64_t *r = row(y);
+        for (int i = 0; i < words_; i++)
+            total += Popcount(r[i]);
+    }
+    return total;
+}
+
+bool Grid::operator==(const Grid &other) const {
+    if (width_ != other.width_ || height_ != other.height_)
+        return false;
+    for (int y = 0; y < height_; y++)
+        if (!std::equal(row(y), row(y) + words_, other.row(y)))
+            return false;
+    return true;
+}
+
+} // namespace life
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace life {
+
+// Grade toroidal com 1 bit por célula (64 células por palavra).
+// O bit i da palavra j de uma linha é a célula x = j * 64 + i, e as bordas
+// se conectam como o sampler em REPEAT das texturas do main.cpp.
+//
+// Cada linha tem uma palavra extra de cada lado (halo). prepareHalo() copia
+// para lá as células do lado oposto, de forma que os kernels leiam os
+// vizinhos de [-1, words] sem tratar o wrap. Ela só escreve no halo: quando
+// width não é múltiplo de 64, o vizinho leste da célula width-1 cai dentro da
+// última palavra e quem chama o kernel monta essa palavra numa cópia local
+// (veja Simulation). Assim outra thread pode ler as células durante um passo.
+// Os bits além de width ficam sempre zerados.
+//
+// A memória normalmente é da própria grade, mas também pode ser externa (um
+// snapshot mapeado com mmap, por exemplo); cópias sempre alocam memória
+// própria.
+class Grid {
+public:
+    Grid() = default;
+    Grid(int width, int height);
+    Grid(const Grid &other);
+    Grid(Grid &&other) noexcept;
+    Grid &operator=(const Grid &other);
+    Grid &operator=(Grid &&other) noexcept;
+
+    // Usa memória externa com o layout de stride(): height linhas de
+    // StrideFor(width) palavras, halo incluído. storage mantém a memória viva
+    // enquanto a grade (ou uma cópia movida dela) existir.
+    static Grid Wrap(int width, int height, uint64_t *data,
+                     std::shared_ptr<void> storage);
+    static int StrideFor(int width) { return (width + 63) / 64 + 2; }
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+    int words() const { return words_; } // palavras por linha
+    int stride() const { return stride_; } // palavras por linha com o halo
+    size_t cells() const { return (size_t)width_ * height_; }
+
+    bool get(int x, int y) const;
+    void set(int x, int y, bool alive);
+    void clear();
+
+    uint64_t *row(int y) { return base_ + (size_t)y * stride_ + 1; }
+    const uint64_t *row(int y) const {
+        return base_ + (size_t)y * stride_ + 1;
+    }
+
+    // Versões por faixa de linhas [y0, y1), para rodar em paralelo
+    void prepareHalo() { prepareHalo(0, height_); }
+    void prepareHalo(int y0, int y1);
+    void clearPadding() { clearPadding(0, height_); }
+    void clearPadding(int y0, int y1);
+
+    // Copia o padrão com o canto superior esquerdo em (x, y), com wrap.
+    void paste(const Grid &pattern, int x, int y);
+
+    uint64_t population() const;
+
+    bool operator==(const Grid &other) const;
+    bool operator!=(const Grid &other) const { return !(*this == other); }
+
+    void swap(Grid &other) noexcept;
+
+private:
+    int width_ = 0;
+    int height_ = 0;
+    int words_ = 0;
+    int stride_ = 0;
+    uint64_t *base_ = nullptr;
+    std::vector<uint64_t> data_;    // vazio se a memória é externa
+    std::shared_ptr<void> storage_; // dono da memória externa
+};
+
+} // namespace life
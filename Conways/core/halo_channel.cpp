@@ -0,0 +1,411 @@
+#include "halo_channel.h"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace life {
+
+namespace {
+
+bool Fail(std::string *error, const std::string &message) {
+    if (error)
+        *error = message;
+    return false;
+}
+
+#if !defined(_WIN32)
+
+using Clock = std::chrono::steady_clock;
+
+Clock::time_point Deadline(double seconds) {
+    return Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                              std::chrono::duration<double>(seconds));
+}
+
+// Gira um pouco (o vizinho costuma estar perto) e depois dorme em passos
+// curtos; false se passou do prazo
+template <class Ready>
+bool WaitFor(const Ready &ready, double timeoutSeconds) {
+    for (int i = 0; i < 4096; i++)
+        if (ready())
+            return true;
+    Clock::time_point deadline = Deadline(timeoutSeconds);
+    while (!ready()) {
+        if (Clock::now() > deadline)
+            return false;
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+    return true;
+}
+
+// Uma caixa de correio por sentido, cada contador na própria cache line
+struct alignas(64) Mailbox {
+    std::atomic<uint64_t> written;
+    alignas(64) std::atomic<uint64_t> read;
+};
+
+struct alignas(64) ShmHeader {
+    std::atomic<uint32_t> ready;
+    uint64_t bytes;
+    Mailbox boxes[2];
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "os contadores da memória compartilhada precisam ser lock-free");
+
+size_t Align64(size_t bytes) { return (bytes + 63) & ~(size_t)63; }
+
+class ShmChannel : public HaloChannel {
+public:
+    ShmChannel(size_t bytes, double timeoutSeconds)
+        : HaloChannel(bytes), timeout_(timeoutSeconds) {}
+
+    ~ShmChannel() override {
+        if (base_)
+            munmap(base_, size_);
+        if (owner_)
+            shm_unlink(name_.c_str());
+    }
+
+    bool open(const std::string &name, bool create, std::string *error) {
+        name_ = name[0] == '/' ? name : "/" + name;
+        size_ = sizeof(ShmHeader) + 2 * Align64(messageBytes());
+        int fd = -1;
+        if (create) {
+            // Um segmento com o mesmo nome é resto de uma execução que caiu
+            shm_unlink(name_.c_str());
+            fd = shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+            if (fd < 0 || ftruncate(fd, (off_t)size_) != 0) {
+                if (fd >= 0)
+                    close(fd);
+                return Fail(error, "não foi possível criar " + name_);
+            }
+            owner_ = true;
+        } else {
+            Clock::time_point deadline = Deadline(timeout_);
+            for (;;) {
+                fd = shm_open(name_.c_str(), O_RDWR, 0600);
+                struct stat info;
+                if (fd >= 0 && fstat(fd, &info) == 0 &&
+                    (size_t)info.st_size >= size_)
+                    break;
+                if (fd >= 0)
+                    close(fd);
+                if (Clock::now() > deadline)
+                    return Fail(error, "o vizinho não criou " + name_);
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+        }
+        void *base =
+            mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (base == MAP_FAILED)
+            return Fail(error, "não foi possível mapear " + name_);
+        base_ = base;
+
+        // O segmento novo vem zerado: contadores em 0
+        ShmHeader *header = static_cast<ShmHeader *>(base_);
+        if (create) {
+            header->bytes = messageBytes();
+            header->ready.store(1, std::memory_order_release);
+        } else if (!WaitFor(
+                       [header] {
+                           return header->ready.load(
+                                      std::memory_order_acquire) == 1;
+                       },
+                       timeout_)) {
+            return Fail(error, "o vizinho não preparou " + name_);
+        } else if (header->bytes != messageBytes()) {
+            return Fail(error, "o vizinho usa outro tamanho de halo em " +
+                                   name_);
+        }
+
+        // Quem cria envia pela caixa 0 e recebe pela 1
+        char *payload = static_cast<char *>(base_) + sizeof(ShmHeader);
+        int out = create ? 0 : 1;
+        outBox_ = &header->boxes[out];
+        inBox_ = &header->boxes[1 - out];
+        outData_ = payload + out * Align64(messageBytes());
+        inData_ = payload + (1 - out) * Align64(messageBytes());
+        return true;
+    }
+
+    bool send(const void *data, std::string *error) override {
+        // Espera o vizinho ter lido a anterior
+        uint64_t previous = sent_++;
+        Mailbox *box = outBox_;
+        if (!WaitFor(
+                [box, previous] {
+                    return box->read.load(std::memory_order_acquire) ==
+                           previous;
+                },
+                timeout_))
+            return Fail(error, "o vizinho parou de ler " + name_);
+        memcpy(outData_, data, messageBytes());
+        box->written.store(sent_, std::memory_order_release);
+        return true;
+    }
+
+    bool receive(void *data, std::string *error) override {
+        uint64_t expected = ++received_;
+        Mailbox *box = inBox_;
+        if (!WaitFor(
+                [box, expected] {
+                    return box->written.load(std::memory_order_acquire) ==
+                           expected;
+                },
+                timeout_))
+            return Fail(error, "o vizinho parou de escrever " + name_);
+        memcpy(data, inData_, messageBytes());
+        box->read.store(expected, std::memory_order_release);
+        return true;
+    }
+
+private:
+    double timeout_;
+    std::string name_;
+    size_t size_ = 0;
+    void *base_ = nullptr;
+    bool owner_ = false;
+    Mailbox *outBox_ = nullptr;
+    Mailbox *inBox_ = nullptr;
+    char *outData_ = nullptr;
+    char *inData_ = nullptr;
+    uint64_t sent_ = 0;
+    uint64_t received_ = 0;
+};
+
+// Cabeçalho trocado na conexão: o mesmo binário dos dois lados e o mesmo
+// tamanho de mensagem
+struct TcpHello {
+    uint64_t magic;
+    uint64_t bytes;
+};
+constexpr uint64_t kHelloMagic = 0x4C49464548414C4Full; // "LIFEHALO"
+
+class TcpChannel : public HaloChannel {
+public:
+    TcpChannel(int fd, size_t bytes) : HaloChannel(bytes), fd_(fd) {}
+    ~TcpChannel() override { close(fd_); }
+
+    bool handshake(double timeoutSeconds, std::string *error) {
+        int on = 1;
+        setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+        // A espera de cada recv também tem prazo: um vizinho que caiu não
+        // trava o processo para sempre
+        struct timeval timeout;
+        timeout.tv_sec = (time_t)timeoutSeconds;
+        timeout.tv_usec =
+            (suseconds_t)((timeoutSeconds - (double)timeout.tv_sec) * 1e6);
+        setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+        TcpHello hello = {kHelloMagic, messageBytes()};
+        TcpHello peer;
+        if (!write(&hello, sizeof(hello), error) ||
+            !read(&peer, sizeof(peer), error))
+            return false;
+        if (peer.magic != kHelloMagic)
+            return Fail(error, "o vizinho não é um conways-domain");
+        if (peer.bytes != messageBytes())
+            return Fail(error, "o vizinho usa outro tamanho de halo");
+        return true;
+    }
+
+    bool send(const void *data, std::string *error) override {
+        return write(data, messageBytes(), error);
+    }
+
+    bool receive(void *data, std::string *error) override {
+        return read(data, messageBytes(), error);
+    }
+
+private:
+    bool write(const void *data, size_t bytes, std::string *error) {
+        const char *p = static_cast<const char *>(data);
+        int flags = 0;
+#if defined(MSG_NOSIGNAL)
+        flags = MSG_NOSIGNAL; // sem SIGPIPE se o vizinho fechou
+#endif
+        while (bytes) {
+            ssize_t n = ::send(fd_, p, bytes, flags);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                return Fail(error, std::string("erro ao enviar o halo: ") +
+                                       strerror(errno));
+            p += n;
+            bytes -= (size_t)n;
+        }
+        return true;
+    }
+
+    bool read(void *data, size_t bytes, std::string *error) {
+        char *p = static_cast<char *>(data);
+        while (bytes) {
+            ssize_t n = ::recv(fd_, p, bytes, 0);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n == 0)
+                return Fail(error, "o vizinho fechou a conexão");
+            if (n < 0)
+                return Fail(error, std::string("erro ao receber o halo: ") +
+                                       strerror(errno));
+            p += n;
+            bytes -= (size_t)n;
+        }
+        return true;
+    }
+
+    int fd_;
+};
+
+std::unique_ptr<HaloChannel> FinishTcp(int fd, size_t bytes,
+                                       double timeoutSeconds,
+                                       std::string *error) {
+    auto channel = std::make_unique<TcpChannel>(fd, bytes);
+    if (!channel->handshake(timeoutSeconds, error))
+        return nullptr;
+    return channel;
+}
+
+#endif
+
+} // namespace
+
+#if !defined(_WIN32)
+
+std::unique_ptr<HaloChannel> OpenShmChannel(const std::string &name,
+                                            bool create, size_t bytes,
+                                            double timeoutSeconds,
+                                            std::string *error) {
+    auto channel = std::make_unique<ShmChannel>(bytes, timeoutSeconds);
+    if (!channel->open(name, create, error))
+        return nullptr;
+    return channel;
+}
+
+std::unique_ptr<HaloChannel> AcceptTcpChannel(int port, size_t bytes,
+                                              double timeoutSeconds,
+                                              std::string *error) {
+    int listener = socket(AF_INET6, SOCK_STREAM, 0);
+    bool v6 = listener >= 0;
+    if (!v6)
+        listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (listener < 0) {
+        Fail(error, "não foi possível criar o socket");
+        return nullptr;
+    }
+    int on = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+    int bound;
+    if (v6) {
+        // IPv6 com IPv4 mapeado: aceita os dois
+        int off = 0;
+        setsockopt(listener, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off));
+        sockaddr_in6 address = {};
+        address.sin6_family = AF_INET6;
+        address.sin6_addr = in6addr_any;
+        address.sin6_port = htons((uint16_t)port);
+        bound = bind(listener, (sockaddr *)&address, sizeof(address));
+    } else {
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_ANY);
+        address.sin_port = htons((uint16_t)port);
+        bound = bind(listener, (sockaddr *)&address, sizeof(address));
+    }
+    if (bound != 0 || listen(listener, 1) != 0) {
+        close(listener);
+        Fail(error, "não foi possível escutar na porta " +
+                        std::to_string(port));
+        return nullptr;
+    }
+
+    pollfd waiting = {listener, POLLIN, 0};
+    int ready = poll(&waiting, 1, (int)(timeoutSeconds * 1000.0));
+    int fd = ready > 0 ? accept(listener, nullptr, nullptr) : -1;
+    close(listener);
+    if (fd < 0) {
+        Fail(error, "nenhum vizinho conectou na porta " +
+                        std::to_string(port));
+        return nullptr;
+    }
+    return FinishTcp(fd, bytes, timeoutSeconds, error);
+}
+
+std::unique_ptr<HaloChannel> ConnectTcpChannel(const std::string &host,
+                                               int port, size_t bytes,
+                                               double timeoutSeconds,
+                                               std::string *error) {
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    std::string service = std::to_string(port);
+    Clock::time_point deadline = Deadline(timeoutSeconds);
+
+    // O vizinho pode ainda não estar escutando: tenta até o prazo
+    for (;;) {
+        addrinfo *found = nullptr;
+        if (getaddrinfo(host.c_str(), service.c_str(), &hints, &found) == 0) {
+            for (addrinfo *a = found; a; a = a->ai_next) {
+                int fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+                if (fd < 0)
+                    continue;
+                if (connect(fd, a->ai_addr, a->ai_addrlen) == 0) {
+                    freeaddrinfo(found);
+                    return FinishTcp(fd, bytes, timeoutSeconds, error);
+                }
+                close(fd);
+            }
+            freeaddrinfo(found);
+        }
+        if (Clock::now() > deadline) {
+            Fail(error, "não foi possível conectar em " + host + ":" +
+                            service);
+            return nullptr;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+}
+
+#else
+
+std::unique_ptr<HaloChannel> OpenShmChannel(const std::string &,
+                                            bool, size_t, double,
+                                            std::string *error) {
+    Fail(error, "halo em memória compartilhada não suportado no Windows");
+    return nullptr;
+}
+
+std::unique_ptr<HaloChannel> AcceptTcpChannel(int, size_t, double,
+                                              std::string *error) {
+    Fail(error, "halo por TCP não suportado no Windows");
+    return nullptr;
+}
+
+std::unique_ptr<HaloChannel> ConnectTcpChannel(const std::string &, int,
+                                               size_t, double,
+                                               std::string *error) {
+    Fail(error, "halo por TCP não suportado no Windows");
+    return nullptr;
+}
+
+#endif
+
+} // namespace life
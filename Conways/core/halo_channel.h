@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace life {
+
+// Canal full-duplex entre dois processos vizinhos de uma DomainWorker, por
+// onde passam as linhas de halo. As mensagens têm o tamanho combinado na
+// abertura e chegam em ordem. send() e receive() podem rodar ao mesmo tempo
+// em threads diferentes (uma de cada), mas não duas de cada.
+class HaloChannel {
+public:
+    virtual ~HaloChannel() = default;
+
+    virtual bool send(const void *data, std::string *error) = 0;
+    virtual bool receive(void *data, std::string *error) = 0;
+    size_t messageBytes() const { return bytes_; }
+
+protected:
+    explicit HaloChannel(size_t bytes) : bytes_(bytes) {}
+
+private:
+    size_t bytes_;
+};
+
+// Memória compartilhada (POSIX shm) com duas caixas de correio, uma por
+// sentido. Quem cria (create) zera o segmento e apaga o nome no fim; o outro
+// lado espera o segmento ficar pronto por até timeoutSeconds. A espera por
+// uma mensagem gira e depois dorme em passos curtos, sem trava.
+std::unique_ptr<HaloChannel> OpenShmChannel(const std::string &name,
+                                            bool create, size_t bytes,
+                                            double timeoutSeconds,
+                                            std::string *error);
+
+// TCP, com TCP_NODELAY. Um lado escuta em port (todas as interfaces) e
+// aceita uma conexão; o outro conecta em host:port, tentando de novo até
+// timeoutSeconds enquanto o vizinho ainda não subiu. Os dois lados trocam
+// um cabeçalho com o tamanho das mensagens, para recusar um vizinho com
+// outra configuração.
+std::unique_ptr<HaloChannel> AcceptTcpChannel(int port, size_t bytes,
+                                              double timeoutSeconds,
+                                              std::string *error);
+std::unique_ptr<HaloChannel> ConnectTcpChannel(const std::string &host,
+                                               int port, size_t bytes,
+                                               double timeoutSeconds,
+                                               std::string *error);
+
+} // namespace life
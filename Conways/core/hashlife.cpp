@@ -0,0 +1,499 @@
+#include "hashlife.h"
+
+#include <algorithm>
+
+namespace life {
+
+// Nós 0 e 1 são as células morta e viva (nível 0)
+static constexpr uint32_t kDead = 0;
+static constexpr uint32_t kAlive = 1;
+
+static inline size_t HashChildren(uint32_t nw, uint32_t ne, uint32_t sw,
+                                  uint32_t se) {
+    uint64_t h = nw;
+    h = h * 0x9E3779B97F4A7C15ull + ne;
+    h = h * 0x9E3779B97F4A7C15ull + sw;
+    h = h * 0x9E3779B97F4A7C15ull + se;
+    return (size_t)(h ^ (h >> 29));
+}
+
+static bool RegionEmpty(const Grid &grid, int64_t x0, int64_t y0, int64_t x1,
+                        int64_t y1) {
+    x0 = std::max<int64_t>(x0, 0);
+    y0 = std::max<int64_t>(y0, 0);
+    x1 = std::min<int64_t>(x1, grid.width());
+    y1 = std::min<int64_t>(y1, grid.height());
+    if (x0 >= x1 || y0 >= y1)
+        return true;
+
+    int firstWord = (int)(x0 >> 6);
+    int lastWord = (int)((x1 - 1) >> 6);
+    uint64_t firstMask = ~0ull << (x0 & 63);
+    uint64_t lastMask = ~0ull >> (63 - ((x1 - 1) & 63));
+    for (int64_t y = y0; y < y1; y++) {
+        const uint64_t *row = grid.row((int)y);
+        for (int w = firstWord; w <= lastWord; w++) {
+            uint64_t word = row[w];
+            if (w == firstWord)
+                word &= firstMask;
+            if (w == lastWord)
+                word &= lastMask;
+            if (word)
+                return false;
+        }
+    }
+    return true;
+}
+
+HashLife::HashLife(size_t maxNodes)
+    : maxNodes_(maxNodes), collectAt_(maxNodes) {
+    clear();
+}
+
+void HashLife::clear() {
+    nodes_.clear();
+    freeList_.clear();
+    emptyNodes_.clear();
+    stack_.clear();
+    table_.assign(1 << 16, kNone);
+    generation_ = 0;
+
+    nodes_.push_back({0, 0, 0, 0, kNone, 0, 0, 0, 0});
+    nodes_.push_back({0, 0, 0, 0, kNone, 0, 0, 0, 1});
+    liveNodes_ = 2;
+    emptyNodes_.push_back(kDead);
+
+    root_ = empty(3);
+}
+
+void HashLife::insert(uint32_t index) {
+    const Node &node = nodes_[index];
+    size_t mask = table_.size() - 1;
+    size_t slot = HashChildren(node.nw, node.ne, node.sw, node.se) & mask;
+    while (table_[slot] != kNone)
+        slot = (slot + 1) & mask;
+    table_[slot] = index;
+}
+
+void HashLife::rebuildTable() {
+    size_t size = table_.size();
+    while (size < liveNodes_ * 2)
+        size *= 2;
+    table_.assign(size, kNone);
+    for (uint32_t i = 2; i < nodes_.size(); i++)
+        if (nodes_[i].level > 0)
+            insert(i);
+}
+
+uint32_t HashLife::join(uint32_t nw, uint32_t ne, uint32_t sw, uint32_t se) {
+    lookups_++;
+    size_t mask = table_.size() - 1;
+    size_t slot = HashChildren(nw, ne, sw, se) & mask;
+    while (table_[slot] != kNone) {
+        const Node &node = nodes_[table_[slot]];
+        if (node.nw == nw && node.ne == ne && node.sw == sw && node.se == se) {
+            hits_++;
+            return table_[slot];
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    // Só coleta dentro de stepPow2, onde todas as raízes estão na pilha
+    if (liveNodes_ >= collectAt_ && collecting_) {
+        stack_.push_back(nw);
+        stack_.push_back(ne);
+        stack_.push_back(sw);
+        stack_.push_back(se);
+        collectGarbage();
+        stack_.resize(stack_.size() - 4);
+        return join(nw, ne, sw, se);
+    }
+
+    Node node;
+    node.nw = nw;
+    node.ne = ne;
+    node.sw = sw;
+    node.se = se;
+    node.result = kNone;
+    node.level = (uint8_t)(nodes_[nw].level + 1);
+    node.resultStep = 0;
+    node.mark = 0;
+    node.population = nodes_[nw].population + nodes_[ne].population +
+                      nodes_[sw].population + nodes_[se].population;
+
+    uint32_t index;
+    if (!freeList_.empty()) {
+        index = freeList_.back();
+        freeList_.pop_back();
+        nodes_[index] = node;
+    } else {
+        index = (uint32_t)nodes_.size();
+        nodes_.push_back(node);
+    }
+    liveNodes_++;
+
+    if (liveNodes_ * 2 > table_.size()) {
+        rebuildTable();
+    } else {
+        table_[slot] = index;
+    }
+    return index;
+}
+
+bool HashLife::setRule(const Rule &rule) {
+    if (rule.birth & 1)
+        return false;
+    if (rule == rule_)
+        return true;
+    rule_ = rule;
+    for (auto &node : nodes_)
+        node.result = kNone;
+    return true;
+}
+
+uint32_t HashLife::empty(int level) {
+    while ((int)emptyNodes_.size() <= level) {
+        uint32_t child = emptyNodes_.back();
+        uint32_t node = join(child, child, child, child);
+        emptyNodes_.push_back(node);
+    }
+    return emptyNodes_[level];
+}
+
+uint32_t HashLife::centered(uint32_t node) {
+    const Node n = nodes_[node];
+    return join(nodes_[n.nw].se, nodes_[n.ne].sw, nodes_[n.sw].ne,
+                nodes_[n.se].nw);
+}
+
+uint32_t HashLife::nextLevel2(uint32_t node) {
+    // Monta a vizinhança 4x4 e aplica a regra às 4 células centrais
+    const Node n = nodes_[node];
+    int cells[4][4];
+    const uint32_t quadrants[4] = {n.nw, n.ne, n.sw, n.se};
+    for (int q = 0; q < 4; q++) {
+        const Node &child = nodes_[quadrants[q]];
+        int ox = (q & 1) * 2;
+        int oy = (q >> 1) * 2;
+        cells[oy][ox] = child.nw == kAlive;
+        cells[oy][ox + 1] = child.ne == kAlive;
+        cells[oy + 1][ox] = child.sw == kAlive;
+        cells[oy + 1][ox + 1] = child.se == kAlive;
+    }
+
+    uint32_t next[2][2];
+    for (int y = 1; y <= 2; y++) {
+        for (int x = 1; x <= 2; x++) {
+            int neighbors = 0;
+            for (int dy = -1; dy <= 1; dy++)
+                for (int dx = -1; dx <= 1; dx++)
+                    if (dx || dy)
+                        neighbors += cells[y + dy][x + dx];
+            bool alive = rule_.next(cells[y][x], neighbors);
+            next[y - 1][x - 1] = alive ? kAlive : kDead;
+        }
+    }
+    return join(next[0][0], next[0][1], next[1][0], next[1][1]);
+}
+
+// Centro do nó (nível - 1) avançado 2^min(k, nível - 2) gerações
+uint32_t HashLife::next(uint32_t node, int k) {
+    int level = nodes_[node].level;
+    int step = std::min(k, level - 2);
+    if (nodes_[node].result != kNone && nodes_[node].resultStep == step)
+        return nodes_[node].result;
+
+    uint32_t result;
+    if (level == 2) {
+        stack_.push_back(node);
+        result = nextLevel2(node);
+        stack_.pop_back();
+    } else {
+        size_t base = stack_.size();
+        stack_.push_back(node);
+
+        const Node n = nodes_[node];
+        const Node nw = nodes_[n.nw], ne = nodes_[n.ne];
+        const Node sw = nodes_[n.sw], se = nodes_[n.se];
+
+        // Os nove sub-nós de nível - 1 sobrepostos: stack_[base + 1 + i]
+        stack_.push_back(n.nw);
+        stack_.push_back(join(nw.ne, ne.nw, nw.se, ne.sw));
+        stack_.push_back(n.ne);
+        stack_.push_back(join(nw.sw, nw.se, sw.nw, sw.ne));
+        stack_.push_back(join(nw.se, ne.sw, sw.ne, se.nw));
+        stack_.push_back(join(ne.sw, ne.se, se.nw, se.ne));
+        stack_.push_back(n.sw);
+        stack_.push_back(join(sw.ne, se.nw, sw.se, se.sw));
+        stack_.push_back(n.se);
+
+        // Velocidade máxima avança os dois estágios; senão o primeiro só
+        // recorta o centro e o segundo avança 2^step
+        bool fullSpeed = step == level - 2;
+        for (int i = 0; i < 9; i++) {
+            uint32_t sub = stack_[base + 1 + i];
+            stack_.push_back(fullSpeed ? next(sub, k) : centered(sub));
+        }
+
+        const uint32_t *r = &stack_[base + 10];
+        uint32_t c00 = join(r[0], r[1], r[3], r[4]);
+        stack_.push_back(c00);
+        r = &stack_[base + 10];
+        uint32_t c01 = join(r[1], r[2], r[4], r[5]);
+        stack_.push_back(c01);
+        r = &stack_[base + 10];
+        uint32_t c10 = join(r[3], r[4], r[6], r[7]);
+        stack_.push_back(c10);
+        r = &stack_[base + 10];
+        uint32_t c11 = join(r[4], r[5], r[7], r[8]);
+        stack_.push_back(c11);
+
+        for (int i = 0; i < 4; i++)
+            stack_.push_back(next(stack_[base + 19 + i], k));
+
+        result = join(stack_[base + 23], stack_[base + 24], stack_[base + 25],
+                      stack_[base + 26]);
+        stack_.resize(base);
+    }
+
+    nodes_[node].result = result;
+    nodes_[node].resultStep = (uint8_t)step;
+    return result;
+}
+
+uint32_t HashLife::expand(uint32_t node) {
+    const Node n = nodes_[node];
+    uint32_t border = empty(n.level - 1);
+    stack_.push_back(node);
+    uint32_t nw = join(border, border, border, n.nw);
+    stack_.push_back(nw);
+    uint32_t ne = join(border, border, n.ne, border);
+    stack_.push_back(ne);
+    uint32_t sw = join(border, n.sw, border, border);
+    stack_.push_back(sw);
+    uint32_t se = join(n.se, border, border, border);
+    uint32_t result = join(nw, ne, sw, se);
+    stack_.resize(stack_.size() - 4);
+    return result;
+}
+
+// Vivas só no quadrado central de metade do lado
+bool HashLife::isPadded(uint32_t node) const {
+    const Node &n = nodes_[node];
+    const Node &nw = nodes_[n.nw];
+    const Node &ne = nodes_[n.ne];
+    const Node &sw = nodes_[n.sw];
+    const Node &se = nodes_[n.se];
+    uint64_t inner = nodes_[nw.se].population + nodes_[ne.sw].population +
+                     nodes_[sw.ne].population + nodes_[se.nw].population;
+    return inner == n.population;
+}
+
+void HashLife::stepPow2(int k) {
+    k = std::max(0, std::min(k, 60));
+    collecting_ = true;
+
+    while (nodes_[root_].level < k + 2 || !isPadded(root_))
+        root_ = expand(root_);
+    // Mais um nível: o padrão pode andar 2^k células e ainda cair no centro
+    root_ = expand(root_);
+
+    root_ = next(root_, k);
+    generation_ += 1ull << k;
+
+    collecting_ = false;
+    if (liveNodes_ >= maxNodes_)
+        collectGarbage();
+}
+
+void HashLife::step(uint64_t n) {
+    for (int k = 0; n; k++, n >>= 1)
+        if (n & 1)
+            stepPow2(k);
+}
+
+void HashLife::mark(uint32_t node, bool withResults) {
+    // Pilha explícita: a recursão em quadtrees profundas estoura a pilha
+    std::vector<uint32_t> pending = {node};
+    while (!pending.empty()) {
+        uint32_t index = pending.back();
+        pending.pop_back();
+        if (index == kNone || nodes_[index].mark)
+            continue;
+        Node &n = nodes_[index];
+        n.mark = 1;
+        if (n.level == 0)
+            continue;
+        pending.push_back(n.nw);
+        pending.push_back(n.ne);
+        pending.push_back(n.sw);
+        pending.push_back(n.se);
+        if (withResults)
+            pending.push_back(n.result);
+    }
+}
+
+void HashLife::collectGarbage() {
+    collections_++;
+    size_t target = maxNodes_ / 2;
+
+    for (int pass = 0; pass < 2; pass++) {
+        bool withResults = pass == 0;
+        if (!withResults)
+            for (auto &node : nodes_)
+                node.result = kNone;
+
+        for (auto &node : nodes_)
+            node.mark = 0;
+        mark(root_, withResults);
+        for (uint32_t node : stack_)
+            mark(node, withResults);
+        for (uint32_t node : emptyNodes_)
+            mark(node, withResults);
+        mark(kDead, false);
+        mark(kAlive, false);
+
+        size_t live = 0;
+        for (const auto &node : nodes_)
+            live += node.mark;
+        if (live <= target || !withResults)
+            break;
+    }
+
+    // Nós livres ficam com nível 0, fora da tabela
+    freeList_.clear();
+    liveNodes_ = 0;
+    for (uint32_t i = 0; i < nodes_.size(); i++) {
+        Node &node = nodes_[i];
+        if (node.mark) {
+            liveNodes_++;
+            if (node.result != kNone && !nodes_[node.result].mark)
+                node.result = kNone;
+        } else {
+            node = {0, 0, 0, 0, kNone, 0, 0, 0, 0};
+            freeList_.push_back(i);
+        }
+    }
+    std::reverse(freeList_.begin(), freeList_.end());
+    rebuildTable();
+    collectAt_ = std::max(maxNodes_, liveNodes_ + liveNodes_ / 2);
+}
+
+uint32_t HashLife::build(const Grid &grid, int level, int64_t x, int64_t y) {
+    int64_t size = 1ll << level;
+    if (RegionEmpty(grid, x, y, x + size, y + size))
+        return empty(level);
+    if (level == 0)
+        return grid.get((int)x, (int)y) ? kAlive : kDead;
+
+    int64_t half = size / 2;
+    uint32_t nw = build(grid, level - 1, x, y);
+    stack_.push_back(nw);
+    uint32_t ne = build(grid, level - 1, x + half, y);
+    stack_.push_back(ne);
+    uint32_t sw = build(grid, level - 1, x, y + half);
+    stack_.push_back(sw);
+    uint32_t se = build(grid, level - 1, x + half, y + half);
+    stack_.resize(stack_.size() - 3);
+    return join(nw, ne, sw, se);
+}
+
+void HashLife::load(const Grid &grid) {
+    clear();
+    int level = 3;
+    while ((1ll << (level - 1)) < std::max(grid.width(), grid.height()))
+        level++;
+    int64_t half = 1ll << (level - 1);
+    root_ = build(grid, level, -half, -half);
+}
+
+int HashLife::rootLevel() const { return nodes_[root_].level; }
+
+uint64_t HashLife::population() const { return nodes_[root_].population; }
+
+bool HashLife::get(int64_t x, int64_t y) const {
+    uint32_t node = root_;
+    int64_t half = 1ll << (nodes_[node].level - 1);
+    if (x < -half || x >= half || y < -half || y >= half)
+        return false;
+
+    // Coordenadas relativas ao canto do nó atual
+    x += half;
+    y += half;
+    while (nodes_[node].level > 0) {
+        const Node &n = nodes_[node];
+        int64_t mid = 1ll << (n.level - 1);
+        bool east = x >= mid;
+        bool south = y >= mid;
+        node = south ? (east ? n.se : n.sw) : (east ? n.ne : n.nw);
+        if (east)
+            x -= mid;
+        if (south)
+            y -= mid;
+    }
+    return node == kAlive;
+}
+
+uint32_t HashLife::setCell(uint32_t node, int64_t x, int64_t y, bool alive) {
+    const Node n = nodes_[node];
+    if (n.level == 0)
+        return alive ? kAlive : kDead;
+
+    int64_t mid = 1ll << (n.level - 1);
+    uint32_t children[4] = {n.nw, n.ne, n.sw, n.se};
+    int quadrant = (y >= mid ? 2 : 0) + (x >= mid ? 1 : 0);
+    children[quadrant] = setCell(children[quadrant], x >= mid ? x - mid : x,
+                                 y >= mid ? y - mid : y, alive);
+    return join(children[0], children[1], children[2], children[3]);
+}
+
+void HashLife::set(int64_t x, int64_t y, bool alive) {
+    for (;;) {
+        int64_t half = 1ll << (nodes_[root_].level - 1);
+        if (x >= -half && x < half && y >= -half && y < half)
+            break;
+        root_ = expand(root_);
+    }
+    int64_t half = 1ll << (nodes_[root_].level - 1);
+    root_ = setCell(root_, x + half, y + half, alive);
+}
+
+void HashLife::write(uint32_t node, int64_t x, int64_t y, Grid &grid,
+                     int64_t x0, int64_t y0) const {
+    const Node &n = nodes_[node];
+    if (n.population == 0)
+        return;
+
+    int64_t size = 1ll << n.level;
+    if (x + size <= x0 || y + size <= y0 || x >= x0 + grid.width() ||
+        y >= y0 + grid.height())
+        return;
+
+    if (n.level == 0) {
+        grid.set((int)(x - x0), (int)(y - y0), true);
+        return;
+    }
+
+    int64_t half = size / 2;
+    write(n.nw, x, y, grid, x0, y0);
+    write(n.ne, x + half, y, grid, x0, y0);
+    write(n.sw, x, y + half, grid, x0, y0);
+    write(n.se, x + half, y + half, grid, x0, y0);
+}
+
+void HashLife::writeTo(Grid &grid, int64_t x0, int64_t y0) const {
+    grid.clear();
+    int64_t half = 1ll << (nodes_[root_].level - 1);
+    write(root_, -half, -half, grid, x0, y0);
+}
+
+HashLife::Stats HashLife::stats() const {
+    Stats stats;
+    stats.nodes = liveNodes_;
+    stats.collections = collections_;
+    stats.lookups = lookups_;
+    stats.hits = hits_;
+    return stats;
+}
+
+} // namespace life
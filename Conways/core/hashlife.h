@@ -0,0 +1,111 @@
+#pragma once
+
+#include "grid.h"
+#include "rule.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace life {
+
+// HashLife: quadtree com hash-consing (nós iguais são o mesmo nó) e o
+// resultado de cada nó memoizado, o que permite avançar 2^k gerações numa
+// chamada. O universo é o plano infinito, sem o wrap da Grid.
+//
+// Os nós vivem num vetor com lista livre. Quando passam de maxNodes o
+// coletor marca o que é alcançável a partir da raiz e da pilha de cálculo
+// e libera o resto; se ainda assim sobrar mais da metade, descarta também os
+// resultados memoizados.
+class HashLife {
+public:
+    struct Stats {
+        size_t nodes = 0;
+        size_t collections = 0;
+        uint64_t lookups = 0;
+        uint64_t hits = 0;
+    };
+
+    explicit HashLife(size_t maxNodes = 1 << 23);
+
+    // Substitui o universo pela grade, com a célula (0, 0) na origem
+    void load(const Grid &grid);
+    void clear();
+
+    bool get(int64_t x, int64_t y) const;
+    void set(int64_t x, int64_t y, bool alive);
+
+    // Troca a regra e descarta os resultados memorizados da anterior. Regras
+    // com B0 fazem o vazio infinito nascer e não são aceitas.
+    bool setRule(const Rule &rule);
+    const Rule &rule() const { return rule_; }
+
+    // Avança 2^k gerações (k <= 60)
+    void stepPow2(int k);
+    // Avança n gerações decompondo n em potências de 2
+    void step(uint64_t n);
+
+    // Copia a região [x0, x0 + width) x [y0, y0 + height) para a grade
+    void writeTo(Grid &grid, int64_t x0, int64_t y0) const;
+
+    uint64_t generation() const { return generation_; }
+    uint64_t population() const;
+    int rootLevel() const;
+
+    size_t maxNodes() const { return maxNodes_; }
+    void setMaxNodes(size_t maxNodes) { maxNodes_ = collectAt_ = maxNodes; }
+    void collectGarbage();
+    Stats stats() const;
+
+private:
+    static constexpr uint32_t kNone = 0xFFFFFFFFu;
+
+    struct Node {
+        uint32_t nw, ne, sw, se;
+        uint32_t result;
+        uint8_t level;
+        uint8_t resultStep; // log2 das gerações de `result`
+        uint8_t mark;
+        uint64_t population;
+    };
+
+    Rule rule_;
+
+    uint32_t join(uint32_t nw, uint32_t ne, uint32_t sw, uint32_t se);
+    uint32_t empty(int level);
+    uint32_t centered(uint32_t node);
+    uint32_t next(uint32_t node, int k);
+    uint32_t nextLevel2(uint32_t node);
+    uint32_t expand(uint32_t node);
+    bool isPadded(uint32_t node) const;
+
+    uint32_t build(const Grid &grid, int level, int64_t x, int64_t y);
+    uint32_t setCell(uint32_t node, int64_t x, int64_t y, bool alive);
+    void write(uint32_t node, int64_t x, int64_t y, Grid &grid, int64_t x0,
+               int64_t y0) const;
+
+    void mark(uint32_t node, bool withResults);
+    void rebuildTable();
+    void insert(uint32_t index);
+
+    std::vector<Node> nodes_;
+    std::vector<uint32_t> freeList_;
+    std::vector<uint32_t> table_; // endereçamento aberto, índices de nós
+    size_t liveNodes_ = 0;
+    std::vector<uint32_t> emptyNodes_;
+
+    // Nós intermediários de next() em andamento, raízes para o coletor
+    std::vector<uint32_t> stack_;
+    bool collecting_ = false;
+
+    uint32_t root_ = kNone;
+    uint64_t generation_ = 0;
+    size_t maxNodes_;
+    // Se a coleta não liberar o bastante, deixa crescer até aqui
+    size_t collectAt_;
+    size_t collections_ = 0;
+    uint64_t lookups_ = 0;
+    uint64_t hits_ = 0;
+};
+
+} // namespace life
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "rule.h"
+
+#include <cstdint>
+
+namespace life {
+
+// Calcula uma linha da próxima geração, 64 células por palavra.
+// Os ponteiros apontam para a primeira palavra de cada linha, e os índices
+// -1 e `words` também são lidos (o halo montado por Grid::prepareHalo).
+// Os bits de saída além da última célula não têm significado. Só o kernel
+// RuleKernel::Table lê `rule`; os outros têm a regra fixa no código.
+using RowKernel = void (*)(const uint64_t *above, const uint64_t *row,
+                           const uint64_t *below, uint64_t *out, int words,
+                           Rule rule);
+
+// Como RowKernel, mas out já tem a linha de duas gerações atrás (o buffer de
+// trabalho do rastreamento de atividade): o kernel escreve por cima e devolve
+// a máscara das palavras que mudaram, bit j para a palavra j. words <= 64.
+using DiffRowKernel = uint64_t (*)(const uint64_t *above, const uint64_t *row,
+                                   const uint64_t *below, uint64_t *out,
+                                   int words, Rule rule);
+
+// Regras com kernel próprio, especializado em tempo de compilação; as
+// demais usam Table, que consulta a tabela de nascimento/sobrevivência
+enum class RuleKernel { Life, HighLife, DayAndNight, Seeds, Table };
+
+RuleKernel RuleKernelFor(const Rule &rule);
+const char *RuleKernelName(RuleKernel kernel);
+
+RowKernel RowKernelScalar(RuleKernel rule);
+RowKernel RowKernelSse2(RuleKernel rule);
+RowKernel RowKernelAvx2(RuleKernel rule);
+RowKernel RowKernelAvx512(RuleKernel rule);
+DiffRowKernel DiffRowKernelScalar(RuleKernel rule);
+DiffRowKernel DiffRowKernelSse2(RuleKernel rule);
+DiffRowKernel DiffRowKernelAvx2(RuleKernel rule);
+DiffRowKernel DiffRowKernelAvx512(RuleKernel rule);
+
+// Sorteia `words` palavras de uma linha para o seed.cpp: a célula x0 + j fica
+// viva se o hash de contador (key, x0 + j) fica abaixo de threshold[j], um
+// limiar de 31 bits. threshold tem words * 64 entradas.
+using SeedKernel = void (*)(uint64_t key, uint32_t x0, const int32_t *threshold,
+                            uint64_t *out, int words);
+
+void SeedRowScalar(uint64_t key, uint32_t x0, const int32_t *threshold,
+                   uint64_t *out, int words);
+void SeedRowSse2(uint64_t key, uint32_t x0, const int32_t *threshold,
+                 uint64_t *out, int words);
+void SeedRowAvx2(uint64_t key, uint32_t x0, const int32_t *threshold,
+                 uint64_t *out, int words);
+void SeedRowAvx512(uint64_t key, uint32_t x0, const int32_t *threshold,
+                   uint64_t *out, int words);
+
+enum class KernelIsa { Scalar, Sse2, Avx2, Avx512 };
+
+const char *KernelIsaName(KernelIsa isa);
+// Palavras de 64 bits por vetor do kernel (1 no escalar)
+int KernelIsaWords(KernelIsa isa);
+bool KernelIsaSupported(KernelIsa isa);
+
+// Melhor ISA da CPU atual, detectada uma vez com __builtin_cpu_supports
+KernelIsa DetectKernelIsa();
+
+// Kernel da ISA e da regra pedidas, ou nullptr se a CPU/compilação não
+// suporta a ISA
+RowKernel GetRowKernel(KernelIsa isa, RuleKernel rule = RuleKernel::Life);
+DiffRowKernel GetDiffRowKernel(KernelIsa isa,
+                               RuleKernel rule = RuleKernel::Life);
+SeedKernel GetSeedKernel(KernelIsa isa);
+
+} // namespace life
@@ -0,0 +1,78 @@
+#include "kernel.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) ||           \
+    defined(_M_IX86)
+
+#include "kernel_impl.h"
+#include "seed_impl.h"
+
+#include <immintrin.h>
+
+namespace life {
+namespace {
+
+struct Avx2Ops {
+    using T = __m256i;
+    static constexpr int kWords = 4;
+
+    static T Load(const uint64_t *p) {
+        return _mm256_loadu_si256((const __m256i *)p);
+    }
+    static void Store(uint64_t *p, T v) {
+        _mm256_storeu_si256((__m256i *)p, v);
+    }
+    static T Splat(uint64_t v) { return _mm256_set1_epi64x((long long)v); }
+    static T And(T a, T b) { return _mm256_and_si256(a, b); }
+    static T Or(T a, T b) { return _mm256_or_si256(a, b); }
+    static T Xor(T a, T b) { return _mm256_xor_si256(a, b); }
+    static T AndNot(T a, T b) { return _mm256_andnot_si256(b, a); }
+    static T Shl1(T a) { return _mm256_slli_epi64(a, 1); }
+    static T Shr1(T a) { return _mm256_srli_epi64(a, 1); }
+    static T Shl63(T a) { return _mm256_slli_epi64(a, 63); }
+    static T Shr63(T a) { return _mm256_srli_epi64(a, 63); }
+    static T Xor3(T a, T b, T c) { return Xor(Xor(a, b), c); }
+    static T Maj(T a, T b, T c) { return Or(And(a, b), And(Xor(a, b), c)); }
+    static uint64_t NonZero(T a) {
+        return (uint64_t)~_mm256_movemask_pd(_mm256_castsi256_pd(
+                   _mm256_cmpeq_epi64(a, _mm256_setzero_si256()))) &
+               0xF;
+    }
+};
+
+struct Avx2Lanes {
+    using T = __m256i;
+    static constexpr int kLanes = 8;
+
+    static T Iota() { return _mm256_set_epi32(7, 6, 5, 4, 3, 2, 1, 0); }
+    static T Set1(uint32_t v) { return _mm256_set1_epi32((int)v); }
+    static T Load(const int32_t *p) {
+        return _mm256_loadu_si256((const __m256i *)p);
+    }
+    static T Add(T a, T b) { return _mm256_add_epi32(a, b); }
+    static T Xor(T a, T b) { return _mm256_xor_si256(a, b); }
+    static T Mul(T a, T b) { return _mm256_mullo_epi32(a, b); }
+    template <int N> static T Shr(T a) { return _mm256_srli_epi32(a, N); }
+    static uint64_t Less(T a, T b) {
+        return (uint64_t)_mm256_movemask_ps(
+            _mm256_castsi256_ps(_mm256_cmpgt_epi32(b, a)));
+    }
+};
+
+} // namespace
+
+RowKernel RowKernelAvx2(RuleKernel rule) {
+    return SelectRowKernel<Avx2Ops>(rule);
+}
+
+DiffRowKernel DiffRowKernelAvx2(RuleKernel rule) {
+    return SelectDiffRowKernel<Avx2Ops>(rule);
+}
+
+void SeedRowAvx2(uint64_t key, uint32_t x0, const int32_t *threshold,
+                 uint64_t *out, int words) {
+    SeedRowVec<Avx2Lanes>(key, x0, threshold, out, words);
+}
+
+} // namespace life
+
+#endif
@@ -0,0 +1,72 @@
+#include "kernel.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+
+#include "kernel_impl.h"
+#include "seed_impl.h"
+
+#include <immintrin.h>
+
+namespace life {
+namespace {
+
+struct Avx512Ops {
+    using T = __m512i;
+    static constexpr int kWords = 8;
+
+    static T Load(const uint64_t *p) { return _mm512_loadu_si512(p); }
+    static void Store(uint64_t *p, T v) { _mm512_storeu_si512(p, v); }
+    static T Splat(uint64_t v) { return _mm512_set1_epi64((long long)v); }
+    static T And(T a, T b) { return _mm512_and_si512(a, b); }
+    static T Or(T a, T b) { return _mm512_or_si512(a, b); }
+    static T Xor(T a, T b) { return _mm512_xor_si512(a, b); }
+    static T AndNot(T a, T b) { return _mm512_andnot_si512(b, a); }
+    static T Shl1(T a) { return _mm512_slli_epi64(a, 1); }
+    static T Shr1(T a) { return _mm512_srli_epi64(a, 1); }
+    static T Shl63(T a) { return _mm512_slli_epi64(a, 63); }
+    static T Shr63(T a) { return _mm512_srli_epi64(a, 63); }
+    // vpternlog resolve o somador completo numa instrução por saída
+    static T Xor3(T a, T b, T c) {
+        return _mm512_ternarylogic_epi64(a, b, c, 0x96);
+    }
+    static T Maj(T a, T b, T c) {
+        return _mm512_ternarylogic_epi64(a, b, c, 0xE8);
+    }
+    static uint64_t NonZero(T a) { return _mm512_test_epi64_mask(a, a); }
+};
+
+struct Avx512Lanes {
+    using T = __m512i;
+    static constexpr int kLanes = 16;
+
+    static T Iota() {
+        return _mm512_set_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3,
+                                2, 1, 0);
+    }
+    static T Set1(uint32_t v) { return _mm512_set1_epi32((int)v); }
+    static T Load(const int32_t *p) { return _mm512_loadu_si512(p); }
+    static T Add(T a, T b) { return _mm512_add_epi32(a, b); }
+    static T Xor(T a, T b) { return _mm512_xor_si512(a, b); }
+    static T Mul(T a, T b) { return _mm512_mullo_epi32(a, b); }
+    template <int N> static T Shr(T a) { return _mm512_srli_epi32(a, N); }
+    static uint64_t Less(T a, T b) { return _mm512_cmplt_epi32_mask(a, b); }
+};
+
+} // namespace
+
+RowKernel RowKernelAvx512(RuleKernel rule) {
+    return SelectRowKernel<Avx512Ops>(rule);
+}
+
+DiffRowKernel DiffRowKernelAvx512(RuleKernel rule) {
+    return SelectDiffRowKernel<Avx512Ops>(rule);
+}
+
+void SeedRowAvx512(uint64_t key, uint32_t x0, const int32_t *threshold,
+                   uint64_t *out, int words) {
+    SeedRowVec<Avx512Lanes>(key, x0, threshold, out, words);
+}
+
+} // namespace life
+
+#endif
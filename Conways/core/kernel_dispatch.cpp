@@ -0,0 +1,169 @@
+#include "kernel.h"
+
+namespace life {
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) ||           \
+    defined(_M_IX86)
+#define LIFE_X86 1
+#endif
+
+const char *KernelIsaName(KernelIsa isa) {
+    switch (isa) {
+    case KernelIsa::Scalar:
+        return "scalar";
+    case KernelIsa::Sse2:
+        return "sse2";
+    case KernelIsa::Avx2:
+        return "avx2";
+    case KernelIsa::Avx512:
+        return "avx512";
+    }
+    return "?";
+}
+
+int KernelIsaWords(KernelIsa isa) {
+    switch (isa) {
+    case KernelIsa::Scalar:
+        return 1;
+    case KernelIsa::Sse2:
+        return 2;
+    case KernelIsa::Avx2:
+        return 4;
+    case KernelIsa::Avx512:
+        return 8;
+    }
+    return 1;
+}
+
+bool KernelIsaSupported(KernelIsa isa) {
+    switch (isa) {
+    case KernelIsa::Scalar:
+        return true;
+#if defined(LIFE_X86) && defined(__GNUC__)
+    case KernelIsa::Sse2:
+        return __builtin_cpu_supports("sse2");
+    case KernelIsa::Avx2:
+        return __builtin_cpu_supports("avx2");
+    case KernelIsa::Avx512:
+#if defined(__x86_64__)
+        return __builtin_cpu_supports("avx512f");
+#else
+        return false;
+#endif
+#elif defined(LIFE_X86)
+    // MSVC não tem __builtin_cpu_supports; fica no SSE2, que todo x64 tem
+    case KernelIsa::Sse2:
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+KernelIsa DetectKernelIsa() {
+    static const KernelIsa best = [] {
+        const KernelIsa order[] = {KernelIsa::Avx512, KernelIsa::Avx2,
+                                   KernelIsa::Sse2};
+        for (KernelIsa isa : order)
+            if (KernelIsaSupported(isa))
+                return isa;
+        return KernelIsa::Scalar;
+    }();
+    return best;
+}
+
+RuleKernel RuleKernelFor(const Rule &rule) {
+    if (rule == LifeRule())
+        return RuleKernel::Life;
+    if (rule == HighLifeRule())
+        return RuleKernel::HighLife;
+    if (rule == DayAndNightRule())
+        return RuleKernel::DayAndNight;
+    if (rule == SeedsRule())
+        return RuleKernel::Seeds;
+    return RuleKernel::Table;
+}
+
+const char *RuleKernelName(RuleKernel kernel) {
+    switch (kernel) {
+    case RuleKernel::Life:
+        return "life";
+    case RuleKernel::HighLife:
+        return "highlife";
+    case RuleKernel::DayAndNight:
+        return "daynight";
+    case RuleKernel::Seeds:
+        return "seeds";
+    case RuleKernel::Table:
+        return "table";
+    }
+    return "?";
+}
+
+RowKernel GetRowKernel(KernelIsa isa, RuleKernel rule) {
+    if (!KernelIsaSupported(isa))
+        return nullptr;
+
+    switch (isa) {
+    case KernelIsa::Scalar:
+        return RowKernelScalar(rule);
+#if defined(LIFE_X86)
+    case KernelIsa::Sse2:
+        return RowKernelSse2(rule);
+    case KernelIsa::Avx2:
+        return RowKernelAvx2(rule);
+#if defined(__x86_64__) || defined(_M_X64)
+    case KernelIsa::Avx512:
+        return RowKernelAvx512(rule);
+#endif
+#endif
+    default:
+        return nullptr;
+    }
+}
+
+DiffRowKernel GetDiffRowKernel(KernelIsa isa, RuleKernel rule) {
+    if (!KernelIsaSupported(isa))
+        return nullptr;
+
+    switch (isa) {
+    case KernelIsa::Scalar:
+        return DiffRowKernelScalar(rule);
+#if defined(LIFE_X86)
+    case KernelIsa::Sse2:
+        return DiffRowKernelSse2(rule);
+    case KernelIsa::Avx2:
+        return DiffRowKernelAvx2(rule);
+#if defined(__x86_64__) || defined(_M_X64)
+    case KernelIsa::Avx512:
+        return DiffRowKernelAvx512(rule);
+#endif
+#endif
+    default:
+        return nullptr;
+    }
+}
+
+SeedKernel GetSeedKernel(KernelIsa isa) {
+    if (!KernelIsaSupported(isa))
+        return nullptr;
+
+    switch (isa) {
+    case KernelIsa::Scalar:
+        return SeedRowScalar;
+#if defined(LIFE_X86)
+    case KernelIsa::Sse2:
+        return SeedRowSse2;
+    case KernelIsa::Avx2:
+        return SeedRowAvx2;
+#if defined(__x86_64__) || defined(_M_X64)
+    case KernelIsa::Avx512:
+        return SeedRowAvx512;
+#endif
+#endif
+    default:
+        return nullptr;
+    }
+}
+
+} // namespace life
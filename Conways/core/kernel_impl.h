@@ -0,0 +1,256 @@
+#pragma once
+
+// Implementação genérica do passo bit a bit, incluída pelos kernel_*.cpp.
+// Cada arquivo é compilado com flags de ISA diferentes (-mavx2, ...), então
+// tudo aqui fica num namespace anônimo: se o linker juntasse as cópias, uma
+// versão AVX-512 poderia acabar sendo chamada pelo caminho escalar.
+
+#include "kernel.h"
+
+#include <cstdint>
+
+namespace life {
+namespace {
+
+// Operações de um "vetor" de uma palavra, usadas no fim das linhas
+struct ScalarOps {
+    using T = uint64_t;
+    static constexpr int kWords = 1;
+
+    static T Load(const uint64_t *p) { return *p; }
+    static void Store(uint64_t *p, T v) { *p = v; }
+    static T Splat(uint64_t v) { return v; }
+    static T And(T a, T b) { return a & b; }
+    static T Or(T a, T b) { return a | b; }
+    static T Xor(T a, T b) { return a ^ b; }
+    static T AndNot(T a, T b) { return a & ~b; } // a & ~b
+    static T Shl1(T a) { return a << 1; }
+    static T Shr1(T a) { return a >> 1; }
+    static T Shl63(T a) { return a << 63; }
+    static T Shr63(T a) { return a >> 63; }
+    static T Xor3(T a, T b, T c) { return a ^ b ^ c; }
+    static T Maj(T a, T b, T c) { return (a & b) | ((a ^ b) & c); }
+    // Bit k aceso se a palavra k do vetor não é zero
+    static uint64_t NonZero(T a) { return a != 0; }
+};
+
+// Soma bit a bit de três entradas: sum recebe o bit 1, carry o bit 2
+template <class V>
+inline void FullAdd(typename V::T a, typename V::T b, typename V::T c,
+                    typename V::T &sum, typename V::T &carry) {
+    sum = V::Xor3(a, b, c);
+    carry = V::Maj(a, b, c);
+}
+
+// Regras do passo. Apply recebe a contagem de vizinhos de cada célula em
+// bits (n0 + 2*n1 + 4*n2 + 8*n3, 0..8) e o estado atual m. As regras comuns
+// são só lógica bit a bit fixa; TableStep consulta a tabela de Rule.
+struct LifeStep {
+    explicit LifeStep(Rule) {}
+
+    // B3/S23: exatamente 3 vizinhos, ou 2 vizinhos e viva
+    template <class V>
+    typename V::T Apply(typename V::T n0, typename V::T n1, typename V::T n2,
+                        typename V::T n3, typename V::T m) const {
+        return V::And(V::AndNot(V::AndNot(n1, n2), n3), V::Or(n0, m));
+    }
+};
+
+struct HighLifeStep {
+    explicit HighLifeStep(Rule) {}
+
+    // B36/S23: o B3/S23 mais o nascimento com 6 (0110); n3 só aparece no 8
+    template <class V>
+    typename V::T Apply(typename V::T n0, typename V::T n1, typename V::T n2,
+                        typename V::T n3, typename V::T m) const {
+        typename V::T life =
+            V::And(V::AndNot(V::AndNot(n1, n2), n3), V::Or(n0, m));
+        typename V::T six = V::AndNot(V::And(n1, n2), V::Or(n0, m));
+        return V::Or(life, six);
+    }
+};
+
+struct DayAndNightStep {
+    explicit DayAndNightStep(Rule) {}
+
+    // B3678/S34678: 3, 6, 7 e 8 valem para os dois estados (8 é só n3; entre
+    // 0..7, 3, 6 e 7 são n1 & (n0 | n2)), e a célula viva sobrevive com 4
+    template <class V>
+    typename V::T Apply(typename V::T n0, typename V::T n1, typename V::T n2,
+                        typename V::T n3, typename V::T m) const {
+        typename V::T both = V::Or(n3, V::And(n1, V::Or(n0, n2)));
+        typename V::T four = V::AndNot(V::And(n2, m), V::Or(n0, n1));
+        return V::Or(both, four);
+    }
+};
+
+struct SeedsStep {
+    explicit SeedsStep(Rule) {}
+
+    // B2/S: nasce com exatamente 2 vizinhos, ninguém sobrevive
+    template <class V>
+    typename V::T Apply(typename V::T n0, typename V::T n1, typename V::T n2,
+                        typename V::T n3, typename V::T m) const {
+        return V::AndNot(n1, V::Or(V::Or(n0, n2), V::Or(n3, m)));
+    }
+};
+
+// Qualquer regra B/S: a tabela (estado, contagem) de Rule vira máscaras de
+// 0 ou ~0, e a consulta é uma árvore de seleções pelos bits da contagem, sem
+// desvios, nos mesmos vetores das outras regras
+struct TableStep {
+    uint64_t birth[9];
+    uint64_t survival[9];
+
+    explicit TableStep(Rule rule) {
+        for (int c = 0; c <= 8; c++) {
+            birth[c] = (rule.birth >> c & 1) ? ~0ull : 0;
+            survival[c] = (rule.survival >> c & 1) ? ~0ull : 0;
+        }
+    }
+
+    // s ? b : a
+    template <class V>
+    static typename V::T Select(typename V::T a, typename V::T b,
+                                typename V::T s) {
+        return V::Xor(a, V::And(V::Xor(a, b), s));
+    }
+
+    template <class V>
+    typename V::T Apply(typename V::T n0, typename V::T n1, typename V::T n2,
+                        typename V::T n3, typename V::T m) const {
+        using T = typename V::T;
+        T next[9];
+        for (int c = 0; c <= 8; c++)
+            next[c] = Select<V>(V::Splat(birth[c]), V::Splat(survival[c]), m);
+
+        T q[4];
+        for (int k = 0; k < 4; k++)
+            q[k] = Select<V>(next[2 * k], next[2 * k + 1], n0);
+        T h0 = Select<V>(q[0], q[1], n1);
+        T h1 = Select<V>(q[2], q[3], n1);
+        // n3 só é 1 na contagem 8, quando os outros bits são 0
+        return Select<V>(Select<V>(h0, h1, n2), next[8], n3);
+    }
+};
+
+// Próximo estado de V::kWords palavras a partir da posição i
+template <class V, class Step>
+inline typename V::T NextWords(const uint64_t *above, const uint64_t *row,
+                               const uint64_t *below, int i,
+                               const Step &step) {
+    using T = typename V::T;
+
+    T a = V::Load(above + i);
+    T m = V::Load(row + i);
+    T b = V::Load(below + i);
+
+    // Vizinhos a oeste (x - 1) e leste (x + 1) de cada célula
+    T aW = V::Or(V::Shl1(a), V::Shr63(V::Load(above + i - 1)));
+    T aE = V::Or(V::Shr1(a), V::Shl63(V::Load(above + i + 1)));
+    T mW = V::Or(V::Shl1(m), V::Shr63(V::Load(row + i - 1)));
+    T mE = V::Or(V::Shr1(m), V::Shl63(V::Load(row + i + 1)));
+    T bW = V::Or(V::Shl1(b), V::Shr63(V::Load(below + i - 1)));
+    T bE = V::Or(V::Shr1(b), V::Shl63(V::Load(below + i + 1)));
+
+    // Contagem de cada linha em dois bits (0..3)
+    T top0, top1, bot0, bot1;
+    FullAdd<V>(aW, a, aE, top0, top1);
+    FullAdd<V>(bW, b, bE, bot0, bot1);
+    T mid0 = V::Xor(mW, mE);
+    T mid1 = V::And(mW, mE);
+
+    // Soma das três linhas: count = n0 + 2*n1 + 4*n2 + 8*n3
+    T n0, carry0, sum1, carry1;
+    FullAdd<V>(top0, mid0, bot0, n0, carry0);
+    FullAdd<V>(top1, mid1, bot1, sum1, carry1);
+    T n1 = V::Xor(sum1, carry0);
+    T carry2 = V::And(sum1, carry0);
+    T n2 = V::Xor(carry1, carry2);
+    T n3 = V::And(carry1, carry2);
+
+    return step.template Apply<V>(n0, n1, n2, n3, m);
+}
+
+template <class V, class Step>
+inline void StepWords(const uint64_t *above, const uint64_t *row,
+                      const uint64_t *below, uint64_t *out, int i,
+                      const Step &step) {
+    V::Store(out + i, NextWords<V>(above, row, below, i, step));
+}
+
+// Escreve por cima da palavra antiga e devolve as palavras que mudaram,
+// deslocadas para a posição i
+template <class V, class Step>
+inline uint64_t StepWordsDiff(const uint64_t *above, const uint64_t *row,
+                              const uint64_t *below, uint64_t *out, int i,
+                              const Step &step) {
+    typename V::T next = NextWords<V>(above, row, below, i, step);
+    typename V::T old = V::Load(out + i);
+    V::Store(out + i, next);
+    return V::NonZero(V::Xor(old, next)) << i;
+}
+
+template <class V, class Step>
+void StepRowVec(const uint64_t *above, const uint64_t *row,
+                const uint64_t *below, uint64_t *out, int words, Rule rule) {
+    const Step step(rule);
+    int i = 0;
+    for (; i + V::kWords <= words; i += V::kWords)
+        StepWords<V>(above, row, below, out, i, step);
+    for (; i < words; i++)
+        StepWords<ScalarOps>(above, row, below, out, i, step);
+}
+
+template <class V, class Step>
+uint64_t StepRowDiffVec(const uint64_t *above, const uint64_t *row,
+                        const uint64_t *below, uint64_t *out, int words,
+                        Rule rule) {
+    const Step step(rule);
+    uint64_t changed = 0;
+    int i = 0;
+    for (; i + V::kWords <= words; i += V::kWords)
+        changed |= StepWordsDiff<V>(above, row, below, out, i, step);
+    for (; i < words; i++)
+        changed |= StepWordsDiff<ScalarOps>(above, row, below, out, i, step);
+    return changed;
+}
+
+// O kernel de cada regra é uma instância separada de StepRowVec: a regra é
+// escolhida uma vez, na troca do ponteiro, e não custa nada no laço
+template <class V>
+RowKernel SelectRowKernel(RuleKernel rule) {
+    switch (rule) {
+    case RuleKernel::Life:
+        return StepRowVec<V, LifeStep>;
+    case RuleKernel::HighLife:
+        return StepRowVec<V, HighLifeStep>;
+    case RuleKernel::DayAndNight:
+        return StepRowVec<V, DayAndNightStep>;
+    case RuleKernel::Seeds:
+        return StepRowVec<V, SeedsStep>;
+    case RuleKernel::Table:
+        return StepRowVec<V, TableStep>;
+    }
+    return nullptr;
+}
+
+template <class V>
+DiffRowKernel SelectDiffRowKernel(RuleKernel rule) {
+    switch (rule) {
+    case RuleKernel::Life:
+        return StepRowDiffVec<V, LifeStep>;
+    case RuleKernel::HighLife:
+        return StepRowDiffVec<V, HighLifeStep>;
+    case RuleKernel::DayAndNight:
+        return StepRowDiffVec<V, DayAndNightStep>;
+    case RuleKernel::Seeds:
+        return StepRowDiffVec<V, SeedsStep>;
+    case RuleKernel::Table:
+        return StepRowDiffVec<V, TableStep>;
+    }
+    return nullptr;
+}
+
+} // namespace
+} // namespace life
@@ -0,0 +1,20 @@
+#include "kernel.h"
+#include "kernel_impl.h"
+#include "seed_impl.h"
+
+namespace life {
+
+RowKernel RowKernelScalar(RuleKernel rule) {
+    return SelectRowKernel<ScalarOps>(rule);
+}
+
+DiffRowKernel DiffRowKernelScalar(RuleKernel rule) {
+    return SelectDiffRowKernel<ScalarOps>(rule);
+}
+
+void SeedRowScalar(uint64_t key, uint32_t x0, const int32_t *threshold,
+                   uint64_t *out, int words) {
+    SeedRowVec<ScalarLanes>(key, x0, threshold, out, words);
+}
+
+} // namespace life
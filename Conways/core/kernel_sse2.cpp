@@ -0,0 +1,85 @@
+#include "kernel.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) ||           \
+    defined(_M_IX86)
+
+#include "kernel_impl.h"
+#include "seed_impl.h"
+
+#include <emmintrin.h>
+
+namespace life {
+namespace {
+
+struct Sse2Ops {
+    using T = __m128i;
+    static constexpr int kWords = 2;
+
+    static T Load(const uint64_t *p) {
+        return _mm_loadu_si128((const __m128i *)p);
+    }
+    static void Store(uint64_t *p, T v) { _mm_storeu_si128((__m128i *)p, v); }
+    static T Splat(uint64_t v) { return _mm_set1_epi64x((long long)v); }
+    static T And(T a, T b) { return _mm_and_si128(a, b); }
+    static T Or(T a, T b) { return _mm_or_si128(a, b); }
+    static T Xor(T a, T b) { return _mm_xor_si128(a, b); }
+    static T AndNot(T a, T b) { return _mm_andnot_si128(b, a); }
+    static T Shl1(T a) { return _mm_slli_epi64(a, 1); }
+    static T Shr1(T a) { return _mm_srli_epi64(a, 1); }
+    static T Shl63(T a) { return _mm_slli_epi64(a, 63); }
+    static T Shr63(T a) { return _mm_srli_epi64(a, 63); }
+    static T Xor3(T a, T b, T c) { return Xor(Xor(a, b), c); }
+    static T Maj(T a, T b, T c) { return Or(And(a, b), And(Xor(a, b), c)); }
+    // SSE2 não compara 64 bits: a palavra é zero se as duas metades são
+    static uint64_t NonZero(T a) {
+        int zero = _mm_movemask_ps(
+            _mm_castsi128_ps(_mm_cmpeq_epi32(a, _mm_setzero_si128())));
+        uint64_t low = (zero & 3) != 3;
+        uint64_t high = (zero >> 2) != 3;
+        return low | high << 1;
+    }
+};
+
+struct Sse2Lanes {
+    using T = __m128i;
+    static constexpr int kLanes = 4;
+
+    static T Iota() { return _mm_set_epi32(3, 2, 1, 0); }
+    static T Set1(uint32_t v) { return _mm_set1_epi32((int)v); }
+    static T Load(const int32_t *p) {
+        return _mm_loadu_si128((const __m128i *)p);
+    }
+    static T Add(T a, T b) { return _mm_add_epi32(a, b); }
+    static T Xor(T a, T b) { return _mm_xor_si128(a, b); }
+    // SSE2 não tem pmulld: multiplica as lanes pares e ímpares com pmuludq
+    static T Mul(T a, T b) {
+        T even = _mm_mul_epu32(a, b);
+        T odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+        return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, 0x08),
+                                  _mm_shuffle_epi32(odd, 0x08));
+    }
+    template <int N> static T Shr(T a) { return _mm_srli_epi32(a, N); }
+    static uint64_t Less(T a, T b) {
+        return (uint64_t)_mm_movemask_ps(
+            _mm_castsi128_ps(_mm_cmplt_epi32(a, b)));
+    }
+};
+
+} // namespace
+
+RowKernel RowKernelSse2(RuleKernel rule) {
+    return SelectRowKernel<Sse2Ops>(rule);
+}
+
+DiffRowKernel DiffRowKernelSse2(RuleKernel rule) {
+    return SelectDiffRowKernel<Sse2Ops>(rule);
+}
+
+void SeedRowSse2(uint64_t key, uint32_t x0, const int32_t *threshold,
+                 uint64_t *out, int words) {
+    SeedRowVec<Sse2Lanes>(key, x0, threshold, out, words);
+}
+
+} // namespace life
+
+#endif
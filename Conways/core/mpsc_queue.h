@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+namespace life {
+
+// Fila sem lock de muitos produtores para um consumidor (a fila intrusiva do
+// Vyukov). push() é um exchange atômico do fim da fila e nunca espera nem
+// falha; pop() só roda no consumidor. O nó da frente é sempre um "stub" cujo
+// valor já foi entregue. Entre o exchange e o encadeamento de um push a fila
+// parece vazia ao consumidor, que pega o item na próxima vez.
+template <class T>
+class MpscQueue {
+public:
+    MpscQueue() : head_(new Node), tail_(head_) {}
+    ~MpscQueue() {
+        while (Node *node = head_) {
+            head_ = node->next.load(std::memory_order_relaxed);
+            delete node;
+        }
+    }
+
+    MpscQueue(const MpscQueue &) = delete;
+    MpscQueue &operator=(const MpscQueue &) = delete;
+
+    // Produtores, de qualquer thread
+    void push(T value) {
+        Node *node = new Node;
+        node->value = std::move(value);
+        Node *previous = tail_.exchange(node, std::memory_order_acq_rel);
+        // seq_cst: quem publica e depois olha se o consumidor dorme não
+        // pode se desencontrar de quem marca que dorme e depois olha a fila
+        previous->next.store(node, std::memory_order_seq_cst);
+    }
+
+    // Consumidor
+    bool pop(T &value) {
+        Node *next = head_->next.load(std::memory_order_acquire);
+        if (!next)
+            return false;
+        value = std::move(next->value);
+        delete head_;
+        head_ = next;
+        return true;
+    }
+    bool empty() const {
+        return !head_->next.load(std::memory_order_seq_cst);
+    }
+
+private:
+    struct Node {
+        std::atomic<Node *> next{nullptr};
+        T value;
+    };
+
+    Node *head_; // só o consumidor
+    alignas(64) std::atomic<Node *> tail_;
+};
+
+} // namespace life
@@ -0,0 +1,499 @@
+#include "multistate.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+
+namespace life {
+
+static bool Fail(std::string *error, const std::string &message) {
+    if (error)
+        *error = message;
+    return false;
+}
+
+namespace {
+
+constexpr int kBlock = 64;
+
+struct NamedMultiStateRule {
+    const char *name;
+    const char *rule;
+};
+
+const NamedMultiStateRule kNamedMultiStateRules[] = {
+    {"brianbrain", "B2/S/C3"},
+    {"starwars", "345/2/4"},
+    {"bosco", "R5,C0,M1,S34..58,B34..45,NM"},
+    {"majority", "R4,C0,M1,S41..81,B41..81,NM"},
+};
+
+// Bits 0..8 de uma máscara de Rule viram intervalos de contagens seguidas
+std::vector<CountRange> RangesFromMask(uint16_t mask) {
+    std::vector<CountRange> ranges;
+    for (int c = 0; c <= 8; c++) {
+        if (!(mask >> c & 1))
+            continue;
+        if (!ranges.empty() && ranges.back().hi == c - 1)
+            ranges.back().hi = (uint16_t)c;
+        else
+            ranges.push_back({(uint16_t)c, (uint16_t)c});
+    }
+    return ranges;
+}
+
+// Máscara de Rule equivalente, ou false se alguma contagem passa de 8
+bool MaskFromRanges(const std::vector<CountRange> &ranges, uint16_t &mask) {
+    mask = 0;
+    for (const CountRange &range : ranges) {
+        if (range.hi > 8)
+            return false;
+        for (int c = range.lo; c <= range.hi; c++)
+            mask |= 1 << c;
+    }
+    return true;
+}
+
+// "34..58", "34-58" ou "34"
+bool ParseRange(const std::string &text, CountRange &range) {
+    char *end;
+    long lo = strtol(text.c_str(), &end, 10);
+    if (end == text.c_str() || lo < 0)
+        return false;
+    long hi = lo;
+    if (*end == '.' && end[1] == '.')
+        hi = strtol(end + 2, &end, 10);
+    else if (*end == '-')
+        hi = strtol(end + 1, &end, 10);
+    if (*end || hi < lo || hi > 0xFFFF)
+        return false;
+    range = {(uint16_t)lo, (uint16_t)hi};
+    return true;
+}
+
+// Formato do Golly: R<raio>,C<estados>,M<0|1>,S<intervalos>,B<intervalos>,
+// N<vizinhança>. Números soltos depois de S ou B são mais intervalos dela.
+bool ParseLtl(const std::string &text, MultiStateRule &rule,
+              std::string *error) {
+    rule = MultiStateRule();
+    rule.birth.clear();
+    rule.survival.clear();
+    std::vector<CountRange> *current = nullptr;
+    size_t start = 0;
+    while (start <= text.size()) {
+        size_t comma = text.find(',', start);
+        if (comma == std::string::npos)
+            comma = text.size();
+        std::string token = text.substr(start, comma - start);
+        start = comma + 1;
+        if (token.empty())
+            return Fail(error, "regra LtL inválida: " + text);
+
+        char key = token[0];
+        bool bare = isdigit((unsigned char)key);
+        std::string value = bare ? token : token.substr(1);
+        CountRange range;
+        if (bare) {
+            if (!current || !ParseRange(value, range))
+                return Fail(error, "regra LtL inválida: " + text);
+            current->push_back(range);
+        } else if (key == 'r') {
+            rule.range = atoi(value.c_str());
+        } else if (key == 'c') {
+            rule.states = std::max(2, atoi(value.c_str()));
+        } else if (key == 'm') {
+            rule.middle = value == "1";
+        } else if (key == 's' || key == 'b') {
+            current = key == 's' ? &rule.survival : &rule.birth;
+            if (!value.empty()) {
+                if (!ParseRange(value, range))
+                    return Fail(error, "regra LtL inválida: " + text);
+                current->push_back(range);
+            }
+        } else if (key == 'n') {
+            if (value != "m")
+                return Fail(error, "só a vizinhança de Moore (NM): " + text);
+        } else {
+            return Fail(error, "regra LtL inválida: " + text);
+        }
+    }
+    return true;
+}
+
+// B/S/C: "b2/s/c3", "b2/s345/4" ou, sem letras, "345/2/4" (S/B/C)
+bool ParseGenerations(const std::string &text, MultiStateRule &rule,
+                      std::string *error) {
+    std::vector<std::string> parts;
+    size_t start = 0;
+    while (true) {
+        size_t slash = text.find('/', start);
+        parts.push_back(text.substr(start, slash - start));
+        if (slash == std::string::npos)
+            break;
+        start = slash + 1;
+    }
+    if (parts.size() != 3)
+        return Fail(error, "regra inválida: " + text);
+
+    // Sem letras, a posição diz o que é cada parte (S/B/C)
+    std::string birth, survival, states;
+    for (size_t i = 0; i < parts.size(); i++) {
+        char key = "sbc"[i];
+        std::string digits = parts[i];
+        if (!digits.empty() && isalpha((unsigned char)digits[0])) {
+            key = digits[0] == 'g' ? 'c' : digits[0];
+            digits.erase(0, 1);
+        }
+        if (key == 'b')
+            birth = digits;
+        else if (key == 's')
+            survival = digits;
+        else if (key == 'c')
+            states = digits;
+        else
+            return Fail(error, "regra inválida: " + text);
+    }
+
+    uint16_t masks[2] = {0, 0};
+    const std::string *lists[2] = {&birth, &survival};
+    for (int l = 0; l < 2; l++) {
+        for (char c : *lists[l]) {
+            if (c < '0' || c > '8')
+                return Fail(error, "regra inválida: " + text);
+            masks[l] |= 1 << (c - '0');
+        }
+    }
+    if (states.empty() ||
+        states.find_first_not_of("0123456789") != std::string::npos)
+        return Fail(error, "número de estados inválido: " + text);
+
+    rule = MultiStateRule();
+    rule.states = atoi(states.c_str());
+    rule.birth = RangesFromMask(masks[0]);
+    rule.survival = RangesFromMask(masks[1]);
+    return true;
+}
+
+std::string RangesString(const std::vector<CountRange> &ranges) {
+    std::string text;
+    for (size_t i = 0; i < ranges.size(); i++) {
+        char buffer[32];
+        if (ranges[i].lo == ranges[i].hi)
+            snprintf(buffer, sizeof(buffer), "%s%d", i ? "," : "",
+                     ranges[i].lo);
+        else
+            snprintf(buffer, sizeof(buffer), "%s%d..%d", i ? "," : "",
+                     ranges[i].lo, ranges[i].hi);
+        text += buffer;
+    }
+    return text;
+}
+
+// Soma em column as células vivas de add e subtrai as de sub (a linha que
+// sai da janela), se houver. Os blocos passam por um array local para o
+// compilador vetorizar sem checar aliasing.
+void SlideColumn(uint8_t *column, const uint8_t *add, const uint8_t *sub,
+                 int stride) {
+    for (int x0 = 0; x0 < stride; x0 += kBlock) {
+        uint8_t delta[kBlock];
+        for (int j = 0; j < kBlock; j++)
+            delta[j] = add[x0 + j] == 1;
+        if (sub)
+            for (int j = 0; j < kBlock; j++)
+                delta[j] -= sub[x0 + j] == 1;
+        for (int j = 0; j < kBlock; j++)
+            column[x0 + j] += delta[j];
+    }
+}
+
+// Marca em inside as contagens de algum dos intervalos
+void InRanges(const uint16_t *count, const std::vector<CountRange> &ranges,
+              uint8_t *inside) {
+    for (const CountRange &range : ranges) {
+        const uint16_t lo = range.lo;
+        const uint16_t hi = range.hi;
+        uint8_t hit[kBlock];
+        for (int j = 0; j < kBlock; j++)
+            hit[j] = (count[j] >= lo) & (count[j] <= hi);
+        for (int j = 0; j < kBlock; j++)
+            inside[j] |= hit[j];
+    }
+}
+
+int Wrap(int v, int n) {
+    v %= n;
+    return v < 0 ? v + n : v;
+}
+
+} // namespace
+
+MultiStateRule MultiStateRuleFrom(const Rule &rule) {
+    MultiStateRule multi;
+    multi.birth = RangesFromMask(rule.birth);
+    multi.survival = RangesFromMask(rule.survival);
+    return multi;
+}
+
+bool ParseMultiStateRule(const char *text, MultiStateRule &rule,
+                         std::string *error) {
+    std::string lower;
+    for (const char *c = text; *c; c++)
+        lower += (char)tolower((unsigned char)*c);
+    for (const NamedMultiStateRule &named : kNamedMultiStateRules)
+        if (lower == named.name)
+            return ParseMultiStateRule(named.rule, rule, error);
+
+    MultiStateRule parsed;
+    if (lower[0] == 'r' && lower.find(',') != std::string::npos) {
+        if (!ParseLtl(lower, parsed, error))
+            return false;
+    } else if (std::count(lower.begin(), lower.end(), '/') == 2) {
+        if (!ParseGenerations(lower, parsed, error))
+            return false;
+    } else {
+        Rule simple;
+        if (!ParseRule(text, simple, error))
+            return false;
+        parsed = MultiStateRuleFrom(simple);
+    }
+
+    if (parsed.range < 1 || parsed.range > MultiStateRule::kMaxRange)
+        return Fail(error, std::string("raio fora de 1..10: ") + text);
+    if (parsed.states < 2 || parsed.states > MultiStateRule::kMaxStates)
+        return Fail(error, std::string("estados fora de 2..255: ") + text);
+    if ((int)parsed.birth.size() > MultiStateRule::kMaxRanges ||
+        (int)parsed.survival.size() > MultiStateRule::kMaxRanges)
+        return Fail(error, std::string("intervalos demais: ") + text);
+    for (const auto *ranges : {&parsed.birth, &parsed.survival})
+        for (const CountRange &range : *ranges)
+            if (range.hi > parsed.maxCount())
+                return Fail(error,
+                            std::string("contagem maior que a vizinhança: ") +
+                                text);
+    rule = parsed;
+    return true;
+}
+
+std::string MultiStateRuleString(const MultiStateRule &rule) {
+    uint16_t birth, survival;
+    if (rule.range == 1 && !rule.middle && MaskFromRanges(rule.birth, birth) &&
+        MaskFromRanges(rule.survival, survival)) {
+        Rule simple;
+        simple.birth = birth;
+        simple.survival = survival;
+        std::string text = RuleString(simple);
+        if (rule.states > 2)
+            text += "/C" + std::to_string(rule.states);
+        return text;
+    }
+
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "R%d,C%d,M%d,S", rule.range,
+             rule.states > 2 ? rule.states : 0, rule.middle ? 1 : 0);
+    return buffer + RangesString(rule.survival) + ",B" +
+           RangesString(rule.birth) + ",NM";
+}
+
+MultiStateLife::MultiStateLife(int width, int height,
+                               const MultiStateRule &rule)
+    : width_(width), height_(height),
+      stride_((width + kBlock - 1) & ~(kBlock - 1)), rule_(rule),
+      cells_((size_t)stride_ * height, 0), next_(cells_.size(), 0) {
+    setThreadCount(1);
+}
+
+MultiStateLife::MultiStateLife(const Grid &grid, const MultiStateRule &rule)
+    : MultiStateLife(grid.width(), grid.height(), rule) {
+    for (int y = 0; y < height_; y++)
+        for (int x = 0; x < width_; x++)
+            cells_[(size_t)y * stride_ + x] = grid.get(x, y);
+}
+
+void MultiStateLife::setRule(const MultiStateRule &rule) {
+    rule_ = rule;
+    for (uint8_t &state : cells_)
+        if (state >= rule_.states)
+            state = 0;
+}
+
+void MultiStateLife::setThreadCount(int threads) {
+    pool_.reset();
+    if (threads != 1)
+        pool_ = std::make_unique<ThreadPool>(threads);
+    if (pool_ && pool_->threadCount() == 1)
+        pool_.reset();
+
+    // Duas faixas por thread: o começo de cada uma soma a janela inteira
+    int bands = 2 * threadCount();
+    bandRows_ = std::max(1, (height_ + bands - 1) / bands);
+    scratch_.resize((size_t)(height_ + bandRows_ - 1) / bandRows_);
+    for (Scratch &scratch : scratch_) {
+        scratch.column.assign(stride_, 0);
+        scratch.prefix.assign(
+            (size_t)stride_ + 2 * MultiStateRule::kMaxRange + 1, 0);
+    }
+}
+
+void MultiStateLife::set(int x, int y, uint8_t state) {
+    cells_[(size_t)y * stride_ + x] =
+        state < rule_.states ? state : (uint8_t)(rule_.states - 1);
+}
+
+// Calcula as linhas [y0, y1) de next_. column[x] começa com as vivas da
+// janela vertical da linha y0 e desliza uma linha por vez; prefix[i] é a
+// soma de column nas posições x - range .. i - range - 1 (com wrap), então a
+// soma da janela (2r + 1)^2 da célula x é prefix[x + 2r + 1] - prefix[x].
+void MultiStateLife::stepRows(int y0, int y1, Scratch &scratch) {
+    const int r = rule_.range;
+    const int w = width_;
+    const int h = height_;
+    const uint8_t states = (uint8_t)rule_.states;
+    // Sem M1, a própria célula sai da soma do quadrado
+    const uint16_t self = rule_.middle ? 0 : 1;
+    uint8_t *column = scratch.column.data();
+    uint16_t *prefix = scratch.prefix.data();
+
+    std::fill(column, column + stride_, 0);
+    for (int d = -r; d <= r; d++)
+        SlideColumn(column, row(Wrap(y0 + d, h)), nullptr, stride_);
+
+    for (int y = y0; y < y1; y++) {
+        if (y > y0)
+            SlideColumn(column, row(Wrap(y + r, h)), row(Wrap(y - r - 1, h)),
+                        stride_);
+
+        // Prefixo com as r colunas de cada lado (wrap) em volta de 0..w-1.
+        // Ele estoura 16 bits em linhas longas, mas as diferenças abaixo são
+        // módulo 2^16 e nunca passam de 441.
+        uint16_t sum = 0;
+        prefix[0] = 0;
+        int i = 0;
+        for (; i < r; i++) {
+            sum += column[Wrap(i - r, w)];
+            prefix[i + 1] = sum;
+        }
+        for (; i < r + w; i++) {
+            sum += column[i - r];
+            prefix[i + 1] = sum;
+        }
+        for (; i < w + 2 * r; i++) {
+            sum += column[Wrap(i - r, w)];
+            prefix[i + 1] = sum;
+        }
+        // Os blocos de 64 leem além de w; as células ali são descartadas
+        std::fill(prefix + w + 2 * r + 1, prefix + stride_ + 2 * r + 1, sum);
+
+        // Os blocos vão para arrays locais, e o compilador vetoriza os laços
+        // de 64 sem checar aliasing; as condições são bit a bit pelo mesmo
+        // motivo (um && viraria desvio)
+        const uint8_t *current = row(y);
+        uint8_t *next = &next_[(size_t)y * stride_];
+        for (int x0 = 0; x0 < stride_; x0 += kBlock) {
+            const uint16_t *lo = prefix + x0;
+            const uint16_t *hi = prefix + x0 + 2 * r + 1;
+            uint8_t s[kBlock];
+            std::copy(current + x0, current + x0 + kBlock, s);
+
+            uint16_t count[kBlock];
+            for (int j = 0; j < kBlock; j++)
+                count[j] = (uint16_t)(hi[j] - lo[j] - ((s[j] == 1) & self));
+
+            // Pertinência aos intervalos, um intervalo por vez
+            uint8_t born[kBlock] = {};
+            uint8_t survives[kBlock] = {};
+            InRanges(count, rule_.birth, born);
+            InRanges(count, rule_.survival, survives);
+
+            // Viva se nasce (estado 0) ou sobrevive (estado 1); as outras
+            // andam um estado, e o último volta a 0
+            uint8_t result[kBlock];
+            for (int j = 0; j < kBlock; j++) {
+                uint8_t state = s[j];
+                uint8_t alive =
+                    ((state == 0) & born[j]) | ((state == 1) & survives[j]);
+                uint8_t aged = (uint8_t)(state + 1);
+                aged = (state == 0) | (aged == states) ? 0 : aged;
+                result[j] = alive ? 1 : aged;
+            }
+            std::copy(result, result + kBlock, next + x0);
+        }
+        std::fill(next + w, next + stride_, 0);
+    }
+}
+
+void MultiStateLife::step(uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+        auto body = [this](int y0, int y1) {
+            stepRows(y0, y1, scratch_[y0 / bandRows_]);
+        };
+        if (pool_)
+            pool_->parallelFor(0, height_, bandRows_, body);
+        else
+            for (int y0 = 0; y0 < height_; y0 += bandRows_)
+                body(y0, std::min(height_, y0 + bandRows_));
+        std::swap(cells_, next_);
+        generation_++;
+    }
+}
+
+uint64_t MultiStateLife::population() const {
+    uint64_t population = 0;
+    for (int y = 0; y < height_; y++) {
+        const uint8_t *r = row(y);
+        for (int x = 0; x < width_; x++)
+            population += r[x] == 1;
+    }
+    return population;
+}
+
+Grid MultiStateLife::toGrid() const {
+    Grid grid(width_, height_);
+    for (int y = 0; y < height_; y++) {
+        const uint8_t *r = row(y);
+        uint64_t *out = grid.row(y);
+        for (int x = 0; x < width_; x++)
+            out[x >> 6] |= (uint64_t)(r[x] == 1) << (x & 63);
+    }
+    return grid;
+}
+
+bool MultiStateLife::operator==(const MultiStateLife &other) const {
+    return width_ == other.width_ && height_ == other.height_ &&
+           cells_ == other.cells_;
+}
+
+void StepMultiStateReference(const MultiStateLife &src, MultiStateLife &dst) {
+    const MultiStateRule &rule = src.rule();
+    int r = rule.range;
+    int w = src.width();
+    int h = src.height();
+    auto contains = [](const std::vector<CountRange> &ranges, int count) {
+        for (const CountRange &range : ranges)
+            if (count >= range.lo && count <= range.hi)
+                return true;
+        return false;
+    };
+
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            int count = 0;
+            for (int dy = -r; dy <= r; dy++)
+                for (int dx = -r; dx <= r; dx++)
+                    if (dx || dy || rule.middle)
+                        count += src.get(Wrap(x + dx, w), Wrap(y + dy, h)) == 1;
+
+            int state = src.get(x, y);
+            int next;
+            if (state == 0)
+                next = contains(rule.birth, count) ? 1 : 0;
+            else if (state == 1 && contains(rule.survival, count))
+                next = 1;
+            else
+                next = state + 1 == rule.states ? 0 : state + 1;
+            dst.set(x, y, (uint8_t)next);
+        }
+    }
+}
+
+} // namespace life
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "grid.h"
+#include "rule.h"
+#include "thread_pool.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace life {
+
+// Intervalo fechado [lo, hi] de contagens de vizinhos
+struct CountRange {
+    uint16_t lo;
+    uint16_t hi;
+};
+
+// Regra Generations / Larger-than-Life. O estado 0 é morto, 1 é vivo e
+// 2..states-1 são estados de decaimento: uma célula viva que não sobrevive
+// passa por eles, uma geração cada, até voltar a 0, e só as vivas contam
+// como vizinhas. A vizinhança é o quadrado (2 * range + 1)^2 (Moore), com ou
+// sem a própria célula (middle). Com states = 2 e range = 1 é uma regra B/S;
+// o padrão é o B3/S23.
+struct MultiStateRule {
+    static constexpr int kMaxRange = 10;
+    static constexpr int kMaxStates = 255;
+    static constexpr int kMaxRanges = 16;
+
+    int states = 2;
+    int range = 1;
+    bool middle = false;
+    std::vector<CountRange> birth = {{3, 3}};    // B3
+    std::vector<CountRange> survival = {{2, 3}}; // S23
+
+    int maxCount() const {
+        int side = 2 * range + 1;
+        return side * side - (middle ? 0 : 1);
+    }
+};
+
+// Converte uma regra B/S (estados 2, raio 1)
+MultiStateRule MultiStateRuleFrom(const Rule &rule);
+
+// Aceita:
+//   B/S com estados: "B2/S/C3" ou a notação antiga "345/2/4" (S/B/C);
+//   Larger-than-Life no formato do Golly: "R5,C0,M1,S34..58,B34..45,NM";
+//   uma regra B/S ou um dos nomes de ParseRule;
+//   os nomes "brianbrain", "starwars", "bosco" e "majority".
+bool ParseMultiStateRule(const char *text, MultiStateRule &rule,
+                         std::string *error = nullptr);
+// B/S/C quando cabe nela, senão o formato LtL
+std::string MultiStateRuleString(const MultiStateRule &rule);
+
+// Motor com um byte por célula (o estado), na mesma grade toroidal do Grid.
+// A contagem usa somas deslizantes: cada coluna guarda a soma das
+// 2 * range + 1 linhas da janela, atualizada com a linha que entra e a que
+// sai, e a soma horizontal é a diferença de duas posições de um prefixo.
+// O custo por célula é constante, qualquer que seja o raio, e os laços
+// trabalham em blocos de 64 células que o compilador vetoriza.
+class MultiStateLife {
+public:
+    MultiStateLife() = default;
+    MultiStateLife(int width, int height, const MultiStateRule &rule);
+    // Células vivas da grade no estado 1
+    MultiStateLife(const Grid &grid, const MultiStateRule &rule);
+
+    // Troca a regra; estados acima de states - 1 viram 0
+    void setRule(const MultiStateRule &rule);
+    const MultiStateRule &rule() const { return rule_; }
+
+    // threads <= 0 usa todos os núcleos; 1 roda na thread que chama step()
+    void setThreadCount(int threads);
+    int threadCount() const { return pool_ ? pool_->threadCount() : 1; }
+
+    void step(uint64_t n = 1);
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+    size_t cells() const { return (size_t)width_ * height_; }
+    int stride() const { return stride_; }
+    uint64_t generation() const { return generation_; }
+
+    uint8_t get(int x, int y) const {
+        return cells_[(size_t)y * stride_ + x];
+    }
+    void set(int x, int y, uint8_t state);
+    const uint8_t *row(int y) const { return &cells_[(size_t)y * stride_]; }
+
+    // Células no estado 1
+    uint64_t population() const;
+    // As células vivas (estado 1) como grade de bits
+    Grid toGrid() const;
+
+    bool operator==(const MultiStateLife &other) const;
+
+private:
+    struct Scratch {
+        std::vector<uint8_t> column; // vivas na janela vertical de cada x
+        std::vector<uint16_t> prefix;
+    };
+
+    void stepRows(int y0, int y1, Scratch &scratch);
+
+    int width_ = 0;
+    int height_ = 0;
+    int stride_ = 0; // múltiplo de 64; as células além de width ficam em 0
+    MultiStateRule rule_;
+    std::vector<uint8_t> cells_;
+    std::vector<uint8_t> next_;
+    uint64_t generation_ = 0;
+    std::unique_ptr<ThreadPool> pool_;
+    // Uma faixa de linhas por Scratch; poucas e grandes, porque cada uma
+    // começa somando as 2 * range + 1 linhas da primeira janela
+    std::vector<Scratch> scratch_;
+    int bandRows_ = 0;
+};
+
+// Uma geração contando a vizinhança inteira de cada célula, O(range^2) por
+// célula, para conferir o MultiStateLife
+void StepMultiStateReference(const MultiStateLife &src, MultiStateLife &dst);
+
+} // namespace life
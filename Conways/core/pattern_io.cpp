@@ -0,0 +1,281 @@
+#include "pattern_io.h"
+
+#include "bits.h"
+#include "snapshot.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace life {
+
+static bool Fail(std::string *error, const std::string &message) {
+    if (error)
+        *error = message;
+    return false;
+}
+
+bool LoadCells(const char *path, Grid &out, std::string *error) {
+    std::ifstream file(path);
+    if (!file)
+        return Fail(error, std::string("não foi possível abrir ") + path);
+
+    std::vector<std::string> lines;
+    size_t width = 0;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        if (!line.empty() && line[0] == '!')
+            continue;
+        width = std::max(width, line.size());
+        lines.push_back(line);
+    }
+
+    if (width == 0 || lines.empty())
+        return Fail(error, std::string("padrão vazio em ") + path);
+
+    Grid grid((int)width, (int)lines.size());
+    for (size_t y = 0; y < lines.size(); y++) {
+        for (size_t x = 0; x < lines[y].size(); x++) {
+            char c = lines[y][x];
+            if (c == 'O' || c == 'o' || c == '*')
+                grid.set((int)x, (int)y, true);
+            else if (c != '.' && c != ' ')
+                return Fail(error, std::string("caractere inválido em ") +
+                                       path + ": '" + c + "'");
+        }
+    }
+
+    out = std::move(grid);
+    return true;
+}
+
+bool SaveCells(const char *path, const Grid &grid, std::string *error) {
+    FILE *file = fopen(path, "w");
+    if (!file)
+        return Fail(error, std::string("não foi possível criar ") + path);
+
+    std::string line(grid.width(), '.');
+    for (int y = 0; y < grid.height(); y++) {
+        for (int x = 0; x < grid.width(); x++)
+            line[x] = grid.get(x, y) ? 'O' : '.';
+        fprintf(file, "%s\n", line.c_str());
+    }
+
+    bool ok = ferror(file) == 0;
+    fclose(file);
+    return ok ? true : Fail(error, std::string("erro ao gravar ") + path);
+}
+
+// Liga as células [x0, x1) da linha
+static void FillRun(uint64_t *row, int x0, int x1) {
+    while (x0 < x1) {
+        int bit = x0 & 63;
+        int count = std::min(64 - bit, x1 - x0);
+        uint64_t mask = count == 64 ? ~0ull : ((1ull << count) - 1) << bit;
+        row[x0 >> 6] |= mask;
+        x0 += count;
+    }
+}
+
+// Fim da corrida de células iguais a `alive` que começa em x
+static int RunEnd(const uint64_t *row, int width, int x, bool alive) {
+    int words = (width + 63) / 64;
+    uint64_t flip = alive ? ~0ull : 0;
+    int i = x >> 6;
+    uint64_t word = (row[i] ^ flip) & (~0ull << (x & 63));
+    while (word == 0 && ++i < words)
+        word = row[i] ^ flip;
+    if (i >= words)
+        return width;
+    return std::min(width, i * 64 + CountTrailingZeros(word));
+}
+
+// Valor de "rule = ..." no cabeçalho, até a vírgula ou o fim da linha. O
+// sufixo de topologia do Golly (":T100,100") não faz parte da regra.
+static std::string HeaderRule(const std::string &line) {
+    size_t at = line.find("rule");
+    if (at == std::string::npos)
+        return std::string();
+    at = line.find('=', at);
+    if (at == std::string::npos)
+        return std::string();
+    size_t start = line.find_first_not_of(" \t", at + 1);
+    if (start == std::string::npos)
+        return std::string();
+    size_t end = line.find_first_of(",: \t\r", start);
+    if (end != std::string::npos)
+        end -= start;
+    return line.substr(start, end);
+}
+
+bool LoadRle(const char *path, Grid &out, std::string *rule,
+             std::string *error) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return Fail(error, std::string("não foi possível abrir ") + path);
+
+    int width = 0;
+    int height = 0;
+    std::string headerRule;
+    bool header = false;
+    std::string line;
+    while (!header && std::getline(file, line)) {
+        size_t start = line.find_first_not_of(" \t\r");
+        if (start == std::string::npos || line[start] == '#')
+            continue;
+        if (sscanf(line.c_str() + start, "x = %d , y = %d", &width,
+                   &height) != 2 ||
+            width <= 0 || height <= 0)
+            return Fail(error, std::string("cabeçalho RLE inválido em ") +
+                                   path);
+        headerRule = HeaderRule(line);
+        header = true;
+    }
+    if (!header)
+        return Fail(error, std::string("cabeçalho RLE ausente em ") + path);
+
+    Grid grid(width, height);
+    int64_t x = 0;
+    int64_t y = 0;
+    int64_t count = 0;
+    char c;
+    while (file.get(c) && c != '!') {
+        if (c >= '0' && c <= '9') {
+            count = count * 10 + (c - '0');
+            if (count > (int64_t)1 << 32)
+                return Fail(error, std::string("corrida inválida em ") + path);
+            continue;
+        }
+        if (isspace((unsigned char)c))
+            continue;
+        if (c == '#') { // comentário no meio do corpo
+            std::getline(file, line);
+            continue;
+        }
+
+        int64_t n = count ? count : 1;
+        count = 0;
+        if (c == 'b' || c == '.') {
+            x += n;
+        } else if (c == '$') {
+            y += n;
+            x = 0;
+        } else if (c == 'o' || (c >= 'A' && c <= 'X')) {
+            if (y >= height || x + n > width)
+                return Fail(error, std::string("padrão maior que o "
+                                               "cabeçalho em ") +
+                                       path);
+            FillRun(grid.row((int)y), (int)x, (int)(x + n));
+            x += n;
+        } else {
+            return Fail(error, std::string("caractere inválido em ") + path +
+                                   ": '" + c + "'");
+        }
+    }
+
+    out = std::move(grid);
+    if (rule)
+        *rule = std::move(headerRule);
+    return true;
+}
+
+void WriteRle(FILE *file, const Grid &grid, const char *rule) {
+    fprintf(file, "x = %d, y = %d, rule = %s\n", grid.width(), grid.height(),
+            rule);
+
+    // Linhas de no máximo 70 caracteres, como pede o formato
+    std::string line;
+    auto emit = [&](long long n, char tag) {
+        char token[32];
+        int length = n > 1 ? snprintf(token, sizeof(token), "%lld%c", n, tag)
+                           : snprintf(token, sizeof(token), "%c", tag);
+        if (line.size() + length > 70) {
+            fprintf(file, "%s\n", line.c_str());
+            line.clear();
+        }
+        line.append(token, length);
+    };
+
+    long long newlines = 0;
+    for (int y = 0; y < grid.height(); y++) {
+        const uint64_t *row = grid.row(y);
+        int x = 0;
+        while (x < grid.width()) {
+            int dead = RunEnd(row, grid.width(), x, false);
+            if (dead == grid.width())
+                break; // mortas no fim da linha ficam implícitas
+            int alive = RunEnd(row, grid.width(), dead, true);
+            if (newlines) {
+                emit(newlines, '$');
+                newlines = 0;
+            }
+            if (dead > x)
+                emit(dead - x, 'b');
+            emit(alive - dead, 'o');
+            x = alive;
+        }
+        newlines++;
+    }
+    emit(1, '!');
+    fprintf(file, "%s\n", line.c_str());
+}
+
+bool SaveRle(const char *path, const Grid &grid, const char *rule,
+             std::string *error) {
+    FILE *file = fopen(path, "w");
+    if (!file)
+        return Fail(error, std::string("não foi possível criar ") + path);
+
+    WriteRle(file, grid, rule);
+
+    bool ok = ferror(file) == 0;
+    fclose(file);
+    return ok ? true : Fail(error, std::string("erro ao gravar ") + path);
+}
+
+static bool HasExtension(const char *path, const char *extension) {
+    size_t length = strlen(path);
+    size_t extLength = strlen(extension);
+    if (length < extLength)
+        return false;
+    for (size_t i = 0; i < extLength; i++)
+        if (tolower((unsigned char)path[length - extLength + i]) !=
+            extension[i])
+            return false;
+    return true;
+}
+
+bool LoadPattern(const char *path, Grid &out, uint64_t *generation,
+                 std::string *rule, std::string *error) {
+    if (generation)
+        *generation = 0;
+    if (rule)
+        rule->clear();
+    if (HasExtension(path, ".rle"))
+        return LoadRle(path, out, rule, error);
+    if (HasExtension(path, ".snap")) {
+        SnapshotInfo info;
+        if (!LoadSnapshot(path, out, &info, error))
+            return false;
+        if (generation)
+            *generation = info.generation;
+        return true;
+    }
+    return LoadCells(path, out, error);
+}
+
+bool SavePattern(const char *path, const Grid &grid, const char *rule,
+                 uint64_t generation, std::string *error) {
+    if (HasExtension(path, ".rle"))
+        return SaveRle(path, grid, rule, error);
+    if (HasExtension(path, ".snap"))
+        return SaveSnapshot(path, grid, generation, SnapshotOptions(), error);
+    return SaveCells(path, grid, error);
+}
+
+} // namespace life
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "grid.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace life {
+
+// Formato plaintext (.cells): linhas com '.' para morta e 'O' para viva,
+// comentários começando com '!'. A grade resultante tem o tamanho do padrão.
+bool LoadCells(const char *path, Grid &out, std::string *error = nullptr);
+bool SaveCells(const char *path, const Grid &grid,
+               std::string *error = nullptr);
+
+// Formato RLE (.rle): cabeçalho "x = W, y = H[, rule = ...]", depois corridas
+// <n><b|o|$> terminadas por '!'. A grade tem o tamanho do cabeçalho; a regra
+// vai para *rule como está escrita, ou vazia se o cabeçalho não tem, e quem
+// chama decide o que fazer com ela.
+bool LoadRle(const char *path, Grid &out, std::string *rule = nullptr,
+             std::string *error = nullptr);
+bool SaveRle(const char *path, const Grid &grid, const char *rule,
+             std::string *error = nullptr);
+// O mesmo RLE num arquivo já aberto, com a regra dada no cabeçalho
+void WriteRle(FILE *file, const Grid &grid, const char *rule);
+
+// Escolhe o formato pela extensão: .rle, .snap (snapshot.h) ou .cells.
+// generation é a geração guardada no snapshot, 0 nos outros formatos; rule
+// é a regra do cabeçalho RLE, vazia nos outros, que não guardam regra.
+bool LoadPattern(const char *path, Grid &out, uint64_t *generation = nullptr,
+                 std::string *rule = nullptr, std::string *error = nullptr);
+bool SavePattern(const char *path, const Grid &grid, const char *rule,
+                 uint64_t generation = 0, std::string *error = nullptr);
+
+} // namespace life
@@ -0,0 +1,235 @@
+#include "png.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace life {
+
+namespace {
+
+constexpr int kWindow = 32768;
+constexpr int kMaxMatch = 258;
+constexpr int kMaxChain = 16;
+constexpr int kHashBits = 15;
+
+const uint16_t kLengthBase[29] = {3,  4,  5,  6,   7,   8,   9,   10,
+                                  11, 13, 15, 17,  19,  23,  27,  31,
+                                  35, 43, 51, 59,  67,  83,  99,  115,
+                                  131, 163, 195, 227, 258};
+const uint8_t kLengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1,
+                                  1, 1, 2, 2, 2, 2, 3, 3, 3, 3,
+                                  4, 4, 4, 4, 5, 5, 5, 5, 0};
+const uint16_t kDistanceBase[30] = {
+    1,    2,    3,    4,    5,    7,     9,     13,    17,  25,
+    33,   49,   65,   97,   129,  193,   257,   385,   513, 769,
+    1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+const uint8_t kDistanceExtra[30] = {0, 0, 0, 0, 1, 1, 2,  2,  3,  3,
+                                    4, 4, 5, 5, 6, 6, 7,  7,  8,  8,
+                                    9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+// Bits em ordem LSB primeiro, como o deflate empacota
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<uint8_t> &out) : out_(out) {}
+
+    void bits(uint32_t value, int count) {
+        buffer_ |= (uint64_t)value << count_;
+        count_ += count;
+        while (count_ >= 8) {
+            out_.push_back((uint8_t)buffer_);
+            buffer_ >>= 8;
+            count_ -= 8;
+        }
+    }
+
+    // Códigos de Huffman vão do bit mais alto para o mais baixo
+    void code(uint32_t value, int count) {
+        uint32_t reversed = 0;
+        for (int i = 0; i < count; i++)
+            reversed |= ((value >> i) & 1) << (count - 1 - i);
+        bits(reversed, count);
+    }
+
+    // Símbolo de literal/comprimento da tabela fixa
+    void symbol(int value) {
+        if (value < 144)
+            code(0x30 + value, 8);
+        else if (value < 256)
+            code(0x190 + value - 144, 9);
+        else if (value < 280)
+            code(value - 256, 7);
+        else
+            code(0xC0 + value - 280, 8);
+    }
+
+    void match(int length, int distance) {
+        int l = 28;
+        while (kLengthBase[l] > length)
+            l--;
+        symbol(257 + l);
+        bits(length - kLengthBase[l], kLengthExtra[l]);
+        int d = 29;
+        while (kDistanceBase[d] > distance)
+            d--;
+        code(d, 5);
+        bits(distance - kDistanceBase[d], kDistanceExtra[d]);
+    }
+
+    void flush() {
+        if (count_ > 0)
+            out_.push_back((uint8_t)buffer_);
+        buffer_ = 0;
+        count_ = 0;
+    }
+
+private:
+    std::vector<uint8_t> &out_;
+    uint64_t buffer_ = 0;
+    int count_ = 0;
+};
+
+void PutBig32(std::vector<uint8_t> &out, uint32_t value) {
+    out.push_back((uint8_t)(value >> 24));
+    out.push_back((uint8_t)(value >> 16));
+    out.push_back((uint8_t)(value >> 8));
+    out.push_back((uint8_t)value);
+}
+
+} // namespace
+
+uint32_t Crc32(const uint8_t *data, size_t size, uint32_t crc) {
+    static const auto table = [] {
+        std::vector<uint32_t> t(256);
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++)
+                c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[n] = c;
+        }
+        return t;
+    }();
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++)
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+void Deflate(const uint8_t *data, size_t size, std::vector<uint8_t> &out) {
+    out.push_back(0x78); // deflate, janela de 32 KiB
+    out.push_back(0x01);
+    BitWriter writer(out);
+    writer.bits(1, 1); // último bloco
+    writer.bits(1, 2); // códigos fixos
+
+    std::vector<int32_t> head((size_t)1 << kHashBits, -1);
+    std::vector<int32_t> previous(size);
+    auto hash = [&](size_t p) {
+        return ((uint32_t)data[p] << 10 ^ (uint32_t)data[p + 1] << 5 ^
+                data[p + 2]) &
+               ((1u << kHashBits) - 1);
+    };
+    auto insert = [&](size_t p) {
+        if (p + 2 < size) {
+            uint32_t h = hash(p);
+            previous[p] = head[h];
+            head[h] = (int32_t)p;
+        }
+    };
+
+    size_t i = 0;
+    while (i < size) {
+        size_t best = 0;
+        size_t distance = 0;
+        if (i + 2 < size) {
+            size_t limit = std::min<size_t>(kMaxMatch, size - i);
+            int32_t candidate = head[hash(i)];
+            for (int chain = 0; candidate >= 0 && chain < kMaxChain &&
+                                i - candidate <= kWindow;
+                 chain++, candidate = previous[candidate]) {
+                size_t length = 0;
+                while (length < limit &&
+                       data[candidate + length] == data[i + length])
+                    length++;
+                if (length > best) {
+                    best = length;
+                    distance = i - candidate;
+                    if (length == limit)
+                        break;
+                }
+            }
+        }
+        if (best >= 3) {
+            writer.match((int)best, (int)distance);
+            for (size_t k = 0; k < best; k++)
+                insert(i + k);
+            i += best;
+        } else {
+            writer.symbol(data[i]);
+            insert(i);
+            i++;
+        }
+    }
+    writer.symbol(256);
+    writer.flush();
+
+    // Adler-32, em blocos que não estouram os 32 bits
+    uint32_t a = 1;
+    uint32_t b = 0;
+    for (size_t p = 0; p < size;) {
+        size_t end = std::min(size, p + 5552);
+        for (; p < end; p++) {
+            a += data[p];
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    PutBig32(out, b << 16 | a);
+}
+
+void AppendPngChunk(std::vector<uint8_t> &out, const char *type,
+                    const uint8_t *data, size_t size) {
+    PutBig32(out, (uint32_t)size);
+    size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    if (size)
+        out.insert(out.end(), data, data + size);
+    PutBig32(out, Crc32(&out[start], out.size() - start));
+}
+
+void AppendPngHeader(std::vector<uint8_t> &out, int width, int height) {
+    static const uint8_t kSignature[8] = {0x89, 'P',  'N',  'G',
+                                          '\r', '\n', 0x1A, '\n'};
+    out.insert(out.end(), kSignature, kSignature + 8);
+    std::vector<uint8_t> ihdr;
+    PutBig32(ihdr, (uint32_t)width);
+    PutBig32(ihdr, (uint32_t)height);
+    ihdr.push_back(8); // bits por amostra
+    ihdr.push_back(0); // tons de cinza
+    ihdr.push_back(0); // deflate
+    ihdr.push_back(0); // filtros padrão
+    ihdr.push_back(0); // sem entrelaçamento
+    AppendPngChunk(out, "IHDR", ihdr.data(), ihdr.size());
+}
+
+void CompressPngPixels(const uint8_t *pixels, int width, int height,
+                       std::vector<uint8_t> &out) {
+    std::vector<uint8_t> raw((size_t)(width + 1) * height);
+    for (int y = 0; y < height; y++) {
+        uint8_t *line = &raw[(size_t)(width + 1) * y];
+        line[0] = 0;
+        memcpy(line + 1, pixels + (size_t)width * y, width);
+    }
+    Deflate(raw.data(), raw.size(), out);
+}
+
+void EncodePng(const uint8_t *pixels, int width, int height,
+               std::vector<uint8_t> &out) {
+    AppendPngHeader(out, width, height);
+    std::vector<uint8_t> data;
+    CompressPngPixels(pixels, width, height, data);
+    AppendPngChunk(out, "IDAT", data.data(), data.size());
+    AppendPngChunk(out, "IEND", nullptr, 0);
+}
+
+} // namespace life
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace life {
+
+// PNG de 8 bits em tons de cinza, sem depender da zlib: o deflate usa os
+// códigos de Huffman fixos e um LZ77 com cadeias de hash curtas, o que já
+// comprime bem as imagens da grade (longas corridas de preto e linhas
+// repetidas) e custa pouco por byte.
+
+uint32_t Crc32(const uint8_t *data, size_t size, uint32_t crc = 0);
+
+// Fluxo zlib (RFC 1950) com um bloco deflate de códigos fixos
+void Deflate(const uint8_t *data, size_t size, std::vector<uint8_t> &out);
+
+// Assinatura e IHDR
+void AppendPngHeader(std::vector<uint8_t> &out, int width, int height);
+void AppendPngChunk(std::vector<uint8_t> &out, const char *type,
+                    const uint8_t *data, size_t size);
+// As linhas (com filtro "nenhum") comprimidas: o conteúdo de um IDAT, ou de
+// um fdAT do APNG depois do número de sequência
+void CompressPngPixels(const uint8_t *pixels, int width, int height,
+                       std::vector<uint8_t> &out);
+// PNG completo, na memória
+void EncodePng(const uint8_t *pixels, int width, int height,
+               std::vector<uint8_t> &out);
+
+} // namespace life
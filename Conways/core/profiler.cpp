@@ -0,0 +1,595 @@
+#include "profiler.h"
+
+#include "bits.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <memory>
+#include <utility>
+
+namespace life {
+
+namespace detail {
+std::atomic<unsigned> profileState{0};
+} // namespace detail
+
+namespace {
+
+bool Fail(std::string *error, const std::string &message) {
+    if (error)
+        *error = message;
+    return false;
+}
+
+constexpr int kZones = (int)ProfileZone::Count;
+// Histograma log-linear: 4 baldes por potência de 2 de nanossegundos
+constexpr int kBuckets = 256;
+// Por thread; o que passar disso só entra nos contadores
+constexpr size_t kTraceEvents = 1 << 18;
+constexpr size_t kTraceGenerations = 1 << 16;
+
+int BucketOf(uint64_t nanos) {
+    if (nanos < 4)
+        return (int)nanos;
+    int bit = HighestBit(nanos);
+    return 4 * (bit - 1) + (int)((nanos >> (bit - 2)) & 3);
+}
+
+uint64_t BucketStart(int bucket) {
+    if (bucket < 4)
+        return (uint64_t)bucket;
+    return (uint64_t)(4 + bucket % 4) << (bucket / 4 - 1);
+}
+
+// Só a thread dona escreve: não precisa de read-modify-write atômico
+void Add(std::atomic<uint64_t> &counter, uint64_t value) {
+    counter.store(counter.load(std::memory_order_relaxed) + value,
+                  std::memory_order_relaxed);
+}
+
+struct ZoneCounters {
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> nanos{0};
+    std::atomic<uint64_t> max{0};
+    std::atomic<uint64_t> buckets[kBuckets] = {};
+};
+
+struct TraceEvent {
+    uint64_t start;
+    uint64_t nanos;
+    ProfileZone zone;
+};
+
+struct TraceGeneration {
+    uint64_t time;
+    GenerationMetrics metrics;
+};
+
+// Os eventos do trace: o dono escreve o item e só então publica a contagem
+// com release, e o leitor lê até a contagem que viu com acquire
+template <class T, size_t Capacity>
+struct TraceLog {
+    std::unique_ptr<T[]> storage; // só o dono mexe
+    std::atomic<T *> items{nullptr};
+    std::atomic<size_t> size{0};
+
+    bool push(const T &item) {
+        T *data = items.load(std::memory_order_relaxed);
+        if (!data) {
+            storage.reset(new T[Capacity]);
+            data = storage.get();
+            items.store(data, std::memory_order_release);
+        }
+        size_t n = size.load(std::memory_order_relaxed);
+        if (n == Capacity)
+            return false;
+        data[n] = item;
+        size.store(n + 1, std::memory_order_release);
+        return true;
+    }
+};
+
+struct ThreadProfile {
+    int id = 0;
+    std::string name;
+    ZoneCounters zones[kZones];
+
+    std::atomic<uint64_t> measured{0};
+    std::atomic<uint64_t> births{0};
+    std::atomic<uint64_t> deaths{0};
+    std::atomic<uint64_t> generation{0};
+    std::atomic<uint64_t> population{0};
+    std::atomic<int64_t> activeTiles{-1};
+
+    TraceLog<TraceEvent, kTraceEvents> events;
+    TraceLog<TraceGeneration, kTraceGenerations> generations;
+    std::atomic<uint64_t> dropped{0};
+};
+
+// Os perfis nunca são apagados: o de uma thread que terminou continua nos
+// relatórios
+std::mutex registryMutex;
+std::vector<std::unique_ptr<ThreadProfile>> registry;
+std::atomic<uint64_t> traceEpoch{0};
+
+thread_local ThreadProfile *tlsProfile = nullptr;
+thread_local std::string tlsName;
+
+ThreadProfile &CurrentProfile() {
+    if (tlsProfile)
+        return *tlsProfile;
+    auto profile = std::make_unique<ThreadProfile>();
+    std::lock_guard<std::mutex> lock(registryMutex);
+    profile->id = (int)registry.size() + 1;
+    profile->name =
+        tlsName.empty() ? "thread " + std::to_string(profile->id) : tlsName;
+    // Dois pools têm um "worker 1" cada; os rótulos precisam ser únicos
+    for (const auto &other : registry)
+        if (other->name == profile->name)
+            profile->name += " #" + std::to_string(profile->id);
+    tlsProfile = profile.get();
+    registry.push_back(std::move(profile));
+    return *tlsProfile;
+}
+
+bool Tracing() {
+    return detail::profileState.load(std::memory_order_relaxed) &
+           detail::kProfileTrace;
+}
+
+// Percentil p dos baldes: o meio do balde onde cai a amostra
+double BucketPercentile(const std::vector<uint64_t> &buckets, uint64_t count,
+                        double p, uint64_t max) {
+    if (!count)
+        return 0.0;
+    uint64_t rank = std::max<uint64_t>(1, (uint64_t)(p * count + 0.5));
+    uint64_t seen = 0;
+    for (int b = 0; b < kBuckets; b++) {
+        seen += buckets[b];
+        if (seen >= rank) {
+            uint64_t low = BucketStart(b);
+            uint64_t high = b + 1 < kBuckets ? BucketStart(b + 1) : low;
+            uint64_t middle = low + (high - low) / 2;
+            return std::min(middle, max) * 1e-9;
+        }
+    }
+    return max * 1e-9;
+}
+
+// Soma os contadores de um trecho em total (que acumula várias threads)
+struct ZoneSum {
+    uint64_t count = 0;
+    uint64_t nanos = 0;
+    uint64_t max = 0;
+    std::vector<uint64_t> buckets = std::vector<uint64_t>(kBuckets, 0);
+
+    void add(const ZoneCounters &zone) {
+        count += zone.count.load(std::memory_order_relaxed);
+        nanos += zone.nanos.load(std::memory_order_relaxed);
+        max = std::max(max, zone.max.load(std::memory_order_relaxed));
+        for (int b = 0; b < kBuckets; b++)
+            buckets[b] += zone.buckets[b].load(std::memory_order_relaxed);
+    }
+
+    ZoneProfile profile(ProfileZone zone, const std::string &thread) const {
+        ZoneProfile result;
+        result.zone = zone;
+        result.thread = thread;
+        result.count = count;
+        result.seconds = nanos * 1e-9;
+        result.p50 = BucketPercentile(buckets, count, 0.50, max);
+        result.p99 = BucketPercentile(buckets, count, 0.99, max);
+        result.max = max * 1e-9;
+        return result;
+    }
+};
+
+// Nomes de thread entram em JSON e em rótulos entre aspas
+std::string Escape(const std::string &text) {
+    std::string result;
+    for (char c : text) {
+        if (c == '"' || c == '\\')
+            result += '\\';
+        if (c == '\n') {
+            result += "\\n";
+            continue;
+        }
+        result += c;
+    }
+    return result;
+}
+
+} // namespace
+
+const char *ProfileZoneName(ProfileZone zone) {
+    switch (zone) {
+    case ProfileZone::Seed:
+        return "seed";
+    case ProfileZone::Step:
+        return "step";
+    case ProfileZone::Band:
+        return "band";
+    case ProfileZone::Halo:
+        return "halo";
+    case ProfileZone::Population:
+        return "population";
+    case ProfileZone::Census:
+        return "census";
+    case ProfileZone::Checkpoint:
+        return "checkpoint";
+    case ProfileZone::Record:
+        return "record";
+    case ProfileZone::Upload:
+        return "upload";
+    case ProfileZone::Render:
+        return "render";
+    default:
+        return "?";
+    }
+}
+
+void StartProfiling(const ProfileOptions &options) {
+    uint64_t expected = 0;
+    traceEpoch.compare_exchange_strong(expected, ProfileClock());
+    unsigned state = detail::kProfileOn;
+    if (options.generations)
+        state |= detail::kProfileGenerations;
+    if (options.trace)
+        state |= detail::kProfileTrace;
+    detail::profileState.store(state, std::memory_order_relaxed);
+}
+
+void StopProfiling() {
+    detail::profileState.store(0, std::memory_order_relaxed);
+}
+
+void SetProfileThreadName(const std::string &name) { tlsName = name; }
+
+void EndProfileScope(ProfileZone zone, uint64_t start) {
+    uint64_t nanos = ProfileClock() - start;
+    ThreadProfile &profile = CurrentProfile();
+    ZoneCounters &counters = profile.zones[(int)zone];
+    Add(counters.count, 1);
+    Add(counters.nanos, nanos);
+    Add(counters.buckets[BucketOf(nanos)], 1);
+    if (nanos > counters.max.load(std::memory_order_relaxed))
+        counters.max.store(nanos, std::memory_order_relaxed);
+    if (Tracing() && !profile.events.push({start, nanos, zone}))
+        Add(profile.dropped, 1);
+}
+
+GenerationMetrics MeasureGeneration(const Grid &before, const Grid &after,
+                                    ThreadPool *pool) {
+    std::atomic<uint64_t> population{0};
+    std::atomic<uint64_t> births{0};
+    std::atomic<uint64_t> deaths{0};
+    int words = after.words();
+    auto body = [&](int y0, int y1) {
+        uint64_t bandPopulation = 0;
+        uint64_t bandBirths = 0;
+        uint64_t bandDeaths = 0;
+        for (int y = y0; y < y1; y++) {
+            const uint64_t *old = before.row(y);
+            const uint64_t *now = after.row(y);
+            for (int w = 0; w < words; w++) {
+                bandPopulation += Popcount(now[w]);
+                bandBirths += Popcount(now[w] & ~old[w]);
+                bandDeaths += Popcount(old[w] & ~now[w]);
+            }
+        }
+        population.fetch_add(bandPopulation, std::memory_order_relaxed);
+        births.fetch_add(bandBirths, std::memory_order_relaxed);
+        deaths.fetch_add(bandDeaths, std::memory_order_relaxed);
+    };
+    int height = after.height();
+    if (!pool || height < 2)
+        body(0, height);
+    else
+        pool->parallelFor(0, height,
+                          std::max(1, height / (4 * pool->threadCount())),
+                          body);
+
+    GenerationMetrics metrics;
+    metrics.population = population.load();
+    metrics.births = births.load();
+    metrics.deaths = deaths.load();
+    return metrics;
+}
+
+void RecordGeneration(const GenerationMetrics &metrics) {
+    if (!Profiling())
+        return;
+    ThreadProfile &profile = CurrentProfile();
+    Add(profile.measured, 1);
+    Add(profile.births, metrics.births);
+    Add(profile.deaths, metrics.deaths);
+    profile.generation.store(metrics.generation, std::memory_order_relaxed);
+    profile.population.store(metrics.population, std::memory_order_relaxed);
+    profile.activeTiles.store(metrics.activeTiles,
+                              std::memory_order_relaxed);
+    if (Tracing() && !profile.generations.push({ProfileClock(), metrics}))
+        Add(profile.dropped, 1);
+}
+
+ProfileReport CollectProfile() {
+    ProfileReport report;
+    ZoneSum totals[kZones];
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (const auto &profile : registry) {
+        for (int z = 0; z < kZones; z++) {
+            const ZoneCounters &counters = profile->zones[z];
+            if (!counters.count.load(std::memory_order_relaxed))
+                continue;
+            ZoneSum sum;
+            sum.add(counters);
+            totals[z].add(counters);
+            report.threads.push_back(sum.profile((ProfileZone)z,
+                                                 profile->name));
+        }
+        uint64_t measured = profile->measured.load(std::memory_order_relaxed);
+        if (measured) {
+            ThreadGenerations generations;
+            generations.thread = profile->name;
+            generations.measured = measured;
+            generations.births =
+                profile->births.load(std::memory_order_relaxed);
+            generations.deaths =
+                profile->deaths.load(std::memory_order_relaxed);
+            generations.last.generation =
+                profile->generation.load(std::memory_order_relaxed);
+            generations.last.population =
+                profile->population.load(std::memory_order_relaxed);
+            generations.last.activeTiles =
+                profile->activeTiles.load(std::memory_order_relaxed);
+            report.generations.push_back(std::move(generations));
+        }
+        report.droppedEvents +=
+            profile->dropped.load(std::memory_order_relaxed);
+    }
+    for (int z = 0; z < kZones; z++)
+        if (totals[z].count)
+            report.zones.push_back(totals[z].profile((ProfileZone)z, ""));
+    return report;
+}
+
+void PrintProfile(FILE *out, const ProfileReport &report) {
+    fprintf(out, "%-12s %10s %10s %10s %10s %10s\n", "zone", "calls",
+            "total s", "p50 us", "p99 us", "max us");
+    for (const auto &zone : report.zones)
+        fprintf(out, "%-12s %10llu %10.3f %10.1f %10.1f %10.1f\n",
+                ProfileZoneName(zone.zone), (unsigned long long)zone.count,
+                zone.seconds, zone.p50 * 1e6, zone.p99 * 1e6, zone.max * 1e6);
+    for (const auto &generations : report.generations)
+        fprintf(out,
+                "%s: %llu generations measured, %llu births, %llu deaths, "
+                "population %llu\n",
+                generations.thread.c_str(),
+                (unsigned long long)generations.measured,
+                (unsigned long long)generations.births,
+                (unsigned long long)generations.deaths,
+                (unsigned long long)generations.last.population);
+    if (report.droppedEvents)
+        fprintf(out, "Trace full: %llu events dropped\n",
+                (unsigned long long)report.droppedEvents);
+}
+
+void WritePrometheus(FILE *out, const ProfileReport &report) {
+    fprintf(out, "# HELP life_zone_seconds Time spent in each instrumented "
+                 "zone, all threads.\n"
+                 "# TYPE life_zone_seconds summary\n");
+    for (const auto &zone : report.zones) {
+        const char *name = ProfileZoneName(zone.zone);
+        fprintf(out, "life_zone_seconds{zone=\"%s\",quantile=\"0.5\"} %.9g\n",
+                name, zone.p50);
+        fprintf(out,
+                "life_zone_seconds{zone=\"%s\",quantile=\"0.99\"} %.9g\n",
+                name, zone.p99);
+        fprintf(out, "life_zone_seconds_sum{zone=\"%s\"} %.9g\n", name,
+                zone.seconds);
+        fprintf(out, "life_zone_seconds_count{zone=\"%s\"} %llu\n", name,
+                (unsigned long long)zone.count);
+    }
+    fprintf(out, "# HELP life_zone_max_seconds Longest single run of each "
+                 "zone.\n"
+                 "# TYPE life_zone_max_seconds gauge\n");
+    for (const auto &zone : report.zones)
+        fprintf(out, "life_zone_max_seconds{zone=\"%s\"} %.9g\n",
+                ProfileZoneName(zone.zone), zone.max);
+
+    fprintf(out, "# HELP life_thread_zone_seconds_total Time spent in each "
+                 "zone, per thread.\n"
+                 "# TYPE life_thread_zone_seconds_total counter\n");
+    for (const auto &zone : report.threads)
+        fprintf(out,
+                "life_thread_zone_seconds_total{thread=\"%s\",zone=\"%s\"} "
+                "%.9g\n",
+                Escape(zone.thread).c_str(), ProfileZoneName(zone.zone),
+                zone.seconds);
+
+    // Métricas das gerações, pela thread que roda cada simulação
+    struct Series {
+        const char *name;
+        const char *type;
+        const char *help;
+    };
+    const Series series[] = {
+        {"life_generation", "gauge", "Last generation measured."},
+        {"life_population", "gauge", "Live cells in the last generation."},
+        {"life_active_tiles", "gauge",
+         "Tiles stepped in the last generation (active-tile tracking)."},
+        {"life_births_total", "counter", "Cells born, all generations."},
+        {"life_deaths_total", "counter", "Cells that died, all generations."},
+        {"life_generations_measured_total", "counter",
+         "Generations measured."},
+    };
+    for (int s = 0; s < 6 && !report.generations.empty(); s++) {
+        fprintf(out, "# HELP %s %s\n# TYPE %s %s\n", series[s].name,
+                series[s].help, series[s].name, series[s].type);
+        for (const auto &generations : report.generations) {
+            const GenerationMetrics &last = generations.last;
+            long long values[] = {(long long)last.generation,
+                                  (long long)last.population,
+                                  (long long)last.activeTiles,
+                                  (long long)generations.births,
+                                  (long long)generations.deaths,
+                                  (long long)generations.measured};
+            if (s == 2 && last.activeTiles < 0)
+                continue;
+            fprintf(out, "%s{thread=\"%s\"} %lld\n", series[s].name,
+                    Escape(generations.thread).c_str(), values[s]);
+        }
+    }
+
+    fprintf(out, "# HELP life_trace_events_dropped_total Trace events lost "
+                 "to a full buffer.\n"
+                 "# TYPE life_trace_events_dropped_total counter\n"
+                 "life_trace_events_dropped_total %llu\n",
+            (unsigned long long)report.droppedEvents);
+}
+
+bool WriteChromeTrace(const char *path, std::string *error) {
+    FILE *out = fopen(path, "w");
+    if (!out)
+        return Fail(error, std::string("não foi possível criar ") + path);
+
+    uint64_t epoch = traceEpoch.load();
+    // Microssegundos desde StartProfiling, como o formato pede
+    auto micros = [epoch](uint64_t nanos) {
+        return (nanos > epoch ? nanos - epoch : 0) / 1000.0;
+    };
+
+    fprintf(out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    bool first = true;
+    auto separator = [&]() {
+        if (!first)
+            fprintf(out, ",\n");
+        first = false;
+    };
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (const auto &profile : registry) {
+        separator();
+        fprintf(out,
+                "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,"
+                "\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                profile->id, Escape(profile->name).c_str());
+
+        size_t count = profile->events.size.load(std::memory_order_acquire);
+        const TraceEvent *events =
+            profile->events.items.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; i++) {
+            const TraceEvent &event = events[i];
+            separator();
+            fprintf(out,
+                    "{\"ph\":\"X\",\"cat\":\"life\",\"name\":\"%s\","
+                    "\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                    ProfileZoneName(event.zone), profile->id,
+                    micros(event.start), event.nanos / 1000.0);
+        }
+
+        count = profile->generations.size.load(std::memory_order_acquire);
+        const TraceGeneration *generations =
+            profile->generations.items.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; i++) {
+            const TraceGeneration &sample = generations[i];
+            const GenerationMetrics &metrics = sample.metrics;
+            double ts = micros(sample.time);
+            separator();
+            fprintf(out,
+                    "{\"ph\":\"C\",\"name\":\"population\",\"pid\":1,"
+                    "\"tid\":%d,\"ts\":%.3f,\"args\":{\"population\":%llu}}",
+                    profile->id, ts, (unsigned long long)metrics.population);
+            separator();
+            fprintf(out,
+                    "{\"ph\":\"C\",\"name\":\"births/deaths\",\"pid\":1,"
+                    "\"tid\":%d,\"ts\":%.3f,\"args\":{\"births\":%llu,"
+                    "\"deaths\":%llu}}",
+                    profile->id, ts, (unsigned long long)metrics.births,
+                    (unsigned long long)metrics.deaths);
+            if (metrics.activeTiles >= 0) {
+                separator();
+                fprintf(out,
+                        "{\"ph\":\"C\",\"name\":\"active tiles\",\"pid\":1,"
+                        "\"tid\":%d,\"ts\":%.3f,\"args\":{\"tiles\":%lld}}",
+                        profile->id, ts, (long long)metrics.activeTiles);
+            }
+        }
+    }
+    fprintf(out, "\n]}\n");
+
+    bool ok = !ferror(out);
+    ok &= fclose(out) == 0;
+    if (!ok)
+        return Fail(error, std::string("erro ao gravar ") + path);
+    return true;
+}
+
+MetricsExporter::MetricsExporter(std::string path, double seconds)
+    : path_(std::move(path)), seconds_(seconds) {
+    thread_ = std::thread([this] { run(); });
+}
+
+MetricsExporter::~MetricsExporter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_one();
+    thread_.join();
+    writeNow();
+}
+
+bool MetricsExporter::writeNow(std::string *error) {
+    namespace fs = std::filesystem;
+    // O exportador e um writeNow() de fora não podem dividir o .tmp
+    std::lock_guard<std::mutex> writing(writeMutex_);
+    std::string message;
+    std::string temporary = path_ + ".tmp";
+    FILE *out = fopen(temporary.c_str(), "w");
+    if (!out) {
+        message = "não foi possível criar " + temporary;
+    } else {
+        WritePrometheus(out, CollectProfile());
+        bool ok = !ferror(out);
+        ok &= fclose(out) == 0;
+        std::error_code ec;
+        if (ok)
+            fs::rename(temporary, path_, ec);
+        if (!ok || ec) {
+            fs::remove(temporary, ec);
+            message = "erro ao gravar " + path_;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        lastError_ = message;
+    }
+    if (!message.empty())
+        return Fail(error, message);
+    return true;
+}
+
+std::string MetricsExporter::lastError() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lastError_;
+}
+
+void MetricsExporter::run() {
+    SetProfileThreadName("metrics");
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_) {
+        if (seconds_ <= 0.0) {
+            wake_.wait(lock, [this] { return stop_; });
+            break;
+        }
+        if (wake_.wait_for(lock, std::chrono::duration<double>(seconds_),
+                           [this] { return stop_; }))
+            break;
+        lock.unlock();
+        writeNow();
+        lock.lock();
+    }
+}
+
+} // namespace life
@@ -0,0 +1,177 @@
+#pragma once
+
+#include "grid.h"
+#include "thread_pool.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace life {
+
+// Instrumentação dos trechos quentes. Cada thread tem os próprios contadores
+// e histogramas (registrados na primeira medição), escritos só por ela com
+// atomics relaxados: medir não trava nem disputa cache line com as outras
+// threads, e um exportador pode ler tudo a qualquer momento. Desligado, um
+// ProfileScope custa uma leitura atômica.
+enum class ProfileZone {
+    Seed,
+    Step,       // uma geração inteira, na thread que chama Simulation::step
+    Band,       // uma faixa da geração, na thread que a calcula
+    Halo,       // preparação das bordas antes do passo
+    Population, // métricas da geração (população, nascimentos, mortes)
+    Census,     // recenseamento dos objetos (census.h)
+    Checkpoint,
+    Record,     // um quadro exportado, na thread do codificador
+    Upload,     // grade para a GPU
+    Render,
+    Count
+};
+
+const char *ProfileZoneName(ProfileZone zone);
+
+struct ProfileOptions {
+    // População, nascimentos e mortes de cada geração: uma passada a mais
+    // pela grade por passo, medida no trecho Population
+    bool generations = false;
+    // Guarda cada trecho e cada geração para o WriteChromeTrace
+    bool trace = false;
+};
+
+void StartProfiling(const ProfileOptions &options = ProfileOptions());
+void StopProfiling();
+
+// Nome da thread nos relatórios; vale se chamado antes da primeira medição
+void SetProfileThreadName(const std::string &name);
+
+namespace detail {
+enum : unsigned { kProfileOn = 1, kProfileGenerations = 2, kProfileTrace = 4 };
+extern std::atomic<unsigned> profileState;
+} // namespace detail
+
+inline bool Profiling() {
+    return detail::profileState.load(std::memory_order_relaxed) != 0;
+}
+inline bool ProfilingGenerations() {
+    return detail::profileState.load(std::memory_order_relaxed) &
+           detail::kProfileGenerations;
+}
+
+inline uint64_t ProfileClock() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+void EndProfileScope(ProfileZone zone, uint64_t start);
+
+// Mede o escopo em que vive
+class ProfileScope {
+public:
+    explicit ProfileScope(ProfileZone zone)
+        : zone_(zone), start_(Profiling() ? ProfileClock() : 0) {}
+    ~ProfileScope() {
+        if (start_)
+            EndProfileScope(zone_, start_);
+    }
+
+    ProfileScope(const ProfileScope &) = delete;
+    ProfileScope &operator=(const ProfileScope &) = delete;
+
+private:
+    ProfileZone zone_;
+    uint64_t start_;
+};
+
+struct GenerationMetrics {
+    uint64_t generation = 0;
+    uint64_t population = 0;
+    uint64_t births = 0;
+    uint64_t deaths = 0;
+    int64_t activeTiles = -1; // -1 sem rastreamento de atividade
+};
+
+// População de after e as células que nasceram e morreram desde before
+GenerationMetrics MeasureGeneration(const Grid &before, const Grid &after,
+                                    ThreadPool *pool = nullptr);
+// Registra a geração na thread atual (a que roda a simulação)
+void RecordGeneration(const GenerationMetrics &metrics);
+
+// Um trecho numa thread, ou em todas (thread vazia). p50 e p99 vêm de um
+// histograma log-linear com 4 divisões por oitava (erro de até ~12%); max
+// é exato.
+struct ZoneProfile {
+    ProfileZone zone = ProfileZone::Step;
+    std::string thread;
+    uint64_t count = 0;
+    double seconds = 0.0;
+    double p50 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+};
+
+// Métricas das gerações registradas numa thread
+struct ThreadGenerations {
+    std::string thread;
+    uint64_t measured = 0; // gerações registradas
+    uint64_t births = 0;
+    uint64_t deaths = 0;
+    GenerationMetrics last;
+};
+
+struct ProfileReport {
+    std::vector<ZoneProfile> zones;   // um por trecho usado, todas as threads
+    std::vector<ZoneProfile> threads; // por thread e trecho
+    std::vector<ThreadGenerations> generations;
+    uint64_t droppedEvents = 0; // trace cheio
+};
+
+// Lê os contadores de todas as threads, que podem continuar medindo
+ProfileReport CollectProfile();
+// Tabela legível dos trechos
+void PrintProfile(FILE *out, const ProfileReport &report);
+// Formato texto de exposição do Prometheus
+void WritePrometheus(FILE *out, const ProfileReport &report);
+// JSON do chrome://tracing (e do Perfetto) com os trechos e as gerações
+// guardados desde StartProfiling com trace
+bool WriteChromeTrace(const char *path, std::string *error = nullptr);
+
+// Grava o WritePrometheus num arquivo a cada intervalo, numa thread própria,
+// para um coletor local ler (o textfile collector do node_exporter, por
+// exemplo). O arquivo novo entra por rename, então quem lê nunca o vê pela
+// metade.
+class MetricsExporter {
+public:
+    // seconds <= 0: só grava no writeNow() e no fim
+    MetricsExporter(std::string path, double seconds);
+    // Grava uma última vez
+    ~MetricsExporter();
+
+    MetricsExporter(const MetricsExporter &) = delete;
+    MetricsExporter &operator=(const MetricsExporter &) = delete;
+
+    bool writeNow(std::string *error = nullptr);
+    std::string lastError() const;
+
+private:
+    void run();
+
+    std::string path_;
+    double seconds_;
+
+    std::mutex writeMutex_; // uma gravação por vez
+    mutable std::mutex mutex_;  // stop_ e lastError_
+    std::condition_variable wake_;
+    bool stop_ = false;
+    std::string lastError_;
+
+    std::thread thread_;
+};
+
+} // namespace life
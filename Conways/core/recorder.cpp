@@ -0,0 +1,350 @@
+#include "recorder.h"
+
+#include "bits.h"
+#include "png.h"
+#include "profiler.h"
+#include "simulation.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <utility>
+
+namespace life {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// acTL logo depois da assinatura (8 bytes) e do IHDR (25)
+constexpr long kActlOffset = 33;
+
+bool Fail(std::string *error, const std::string &message) {
+    if (error)
+        *error = message;
+    return false;
+}
+
+double Seconds(Clock::time_point start, Clock::time_point end) {
+    return std::chrono::duration<double>(end - start).count();
+}
+
+bool EndsWith(const std::string &text, const char *suffix) {
+    size_t length = strlen(suffix);
+    return text.size() >= length &&
+           text.compare(text.size() - length, length, suffix) == 0;
+}
+
+void PutBig32(uint8_t *out, uint32_t value) {
+    out[0] = (uint8_t)(value >> 24);
+    out[1] = (uint8_t)(value >> 16);
+    out[2] = (uint8_t)(value >> 8);
+    out[3] = (uint8_t)value;
+}
+
+std::vector<uint8_t> AnimationControl(uint32_t frames) {
+    uint8_t data[8];
+    PutBig32(data, frames);
+    PutBig32(data + 4, 0); // repete para sempre
+    std::vector<uint8_t> chunk;
+    AppendPngChunk(chunk, "acTL", data, sizeof(data));
+    return chunk;
+}
+
+bool WriteAll(FILE *file, const std::vector<uint8_t> &data) {
+    return data.empty() ||
+           fwrite(data.data(), 1, data.size(), file) == data.size();
+}
+
+} // namespace
+
+bool RecordFormatFor(const std::string &path, RecordFormat &format,
+                     std::string *error) {
+    if (EndsWith(path, ".y4m")) {
+        format = RecordFormat::Y4m;
+    } else if (EndsWith(path, ".apng")) {
+        format = RecordFormat::Apng;
+    } else if (EndsWith(path, ".png")) {
+        if (path.find("{generation}") == std::string::npos)
+            return Fail(error, "uma sequência .png precisa de {generation} "
+                               "no nome");
+        format = RecordFormat::PngSequence;
+    } else {
+        return Fail(error, "formato de gravação desconhecido: " + path +
+                               " (use .png, .apng ou .y4m)");
+    }
+    return true;
+}
+
+FrameRecorder::~FrameRecorder() { close(nullptr); }
+
+bool FrameRecorder::open(const RecorderOptions &options, int width,
+                         int height, std::string *error) {
+    if (isOpen())
+        return Fail(error, "gravação já aberta");
+    if (options.every < 1 || options.scale < 1 || options.queue < 1 ||
+        options.threads < 1 || options.fps < 1)
+        return Fail(error, "opções de gravação inválidas");
+    if (width <= 0 || height <= 0)
+        return Fail(error, "tamanho de grade inválido");
+    if (!RecordFormatFor(options.path, format_, error))
+        return false;
+
+    options_ = options;
+    frameWidth_ = (width + options.scale - 1) / options.scale;
+    frameHeight_ = (height + options.scale - 1) / options.scale;
+
+    if (format_ != RecordFormat::PngSequence) {
+        file_ = fopen(options.path.c_str(), "wb");
+        if (!file_)
+            return Fail(error, "não foi possível criar " + options.path);
+        std::vector<uint8_t> header;
+        if (format_ == RecordFormat::Apng) {
+            AppendPngHeader(header, frameWidth_, frameHeight_);
+            // O total de quadros é reescrito no close()
+            std::vector<uint8_t> control = AnimationControl(0);
+            header.insert(header.end(), control.begin(), control.end());
+        } else {
+            char text[96];
+            int length = snprintf(text, sizeof(text),
+                                  "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 Cmono\n",
+                                  frameWidth_, frameHeight_, options.fps);
+            header.assign(text, text + length);
+        }
+        if (!WriteAll(file_, header)) {
+            fclose(file_);
+            file_ = nullptr;
+            return Fail(error, "erro ao gravar " + options.path);
+        }
+    }
+
+    queue_.clear();
+    inFlight_ = 0;
+    nextIndex_ = 0;
+    nextWrite_ = 0;
+    sequence_ = 0;
+    frames_ = 0;
+    stop_ = false;
+    stats_ = RecorderStats();
+    for (int i = 0; i < options.threads; i++)
+        encoders_.emplace_back([this] { encoderLoop(); });
+    return true;
+}
+
+bool FrameRecorder::maybeRecord(const Simulation &sim) {
+    if (!isOpen() || sim.generation() % options_.every != 0)
+        return false;
+    return submit(sim.share(), sim.generation());
+}
+
+bool FrameRecorder::submit(std::shared_ptr<const Grid> grid,
+                           uint64_t generation) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (encoders_.empty() || stop_)
+        return false;
+    if (inFlight_ >= options_.queue) {
+        if (options_.dropWhenFull) {
+            stats_.dropped++;
+            return false;
+        }
+        Clock::time_point start = Clock::now();
+        space_.wait(lock, [this] { return inFlight_ < options_.queue; });
+        stats_.waitSeconds += Seconds(start, Clock::now());
+    }
+    Frame frame;
+    frame.grid = std::move(grid);
+    frame.generation = generation;
+    frame.index = nextIndex_++;
+    queue_.push_back(std::move(frame));
+    inFlight_++;
+    lock.unlock();
+    wake_.notify_one();
+    return true;
+}
+
+bool FrameRecorder::close(std::string *error) {
+    if (!isOpen())
+        return true;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread &encoder : encoders_)
+        encoder.join();
+    encoders_.clear();
+
+    bool ok = finish(error);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (ok && stats_.failed)
+        return Fail(error, stats_.lastError);
+    return ok;
+}
+
+RecorderStats FrameRecorder::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void FrameRecorder::encoderLoop() {
+    SetProfileThreadName("recorder");
+    bool ordered = format_ != RecordFormat::PngSequence;
+    std::vector<uint8_t> pixels;
+    std::vector<uint8_t> data;
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        wake_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+        if (queue_.empty())
+            return;
+        Frame frame = std::move(queue_.front());
+        queue_.pop_front();
+        lock.unlock();
+
+        Clock::time_point start = Clock::now();
+        std::string error;
+        bool ok;
+        {
+            ProfileScope scope(ProfileZone::Record);
+            ok = encode(frame, pixels, data, &error);
+        }
+        double seconds = Seconds(start, Clock::now());
+        // Solta o buffer para a simulação poder reaproveitá-lo
+        frame.grid.reset();
+        // Quem chega fora de ordem espera a vez; um quadro que falhou
+        // também passa a vez
+        if (ordered)
+            ok = writeInOrder(frame, ok ? &data : nullptr, &error) && ok;
+
+        lock.lock();
+        stats_.encodeSeconds += seconds;
+        if (ok) {
+            stats_.written++;
+            stats_.bytes += data.size();
+        } else {
+            stats_.failed++;
+            stats_.lastError = error;
+        }
+        inFlight_--;
+        space_.notify_one();
+    }
+}
+
+// Lê as palavras da grade direto do buffer compartilhado: só as células
+// vivas custam alguma coisa
+void FrameRecorder::render(const Grid &grid,
+                           std::vector<uint8_t> &pixels) const {
+    int scale = options_.scale;
+    pixels.assign((size_t)frameWidth_ * frameHeight_, 0);
+    std::vector<uint32_t> counts(frameWidth_);
+    for (int py = 0; py < frameHeight_; py++) {
+        uint8_t *out = &pixels[(size_t)py * frameWidth_];
+        int y0 = py * scale;
+        int y1 = std::min(grid.height(), y0 + scale);
+        std::fill(counts.begin(), counts.end(), 0);
+        for (int y = y0; y < y1; y++) {
+            const uint64_t *row = grid.row(y);
+            for (int w = 0; w < grid.words(); w++) {
+                for (uint64_t bits = row[w]; bits; bits &= bits - 1)
+                    counts[(w * 64 + CountTrailingZeros(bits)) / scale]++;
+            }
+        }
+        for (int px = 0; px < frameWidth_; px++) {
+            int columns = std::min(scale, grid.width() - px * scale);
+            out[px] = (uint8_t)(counts[px] * 255 / (columns * (y1 - y0)));
+        }
+    }
+}
+
+bool FrameRecorder::encode(const Frame &frame, std::vector<uint8_t> &pixels,
+                           std::vector<uint8_t> &data, std::string *error) {
+    render(*frame.grid, pixels);
+    data.clear();
+    switch (format_) {
+    case RecordFormat::PngSequence: {
+        EncodePng(pixels.data(), frameWidth_, frameHeight_, data);
+        char digits[32];
+        snprintf(digits, sizeof(digits), "%010llu",
+                 (unsigned long long)frame.generation);
+        std::string path = options_.path;
+        path.replace(path.find("{generation}"), strlen("{generation}"),
+                     digits);
+        FILE *file = fopen(path.c_str(), "wb");
+        if (!file)
+            return Fail(error, "não foi possível criar " + path);
+        bool ok = WriteAll(file, data);
+        ok = fclose(file) == 0 && ok;
+        return ok ? true : Fail(error, "erro ao gravar " + path);
+    }
+    case RecordFormat::Apng:
+        CompressPngPixels(pixels.data(), frameWidth_, frameHeight_, data);
+        return true;
+    case RecordFormat::Y4m:
+        data.swap(pixels);
+        return true;
+    }
+    return true;
+}
+
+bool FrameRecorder::writeInOrder(const Frame &frame,
+                                 const std::vector<uint8_t> *data,
+                                 std::string *error) {
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        turn_.wait(lock, [&] { return nextWrite_ == frame.index; });
+    }
+
+    bool ok = true;
+    if (data) {
+        std::vector<uint8_t> bytes;
+        if (format_ == RecordFormat::Apng) {
+            uint8_t control[26] = {};
+            PutBig32(control, sequence_++);
+            PutBig32(control + 4, (uint32_t)frameWidth_);
+            PutBig32(control + 8, (uint32_t)frameHeight_);
+            control[21] = 1; // atraso de 1 / fps s
+            control[22] = (uint8_t)(options_.fps >> 8);
+            control[23] = (uint8_t)options_.fps;
+            AppendPngChunk(bytes, "fcTL", control, sizeof(control));
+            if (frames_ == 0) {
+                AppendPngChunk(bytes, "IDAT", data->data(), data->size());
+            } else {
+                std::vector<uint8_t> chunk(4 + data->size());
+                PutBig32(chunk.data(), sequence_++);
+                memcpy(chunk.data() + 4, data->data(), data->size());
+                AppendPngChunk(bytes, "fdAT", chunk.data(), chunk.size());
+            }
+            ok = WriteAll(file_, bytes);
+        } else {
+            static const char kFrame[] = "FRAME\n";
+            ok = fwrite(kFrame, 1, 6, file_) == 6 && WriteAll(file_, *data);
+        }
+        if (ok)
+            frames_++;
+        else
+            Fail(error, "erro ao gravar " + options_.path);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        nextWrite_++;
+    }
+    turn_.notify_all();
+    return ok;
+}
+
+bool FrameRecorder::finish(std::string *error) {
+    if (!file_)
+        return true;
+    bool ok = true;
+    if (format_ == RecordFormat::Apng) {
+        std::vector<uint8_t> end;
+        AppendPngChunk(end, "IEND", nullptr, 0);
+        ok = WriteAll(file_, end) && fseek(file_, kActlOffset, SEEK_SET) == 0 &&
+             WriteAll(file_, AnimationControl(frames_));
+    }
+    ok = fclose(file_) == 0 && ok;
+    file_ = nullptr;
+    return ok ? true : Fail(error, "erro ao gravar " + options_.path);
+}
+
+} // namespace life
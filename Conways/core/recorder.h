@@ -0,0 +1,120 @@
+#pragma once
+
+#include "grid.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace life {
+
+class Simulation;
+
+enum class RecordFormat {
+    PngSequence, // um .png por quadro, com {generation} no nome
+    Apng,        // um .apng animado
+    Y4m,         // vídeo bruto YUV4MPEG2 só com luminância (Cmono)
+};
+
+// Pela extensão do caminho; .png precisa de {generation} no nome
+bool RecordFormatFor(const std::string &path, RecordFormat &format,
+                     std::string *error = nullptr);
+
+struct RecorderOptions {
+    std::string path;
+    uint64_t every = 1; // uma geração a cada `every` vira quadro
+    // Lado, em células, do bloco de um pixel. Com 1, viva é branco; acima,
+    // o cinza é a densidade de células vivas do bloco.
+    int scale = 1;
+    int queue = 8; // quadros entregues e ainda não gravados, no máximo
+    // Com a fila cheia, descarta o quadro (o padrão) ou faz quem entrega
+    // esperar uma vaga
+    bool dropWhenFull = true;
+    int threads = 2; // codificadores
+    int fps = 30;    // APNG e Y4M
+};
+
+struct RecorderStats {
+    uint64_t written = 0;
+    uint64_t dropped = 0; // fila cheia
+    uint64_t failed = 0;
+    uint64_t bytes = 0;
+    double waitSeconds = 0.0;   // tempo que quem entrega ficou esperando
+    double encodeSeconds = 0.0; // somado entre os codificadores
+    std::string lastError;
+};
+
+// Grava quadros da simulação em segundo plano, como o Checkpointer: o loop
+// só entrega uma referência à geração atual (Simulation::share()), sem cópia
+// da grade de bits, e os codificadores desenham e comprimem em paralelo. No
+// APNG e no Y4M os quadros são escritos na ordem em que foram entregues.
+class FrameRecorder {
+public:
+    FrameRecorder() = default;
+    // Fecha, gravando o que estiver na fila
+    ~FrameRecorder();
+
+    FrameRecorder(const FrameRecorder &) = delete;
+    FrameRecorder &operator=(const FrameRecorder &) = delete;
+
+    // Grades de width x height células; cria o arquivo (APNG e Y4M) e
+    // inicia os codificadores
+    bool open(const RecorderOptions &options, int width, int height,
+              std::string *error = nullptr);
+    // Entrega a geração atual se ela é múltipla de `every`
+    bool maybeRecord(const Simulation &sim);
+    // false se o quadro foi descartado
+    bool submit(std::shared_ptr<const Grid> grid, uint64_t generation);
+    // Espera a fila esvaziar e termina o arquivo; false se algo falhou
+    bool close(std::string *error = nullptr);
+
+    bool isOpen() const { return !encoders_.empty(); }
+    RecorderStats stats() const;
+    int frameWidth() const { return frameWidth_; }
+    int frameHeight() const { return frameHeight_; }
+
+private:
+    struct Frame {
+        std::shared_ptr<const Grid> grid;
+        uint64_t generation = 0;
+        uint64_t index = 0; // ordem de gravação
+    };
+
+    void encoderLoop();
+    void render(const Grid &grid, std::vector<uint8_t> &pixels) const;
+    bool encode(const Frame &frame, std::vector<uint8_t> &pixels,
+                std::vector<uint8_t> &data, std::string *error);
+    // data nulo: o quadro falhou, só passa a vez
+    bool writeInOrder(const Frame &frame, const std::vector<uint8_t> *data,
+                      std::string *error);
+    bool finish(std::string *error);
+
+    RecorderOptions options_;
+    RecordFormat format_ = RecordFormat::Y4m;
+    int frameWidth_ = 0;
+    int frameHeight_ = 0;
+    FILE *file_ = nullptr;
+    uint32_t sequence_ = 0; // fcTL e fdAT do APNG
+    uint32_t frames_ = 0;   // gravados no arquivo
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;  // quadro na fila ou parada
+    std::condition_variable space_; // vaga liberada
+    std::condition_variable turn_;  // nextWrite_ andou
+    std::deque<Frame> queue_;
+    int inFlight_ = 0; // na fila ou sendo codificados
+    uint64_t nextIndex_ = 0;
+    uint64_t nextWrite_ = 0;
+    bool stop_ = false;
+    RecorderStats stats_;
+
+    std::vector<std::thread> encoders_;
+};
+
+} // namespace life
@@ -0,0 +1,121 @@
+#include "rule.h"
+
+#include <cctype>
+
+namespace life {
+
+static bool Fail(std::string *error, const std::string &message) {
+    if (error)
+        *error = message;
+    return false;
+}
+
+static Rule MakeRule(uint16_t birth, uint16_t survival) {
+    Rule rule;
+    rule.birth = birth;
+    rule.survival = survival;
+    return rule;
+}
+
+Rule LifeRule() { return MakeRule(1 << 3, 1 << 2 | 1 << 3); }
+
+Rule HighLifeRule() { return MakeRule(1 << 3 | 1 << 6, 1 << 2 | 1 << 3); }
+
+Rule DayAndNightRule() {
+    return MakeRule(1 << 3 | 1 << 6 | 1 << 7 | 1 << 8,
+                    1 << 3 | 1 << 4 | 1 << 6 | 1 << 7 | 1 << 8);
+}
+
+Rule SeedsRule() { return MakeRule(1 << 2, 0); }
+
+namespace {
+
+struct NamedRule {
+    const char *name;   // para ParseRule
+    const char *title;  // para RuleName
+    Rule (*make)();
+};
+
+const NamedRule kNamedRules[] = {
+    {"life", "Life", LifeRule},
+    {"highlife", "HighLife", HighLifeRule},
+    {"daynight", "Day & Night", DayAndNightRule},
+    {"seeds", "Seeds", SeedsRule},
+};
+
+// Lê dígitos 0..8 até o fim ou um separador; cada um liga um bit de mask
+bool ParseCounts(const char *&c, uint16_t &mask, const char *text,
+                 std::string *error) {
+    mask = 0;
+    for (; *c >= '0' && *c <= '9'; c++) {
+        if (*c == '9')
+            return Fail(error, std::string("contagem 9 na regra ") + text);
+        mask |= 1 << (*c - '0');
+    }
+    return true;
+}
+
+} // namespace
+
+bool ParseRule(const char *text, Rule &rule, std::string *error) {
+    std::string lower;
+    for (const char *c = text; *c; c++)
+        lower += (char)tolower((unsigned char)*c);
+    for (const NamedRule &named : kNamedRules) {
+        if (lower == named.name) {
+            rule = named.make();
+            return true;
+        }
+    }
+
+    uint16_t birth = 0, survival = 0;
+    const char *c = lower.c_str();
+    if (*c == 'b') {
+        // B<nascimento>/S<sobrevivência>, com ou sem a barra
+        c++;
+        if (!ParseCounts(c, birth, text, error))
+            return false;
+        if (*c == '/')
+            c++;
+        if (*c != 's')
+            return Fail(error, std::string("regra inválida: ") + text);
+        c++;
+        if (!ParseCounts(c, survival, text, error))
+            return false;
+    } else {
+        // Notação antiga <sobrevivência>/<nascimento>, como "23/3"
+        if (!ParseCounts(c, survival, text, error))
+            return false;
+        if (*c != '/')
+            return Fail(error, std::string("regra inválida: ") + text);
+        c++;
+        if (!ParseCounts(c, birth, text, error))
+            return false;
+    }
+    if (*c)
+        return Fail(error, std::string("regra inválida: ") + text);
+
+    rule = MakeRule(birth, survival);
+    return true;
+}
+
+std::string RuleString(const Rule &rule) {
+    std::string text = "B";
+    for (int c = 0; c <= 8; c++)
+        if (rule.birth >> c & 1)
+            text += (char)('0' + c);
+    text += "/S";
+    for (int c = 0; c <= 8; c++)
+        if (rule.survival >> c & 1)
+            text += (char)('0' + c);
+    return text;
+}
+
+std::string RuleName(const Rule &rule) {
+    for (const NamedRule &named : kNamedRules)
+        if (named.make() == rule)
+            return named.title;
+    return RuleString(rule);
+}
+
+} // namespace life
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace life {
+
+// Regra outer-totalistic: a célula nasce (morta) ou sobrevive (viva) conforme
+// o número de vizinhos vivos, 0..8. O bit c de birth/survival liga o caso de
+// c vizinhos; juntos são a tabela de 2 x 9 bits que o kernel genérico consulta.
+// O padrão é o B3/S23 do game_of_life.fs.
+struct Rule {
+    uint16_t birth = 1 << 3;
+    uint16_t survival = 1 << 2 | 1 << 3;
+
+    bool next(bool alive, int neighbors) const {
+        return ((alive ? survival : birth) >> neighbors) & 1;
+    }
+
+    bool operator==(const Rule &other) const {
+        return birth == other.birth && survival == other.survival;
+    }
+    bool operator!=(const Rule &other) const { return !(*this == other); }
+};
+
+constexpr uint16_t kRuleCountMask = 0x1FF; // contagens 0..8
+
+// Regras conhecidas pelo nome (e com kernel próprio, veja RuleKernel)
+Rule LifeRule();        // B3/S23
+Rule HighLifeRule();    // B36/S23
+Rule DayAndNightRule(); // B3678/S34678
+Rule SeedsRule();       // B2/S
+
+// Aceita "B36/S23" (também "b36s23"), a notação antiga "23/36" (S/B) ou um
+// nome: "life", "highlife", "daynight", "seeds". Em caso de erro devolve
+// false e preenche *error, se não for nulo.
+bool ParseRule(const char *text, Rule &rule, std::string *error = nullptr);
+
+// "B3/S23"
+std::string RuleString(const Rule &rule);
+// "Life", "HighLife", ... ou a própria string B/S
+std::string RuleName(const Rule &rule);
+
+} // namespace life
@@ -0,0 +1,796 @@
+#include "search.h"
+
+#include "bits.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace life {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr char kMagic[8] = {'C', 'W', 'L', 'S', 'R', 'C', 'H', '\0'};
+constexpr uint32_t kVersion = 1;
+// A caixa, as duas colunas de borda e o deslocamento cabem numa palavra
+constexpr int kMaxWidth = 60;
+
+// Campos em little-endian, como no snapshot; os nós vêm em seguida
+struct Header {
+    char magic[8];
+    uint32_t version;
+    int32_t width;
+    int32_t height;
+    int32_t period;
+    int32_t dx;
+    int32_t dy;
+    uint16_t birth;
+    uint16_t survival;
+    uint32_t words; // palavras de estado por nó
+    uint64_t nodes;
+    uint64_t solutions;
+    uint64_t pending; // nós gravados
+};
+static_assert(sizeof(Header) == 64, "layout do cabeçalho mudou");
+
+// Linha que não existe: tudo morto
+const uint64_t kNone[2] = {0, ~0ULL};
+
+bool Fail(std::string *error, const std::string &message) {
+    if (error)
+        *error = message;
+    return false;
+}
+
+Clock::time_point After(Clock::time_point start, double seconds) {
+    return start + std::chrono::duration_cast<Clock::duration>(
+                       std::chrono::duration<double>(seconds));
+}
+
+double Seconds(Clock::time_point start, Clock::time_point end) {
+    return std::chrono::duration<double>(end - start).count();
+}
+
+// Desloca para os bits mais altos com d > 0, para os mais baixos com d < 0
+uint64_t Shift(uint64_t x, int d) { return d >= 0 ? x << d : x >> -d; }
+
+// Soma das 8 máscaras de vizinhos: s[0..3] é o contador de 4 bits de cada
+// coluna
+void Sum8(const uint64_t n[8], uint64_t s[4]) {
+    auto full = [](uint64_t a, uint64_t b, uint64_t c, uint64_t &carry) {
+        uint64_t t = a ^ b;
+        carry = (a & b) | (t & c);
+        return t ^ c;
+    };
+    uint64_t c0;
+    uint64_t c1;
+    uint64_t c2;
+    uint64_t c3;
+    uint64_t c4;
+    uint64_t s0 = full(n[0], n[1], n[2], c0);
+    uint64_t s1 = full(n[3], n[4], n[5], c1);
+    uint64_t s2 = n[6] ^ n[7];
+    c2 = n[6] & n[7];
+    s[0] = full(s0, s1, s2, c3);
+    uint64_t twos = full(c0, c1, c2, c4);
+    s[1] = twos ^ c3;
+    uint64_t c5 = twos & c3;
+    s[2] = c4 ^ c5;
+    s[3] = c4 & c5;
+}
+
+// eq[c]: colunas cujo contador vale c
+void Equal(const uint64_t s[4], uint64_t eq[9]) {
+    for (int c = 0; c <= 8; c++) {
+        uint64_t m = ~0ULL;
+        for (int b = 0; b < 4; b++)
+            m &= (c >> b & 1) ? s[b] : ~s[b];
+        eq[c] = m;
+    }
+}
+
+// Uma subárvore: o estado já propagado e a célula a fixar antes de seguir
+struct Node {
+    std::vector<uint64_t> cells;
+    int32_t cell = -1; // (t * height + y) * width + x; -1 na raiz
+    int32_t alive = 0;
+};
+
+// Restrições (geração, linha) que precisam ser reavaliadas
+struct Scratch {
+    std::vector<uint8_t> dirty;
+    size_t count = 0;
+};
+
+// A linha r da geração t guarda as palavras "viva" e "morta" em
+// cells[at(t, r)] e cells[at(t, r) + 1]. As linhas 0 e height + 1 e os bits
+// 0 e width + 1 são a borda, sempre morta; a célula (x, y) é o bit x + 1 da
+// linha y + 1. A restrição (t, r) liga as linhas r - 1..r + 1 da geração t à
+// linha r da geração t + 1, que na última geração é a geração 0 deslocada.
+class Searcher {
+public:
+    Searcher(const SearchOptions &options,
+             const std::function<void(const SearchSolution &)> &onSolution)
+        : width_(options.width), height_(options.height),
+          period_(options.period), dx_(options.dx), dy_(options.dy),
+          rows_(options.height + 2), rule_(options.rule),
+          maxSolutions_(options.maxSolutions), onSolution_(onSolution),
+          pool_(options.threads) {
+        box_ = ((1ULL << width_) - 1) << 1;
+        frame_ = (1ULL << (width_ + 2)) - 1;
+        threads_ = pool_.threadCount();
+    }
+
+    size_t words() const { return (size_t)period_ * rows_ * 2; }
+    uint64_t nodes() const { return nodes_; }
+    uint64_t solutions() const { return solutions_; }
+    // Achou maxSolutions
+    bool satisfied() const {
+        return maxSolutions_ && solutions_ >= maxSolutions_;
+    }
+
+    void resume(uint64_t nodes, uint64_t solutions) {
+        nodes_ = nodes;
+        solutions_ = solutions;
+    }
+
+    Node root() const;
+    // Explora as subárvores até esgotá-las ou até o prazo; devolve as que
+    // ficaram pendentes
+    std::vector<Node> run(std::vector<Node> frontier,
+                          Clock::time_point deadline);
+
+private:
+    size_t at(int t, int r) const { return ((size_t)t * rows_ + r) * 2; }
+
+    void mark(Scratch &scratch, int t, int r) const;
+    bool set(uint64_t *cells, Scratch &scratch, int t, int r, uint64_t on,
+             uint64_t off) const;
+    void target(const uint64_t *cells, int t, int r, uint64_t &on,
+                uint64_t &off) const;
+    bool setTarget(uint64_t *cells, Scratch &scratch, int t, int r,
+                   uint64_t on, uint64_t off) const;
+    bool evaluate(uint64_t *cells, Scratch &scratch, int t, int r) const;
+    bool propagate(uint64_t *cells, Scratch &scratch) const;
+    bool apply(Node &node, Scratch &scratch) const;
+    bool touchesCorner(const uint64_t *cells) const;
+    int choose(const uint64_t *cells) const;
+    bool accept(const uint64_t *cells) const;
+    void report(const uint64_t *cells);
+
+    void submit(Node node);
+    void explore(Node node);
+
+    int width_;
+    int height_;
+    int period_;
+    int dx_;
+    int dy_;
+    int rows_;
+    Rule rule_;
+    uint64_t maxSolutions_;
+    uint64_t box_ = 0;   // bits das células da caixa
+    uint64_t frame_ = 0; // caixa e bordas: onde as restrições valem
+    const std::function<void(const SearchSolution &)> &onSolution_;
+
+    ThreadPool pool_;
+    int threads_ = 1;
+    std::atomic<bool> stop_{false};
+    std::atomic<int> queued_{0}; // tarefas na fila, ainda não iniciadas
+    std::atomic<uint64_t> nodes_{0};
+    std::atomic<uint64_t> solutions_{0};
+    Clock::time_point deadline_;
+
+    std::mutex mutex_; // leftovers_ e onSolution_
+    std::vector<Node> leftovers_;
+};
+
+Node Searcher::root() const {
+    Node node;
+    node.cells.resize(words());
+    uint64_t *cells = node.cells.data();
+    for (int t = 0; t < period_; t++)
+        for (int r = 0; r < rows_; r++)
+            cells[at(t, r) + 1] = r == 0 || r == rows_ - 1 ? ~0ULL : ~box_;
+
+    // Células da geração 0 que, deslocadas, caem longe demais da caixa para
+    // a última geração produzir
+    for (int r = 1; r <= height_; r++) {
+        if (r + dy_ < 0 || r + dy_ >= rows_)
+            cells[at(0, r) + 1] = ~0ULL;
+        else
+            cells[at(0, r) + 1] |= box_ & ~Shift(frame_, -dx_);
+    }
+    return node;
+}
+
+void Searcher::mark(Scratch &scratch, int t, int r) const {
+    if (r < 0 || r >= rows_)
+        return;
+    uint8_t &dirty = scratch.dirty[(size_t)t * rows_ + r];
+    if (!dirty) {
+        dirty = 1;
+        scratch.count++;
+    }
+}
+
+// Fixa células da linha r da geração t; false em contradição
+bool Searcher::set(uint64_t *cells, Scratch &scratch, int t, int r,
+                   uint64_t on, uint64_t off) const {
+    uint64_t &alive = cells[at(t, r)];
+    uint64_t &dead = cells[at(t, r) + 1];
+    on &= ~alive;
+    off &= ~dead;
+    if (!(on | off))
+        return true;
+    if ((on & (dead | off)) | (off & alive))
+        return false;
+    alive |= on;
+    dead |= off;
+
+    mark(scratch, t, r - 1);
+    mark(scratch, t, r);
+    mark(scratch, t, r + 1);
+    if (t > 0)
+        mark(scratch, t - 1, r);
+    else
+        mark(scratch, period_ - 1, r + dy_);
+    return true;
+}
+
+// Linha r da geração t + 1 vista da geração t
+void Searcher::target(const uint64_t *cells, int t, int r, uint64_t &on,
+                      uint64_t &off) const {
+    if (t + 1 < period_) {
+        on = cells[at(t + 1, r)];
+        off = cells[at(t + 1, r) + 1];
+        return;
+    }
+    int source = r - dy_;
+    if (source < 0 || source >= rows_) {
+        on = kNone[0];
+        off = kNone[1];
+        return;
+    }
+    on = Shift(cells[at(0, source)], dx_);
+    // Os bits que entram pelo deslocamento vêm de fora da caixa
+    off = Shift(cells[at(0, source) + 1], dx_) | ~Shift(~0ULL, dx_);
+}
+
+bool Searcher::setTarget(uint64_t *cells, Scratch &scratch, int t, int r,
+                         uint64_t on, uint64_t off) const {
+    if (t + 1 < period_)
+        return set(cells, scratch, t + 1, r, on, off);
+    int source = r - dy_;
+    if (source < 0 || source >= rows_)
+        return !on;
+    return set(cells, scratch, 0, source, Shift(on, -dx_), Shift(off, -dx_));
+}
+
+// Propaga a restrição (t, r) para as 64 colunas de uma vez. Com os
+// contadores do mínimo (vizinhos sabidamente vivos) e do máximo (não
+// sabidamente mortos), vê para cada coluna quais pares (vizinhos, centro)
+// ainda são possíveis e o que cada um dá na geração seguinte.
+bool Searcher::evaluate(uint64_t *cells, Scratch &scratch, int t,
+                        int r) const {
+    const uint64_t *a = r > 0 ? &cells[at(t, r - 1)] : kNone;
+    const uint64_t *b = &cells[at(t, r)];
+    const uint64_t *c = r + 1 < rows_ ? &cells[at(t, r + 1)] : kNone;
+    uint64_t aUnknown = ~(a[0] | a[1]);
+    uint64_t bUnknown = ~(b[0] | b[1]);
+    uint64_t cUnknown = ~(c[0] | c[1]);
+    uint64_t nextOn;
+    uint64_t nextOff;
+    target(cells, t, r, nextOn, nextOff);
+
+    const uint64_t on[8] = {a[0] << 1, a[0], a[0] >> 1, b[0] << 1,
+                            b[0] >> 1, c[0] << 1, c[0], c[0] >> 1};
+    const uint64_t may[8] = {~a[1] << 1, ~a[1], ~a[1] >> 1, ~b[1] << 1,
+                             ~b[1] >> 1, ~c[1] << 1, ~c[1], ~c[1] >> 1};
+    uint64_t low[4];
+    uint64_t high[4];
+    Sum8(on, low);
+    Sum8(may, high);
+    uint64_t isLow[9];
+    uint64_t isHigh[9];
+    Equal(low, isLow);
+    Equal(high, isHigh);
+
+    // range[c]: colunas onde c vizinhos vivos ainda é possível
+    uint64_t range[9];
+    uint64_t atLeast = 0;
+    for (int n = 0; n <= 8; n++) {
+        atLeast |= isLow[n];
+        range[n] = atLeast;
+    }
+    uint64_t atMost = 0;
+    for (int n = 8; n >= 0; n--) {
+        atMost |= isHigh[n];
+        range[n] &= atMost;
+    }
+
+    uint64_t centerMayBeOff = ~b[0];
+    uint64_t centerMayBeOn = ~b[1];
+    uint64_t canOn = 0;
+    uint64_t canOff = 0;
+    uint64_t fitsOff = 0;  // algum par que bate tem o centro morto
+    uint64_t fitsOn = 0;   // idem, vivo
+    uint64_t notHigh = 0;  // algum par que bate tem menos que o máximo
+    uint64_t notLow = 0;   // idem, mais que o mínimo
+    for (int n = 0; n <= 8; n++) {
+        bool born = (rule_.birth >> n) & 1;
+        bool stays = (rule_.survival >> n) & 1;
+        uint64_t fromOff = range[n] & centerMayBeOff;
+        uint64_t fromOn = range[n] & centerMayBeOn;
+        (born ? canOn : canOff) |= fromOff;
+        (stays ? canOn : canOff) |= fromOn;
+
+        uint64_t fitOff = fromOff & (born ? nextOn : nextOff);
+        uint64_t fitOn = fromOn & (stays ? nextOn : nextOff);
+        fitsOff |= fitOff;
+        fitsOn |= fitOn;
+        notHigh |= (fitOff | fitOn) & ~isHigh[n];
+        notLow |= (fitOff | fitOn) & ~isLow[n];
+    }
+
+    if (frame_ & ((nextOn & ~canOn) | (nextOff & ~canOff)))
+        return false;
+    // Para frente: o que só pode dar um resultado
+    if (!setTarget(cells, scratch, t, r, frame_ & ~canOff,
+                   frame_ & ~canOn))
+        return false;
+
+    // Para trás: se só o máximo (ou o mínimo) de vizinhos bate com a
+    // geração seguinte, os desconhecidos em volta estão todos vivos (mortos)
+    uint64_t known = frame_ & (nextOn | nextOff);
+    uint64_t allOn = known & ~notHigh;
+    uint64_t allOff = known & ~notLow;
+    uint64_t centerOn = known & ~fitsOff;
+    uint64_t centerOff = known & ~fitsOn;
+    uint64_t spreadOn = allOn | allOn << 1 | allOn >> 1;
+    uint64_t spreadOff = allOff | allOff << 1 | allOff >> 1;
+    uint64_t sideOn = allOn << 1 | allOn >> 1;
+    uint64_t sideOff = allOff << 1 | allOff >> 1;
+    if (r > 0 && !set(cells, scratch, t, r - 1, spreadOn & aUnknown,
+                      spreadOff & aUnknown))
+        return false;
+    if (!set(cells, scratch, t, r, (sideOn | centerOn) & bUnknown,
+             (sideOff | centerOff) & bUnknown))
+        return false;
+    return r + 1 >= rows_ || set(cells, scratch, t, r + 1,
+                                 spreadOn & cUnknown, spreadOff & cUnknown);
+}
+
+bool Searcher::propagate(uint64_t *cells, Scratch &scratch) const {
+    while (scratch.count > 0) {
+        for (size_t i = 0; i < scratch.dirty.size(); i++) {
+            if (!scratch.dirty[i])
+                continue;
+            scratch.dirty[i] = 0;
+            scratch.count--;
+            if (!evaluate(cells, scratch, (int)(i / rows_), (int)(i % rows_))) {
+                std::fill(scratch.dirty.begin(), scratch.dirty.end(), 0);
+                scratch.count = 0;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Fixa a célula do nó e propaga; false se a subárvore não tem solução
+bool Searcher::apply(Node &node, Scratch &scratch) const {
+    uint64_t *cells = node.cells.data();
+    if (node.cell < 0) {
+        for (int t = 0; t < period_; t++)
+            for (int r = 0; r < rows_; r++)
+                mark(scratch, t, r);
+    } else {
+        int t = node.cell / (width_ * height_);
+        int r = node.cell / width_ % height_ + 1;
+        uint64_t bit = 1ULL << (node.cell % width_ + 1);
+        if (!set(cells, scratch, t, r, node.alive ? bit : 0,
+                 node.alive ? 0 : bit))
+            return false;
+    }
+    return propagate(cells, scratch) && touchesCorner(cells);
+}
+
+// Um padrão que não toca a primeira linha ou a primeira coluna da caixa em
+// nenhuma fase também é achado transladado para lá
+bool Searcher::touchesCorner(const uint64_t *cells) const {
+    uint64_t top = 0;
+    uint64_t left = 0;
+    for (int t = 0; t < period_; t++) {
+        top |= ~cells[at(t, 1) + 1];
+        for (int r = 1; r <= height_; r++)
+            left |= ~cells[at(t, r) + 1];
+    }
+    return (top & box_) && (left & 2);
+}
+
+// Primeira célula desconhecida, linha a linha e, na mesma linha, geração a
+// geração, como no lifesrc: as linhas de cima de todas as fases se fecham
+// antes de descer, e as contradições aparecem cedo. -1 se não há.
+int Searcher::choose(const uint64_t *cells) const {
+    for (int r = 1; r <= height_; r++) {
+        for (int t = 0; t < period_; t++) {
+            uint64_t unknown =
+                box_ & ~(cells[at(t, r)] | cells[at(t, r) + 1]);
+            if (unknown)
+                return (t * height_ + r - 1) * width_ +
+                       CountTrailingZeros(unknown) - 1;
+        }
+    }
+    return -1;
+}
+
+// Não vazia e sem período menor (no mesmo sentido, para naves)
+bool Searcher::accept(const uint64_t *cells) const {
+    uint64_t population = 0;
+    for (int r = 1; r <= height_; r++)
+        population += Popcount(cells[at(0, r)]);
+    if (population == 0)
+        return false;
+
+    for (int q = 1; q < period_; q++) {
+        if (period_ % q || (dx_ * q) % period_ || (dy_ * q) % period_)
+            continue;
+        int sx = dx_ * q / period_;
+        int sy = dy_ * q / period_;
+        uint64_t phase = 0;
+        bool same = true;
+        for (int r = 0; r < rows_ && same; r++) {
+            int source = r - sy;
+            uint64_t shifted = source >= 0 && source < rows_
+                                   ? Shift(cells[at(0, source)], sx)
+                                   : 0;
+            same = cells[at(q, r)] == shifted;
+            phase += Popcount(cells[at(q, r)]);
+        }
+        if (same && phase == population)
+            return false;
+    }
+    return true;
+}
+
+void Searcher::report(const uint64_t *cells) {
+    int x0 = width_;
+    int x1 = -1;
+    int y0 = height_;
+    int y1 = -1;
+    for (int y = 0; y < height_; y++) {
+        uint64_t row = cells[at(0, y + 1)] >> 1;
+        if (!row)
+            continue;
+        y0 = std::min(y0, y);
+        y1 = y;
+        x0 = std::min(x0, CountTrailingZeros(row));
+        x1 = std::max(x1, HighestBit(row));
+    }
+
+    SearchSolution solution;
+    solution.phase = Grid(x1 - x0 + 1, y1 - y0 + 1);
+    solution.period = period_;
+    solution.dx = dx_;
+    solution.dy = dy_;
+    for (int y = y0; y <= y1; y++)
+        for (int x = x0; x <= x1; x++)
+            if ((cells[at(0, y + 1)] >> (x + 1)) & 1)
+                solution.phase.set(x - x0, y - y0, true);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (satisfied())
+        return;
+    solutions_++;
+    solution.nodes = nodes_;
+    if (onSolution_)
+        onSolution_(solution);
+    if (satisfied())
+        stop_ = true;
+}
+
+void Searcher::submit(Node node) {
+    queued_++;
+    pool_.submit([this, node = std::move(node)]() mutable {
+        explore(std::move(node));
+    });
+}
+
+// Busca em profundidade com pilha própria: segue o ramo "morta" no mesmo
+// estado e empilha uma cópia com "viva". Se há menos tarefas na fila do que
+// workers, o nó mais raso da pilha (a maior subárvore) vira uma tarefa, que
+// os workers ociosos roubam.
+void Searcher::explore(Node node) {
+    queued_--;
+    std::vector<Node> stack;
+    stack.push_back(std::move(node));
+    Scratch scratch;
+    scratch.dirty.assign((size_t)period_ * rows_, 0);
+
+    uint64_t visited = 0;
+    while (!stack.empty() && !stop_) {
+        Node current = std::move(stack.back());
+        stack.pop_back();
+        for (;;) {
+            if (++visited % 1024 == 0) {
+                nodes_ += 1024;
+                if (Clock::now() >= deadline_)
+                    stop_ = true;
+            }
+            if (!apply(current, scratch))
+                break;
+            int cell = choose(current.cells.data());
+            if (cell < 0) {
+                if (accept(current.cells.data())) {
+                    // A solução leva a contagem global: os nós deste worker
+                    // ainda fora de nodes_ entram antes
+                    nodes_ += visited % 1024;
+                    visited -= visited % 1024;
+                    report(current.cells.data());
+                }
+                break;
+            }
+
+            Node alive;
+            alive.cells = current.cells;
+            alive.cell = cell;
+            alive.alive = 1;
+            stack.push_back(std::move(alive));
+            current.cell = cell;
+            current.alive = 0;
+
+            if (threads_ > 1 && queued_ < threads_) {
+                submit(std::move(stack.front()));
+                stack.erase(stack.begin());
+            }
+            if (stop_) {
+                stack.push_back(std::move(current));
+                break;
+            }
+        }
+    }
+    nodes_ += visited % 1024;
+
+    if (stack.empty())
+        return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (Node &pending : stack)
+        leftovers_.push_back(std::move(pending));
+}
+
+std::vector<Node> Searcher::run(std::vector<Node> frontier,
+                                Clock::time_point deadline) {
+    deadline_ = deadline;
+    stop_ = satisfied();
+    for (Node &node : frontier)
+        submit(std::move(node));
+    pool_.wait();
+
+    std::vector<Node> pending;
+    pending.swap(leftovers_);
+    return pending;
+}
+
+// Abre uma busca gravada com o arquivo posicionado depois do cabeçalho
+FILE *OpenSaved(const char *path, Header &header, std::string *error) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        Fail(error, std::string("não foi possível abrir ") + path);
+        return nullptr;
+    }
+    if (fread(&header, sizeof(header), 1, file) != 1 ||
+        memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+        fclose(file);
+        Fail(error, std::string(path) + " não é uma busca gravada");
+        return nullptr;
+    }
+    if (header.version != kVersion) {
+        fclose(file);
+        Fail(error, std::string("versão de busca não suportada em ") + path);
+        return nullptr;
+    }
+    return file;
+}
+
+bool LoadFrontier(const SearchOptions &options, size_t words,
+                  std::vector<Node> &frontier, Header &header,
+                  std::string *error) {
+    const char *path = options.resumePath.c_str();
+    FILE *file = OpenSaved(path, header, error);
+    if (!file)
+        return false;
+    if (header.width != options.width || header.height != options.height ||
+        header.period != options.period || header.dx != options.dx ||
+        header.dy != options.dy || header.birth != options.rule.birth ||
+        header.survival != options.rule.survival || header.words != words) {
+        fclose(file);
+        return Fail(error, std::string("a busca gravada em ") + path +
+                               " tem outra caixa, período ou regra");
+    }
+
+    bool ok = true;
+    frontier.resize(header.pending);
+    for (Node &node : frontier) {
+        node.cells.resize(words);
+        ok = ok && fread(&node.cell, sizeof(node.cell), 1, file) == 1 &&
+             fread(&node.alive, sizeof(node.alive), 1, file) == 1 &&
+             fread(node.cells.data(), sizeof(uint64_t), words, file) == words;
+    }
+    fclose(file);
+    return ok ? true : Fail(error, std::string(path) + " está truncado");
+}
+
+// Grava num .tmp sincronizado e renomeia, como os checkpoints
+bool SaveFrontier(const SearchOptions &options, size_t words,
+                  const std::vector<Node> &frontier, uint64_t nodes,
+                  uint64_t solutions, std::string *error) {
+    std::string temporary = options.savePath + ".tmp";
+    FILE *file = fopen(temporary.c_str(), "wb");
+    if (!file)
+        return Fail(error, "não foi possível criar " + temporary);
+
+    Header header = {};
+    memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.width = options.width;
+    header.height = options.height;
+    header.period = options.period;
+    header.dx = options.dx;
+    header.dy = options.dy;
+    header.birth = options.rule.birth;
+    header.survival = options.rule.survival;
+    header.words = (uint32_t)words;
+    header.nodes = nodes;
+    header.solutions = solutions;
+    header.pending = frontier.size();
+
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    for (const Node &node : frontier)
+        ok = ok && fwrite(&node.cell, sizeof(node.cell), 1, file) == 1 &&
+             fwrite(&node.alive, sizeof(node.alive), 1, file) == 1 &&
+             fwrite(node.cells.data(), sizeof(uint64_t), words, file) ==
+                 words;
+    ok = ok && fflush(file) == 0;
+#if defined(_WIN32)
+    ok = ok && _commit(_fileno(file)) == 0;
+#else
+    ok = ok && fsync(fileno(file)) == 0;
+#endif
+    ok = fclose(file) == 0 && ok;
+
+    std::error_code ec;
+    if (!ok) {
+        fs::remove(temporary, ec);
+        return Fail(error, "erro ao gravar " + temporary);
+    }
+    fs::rename(temporary, options.savePath, ec);
+    if (ec) {
+        fs::remove(temporary, ec);
+        return Fail(error, "não foi possível renomear para " +
+                               options.savePath);
+    }
+    return true;
+}
+
+} // namespace
+
+bool CheckSearchOptions(const SearchOptions &options, std::string *error) {
+    if (options.width < 1 || options.height < 1)
+        return Fail(error, "caixa inválida");
+    if (options.width + std::abs(options.dx) > kMaxWidth)
+        return Fail(error, "largura mais deslocamento passa de " +
+                               std::to_string(kMaxWidth));
+    if (options.period < 1)
+        return Fail(error, "período inválido");
+    // Uma célula só influencia as vizinhas a cada geração
+    if (std::abs(options.dx) > options.period ||
+        std::abs(options.dy) > options.period)
+        return Fail(error, "deslocamento acima da velocidade da luz");
+    if (options.rule.birth & 1)
+        return Fail(error, "regras com B0 não são suportadas");
+    return true;
+}
+
+bool LoadSearchOptions(const char *path, SearchOptions &options,
+                       std::string *error) {
+    Header header;
+    FILE *file = OpenSaved(path, header, error);
+    if (!file)
+        return false;
+    fclose(file);
+    options.width = header.width;
+    options.height = header.height;
+    options.period = header.period;
+    options.dx = header.dx;
+    options.dy = header.dy;
+    options.rule.birth = header.birth;
+    options.rule.survival = header.survival;
+    return true;
+}
+
+bool RunSearch(const SearchOptions &options,
+               const std::function<void(const SearchSolution &)> &onSolution,
+               const std::function<void(const SearchProgress &)> &onProgress,
+               SearchProgress *result, std::string *error) {
+    if (!CheckSearchOptions(options, error))
+        return false;
+
+    Searcher searcher(options, onSolution);
+    std::vector<Node> frontier;
+    if (!options.resumePath.empty()) {
+        Header header;
+        if (!LoadFrontier(options, searcher.words(), frontier, header, error))
+            return false;
+        searcher.resume(header.nodes, header.solutions);
+    } else {
+        frontier.push_back(searcher.root());
+    }
+
+    uint64_t startNodes = searcher.nodes();
+    Clock::time_point start = Clock::now();
+    Clock::time_point end = options.seconds > 0.0
+                                ? After(start, options.seconds)
+                                : Clock::time_point::max();
+    bool saving = !options.savePath.empty();
+    Clock::time_point nextSave = After(start, options.saveEvery);
+
+    SearchProgress progress;
+    for (;;) {
+        Clock::time_point now = Clock::now();
+        Clock::time_point deadline = end;
+        if (options.progressEvery > 0.0)
+            deadline = std::min(deadline, After(now, options.progressEvery));
+        if (saving && options.saveEvery > 0.0)
+            deadline = std::min(deadline, nextSave);
+
+        frontier = searcher.run(std::move(frontier), deadline);
+
+        now = Clock::now();
+        progress.nodes = searcher.nodes();
+        progress.solutions = searcher.solutions();
+        progress.pending = frontier.size();
+        progress.seconds = Seconds(start, now);
+        progress.nodesPerSecond =
+            progress.seconds > 0.0
+                ? (progress.nodes - startNodes) / progress.seconds
+                : 0.0;
+        progress.complete = frontier.empty();
+
+        bool done = frontier.empty() || now >= end || searcher.satisfied();
+        if (saving && (done || (options.saveEvery > 0.0 && now >= nextSave))) {
+            if (!SaveFrontier(options, searcher.words(), frontier,
+                              progress.nodes, progress.solutions, error))
+                return false;
+            nextSave = After(now, options.saveEvery);
+        }
+        if (done)
+            break;
+        if (onProgress)
+            onProgress(progress);
+    }
+
+    if (result)
+        *result = progress;
+    return true;
+}
+
+} // namespace life
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "grid.h"
+#include "rule.h"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace life {
+
+// Busca de osciladores e naves no estilo do lifesrc: as células de cada uma
+// das `period` gerações, dentro de uma caixa width x height, são variáveis
+// de três estados (viva, morta, desconhecida), e a geração period é a
+// geração 0 deslocada de (dx, dy). Fora da caixa tudo está morto.
+//
+// Cada linha de cada geração são duas palavras, "sabidamente viva" e
+// "sabidamente morta", então a regra é propagada para as 64 células de uma
+// linha de uma vez: contadores bit a bit dão o mínimo e o máximo de vizinhos
+// vivos, que decidem a linha seguinte (para frente) e forçam o centro e os
+// vizinhos desconhecidos (para trás). A busca escolhe uma célula da geração
+// 0, tenta morta e viva, propaga até o ponto fixo e volta ao achar
+// contradição.
+//
+// As subárvores são tarefas do ThreadPool, que já rouba trabalho entre os
+// workers; quem fica sem tarefas na fila recebe o ramo mais raso da pilha de
+// quem está ocupado. A busca para em intervalos para relatar o progresso e
+// gravar as subárvores pendentes, de onde pode ser retomada.
+struct SearchOptions {
+    int width = 16; // caixa que contém todas as fases
+    int height = 16;
+    int period = 2;
+    // Deslocamento por período: (0, 0) procura osciladores (still lifes com
+    // period 1), qualquer outro, naves
+    int dx = 0;
+    int dy = 0;
+    Rule rule;
+    int threads = 0;           // 0 usa todos os núcleos
+    uint64_t maxSolutions = 1; // 0 = todas
+    double seconds = 0.0;      // limite de tempo, 0 = sem limite
+    double progressEvery = 10.0;
+    // Arquivo com as subárvores pendentes, gravado a cada saveEvery segundos
+    // e ao parar; vazio não grava
+    std::string savePath;
+    double saveEvery = 60.0;
+    // Retoma uma busca gravada; a caixa, o período, o deslocamento e a regra
+    // precisam ser os do arquivo (veja LoadSearchOptions)
+    std::string resumePath;
+};
+
+struct SearchSolution {
+    Grid phase; // geração 0, cortada ao retângulo das células vivas
+    int period = 0;
+    int dx = 0;
+    int dy = 0;
+    uint64_t nodes = 0; // nós visitados até aqui
+};
+
+struct SearchProgress {
+    uint64_t nodes = 0;     // desde o começo da busca, inclusive retomadas
+    uint64_t solutions = 0; // idem
+    uint64_t pending = 0;   // subárvores que faltam
+    double seconds = 0.0;   // desta execução
+    double nodesPerSecond = 0.0;
+    bool complete = false; // o espaço inteiro foi visto
+};
+
+bool CheckSearchOptions(const SearchOptions &options,
+                        std::string *error = nullptr);
+
+// Preenche a caixa, o período, o deslocamento e a regra com os de uma busca
+// gravada
+bool LoadSearchOptions(const char *path, SearchOptions &options,
+                       std::string *error = nullptr);
+
+// Roda até esgotar o espaço, achar maxSolutions soluções ou passar o tempo.
+// onSolution é chamada das threads da busca, uma de cada vez; onProgress, da
+// thread que chamou, a cada progressEvery segundos. Soluções que diferem só
+// pela fase (ou por simetria) aparecem separadas; translações não.
+bool RunSearch(const SearchOptions &options,
+               const std::function<void(const SearchSolution &)> &onSolution,
+               const std::function<void(const SearchProgress &)> &onProgress,
+               SearchProgress *result = nullptr,
+               std::string *error = nullptr);
+
+} // namespace life
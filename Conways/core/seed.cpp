@@ -0,0 +1,351 @@
+#include "seed.h"
+
+#include "profiler.h"
+#include "seed_impl.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace life {
+
+namespace {
+
+constexpr int kBlockSize = 5; // blocos de 5x5 como no shader
+constexpr int kHotspots = 8;
+constexpr int kOctaves = 4;
+// Oitava 0 com uma célula de ruído a cada 128 px (0,01 px^-1 no shader); as
+// potências de 2 deixam o ruído inteiro só com shifts
+constexpr int kLatticeShift = 7;
+
+// Fluxos independentes de números por finalidade
+enum Stream : uint32_t {
+    kRandomCells,
+    kBlockCells,
+    kNoiseCells,
+    kHotspotCells,
+    kBlocks,
+    kHotspotParams,
+    kLattice, // + oitava
+};
+
+uint64_t SplitMix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+// Chave de uma linha (ou de um índice qualquer) dentro de um fluxo
+uint64_t RowKey(uint64_t seed, uint32_t stream, uint32_t index) {
+    return SplitMix64(seed ^ SplitMix64((uint64_t)stream << 32 | index));
+}
+
+// Probabilidade em [0, 1] para o limiar de 31 bits dos kernels
+int32_t Threshold(double p) {
+    if (p <= 0.0)
+        return 0;
+    return (int32_t)std::min(p * 2147483648.0, (double)INT32_MAX);
+}
+
+double Unit(uint32_t hash) { return hash / 2147483648.0; }
+
+struct Hotspot {
+    double x, y, radius;
+};
+
+// Ruído de valor em ponto fixo: rede em Q14 ([-1, 1) em int16) e curva de
+// interpolação em Q15. Tudo cabe em 16 bits, o que deixa o compilador
+// vetorizar os laços por célula com 8 lanes.
+int32_t LatticeValue(uint64_t key, uint32_t x) {
+    return (int32_t)(CellHash(key, x) >> 16) - 16384;
+}
+
+// 3f^2 - 2f^3
+int16_t Smooth(int64_t f) {
+    return (int16_t)((f * f >> 15) * (3 * 32768 - 2 * f) >> 15);
+}
+
+int32_t Lerp(int32_t a, int32_t b, int32_t u) {
+    return a + ((b - a) * u >> 15);
+}
+
+// Soma uma oitava (amplitude 2^-(octave + 1)) na linha de ruído. column tem
+// os pontos da rede já interpolados na vertical; o tamanho da célula da rede
+// é constante para o laço interno ter um número fixo de iterações.
+template <int kShift>
+void AddOctave(int16_t *noise, const int32_t *column, const int16_t *smooth,
+               int width, int octave) {
+    constexpr int kSize = 1 << kShift;
+    // Cópia local: sem ela o compilador teme que noise e smooth se sobreponham
+    int16_t curve[kSize];
+    std::copy(smooth, smooth + kSize, curve);
+    for (int ix = 0; ix * kSize < width; ix++) {
+        int16_t a = (int16_t)column[ix];
+        int16_t d = (int16_t)(column[ix + 1] - a);
+        int16_t *out = noise + ix * kSize;
+        for (int f = 0; f < kSize; f++) {
+            // Só a metade alta do produto (pmulhw)
+            int16_t step = (int16_t)(d * curve[f] >> 16);
+            out[f] += (int16_t)((int16_t)(a + 2 * step) >> (octave + 1));
+        }
+    }
+}
+
+// Preenche threshold com o limiar de cada célula da linha y e devolve o
+// fluxo das células; o estado guardado entre linhas de uma faixa só evita
+// recalcular o que se repete (linha de blocos, linhas da rede de ruído)
+class RowSeeder {
+public:
+    RowSeeder(const Grid &grid, const SeedOptions &options,
+              const Hotspot *hotspots)
+        : options_(options), hotspots_(hotspots), width_(grid.width()),
+          threshold_((size_t)grid.words() * 64, 0),
+          base_(Threshold(options.density)) {
+        if (options.pattern == SeedPattern::Random)
+            std::fill(threshold_.begin(), threshold_.begin() + width_, base_);
+        if (options.pattern == SeedPattern::Noise) {
+            // Folga de uma célula da rede: o laço por célula vai até o fim dela
+            noise_.resize((size_t)width_ + (1 << kLatticeShift));
+            for (int o = 0; o < kOctaves; o++) {
+                int shift = kLatticeShift - o;
+                smooth_[o].resize((size_t)1 << shift);
+                for (int f = 0; f < (1 << shift); f++)
+                    smooth_[o][f] = Smooth((int64_t)f << (15 - shift));
+                for (auto &row : lattice_[o])
+                    row.resize((size_t)(width_ >> shift) + 2);
+                column_.resize(lattice_[o][0].size());
+                lastLatticeRow_[o] = UINT32_MAX;
+            }
+        }
+    }
+
+    const int32_t *threshold() const { return threshold_.data(); }
+
+    uint32_t prepare(int y) {
+        switch (options_.pattern) {
+        case SeedPattern::Random:
+            return kRandomCells;
+        case SeedPattern::Blocks:
+            prepareBlocks(y);
+            return kBlockCells;
+        case SeedPattern::Noise:
+            prepareNoise(y);
+            return kNoiseCells;
+        case SeedPattern::Hotspots:
+            prepareHotspots(y);
+            return kHotspotCells;
+        }
+        return kRandomCells;
+    }
+
+private:
+    // Bloco vivo com probabilidade density; dentro dele, células com 0,6
+    void prepareBlocks(int y) {
+        int by = y / kBlockSize;
+        if (by == lastBlockRow_)
+            return;
+        lastBlockRow_ = by;
+        uint64_t key = RowKey(options_.seed, kBlocks, (uint32_t)by);
+        int32_t alive = Threshold(0.6);
+        for (int x = 0; x < width_; x += kBlockSize) {
+            int32_t t = (int32_t)CellHash(key, (uint32_t)(x / kBlockSize)) <
+                                base_
+                            ? alive
+                            : 0;
+            std::fill(threshold_.begin() + x,
+                      threshold_.begin() + std::min(width_, x + kBlockSize), t);
+        }
+    }
+
+    // fbm de 4 oitavas misturado 70/30 com o sorteio da célula:
+    // 0,7 * ruído + 0,3 * r < density  <=>  r < (density - 0,7 * ruído) / 0,3
+    void prepareNoise(int y) {
+        std::fill(noise_.begin(), noise_.end(), 0);
+        for (int o = 0; o < kOctaves; o++) {
+            int shift = kLatticeShift - o;
+            int size = 1 << shift;
+            uint32_t iy = (uint32_t)y >> shift;
+            if (iy != lastLatticeRow_[o]) {
+                lastLatticeRow_[o] = iy;
+                for (int r = 0; r < 2; r++) {
+                    uint64_t key = RowKey(options_.seed, kLattice + o, iy + r);
+                    auto &row = lattice_[o][r];
+                    for (size_t ix = 0; ix < row.size(); ix++)
+                        row[ix] = LatticeValue(key, (uint32_t)ix);
+                }
+            }
+
+            // Interpola na vertical nos pontos da rede e depois, célula a
+            // célula, na horizontal
+            const int32_t *top = lattice_[o][0].data();
+            const int32_t *bottom = lattice_[o][1].data();
+            const int16_t *smooth = smooth_[o].data();
+            int32_t uy = smooth[y & (size - 1)];
+            for (size_t ix = 0; ix < lattice_[o][0].size(); ix++)
+                column_[ix] = Lerp(top[ix], bottom[ix], uy);
+            switch (shift) {
+            case 7:
+                AddOctave<7>(noise_.data(), column_.data(), smooth, width_, o);
+                break;
+            case 6:
+                AddOctave<6>(noise_.data(), column_.data(), smooth, width_, o);
+                break;
+            case 5:
+                AddOctave<5>(noise_.data(), column_.data(), smooth, width_, o);
+                break;
+            default:
+                AddOctave<4>(noise_.data(), column_.data(), smooth, width_, o);
+                break;
+            }
+        }
+
+        // Limiar de 31 bits = (10 * density - 7 * ruído) / 3 em Q14,
+        // saturado antes de escalar para caber em 32 bits. Em blocos de 64
+        // células para o laço ser vetorizado.
+        int32_t density = (int32_t)(options_.density * 16384.0);
+        for (int x0 = 0; x0 < width_; x0 += 64) {
+            const int16_t *noise = noise_.data() + x0;
+            int32_t *threshold = threshold_.data() + x0;
+            for (int x = 0; x < 64; x++) {
+                int32_t value = noise[x] / 2 + 8192; // fbm * 0,5 + 0,5
+                int32_t r = std::clamp(10 * density - 7 * value, 0, 49151);
+                threshold[x] = r * 43690; // 2^31 / (3 * 2^14)
+            }
+        }
+        // As células além de width continuam mortas
+        std::fill(threshold_.begin() + width_, threshold_.end(), 0);
+    }
+
+    // Densidade base 0,3 * density, mais 1,5 * density * (1 - d/r)^2 dentro
+    // de cada hotspot
+    void prepareHotspots(int y) {
+        double low = options_.density * 0.3;
+        if (!hotspotsClean_) {
+            std::fill(threshold_.begin(), threshold_.begin() + width_,
+                      Threshold(low));
+            hotspotsClean_ = true;
+        }
+
+        double py = y + 0.5;
+        double x0 = width_;
+        double x1 = 0.0;
+        for (int i = 0; i < kHotspots; i++) {
+            if (std::fabs(py - hotspots_[i].y) < hotspots_[i].radius) {
+                x0 = std::min(x0, hotspots_[i].x - hotspots_[i].radius);
+                x1 = std::max(x1, hotspots_[i].x + hotspots_[i].radius);
+            }
+        }
+        if (x0 >= x1)
+            return;
+
+        hotspotsClean_ = false;
+        int begin = std::max(0, (int)std::floor(x0));
+        int end = std::min(width_, (int)std::ceil(x1) + 1);
+        for (int x = begin; x < end; x++) {
+            double density = low;
+            for (int i = 0; i < kHotspots; i++) {
+                const Hotspot &h = hotspots_[i];
+                double dx = x + 0.5 - h.x;
+                double dy = py - h.y;
+                double distance = std::sqrt(dx * dx + dy * dy);
+                if (distance < h.radius) {
+                    double influence = 1.0 - distance / h.radius;
+                    density += options_.density * 1.5 * influence * influence;
+                }
+            }
+            threshold_[x] = Threshold(density);
+        }
+    }
+
+    const SeedOptions &options_;
+    const Hotspot *hotspots_;
+    int width_;
+    // Limiar por célula; as entradas além de width ficam em 0 (mortas)
+    std::vector<int32_t> threshold_;
+    int32_t base_;
+
+    int lastBlockRow_ = -1;
+
+    std::vector<int16_t> noise_;
+    std::vector<int32_t> column_;
+    std::vector<int16_t> smooth_[kOctaves];
+    std::vector<int32_t> lattice_[kOctaves][2];
+    uint32_t lastLatticeRow_[kOctaves];
+
+    bool hotspotsClean_ = false;
+};
+
+} // namespace
+
+const char *SeedPatternName(SeedPattern pattern) {
+    switch (pattern) {
+    case SeedPattern::Random:
+        return "random";
+    case SeedPattern::Blocks:
+        return "blocks";
+    case SeedPattern::Noise:
+        return "noise";
+    case SeedPattern::Hotspots:
+        return "hotspots";
+    }
+    return "?";
+}
+
+bool ParseSeedPattern(const char *text, SeedPattern &pattern) {
+    const SeedPattern patterns[] = {SeedPattern::Random, SeedPattern::Blocks,
+                                    SeedPattern::Noise, SeedPattern::Hotspots};
+    for (int i = 0; i < 4; i++) {
+        if (!strcmp(text, SeedPatternName(patterns[i])) ||
+            atoi(text) == i + 1) {
+            pattern = patterns[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t RandomSeed() {
+    std::random_device device;
+    return (uint64_t)device() << 32 | device();
+}
+
+void SeedGrid(Grid &grid, const SeedOptions &options, ThreadPool *pool) {
+    SeedStrip(grid, options, 0, grid.height(), pool);
+}
+
+void SeedStrip(Grid &grid, const SeedOptions &options, int y0,
+               int fullHeight, ThreadPool *pool) {
+    ProfileScope scope(ProfileZone::Seed);
+    SeedKernel kernel = GetSeedKernel(options.isa);
+    if (!kernel)
+        kernel = SeedRowScalar;
+
+    Hotspot hotspots[kHotspots];
+    for (int i = 0; i < kHotspots; i++) {
+        uint64_t key = RowKey(options.seed, kHotspotParams, (uint32_t)i);
+        hotspots[i].x = Unit(CellHash(key, 0)) * grid.width();
+        hotspots[i].y = Unit(CellHash(key, 1)) * fullHeight;
+        hotspots[i].radius = 30.0 + Unit(CellHash(key, 2)) * 50.0;
+    }
+
+    auto body = [&](int begin, int end) {
+        RowSeeder seeder(grid, options, hotspots);
+        for (int y = begin; y < end; y++) {
+            uint32_t row = (uint32_t)(y0 + y);
+            uint32_t stream = seeder.prepare(y0 + y);
+            kernel(RowKey(options.seed, stream, row), 0, seeder.threshold(),
+                   grid.row(y), grid.words());
+        }
+    };
+    if (pool)
+        pool->parallelFor(0, grid.height(), 64, body);
+    else
+        body(0, grid.height());
+}
+
+} // namespace life
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "grid.h"
+#include "kernel.h"
+#include "thread_pool.h"
+
+#include <cstdint>
+
+namespace life {
+
+// Os quatro padrões do generation.fs (teclas 1-4 da janela)
+enum class SeedPattern { Random, Blocks, Noise, Hotspots };
+
+const char *SeedPatternName(SeedPattern pattern);
+// Aceita o nome ("random", "blocks", "noise", "hotspots") ou o número 1-4
+bool ParseSeedPattern(const char *text, SeedPattern &pattern);
+
+struct SeedOptions {
+    uint64_t seed = 0;
+    float density = 0.25f;
+    SeedPattern pattern = SeedPattern::Random;
+    KernelIsa isa = DetectKernelIsa();
+};
+
+// Semente nova do std::random_device, para imprimir e repetir depois
+uint64_t RandomSeed();
+
+// Sopa inicial reproduzível na CPU. Cada célula é um hash de contador de
+// (semente, linha, coluna), sem estado, então a grade só depende da semente,
+// do tamanho e da densidade: não muda com a máquina, a ISA ou o número de
+// threads. O ruído fbm usa aritmética inteira e os hotspots só operações
+// IEEE exatas, pelo mesmo motivo. Sobrescreve todas as células.
+void SeedGrid(Grid &grid, const SeedOptions &options,
+              ThreadPool *pool = nullptr);
+// As linhas [y0, y0 + grid.height()) da sopa de uma grade com fullHeight
+// linhas e a largura de grid, idênticas às do SeedGrid da grade inteira
+void SeedStrip(Grid &grid, const SeedOptions &options, int y0, int fullHeight,
+               ThreadPool *pool = nullptr);
+
+} // namespace life
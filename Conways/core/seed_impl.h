@@ -0,0 +1,68 @@
+#pragma once
+
+// Implementação genérica do sorteio de células (seed.cpp), incluída pelos
+// kernel_*.cpp junto com o kernel_impl.h e pelo próprio seed.cpp, que usa o
+// hash escalar. Mesmo cuidado do kernel_impl.h: tudo fica num namespace
+// anônimo para cada ISA ter a sua cópia.
+
+#include <cstdint>
+
+namespace life {
+namespace {
+
+// Operações em lanes de 32 bits; a versão escalar tem uma lane só
+struct ScalarLanes {
+    using T = uint32_t;
+    static constexpr int kLanes = 1;
+
+    static T Iota() { return 0; }
+    static T Set1(uint32_t v) { return v; }
+    static T Load(const int32_t *p) { return (uint32_t)*p; }
+    static T Add(T a, T b) { return a + b; }
+    static T Xor(T a, T b) { return a ^ b; }
+    static T Mul(T a, T b) { return a * b; }
+    template <int N> static T Shr(T a) { return a >> N; }
+    // Bit i ligado se a < b na lane i (com sinal)
+    static uint64_t Less(T a, T b) { return (int32_t)a < (int32_t)b; }
+};
+
+// lowbias32 (Chris Wellons): bijeção de 32 bits com boa avalanche
+template <class V> inline typename V::T Mix32(typename V::T x) {
+    x = V::Xor(x, V::template Shr<16>(x));
+    x = V::Mul(x, V::Set1(0x7feb352du));
+    x = V::Xor(x, V::template Shr<15>(x));
+    x = V::Mul(x, V::Set1(0x846ca68bu));
+    return V::Xor(x, V::template Shr<16>(x));
+}
+
+// Hash de contador: o valor da coluna x só depende da chave da linha, então
+// qualquer ISA e qualquer divisão em threads sorteia as mesmas células.
+// Devolve 31 bits, comparados com limiares em [0, 2^31).
+template <class V>
+inline typename V::T CellHash(typename V::T x, uint64_t key) {
+    x = Mix32<V>(V::Xor(x, V::Set1((uint32_t)key)));
+    x = Mix32<V>(V::Add(x, V::Set1((uint32_t)(key >> 32))));
+    return V::template Shr<1>(x);
+}
+
+inline uint32_t CellHash(uint64_t key, uint32_t x) {
+    return CellHash<ScalarLanes>(x, key);
+}
+
+// Célula x0 + j viva se CellHash(key, x0 + j) < threshold[j]
+template <class V>
+inline void SeedRowVec(uint64_t key, uint32_t x0, const int32_t *threshold,
+                       uint64_t *out, int words) {
+    for (int i = 0; i < words; i++) {
+        uint64_t bits = 0;
+        for (int b = 0; b < 64; b += V::kLanes) {
+            uint32_t x = x0 + (uint32_t)(i * 64 + b);
+            typename V::T h = CellHash<V>(V::Add(V::Set1(x), V::Iota()), key);
+            bits |= V::Less(h, V::Load(threshold + i * 64 + b)) << b;
+        }
+        out[i] = bits;
+    }
+}
+
+} // namespace
+} // namespace life
@@ -0,0 +1,176 @@
+#include "sim_thread.h"
+
+#include "profiler.h"
+
+#include <chrono>
+#include <utility>
+
+namespace life {
+
+namespace {
+
+// Edições aplicadas de uma vez antes de voltar a passar: uma enxurrada delas
+// não segura a simulação
+constexpr int kMaxEditBatch = 65536;
+
+} // namespace
+
+SimThread::SimThread(Grid initial, const Rule &rule, int threads)
+    : sim_(std::move(initial)) {
+    sim_.setRule(rule);
+    sim_.setThreadCount(threads);
+    sim_.setActivityTracking(true);
+    snapshots_.front().grid = sim_.share();
+    thread_ = std::thread([this] { run(); });
+}
+
+SimThread::~SimThread() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_one();
+    thread_.join();
+}
+
+void SimThread::setRunning(bool running) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (running_ == running)
+            return;
+        running_ = running;
+    }
+    wake_.notify_one();
+}
+
+void SimThread::setTargetRate(double rate) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (rate_ == rate)
+            return;
+        rate_ = rate;
+    }
+    wake_.notify_one();
+}
+
+void SimThread::edit(std::function<void(Simulation &)> change) {
+    Edit edit;
+    edit.change = std::move(change);
+    push(std::move(edit));
+}
+
+void SimThread::editCells(CellEdit cells) {
+    Edit edit;
+    edit.cells = std::move(cells);
+    push(std::move(edit));
+}
+
+void SimThread::push(Edit edit) {
+    edits_.push(std::move(edit));
+    // Quem dorme marca sleeping_ antes de olhar a fila; as duas ordens são
+    // seq_cst, então ou ela vê a edição ou a gente vê que ela dorme. O
+    // mutex garante que ela já está no wait quando o notify chega.
+    if (sleeping_.load(std::memory_order_seq_cst)) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        wake_.notify_one();
+    }
+}
+
+bool SimThread::applyEdits() {
+    Edit edit;
+    Grid *grid = nullptr; // um grid() (e uma cópia, no máximo) por lote
+    uint64_t cells = 0;
+    int count = 0;
+    for (; count < kMaxEditBatch && edits_.pop(edit); count++) {
+        if (edit.change) {
+            edit.change(sim_);
+            grid = nullptr;
+        } else {
+            if (!grid)
+                grid = &sim_.grid();
+            ApplyCellEdit(*grid, edit.cells);
+            cells++;
+        }
+    }
+    if (cells)
+        cellEdits_.fetch_add(cells, std::memory_order_relaxed);
+    return count > 0;
+}
+
+void SimThread::publish() {
+    SimSnapshot &back = snapshots_.back();
+    back.grid = sim_.share();
+    back.generation = sim_.generation();
+    const CycleDetector &cycles = sim_.cycles();
+    back.period = cycles.found() ? cycles.period() : 0;
+    back.cycleStart = cycles.found() ? cycles.start() : 0;
+    snapshots_.publish();
+}
+
+void SimThread::run() {
+    SetProfileThreadName("sim");
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point due = Clock::now();
+    bool pending = false; // há geração calculada e ainda não publicada
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_) {
+        bool edits = !edits_.empty();
+        if (!running_ && !edits) {
+            // Parada: entrega a última geração antes de dormir
+            if (pending) {
+                lock.unlock();
+                publish();
+                pending = false;
+                lock.lock();
+                continue;
+            }
+            sleeping_.store(true, std::memory_order_seq_cst);
+            wake_.wait(lock, [&] {
+                return stop_ || running_ || !edits_.empty();
+            });
+            sleeping_.store(false, std::memory_order_relaxed);
+            due = Clock::now();
+            continue;
+        }
+        bool step = running_;
+        if (running_ && rate_ > 0.0) {
+            // Ritmo alvo: espera a vez do próximo passo, mas acorda para
+            // edições e paradas. Edições antes da vez não adiantam o passo.
+            Clock::time_point now = Clock::now();
+            if (now < due) {
+                if (!edits) {
+                    sleeping_.store(true, std::memory_order_seq_cst);
+                    wake_.wait_until(lock, due, [&] {
+                        return stop_ || !running_ || !edits_.empty();
+                    });
+                    sleeping_.store(false, std::memory_order_relaxed);
+                    continue;
+                }
+                step = false;
+            } else {
+                due += std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::duration<double>(1.0 / rate_));
+                // Um atraso grande (a máquina ocupada) não vira rajada
+                if (due < now - std::chrono::milliseconds(100))
+                    due = now;
+            }
+        }
+        lock.unlock();
+
+        pending |= applyEdits();
+        if (step) {
+            sim_.step();
+            pending = true;
+        }
+        generation_.store(sim_.generation(), std::memory_order_relaxed);
+        if (pending && snapshots_.consumed()) {
+            publish();
+            pending = false;
+        }
+
+        lock.lock();
+    }
+}
+
+} // namespace life
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "cell_edit.h"
+#include "grid.h"
+#include "mpsc_queue.h"
+#include "rule.h"
+#include "simulation.h"
+#include "triple_buffer.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace life {
+
+// Geração entregue ao leitor de uma SimThread
+struct SimSnapshot {
+    std::shared_ptr<const Grid> grid; // Simulation::share(), sem cópia
+    uint64_t generation = 0;
+    // Ciclo achado pela detecção de ciclos (period 0: nenhum ainda)
+    uint64_t period = 0;
+    uint64_t cycleStart = 0;
+};
+
+// Roda uma Simulation na própria thread, o mais rápido possível ou num ritmo
+// alvo, desacoplada de quem desenha. As gerações chegam ao leitor por um
+// TripleBuffer: o leitor nunca espera a simulação nem vice-versa.
+//
+// Uma geração só é publicada quando o leitor já pegou a anterior (ou quando a
+// simulação para), então ela é compartilhada no ritmo do leitor e não a cada
+// passo: cada share() obriga os dois passos seguintes a recalcular todas as
+// tiles. O leitor vê no máximo uma leitura de atraso.
+//
+// As edições entram por uma MpscQueue: quem edita (o mouse, um script, um
+// cliente de rede) nunca espera a simulação, e ela as aplica em lotes entre
+// dois passos, com uma única cópia da grade por lote se ela estava
+// compartilhada.
+class SimThread {
+public:
+    // Começa parada; threads como em Simulation::setThreadCount
+    SimThread(Grid initial, const Rule &rule, int threads = 0);
+    ~SimThread();
+
+    SimThread(const SimThread &) = delete;
+    SimThread &operator=(const SimThread &) = delete;
+
+    void setRunning(bool running);
+    // Gerações por segundo; <= 0 roda sem limite
+    void setTargetRate(double rate);
+    // Aplica change na thread da simulação, entre dois passos. As edições
+    // (as duas formas) entram na ordem em que foram enviadas. Seguras de
+    // qualquer thread e sem lock.
+    void edit(std::function<void(Simulation &)> change);
+    void editCells(CellEdit edit);
+
+    // Leitor: pega a geração mais nova, se houver uma que ainda não viu.
+    // snapshot() fica válida até o próximo acquire().
+    bool acquire() { return snapshots_.update(); }
+    const SimSnapshot &snapshot() const { return snapshots_.front(); }
+
+    // Gerações calculadas até agora (para medir o UPS real)
+    uint64_t generation() const {
+        return generation_.load(std::memory_order_relaxed);
+    }
+    // CellEdits aplicadas até agora
+    uint64_t cellEdits() const {
+        return cellEdits_.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Edit {
+        std::function<void(Simulation &)> change; // vazio: cells
+        CellEdit cells;
+    };
+
+    void push(Edit edit);
+    void run();
+    void publish();
+    // Aplica até um lote da fila; false se ela estava vazia
+    bool applyEdits();
+
+    Simulation sim_;
+    TripleBuffer<SimSnapshot> snapshots_;
+    std::atomic<uint64_t> generation_{0};
+    std::atomic<uint64_t> cellEdits_{0};
+
+    MpscQueue<Edit> edits_;
+    // A thread da simulação está (ou vai estar) esperando em wake_: só então
+    // quem edita precisa do mutex para acordá-la
+    std::atomic<bool> sleeping_{false};
+
+    std::mutex mutex_; // running_, rate_ e stop_
+    std::condition_variable wake_;
+    bool running_ = false;
+    double rate_ = 0.0;
+    bool stop_ = false;
+
+    std::thread thread_;
+};
+
+} // namespace life
@@ -0,0 +1,501 @@
+#include "simulation.h"
+
+#include "bits.h"
+#include "kernel.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+namespace life {
+
+namespace {
+
+// Um passo por tiles só compensa se pula pelo menos esta fração delas: os
+// trechos curtos custam por palavra cerca de três vezes a faixa inteira
+// (empate perto de 2/3 puladas numa sopa 8192x2048). Abaixo disso a simulação
+// fica kMinBackoff gerações nas faixas, dobrando a cada tentativa frustrada
+// até kMaxBackoff, e então mede de novo.
+constexpr double kMinSkipped = 0.7;
+constexpr int kMinBackoff = 16;
+constexpr int kMaxBackoff = 1024;
+// Tiles paradas entre duas ativas que o trecho calcula mesmo assim, para
+// chamar o kernel menos vezes
+constexpr int kMaxGap = 8;
+
+// Bits de changed_: a tile mudou, e se mudou na primeira ou na última linha
+// (só essas alcançam a tile de cima ou a de baixo)
+constexpr uint8_t kChanged = 1;
+constexpr uint8_t kFirstRow = 2;
+constexpr uint8_t kLastRow = 4;
+
+} // namespace
+
+void StepReference(const Grid &src, Grid &dst, const Rule &rule) {
+    int width = src.width();
+    int height = src.height();
+
+    for (int y = 0; y < height; y++) {
+        int up = (y + height - 1) % height;
+        int down = (y + 1) % height;
+        for (int x = 0; x < width; x++) {
+            int left = (x + width - 1) % width;
+            int right = (x + 1) % width;
+
+            int neighbors = src.get(left, up) + src.get(x, up) +
+                            src.get(right, up) + src.get(left, y) +
+                            src.get(right, y) + src.get(left, down) +
+                            src.get(x, down) + src.get(right, down);
+
+            bool alive = src.get(x, y);
+            dst.set(x, y, rule.next(alive, neighbors));
+        }
+    }
+}
+
+Simulation::Simulation(Grid initial, KernelIsa isa)
+    : front_(std::make_shared<Grid>(std::move(initial))),
+      back_(std::make_shared<Grid>(front_->width(), front_->height())) {
+    setKernelIsa(isa);
+    setThreadCount(1);
+}
+
+Grid &Simulation::grid() {
+    // Copy-on-write: quem recebeu share() continua vendo a geração antiga
+    if (front_.use_count() > 1)
+        front_ = std::make_shared<Grid>(*front_);
+    invalidateActivity();
+    frontHashValid_ = false;
+    cycles_.reset();
+    cycleGrid_ = Grid();
+    return *front_;
+}
+
+void Simulation::acquireBack() {
+    if (back_.use_count() == 1)
+        return;
+
+    // Alguém ainda lê o buffer de trabalho (um snapshot de gerações atrás):
+    // ele fica guardado e o passo escreve num reserva livre ou novo
+    spares_.push_back(std::move(back_));
+    for (auto &spare : spares_) {
+        if (spare.use_count() == 1) {
+            back_ = std::move(spare);
+            break;
+        }
+    }
+    spares_.erase(std::remove(spares_.begin(), spares_.end(), nullptr),
+                  spares_.end());
+    if (!back_)
+        back_ = std::make_shared<Grid>(front_->width(), front_->height());
+    // O leitor soltou a referência depois de terminar de ler
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    // O rastreamento de atividade conta com a geração t-1 no back_
+    invalidateActivity();
+    backHashValid_ = false;
+}
+
+// Calcula as palavras [w0, w1) da linha y em out (out[0] é a palavra w0).
+// Quando width não é múltiplo de 64, o vizinho leste da célula width-1 é a
+// célula 0, que entra no bit seguinte de uma cópia local da última palavra;
+// a geração atual só é escrita no halo.
+void Simulation::stepSpan(int y, int w0, int w1, uint64_t *out) const {
+    const Grid &src = *front_;
+    int height = src.height();
+    int words = src.words();
+    const uint64_t *rows[3] = {src.row(y == 0 ? height - 1 : y - 1),
+                               src.row(y),
+                               src.row(y == height - 1 ? 0 : y + 1)};
+
+    int tail = src.width() & 63;
+    int end = tail && w1 == words ? words - 1 : w1;
+    if (end > w0)
+        kernel_(rows[0] + w0, rows[1] + w0, rows[2] + w0, out, end - w0,
+                rule_);
+    if (end == w1)
+        return;
+
+    uint64_t local[3][3];
+    for (int i = 0; i < 3; i++) {
+        const uint64_t *r = rows[i];
+        local[i][0] = r[words - 2]; // com uma palavra só, o halo [-1]
+        local[i][1] = r[words - 1] | (r[0] & 1) << tail;
+        local[i][2] = 0;
+    }
+    kernel_(local[0] + 1, local[1] + 1, local[2] + 1, out + (end - w0), 1,
+            rule_);
+}
+
+// Como stepSpan, mas escreve direto no back_, que tem a geração t-1, e
+// devolve a máscara das palavras [w0, w1) que mudaram (bit 0: w0); w1 - w0
+// <= 64. Se hash não é nulo, aplica nele a troca de cada palavra alterada.
+uint64_t Simulation::stepSpanDiff(int y, int w0, int w1, uint64_t *hash) {
+    const Grid &src = *front_;
+    int height = src.height();
+    int words = src.words();
+    uint64_t *out = back_->row(y);
+    uint64_t old[64];
+    if (hash)
+        std::copy(out + w0, out + w1, old);
+
+    int tail = src.width() & 63;
+    int end = tail && w1 == words ? words - 1 : w1;
+    uint64_t changed = 0;
+    if (end > w0)
+        changed = diffKernel_(src.row(y == 0 ? height - 1 : y - 1) + w0,
+                              src.row(y) + w0,
+                              src.row(y == height - 1 ? 0 : y + 1) + w0,
+                              out + w0, end - w0, rule_);
+    if (end < w1) {
+        // O kernel escreve os bits além de width; a grade os mantém zerados
+        uint64_t last;
+        stepSpan(y, end, w1, &last);
+        last &= (1ull << tail) - 1;
+        if (out[end] != last) {
+            changed |= 1ull << (end - w0);
+            out[end] = last;
+        }
+    }
+
+    if (hash) {
+        for (uint64_t bits = changed; bits; bits &= bits - 1) {
+            int j = CountTrailingZeros(bits);
+            uint64_t index = (uint64_t)y * words + w0 + j;
+            *hash ^= HashWord(index, old[j]) ^ HashWord(index, out[w0 + j]);
+        }
+    }
+    return changed;
+}
+
+// Fora do trecho Step: a passada a mais pela grade é medida à parte
+void Simulation::recordGeneration() {
+    ProfileScope scope(ProfileZone::Population);
+    // O back_ voltou a ter a geração anterior
+    GenerationMetrics metrics = MeasureGeneration(*back_, *front_,
+                                                  pool_.get());
+    metrics.generation = generation_;
+    if (tracking_)
+        metrics.activeTiles = (int64_t)(activity_.tiles - activity_.skipped);
+    RecordGeneration(metrics);
+}
+
+bool Simulation::setKernelIsa(KernelIsa isa) {
+    RowKernel kernel = GetRowKernel(isa, RuleKernelFor(rule_));
+    if (!kernel)
+        return false;
+    isa_ = isa;
+    kernel_ = kernel;
+    diffKernel_ = GetDiffRowKernel(isa, RuleKernelFor(rule_));
+    return true;
+}
+
+void Simulation::setRule(const Rule &rule) {
+    rule_ = rule;
+    kernel_ = GetRowKernel(isa_, RuleKernelFor(rule_));
+    diffKernel_ = GetDiffRowKernel(isa_, RuleKernelFor(rule_));
+    // A comparação com t-2 das tiles só vale dentro da mesma regra
+    invalidateActivity();
+    cycles_.reset();
+}
+
+void Simulation::setThreadCount(int threads) {
+    pool_.reset();
+    if (threads != 1)
+        pool_ = std::make_unique<ThreadPool>(threads);
+    if (pool_ && pool_->threadCount() == 1)
+        pool_.reset();
+
+    // Faixas de ~256 KB de saída, com pelo menos 4 por thread
+    size_t rowBytes = (size_t)front_->words() * sizeof(uint64_t);
+    int height = front_->height();
+    int rows = (int)std::max<size_t>(4, (256 * 1024) / std::max<size_t>(
+                                                            rowBytes, 1));
+    int perThread = (height + 4 * threadCount() - 1) / (4 * threadCount());
+    bandRows_ = std::max(1, std::min(rows, perThread));
+}
+
+template <class Body>
+void Simulation::forEachBand(const Body &body) {
+    if (!pool_)
+        body(0, front_->height());
+    else
+        pool_->parallelFor(0, front_->height(), bandRows_, body);
+}
+
+void Simulation::setActivityTracking(bool enabled) {
+    tracking_ = enabled;
+    tilesX_ = front_->words();
+    tilesY_ = (front_->height() + kTileRows - 1) / kTileRows;
+    changed_.assign((size_t)tilesX_ * tilesY_, 1);
+    changedNext_.assign(changed_.size(), 1);
+    runs_.assign(changed_.size() * 2, 0);
+    activity_ = ActivityStats();
+    activity_.tiles = changed_.size();
+    bandSteps_ = 0;
+    backoff_ = kMinBackoff;
+    invalidateActivity();
+}
+
+// Marca em active as tiles da linha ty com alguma vizinha (3x3, com wrap)
+// alterada na última geração; das linhas de cima e de baixo só contam as
+// mudanças na linha de células que encosta nesta
+void Simulation::activeTiles(int ty, uint8_t *active) const {
+    int up = ty == 0 ? tilesY_ - 1 : ty - 1;
+    int down = ty == tilesY_ - 1 ? 0 : ty + 1;
+    const uint8_t *a = &changed_[(size_t)up * tilesX_];
+    const uint8_t *b = &changed_[(size_t)ty * tilesX_];
+    const uint8_t *c = &changed_[(size_t)down * tilesX_];
+
+    uint8_t *column = active; // usa a própria saída como temporário
+    for (int tx = 0; tx < tilesX_; tx++)
+        column[tx] = (a[tx] & kLastRow) | b[tx] | (c[tx] & kFirstRow);
+
+    uint8_t first = column[0];
+    uint8_t previous = column[tilesX_ - 1];
+    for (int tx = 0; tx < tilesX_; tx++) {
+        uint8_t current = column[tx];
+        uint8_t next = tx + 1 < tilesX_ ? column[tx + 1] : first;
+        active[tx] = previous | current | next;
+        previous = current;
+    }
+}
+
+// Calcula as tiles ativas de uma linha de tiles no back_. As tiles ativas
+// consecutivas viram trechos de até 64 palavras, e cada linha da grade roda o
+// kernel uma vez por trecho. Marca em changedNext_ as tiles que ficaram
+// diferentes de duas gerações atrás, pelas máscaras do kernel, e devolve
+// quantas foram puladas. Se hash não é nulo, aplica nele a troca de cada
+// palavra alterada.
+int Simulation::stepTileRow(int ty, bool full, uint64_t *hash) {
+    int height = front_->height();
+    int y0 = ty * kTileRows;
+    int y1 = std::min(height, y0 + kTileRows);
+
+    // changedNext serve de rascunho para as tiles ativas até virar trechos
+    uint8_t *changedNext = &changedNext_[(size_t)ty * tilesX_];
+    if (full)
+        std::fill(changedNext, changedNext + tilesX_, 1);
+    else
+        activeTiles(ty, changedNext);
+
+    int32_t *runs = &runs_[(size_t)ty * tilesX_ * 2];
+    int runCount = 0;
+    int skipped = tilesX_;
+    int vector = KernelIsaWords(isa_);
+    int end = 0; // fim do trecho anterior
+    for (int tx = 0; tx < tilesX_;) {
+        if (!changedNext[tx]) {
+            tx++;
+            continue;
+        }
+        int first = tx;
+        int last = tx; // última ativa do trecho
+        while (++tx < tilesX_ && tx - first < 64 && tx - last <= kMaxGap)
+            if (changedNext[tx])
+                last = tx;
+        tx = last + 1;
+        // Arredonda para vetores inteiros do kernel, dentro da linha e sem
+        // invadir o trecho anterior
+        int length = std::min(64, (tx - first + vector - 1) / vector * vector);
+        tx = std::min(tilesX_, first + length);
+        first = std::max(end, tx - length);
+        end = tx;
+        runs[2 * runCount] = first;
+        runs[2 * runCount + 1] = tx;
+        runCount++;
+        skipped -= tx - first;
+    }
+    if (runCount == 0)
+        return skipped;
+    std::fill(changedNext, changedNext + tilesX_, 0);
+
+    for (int r = 0; r < runCount; r++) {
+        int w0 = runs[2 * r];
+        int w1 = runs[2 * r + 1];
+        uint64_t changed = 0;
+        uint64_t firstRow = 0;
+        uint64_t lastRow = 0;
+        for (int y = y0; y < y1; y++) {
+            uint64_t mask = stepSpanDiff(y, w0, w1, hash);
+            changed |= mask;
+            if (y == y0)
+                firstRow = mask;
+            if (y == y1 - 1)
+                lastRow = mask;
+        }
+        for (; changed; changed &= changed - 1) {
+            int j = CountTrailingZeros(changed);
+            changedNext[w0 + j] = kChanged |
+                                  (firstRow >> j & 1 ? kFirstRow : 0) |
+                                  (lastRow >> j & 1 ? kLastRow : 0);
+        }
+    }
+    return skipped;
+}
+
+void Simulation::stepTiles() {
+    bool full = fullSteps_ > 0;
+    std::atomic<uint64_t> skipped{0};
+    std::atomic<uint64_t> hash{backHash_};
+
+    auto body = [this, full, &skipped, &hash](int ty0, int ty1) {
+        ProfileScope scope(ProfileZone::Band);
+        uint64_t bandSkipped = 0;
+        uint64_t bandHash = 0;
+        uint64_t *bandHashOut = hashing_ ? &bandHash : nullptr;
+        for (int ty = ty0; ty < ty1; ty++)
+            bandSkipped += stepTileRow(ty, full, bandHashOut);
+        skipped.fetch_add(bandSkipped, std::memory_order_relaxed);
+        hash.fetch_xor(bandHash, std::memory_order_relaxed);
+    };
+
+    if (!pool_)
+        body(0, tilesY_);
+    else
+        pool_->parallelFor(0, tilesY_,
+                           std::max(1, bandRows_ / kTileRows), body);
+
+    std::swap(changed_, changedNext_);
+    if (fullSteps_ > 0)
+        fullSteps_--;
+    // O back_ tinha t-1 e agora tem t+1; os hashes trocam no step()
+    backHash_ = hash.load();
+
+    activity_.skipped = skipped.load();
+    activity_.totalTiles += activity_.tiles;
+    activity_.totalSkipped += activity_.skipped;
+
+    // Um passo completo não diz nada sobre a atividade
+    if (full)
+        return;
+    if (activity_.skipped < kMinSkipped * activity_.tiles) {
+        bandSteps_ = backoff_;
+        backoff_ = std::min(2 * backoff_, kMaxBackoff);
+    } else {
+        backoff_ = kMinBackoff;
+    }
+}
+
+// Uma geração em faixas inteiras com o rastreamento ligado. O mapa não viu o
+// que mudou nela, mas o back_ continua com a geração anterior, então um passo
+// completo por tiles basta para refazê-lo.
+void Simulation::bandStep() {
+    bandSteps_--;
+    if (bandSteps_ == 0)
+        fullSteps_ = std::max(fullSteps_, 1);
+    activity_.skipped = 0;
+    activity_.totalTiles += activity_.tiles;
+    activity_.bandSteps++;
+}
+
+void Simulation::setCycleDetection(int maxPeriod) {
+    hashing_ = maxPeriod > 0;
+    cycles_ = CycleDetector(maxPeriod);
+    cycleGrid_ = Grid();
+    frontHashValid_ = false;
+    backHashValid_ = false;
+    skipped_ = 0;
+}
+
+void Simulation::setHashBits(int bits) {
+    hashMask_ = bits >= 64 ? ~0ull : (1ull << std::max(0, bits)) - 1;
+    cycles_.reset();
+}
+
+uint64_t Simulation::hash() const {
+    return hashing_ && frontHashValid_ ? frontHash_ : HashGrid(*front_);
+}
+
+// Recalcula o que uma edição invalidou e registra a geração atual
+void Simulation::syncHash() {
+    if (!frontHashValid_) {
+        frontHash_ = HashGrid(*front_, pool_.get());
+        frontHashValid_ = true;
+    }
+    if (cycles_.empty() || cycles_.lastGeneration() != generation_)
+        observeCycle();
+}
+
+// Registra a geração atual e devolve true se ela está num ciclo conferido.
+// Um hash repetido guarda a grade e espera um período: se a grade voltar
+// igual, o ciclo é real; se não, foi colisão e o histórico recomeça daqui.
+bool Simulation::observeCycle() {
+    if (cycles_.found())
+        return true;
+    if (cycles_.pending()) {
+        if (generation_ < confirmAt_)
+            return false;
+        bool same = generation_ == confirmAt_ && *front_ == cycleGrid_;
+        cycleGrid_ = Grid();
+        if (same) {
+            cycles_.confirm();
+            return true;
+        }
+        cycles_.reject();
+    }
+    if (!cycles_.observe(generation_, frontHash_ & hashMask_))
+        return false;
+    cycleGrid_ = *front_;
+    confirmAt_ = generation_ + cycles_.period();
+    return false;
+}
+
+void Simulation::step(uint64_t n) {
+    int words = front_->words();
+    if (hashing_)
+        syncHash();
+
+    for (uint64_t i = 0; i < n; i++) {
+        {
+            ProfileScope scope(ProfileZone::Step);
+            acquireBack();
+            {
+                ProfileScope halo(ProfileZone::Halo);
+                forEachBand([this](int y0, int y1) {
+                    front_->prepareHalo(y0, y1);
+                });
+            }
+
+            if (tracking_ && bandSteps_ == 0) {
+                if (hashing_ && !backHashValid_)
+                    backHash_ = HashGrid(*back_, pool_.get());
+                stepTiles();
+            } else {
+                std::atomic<uint64_t> hash{0};
+                forEachBand([this, words, &hash](int y0, int y1) {
+                    ProfileScope band(ProfileZone::Band);
+                    for (int y = y0; y < y1; y++)
+                        stepSpan(y, 0, words, back_->row(y));
+                    back_->clearPadding(y0, y1);
+                    if (hashing_)
+                        hash.fetch_xor(HashRows(*back_, y0, y1),
+                                       std::memory_order_relaxed);
+                });
+                backHash_ = hash.load();
+                if (tracking_)
+                    bandStep();
+            }
+
+            std::swap(front_, back_);
+            std::swap(frontHash_, backHash_);
+            backHashValid_ = frontHashValid_;
+            frontHashValid_ = true;
+            generation_++;
+        }
+        if (ProfilingGenerations())
+            recordGeneration();
+
+        if (hashing_ && observeCycle()) {
+            // O estado se repete a cada período: só falta a fase
+            uint64_t remaining = n - i - 1;
+            uint64_t skip = remaining - remaining % cycles_.period();
+            generation_ += skip;
+            skipped_ += skip;
+            n -= skip;
+        }
+    }
+}
+
+} // namespace life
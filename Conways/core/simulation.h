@@ -0,0 +1,173 @@
+#pragma once
+
+#include "cycle.h"
+#include "grid.h"
+#include "kernel.h"
+#include "thread_pool.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace life {
+
+// Calcula uma geração de src em dst, célula por célula, consultando a tabela
+// da regra (por padrão o B3/S23 do game_of_life.fs). dst precisa ter as
+// dimensões de src.
+void StepReference(const Grid &src, Grid &dst, const Rule &rule = Rule());
+
+// Simulação headless: mantém a geração atual e um buffer de trabalho,
+// alternados a cada passo (o mesmo ping-pong das texturas do main.cpp).
+// Os buffers são alocados uma vez; step() não aloca memória, a não ser que
+// um buffer ainda esteja compartilhado (veja share()).
+//
+// Com mais de uma thread, cada geração é dividida em faixas de linhas do
+// tamanho do cache, executadas num ThreadPool persistente. As faixas leem as
+// linhas vizinhas (o halo de uma linha) direto do buffer atual, que só é
+// escrito depois que todas terminam.
+//
+// Com o rastreamento de atividade ligado, a grade é dividida em tiles de uma
+// palavra x kTileRows linhas. O buffer de trabalho guarda a geração t-1,
+// então uma tile cuja vizinhança 3x3 está igual à de t-2 já tem o resultado
+// certo nele e nem é calculada. Isso cobre tanto still lifes quanto
+// osciladores de período 2. O kernel escreve direto no buffer de trabalho e
+// devolve as palavras que mudaram, que viram o mapa da geração seguinte.
+// Quando um passo pula pouco, o mapa não se paga: a simulação volta às
+// faixas inteiras por algumas gerações e depois mede de novo.
+class Simulation {
+public:
+    explicit Simulation(Grid initial, KernelIsa isa = DetectKernelIsa());
+
+    void step(uint64_t n = 1);
+
+    const Grid &grid() const { return *front_; }
+    // Acesso para edição: invalida o mapa de atividade e, se a geração atual
+    // foi compartilhada, copia antes (copy-on-write)
+    Grid &grid();
+
+    // A geração atual sem cópia, para ser lida em outra thread (um
+    // checkpoint em segundo plano, por exemplo). A simulação não escreve mais
+    // nas células dela: os passos seguintes usam outro buffer enquanto
+    // houver referências.
+    std::shared_ptr<const Grid> share() const { return front_; }
+    uint64_t generation() const { return generation_; }
+    // Para continuar a contagem de um snapshot
+    void setGeneration(uint64_t generation) { generation_ = generation; }
+
+    KernelIsa kernelIsa() const { return isa_; }
+    // Troca o kernel; devolve false se a ISA não está disponível
+    bool setKernelIsa(KernelIsa isa);
+
+    // Troca a regra: escolhe o kernel especializado dela, ou o da tabela, e
+    // o passo continua sendo uma chamada pelo mesmo ponteiro
+    void setRule(const Rule &rule);
+    const Rule &rule() const { return rule_; }
+    RuleKernel ruleKernel() const { return RuleKernelFor(rule_); }
+
+    // threads <= 0 usa todos os núcleos; 1 roda na thread que chama step()
+    void setThreadCount(int threads);
+    int threadCount() const { return pool_ ? pool_->threadCount() : 1; }
+    // Estatísticas por thread, ou nullptr se está rodando numa thread só
+    const ThreadPool *threadPool() const { return pool_.get(); }
+    ThreadPool *threadPool() { return pool_.get(); }
+
+    static constexpr int kTileRows = 8;
+
+    struct ActivityStats {
+        uint64_t tiles = 0;   // tiles por geração
+        uint64_t skipped = 0; // puladas na última geração
+        uint64_t totalTiles = 0;
+        uint64_t totalSkipped = 0;
+        // Gerações calculadas em faixas inteiras, sem o mapa
+        uint64_t bandSteps = 0;
+
+        double skippedFraction() const {
+            return totalTiles ? (double)totalSkipped / totalTiles : 0.0;
+        }
+    };
+
+    void setActivityTracking(bool enabled);
+    bool activityTracking() const { return tracking_; }
+    const ActivityStats &activityStats() const { return activity_; }
+    // Força as próximas gerações a recalcular todas as tiles
+    void invalidateActivity() { fullSteps_ = 2; }
+
+    // Detecção de ciclos: mantém um hash de 64 bits da geração atual e o
+    // compara com o das últimas maxPeriod gerações. Com o rastreamento de
+    // atividade o hash é atualizado só com as palavras que mudaram; sem ele,
+    // cada faixa soma o hash das linhas que acabou de calcular. Um hash
+    // repetido não basta: a grade daquela geração é guardada e comparada
+    // com a de um período depois. Só com o ciclo conferido step(n) deixa de
+    // calcular o resto: avança só (resto mod período) gerações e ajusta a
+    // contagem. 0 desliga.
+    void setCycleDetection(int maxPeriod);
+    // Para testes: o detector só vê os `bits` bits baixos do hash, o que
+    // força colisões (0: todas as gerações têm o mesmo hash)
+    void setHashBits(int bits);
+    const CycleDetector &cycles() const { return cycles_; }
+    // Gerações puladas por estarem num ciclo
+    uint64_t skippedGenerations() const { return skipped_; }
+    // Hash da geração atual (veja HashWord)
+    uint64_t hash() const;
+
+private:
+    void acquireBack();
+    void stepSpan(int y, int w0, int w1, uint64_t *out) const;
+    uint64_t stepSpanDiff(int y, int w0, int w1, uint64_t *hash);
+    void stepTiles();
+    void bandStep();
+    void activeTiles(int ty, uint8_t *active) const;
+    int stepTileRow(int ty, bool full, uint64_t *hash);
+    void syncHash();
+    bool observeCycle();
+    void recordGeneration();
+
+    template <class Body>
+    void forEachBand(const Body &body);
+
+    std::shared_ptr<Grid> front_;
+    std::shared_ptr<Grid> back_;
+    // Buffers que saíram de uso enquanto compartilhados, para reaproveitar
+    std::vector<std::shared_ptr<Grid>> spares_;
+    uint64_t generation_ = 0;
+    KernelIsa isa_ = KernelIsa::Scalar;
+    Rule rule_;
+    RowKernel kernel_ = RowKernelScalar(RuleKernel::Life);
+    DiffRowKernel diffKernel_ = DiffRowKernelScalar(RuleKernel::Life);
+    std::unique_ptr<ThreadPool> pool_;
+    int bandRows_ = 0;
+
+    bool tracking_ = false;
+    int tilesX_ = 0;
+    int tilesY_ = 0;
+    // changed_[t]: a tile mudou em relação a duas gerações atrás
+    std::vector<uint8_t> changed_;
+    std::vector<uint8_t> changedNext_;
+    // Trechos [w0, w1) de palavras ativas; cada linha de tiles usa só os seus
+    std::vector<int32_t> runs_;
+    // Gerações que ainda precisam ser calculadas por inteiro: depois de uma
+    // edição nem o front_ nem o back_ servem de referência
+    int fullSteps_ = 2;
+    // Gerações que faltam em faixas inteiras, e quantas serão da próxima
+    // vez que as tiles não compensarem
+    int bandSteps_ = 0;
+    int backoff_ = 0;
+    ActivityStats activity_;
+
+    bool hashing_ = false;
+    // frontHash_ vale se frontHashValid_; backHash_ é o hash do conteúdo do
+    // back_ (a geração t-1), base da atualização incremental
+    uint64_t frontHash_ = 0;
+    uint64_t backHash_ = 0;
+    bool frontHashValid_ = false;
+    bool backHashValid_ = false;
+    CycleDetector cycles_;
+    uint64_t hashMask_ = ~0ull;
+    // Candidato a ciclo: a grade da geração em que o hash repetiu, a
+    // conferir na geração confirmAt_
+    Grid cycleGrid_;
+    uint64_t confirmAt_ = 0;
+    uint64_t skipped_ = 0;
+};
+
+} // namespace life
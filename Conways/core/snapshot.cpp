@@ -0,0 +1,388 @@
+#include "snapshot.h"
+
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#if defined(_WIN32)
+#include <io.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(CONWAYS_WITH_ZSTD)
+#include <zstd.h>
+#endif
+
+namespace life {
+
+namespace {
+
+constexpr char kMagic[8] = {'C', 'W', 'L', 'S', 'N', 'A', 'P', '\0'};
+constexpr uint32_t kVersion = 1;
+constexpr uint32_t kFlagZstd = 1;
+// Os dados começam numa fronteira de página para poderem ser mapeados
+constexpr uint64_t kDataOffset = 4096;
+
+// Campos em little-endian, na ordem em que aparecem no arquivo
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    int32_t width;
+    int32_t height;
+    uint64_t generation;
+    uint32_t stride;    // palavras por linha no arquivo (sem compressão)
+    uint32_t chunkRows; // linhas por bloco (com compressão)
+    uint64_t dataOffset;
+    uint64_t dataSize;
+    uint8_t reserved[16];
+};
+static_assert(sizeof(Header) == 72, "layout do cabeçalho mudou");
+
+bool Fail(std::string *error, const std::string &message) {
+    if (error)
+        *error = message;
+    return false;
+}
+
+bool LittleEndian() {
+    uint16_t probe = 1;
+    uint8_t first;
+    memcpy(&first, &probe, 1);
+    return first == 1;
+}
+
+// Fecha o arquivo e junta o erro de escrita, se houver
+bool Close(FILE *file, const char *path, std::string *error) {
+    bool ok = ferror(file) == 0;
+    ok = fclose(file) == 0 && ok;
+    return ok ? true : Fail(error, std::string("erro ao gravar ") + path);
+}
+
+bool WriteRaw(FILE *file, const Grid &grid) {
+    // Halo zerado: o arquivo não depende do estado de um passo
+    std::vector<uint64_t> line(grid.stride(), 0);
+    for (int y = 0; y < grid.height(); y++) {
+        std::copy(grid.row(y), grid.row(y) + grid.words(), line.begin() + 1);
+        if (fwrite(line.data(), sizeof(uint64_t), line.size(), file) !=
+            line.size())
+            return false;
+    }
+    return true;
+}
+
+#if defined(CONWAYS_WITH_ZSTD)
+
+bool WriteZstd(FILE *file, const Grid &grid, const SnapshotOptions &options,
+               uint64_t &dataSize) {
+    int chunkRows = options.chunkRows;
+    int chunks = (grid.height() + chunkRows - 1) / chunkRows;
+    std::vector<std::vector<char>> compressed(chunks);
+    std::vector<char> failed(chunks, 0);
+
+    ThreadPool pool;
+    pool.parallelFor(0, chunks, 1, [&](int c0, int c1) {
+        std::vector<uint64_t> raw;
+        for (int c = c0; c < c1; c++) {
+            int y0 = c * chunkRows;
+            int y1 = std::min(grid.height(), y0 + chunkRows);
+            raw.resize((size_t)(y1 - y0) * grid.words());
+            for (int y = y0; y < y1; y++)
+                std::copy(grid.row(y), grid.row(y) + grid.words(),
+                          raw.begin() + (size_t)(y - y0) * grid.words());
+
+            size_t bytes = raw.size() * sizeof(uint64_t);
+            std::vector<char> &out = compressed[c];
+            out.resize(ZSTD_compressBound(bytes));
+            size_t size = ZSTD_compress(out.data(), out.size(), raw.data(),
+                                        bytes, options.level);
+            if (ZSTD_isError(size))
+                failed[c] = 1;
+            else
+                out.resize(size);
+        }
+    });
+    if (std::count(failed.begin(), failed.end(), 1))
+        return false;
+
+    // Tabela com o tamanho comprimido de cada bloco, seguida dos blocos
+    std::vector<uint64_t> sizes(chunks);
+    for (int c = 0; c < chunks; c++)
+        sizes[c] = compressed[c].size();
+    if (fwrite(sizes.data(), sizeof(uint64_t), sizes.size(), file) !=
+        sizes.size())
+        return false;
+    dataSize = sizes.size() * sizeof(uint64_t);
+    for (const auto &chunk : compressed) {
+        if (fwrite(chunk.data(), 1, chunk.size(), file) != chunk.size())
+            return false;
+        dataSize += chunk.size();
+    }
+    return true;
+}
+
+// header.chunkRows já foi conferido contra a altura em LoadSnapshot
+bool ReadZstd(FILE *file, const Header &header, Grid &out,
+              std::string *error) {
+    int chunkRows = (int)header.chunkRows;
+    int chunks = (int)(((uint64_t)header.height + chunkRows - 1) / chunkRows);
+    std::vector<uint64_t> sizes(chunks);
+    if (fread(sizes.data(), sizeof(uint64_t), sizes.size(), file) !=
+        sizes.size())
+        return Fail(error, "snapshot truncado");
+
+    // Cada tamanho cabe em dataSize antes de somar, então a soma não dá a
+    // volta e o total confere com o que o cabeçalho promete
+    uint64_t table = sizes.size() * sizeof(uint64_t);
+    std::vector<uint64_t> offsets(chunks + 1, 0);
+    for (int c = 0; c < chunks; c++) {
+        if (sizes[c] > header.dataSize ||
+            offsets[c] + sizes[c] + table > header.dataSize)
+            return Fail(error, "snapshot truncado");
+        offsets[c + 1] = offsets[c] + sizes[c];
+    }
+
+    std::vector<char> payload(offsets[chunks]);
+    if (fread(payload.data(), 1, payload.size(), file) != payload.size())
+        return Fail(error, "snapshot truncado");
+
+    Grid grid(header.width, header.height);
+    std::vector<char> failed(chunks, 0);
+    ThreadPool pool;
+    pool.parallelFor(0, chunks, 1, [&](int c0, int c1) {
+        std::vector<uint64_t> raw;
+        for (int c = c0; c < c1; c++) {
+            int y0 = c * chunkRows;
+            int y1 = std::min(grid.height(), y0 + chunkRows);
+            raw.resize((size_t)(y1 - y0) * grid.words());
+            size_t bytes = raw.size() * sizeof(uint64_t);
+            size_t size = ZSTD_decompress(raw.data(), bytes,
+                                          payload.data() + offsets[c],
+                                          sizes[c]);
+            if (ZSTD_isError(size) || size != bytes) {
+                failed[c] = 1;
+                continue;
+            }
+            for (int y = y0; y < y1; y++) {
+                const uint64_t *src = raw.data() + (size_t)(y - y0) *
+                                                       grid.words();
+                std::copy(src, src + grid.words(), grid.row(y));
+            }
+        }
+    });
+    if (std::count(failed.begin(), failed.end(), 1))
+        return Fail(error, "bloco comprimido inválido");
+
+    grid.clearPadding();
+    out = std::move(grid);
+    return true;
+}
+
+#endif
+
+#if !defined(_WIN32)
+
+// Algum bit além de width na última palavra de uma linha
+bool HasPadding(const Grid &grid) {
+    int tail = grid.width() & 63;
+    if (tail == 0)
+        return false;
+    for (int y = 0; y < grid.height(); y++)
+        if (grid.row(y)[grid.words() - 1] >> tail)
+            return true;
+    return false;
+}
+
+// Memória mapeada de um snapshot, liberada junto com a última grade
+struct Mapping {
+    void *address;
+    size_t size;
+    ~Mapping() { munmap(address, size); }
+};
+
+#endif
+
+} // namespace
+
+bool SnapshotCompressionAvailable() {
+#if defined(CONWAYS_WITH_ZSTD)
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool SaveSnapshot(const char *path, const Grid &grid, uint64_t generation,
+                  const SnapshotOptions &options, std::string *error) {
+    if (!LittleEndian())
+        return Fail(error, "snapshots só são suportados em little-endian");
+#if !defined(CONWAYS_WITH_ZSTD)
+    if (options.compress)
+        return Fail(error, "compilado sem suporte a zstd");
+#endif
+    if (options.compress && options.chunkRows <= 0)
+        return Fail(error, "chunkRows precisa ser positivo");
+
+    FILE *file = fopen(path, "wb");
+    if (!file)
+        return Fail(error, std::string("não foi possível criar ") + path);
+
+    Header header = {};
+    memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.flags = options.compress ? kFlagZstd : 0;
+    header.width = grid.width();
+    header.height = grid.height();
+    header.generation = generation;
+    header.stride = (uint32_t)grid.stride();
+    header.chunkRows = options.compress ? (uint32_t)options.chunkRows : 0;
+    header.dataOffset = kDataOffset;
+    header.dataSize =
+        (uint64_t)grid.stride() * grid.height() * sizeof(uint64_t);
+
+    // Cabeçalho completo numa página; dataSize é reescrito no fim se mudar
+    std::vector<char> page(kDataOffset, 0);
+    memcpy(page.data(), &header, sizeof(header));
+    bool ok = fwrite(page.data(), 1, page.size(), file) == page.size();
+
+    if (ok && options.compress) {
+#if defined(CONWAYS_WITH_ZSTD)
+        ok = WriteZstd(file, grid, options, header.dataSize);
+        ok = ok && fseek(file, 0, SEEK_SET) == 0 &&
+             fwrite(&header, sizeof(header), 1, file) == 1;
+#endif
+    } else if (ok) {
+        ok = WriteRaw(file, grid);
+    }
+
+    if (ok && options.sync) {
+        ok = fflush(file) == 0;
+#if defined(_WIN32)
+        ok = ok && _commit(_fileno(file)) == 0;
+#else
+        ok = ok && fsync(fileno(file)) == 0;
+#endif
+    }
+
+    if (!ok) {
+        fclose(file);
+        return Fail(error, std::string("erro ao gravar ") + path);
+    }
+    return Close(file, path, error);
+}
+
+bool LoadSnapshot(const char *path, Grid &out, SnapshotInfo *info,
+                  std::string *error) {
+    if (!LittleEndian())
+        return Fail(error, "snapshots só são suportados em little-endian");
+
+    FILE *file = fopen(path, "rb");
+    if (!file)
+        return Fail(error, std::string("não foi possível abrir ") + path);
+
+    Header header;
+    bool ok = fread(&header, sizeof(header), 1, file) == 1;
+#if defined(_WIN32)
+    struct _stat64 status;
+    ok = ok && _fstat64(_fileno(file), &status) == 0;
+#else
+    struct stat status;
+    ok = ok && fstat(fileno(file), &status) == 0;
+#endif
+    if (!ok || memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+        fclose(file);
+        return Fail(error, std::string(path) + " não é um snapshot");
+    }
+    if (header.version != kVersion) {
+        fclose(file);
+        return Fail(error, std::string("versão de snapshot não suportada em ") +
+                               path);
+    }
+
+    bool compressed = (header.flags & kFlagZstd) != 0;
+    uint64_t fileSize = (uint64_t)status.st_size;
+    uint64_t rawSize = (uint64_t)Grid::StrideFor(header.width) *
+                       (uint64_t)header.height * sizeof(uint64_t);
+    if (header.width <= 0 || header.height <= 0 ||
+        header.dataOffset != kDataOffset ||
+        header.dataOffset + header.dataSize > fileSize ||
+        (!compressed && (header.stride != (uint32_t)Grid::StrideFor(
+                                              header.width) ||
+                         header.dataSize != rawSize)) ||
+        (compressed && (header.chunkRows == 0 ||
+                        header.chunkRows > (uint32_t)header.height))) {
+        fclose(file);
+        return Fail(error, std::string("snapshot inválido ou truncado: ") +
+                               path);
+    }
+
+    if (info) {
+        info->width = header.width;
+        info->height = header.height;
+        info->generation = header.generation;
+        info->compressed = compressed;
+        info->mapped = false;
+    }
+
+    if (compressed) {
+#if defined(CONWAYS_WITH_ZSTD)
+        ok = fseek(file, (long)header.dataOffset, SEEK_SET) == 0;
+        ok = ok ? ReadZstd(file, header, out, error)
+                : Fail(error, std::string("erro ao ler ") + path);
+        fclose(file);
+        return ok;
+#else
+        fclose(file);
+        return Fail(error, std::string(path) +
+                               " é comprimido e o binário não tem zstd");
+#endif
+    }
+
+#if defined(_WIN32)
+    // Sem mmap aqui: lê as linhas para uma grade própria
+    Grid grid(header.width, header.height);
+    ok = fseek(file, (long)header.dataOffset, SEEK_SET) == 0;
+    for (int y = 0; ok && y < grid.height(); y++)
+        ok = fread(grid.row(y) - 1, sizeof(uint64_t), grid.stride(), file) ==
+             (size_t)grid.stride();
+    fclose(file);
+    if (!ok)
+        return Fail(error, std::string("erro ao ler ") + path);
+    grid.clearPadding();
+    out = std::move(grid);
+#else
+    // PROT_WRITE com MAP_PRIVATE: o passo escreve no halo e, se a grade for
+    // editada, só as páginas tocadas são copiadas
+    size_t size = (size_t)(header.dataOffset + header.dataSize);
+    void *address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                         fileno(file), 0);
+    fclose(file);
+    if (address == MAP_FAILED)
+        return Fail(error, std::string("não foi possível mapear ") + path);
+
+    auto mapping = std::make_shared<Mapping>();
+    mapping->address = address;
+    mapping->size = size;
+    uint64_t *data = reinterpret_cast<uint64_t *>(
+        static_cast<char *>(address) + header.dataOffset);
+    out = Grid::Wrap(header.width, header.height, data, std::move(mapping));
+    // O arquivo pode trazer células além de width, que o passo leria como
+    // vizinhas. Só escreve se achar alguma: a escrita copia a página.
+    if (HasPadding(out))
+        out.clearPadding();
+    if (info)
+        info->mapped = true;
+#endif
+    return true;
+}
+
+} // namespace life
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "grid.h"
+
+#include <cstdint>
+#include <string>
+
+namespace life {
+
+// Snapshot binário (.snap) da grade, versionado.
+//
+// Sem compressão, as linhas ficam no arquivo exatamente com o layout da Grid
+// (stride() palavras, halo incluído) a partir de uma fronteira de página,
+// então LoadSnapshot() só mapeia o arquivo com mmap e a grade usa as páginas
+// direto: carregar não lê nem copia os dados. O mapeamento é privado
+// (copy-on-write); o arquivo nunca é alterado pela simulação.
+//
+// Com compressão (compilado com CONWAYS_WITH_ZSTD), as linhas são agrupadas
+// em blocos de chunkRows linhas comprimidos com zstd de forma independente, e
+// a leitura descomprime os blocos em paralelo numa grade própria.
+struct SnapshotOptions {
+    bool compress = false;
+    int level = 3;        // nível do zstd
+    int chunkRows = 1024; // linhas por bloco comprimido
+    bool sync = false;    // fsync antes de fechar, para checkpoints
+};
+
+struct SnapshotInfo {
+    int width = 0;
+    int height = 0;
+    uint64_t generation = 0;
+    bool compressed = false;
+    bool mapped = false; // a grade usa o arquivo mapeado, sem cópia
+};
+
+// Se o binário foi compilado com suporte a zstd
+bool SnapshotCompressionAvailable();
+
+bool SaveSnapshot(const char *path, const Grid &grid, uint64_t generation,
+                  const SnapshotOptions &options = SnapshotOptions(),
+                  std::string *error = nullptr);
+bool LoadSnapshot(const char *path, Grid &out, SnapshotInfo *info = nullptr,
+                  std::string *error = nullptr);
+
+} // namespace life
@@ -0,0 +1,49 @@
+#include "sparse_life.h"
+
+#include <utility>
+
+namespace life {
+
+SparseLife::SparseLife(const Grid &grid) {
+    for (int y = 0; y < grid.height(); y++)
+        for (int x = 0; x < grid.width(); x++)
+            if (grid.get(x, y))
+                cells_.insert({x, y});
+}
+
+bool SparseLife::setRule(const Rule &rule) {
+    if (rule.birth & 1)
+        return false;
+    rule_ = rule;
+    return true;
+}
+
+void SparseLife::step(uint64_t n) {
+    for (uint64_t gen = 0; gen < n; gen++) {
+        next_.clear();
+        neighborCount_.clear();
+        neighborCount_.reserve(cells_.size() * 9);
+
+        for (const auto &pos : cells_) {
+            for (int i = -1; i <= 1; i++) {
+                for (int j = -1; j <= 1; j++) {
+                    Pos neighbor = {pos.x + i, pos.y + j};
+                    neighborCount_[neighbor]++;
+                }
+            }
+        }
+
+        for (const auto &[pos, count] : neighborCount_) {
+            bool isAlive = cells_.count(pos);
+            int actualNeighbors = isAlive ? count - 1 : count;
+
+            if (rule_.next(isAlive, actualNeighbors))
+                next_.insert(pos);
+        }
+
+        std::swap(cells_, next_);
+        generation_++;
+    }
+}
+
+} // namespace life
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "grid.h"
+#include "rule.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace life {
+
+struct Pos {
+    int x, y;
+    bool operator==(const Pos &other) const {
+        return x == other.x && y == other.y;
+    }
+};
+
+// O hash x ^ (y << 1) do main_old.cpp colide em massa em grades grandes
+// (só ~8K valores distintos em 2400x2000); aqui as coordenadas são misturadas.
+struct PosHash {
+    size_t operator()(const Pos &pos) const {
+        uint64_t key = ((uint64_t)(uint32_t)pos.x << 32) | (uint32_t)pos.y;
+        key *= 0x9E3779B97F4A7C15ull;
+        return (size_t)(key ^ (key >> 32));
+    }
+};
+
+// O motor do main_old.cpp: plano ilimitado com um conjunto de células
+// vivas e contagem de vizinhos num unordered_map. Fica como referência de
+// desempenho para os motores em bitboard.
+class SparseLife {
+public:
+    SparseLife() = default;
+    explicit SparseLife(const Grid &grid);
+
+    // Como no HashLife, regras com B0 não cabem no plano ilimitado
+    bool setRule(const Rule &rule);
+    const Rule &rule() const { return rule_; }
+
+    void step(uint64_t n = 1);
+
+    const std::unordered_set<Pos, PosHash> &cells() const { return cells_; }
+    uint64_t population() const { return cells_.size(); }
+    uint64_t generation() const { return generation_; }
+
+private:
+    std::unordered_set<Pos, PosHash> cells_;
+    std::unordered_set<Pos, PosHash> next_;
+    std::unordered_map<Pos, int, PosHash> neighborCount_;
+    uint64_t generation_ = 0;
+    Rule rule_;
+};
+
+} // namespace life
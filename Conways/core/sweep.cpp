@@ -0,0 +1,91 @@
+#include "sweep.h"
+
+#include "simulation.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <mutex>
+
+namespace life {
+
+void RunSweep(const SweepSpec &spec,
+              const std::function<void(const SoupResult &)> &onResult) {
+    int maxPeriod = spec.maxPeriod > 0
+                        ? spec.maxPeriod
+                        : 4 * std::max(spec.width, spec.height);
+    KernelIsa isa = DetectKernelIsa();
+
+    std::mutex mutex; // lista livre e onResult
+    std::vector<std::unique_ptr<Simulation>> free;
+    // Um só para todas as sopas: as formas novas de uma ficam no cache
+    std::unique_ptr<Census> census;
+    if (spec.census)
+        census = std::make_unique<Census>(spec.rule);
+
+    auto runSoup = [&](size_t index) {
+        std::unique_ptr<Simulation> sim;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!free.empty()) {
+                sim = std::move(free.back());
+                free.pop_back();
+            }
+        }
+        if (!sim) {
+            sim = std::make_unique<Simulation>(Grid(spec.width, spec.height),
+                                               isa);
+            sim->setRule(spec.rule);
+        }
+
+        SoupResult result;
+        result.index = index;
+        size_t perPattern = spec.densities.size() * (size_t)spec.seeds;
+        result.pattern = spec.patterns[index / perPattern];
+        result.density = spec.densities[index % perPattern / spec.seeds];
+        result.seed = spec.firstSeed + index % spec.seeds;
+
+        auto start = std::chrono::steady_clock::now();
+        SeedOptions seed;
+        seed.seed = result.seed;
+        seed.density = result.density;
+        seed.pattern = result.pattern;
+        seed.isa = isa;
+        SeedGrid(sim->grid(), seed);
+        sim->setGeneration(0);
+        sim->setCycleDetection(maxPeriod);
+        // Leituras pela referência const: o grid() não const conta como edição
+        const Simulation &view = *sim;
+        result.initialPopulation = view.grid().population();
+
+        // Uma geração por vez: a sopa para assim que o ciclo aparece
+        while (sim->generation() < spec.maxGenerations &&
+               !sim->cycles().found())
+            sim->step();
+
+        const CycleDetector &cycles = sim->cycles();
+        result.lifespan =
+            cycles.found() ? cycles.start() : spec.maxGenerations;
+        result.period = cycles.period();
+        result.generations = sim->generation();
+        result.population = view.grid().population();
+        if (census)
+            result.census = census->take(*sim);
+        result.seconds = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        onResult(result);
+        free.push_back(std::move(sim));
+    };
+
+    ThreadPool pool(spec.threads);
+    pool.parallelFor(0, (int)spec.soups(), 1, [&](int i0, int i1) {
+        for (int i = i0; i < i1; i++)
+            runSoup((size_t)i);
+    });
+}
+
+} // namespace life
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "census.h"
+#include "rule.h"
+#include "seed.h"
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace life {
+
+// Varredura de sopas: cada combinação de densidade x padrão roda `seeds`
+// sementes consecutivas a partir de firstSeed, numa grade pequena, até a
+// grade entrar num ciclo ou chegar a maxGenerations.
+struct SweepSpec {
+    std::vector<float> densities = {0.25f};
+    std::vector<SeedPattern> patterns = {SeedPattern::Random};
+    int seeds = 100;
+    uint64_t firstSeed = 0;
+    int width = 256;
+    int height = 256;
+    uint64_t maxGenerations = 10000;
+    // Maior período procurado; 0 usa 4 * max(width, height), o tempo de um
+    // glider dar a volta no toro quadrado
+    int maxPeriod = 0;
+    Rule rule;
+    int threads = 0;
+    // Recenseia os objetos de cada sopa quando ela para (veja Census)
+    bool census = false;
+
+    size_t soups() const {
+        return densities.size() * patterns.size() * (size_t)seeds;
+    }
+};
+
+struct SoupResult {
+    size_t index = 0; // ordem na varredura (padrão, densidade, semente)
+    float density = 0.0f;
+    SeedPattern pattern = SeedPattern::Random;
+    uint64_t seed = 0;
+    uint64_t initialPopulation = 0;
+    uint64_t population = 0; // quando parou
+    // Primeira geração do ciclo, ou maxGenerations se não assentou
+    uint64_t lifespan = 0;
+    uint64_t period = 0; // 0 se não assentou
+    uint64_t generations = 0; // calculadas
+    double seconds = 0.0;
+    CensusResult census; // com SweepSpec::census
+};
+
+// Roda a varredura numa fila de tarefas com uma sopa cada. As simulações
+// (e as grades delas) ficam numa lista livre e são reaproveitadas de uma
+// sopa para a próxima, então a varredura só aloca uma por thread.
+// onResult é chamada assim que cada sopa termina, numa thread qualquer, mas
+// nunca duas vezes ao mesmo tempo.
+void RunSweep(const SweepSpec &spec,
+              const std::function<void(const SoupResult &)> &onResult);
+
+} // namespace life
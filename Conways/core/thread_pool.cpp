@@ -0,0 +1,230 @@
+#include "thread_pool.h"
+
+#include "profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+
+namespace life {
+
+// Índice do worker da thread atual neste pool, ou -1 fora dele
+static thread_local const ThreadPool *tlsPool = nullptr;
+static thread_local int tlsWorker = -1;
+
+static int64_t NowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+ThreadPool::ThreadPool(int threads) {
+    if (threads <= 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    for (int i = 0; i < threads; i++)
+        queues_.push_back(std::make_unique<Queue>());
+
+    statsEpochNanos_ = NowNanos();
+    for (int i = 1; i < threads; i++)
+        threads_.emplace_back([this, i] { workerLoop(i); });
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto &thread : threads_)
+        thread.join();
+}
+
+void ThreadPool::Queue::pushBack(Task task) {
+    if (size == ring.size()) {
+        std::vector<Task> larger(std::max<size_t>(16, 2 * ring.size()));
+        for (size_t i = 0; i < size; i++)
+            larger[i] = std::move(ring[(head + i) % ring.size()]);
+        ring = std::move(larger);
+        head = 0;
+    }
+    ring[(head + size) % ring.size()] = std::move(task);
+    size++;
+}
+
+bool ThreadPool::Queue::popBack(Task &task) {
+    if (size == 0)
+        return false;
+    size--;
+    task = std::move(ring[(head + size) % ring.size()]);
+    return true;
+}
+
+bool ThreadPool::Queue::popFront(Task &task) {
+    if (size == 0)
+        return false;
+    task = std::move(ring[head]);
+    head = (head + 1) % ring.size();
+    size--;
+    return true;
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    Task entry;
+    entry.function = std::move(task);
+    push(std::move(entry));
+}
+
+void ThreadPool::push(Task task) {
+    int target;
+    if (tlsPool == this && tlsWorker >= 0)
+        target = tlsWorker;
+    else
+        target = (int)(nextQueue_.fetch_add(1, std::memory_order_relaxed) %
+                       queues_.size());
+
+    pending_.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(queues_[target]->mutex);
+        queues_[target]->pushBack(std::move(task));
+    }
+    queued_.fetch_add(1, std::memory_order_release);
+
+    // Pega o mutex para não perder um worker que está indo dormir; a thread
+    // em wait() também acorda para ajudar
+    { std::lock_guard<std::mutex> lock(sleepMutex_); }
+    wake_.notify_one();
+    done_.notify_one();
+}
+
+bool ThreadPool::runOne(int worker) {
+    Task task;
+    int count = (int)queues_.size();
+
+    bool found;
+    {
+        Queue &own = *queues_[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        found = own.popBack(task);
+    }
+
+    for (int i = 1; !found && i < count; i++) {
+        Queue &victim = *queues_[(worker + i) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        found = victim.popFront(task);
+        if (found)
+            queues_[worker]->steals.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (!found)
+        return false;
+
+    queued_.fetch_sub(1, std::memory_order_relaxed);
+
+    int64_t start = NowNanos();
+    if (task.range)
+        task.range(task.context, task.begin, task.end);
+    else
+        task.function();
+    Queue &own = *queues_[worker];
+    own.busyNanos.fetch_add(NowNanos() - start, std::memory_order_relaxed);
+    own.executed.fetch_add(1, std::memory_order_relaxed);
+
+    if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        { std::lock_guard<std::mutex> lock(sleepMutex_); }
+        done_.notify_all();
+    }
+    return true;
+}
+
+void ThreadPool::workerLoop(int worker) {
+    tlsPool = this;
+    tlsWorker = worker;
+    SetProfileThreadName("worker " + std::to_string(worker));
+
+    for (;;) {
+        if (runOne(worker))
+            continue;
+
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        wake_.wait(lock, [this] {
+            return stop_ || queued_.load(std::memory_order_acquire) > 0;
+        });
+        if (stop_)
+            return;
+    }
+}
+
+void ThreadPool::wait() {
+    const ThreadPool *previousPool = tlsPool;
+    int previousWorker = tlsWorker;
+    if (tlsPool != this) {
+        tlsPool = this;
+        tlsWorker = 0;
+    }
+
+    while (pending_.load(std::memory_order_acquire) > 0) {
+        if (runOne(tlsWorker))
+            continue;
+
+        // Acorda quando a última tarefa termina (runOne) ou quando chega
+        // uma nova para ajudar (push)
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        done_.wait(lock, [this] {
+            return pending_.load(std::memory_order_acquire) == 0 ||
+                   queued_.load(std::memory_order_acquire) > 0;
+        });
+    }
+
+    tlsPool = previousPool;
+    tlsWorker = previousWorker;
+}
+
+void ThreadPool::parallelFor(int begin, int end, int grain,
+                             const void *context, RangeFunction range) {
+    if (end <= begin)
+        return;
+    grain = std::max(1, grain);
+
+    if (queues_.size() == 1 || end - begin <= grain) {
+        range(context, begin, end);
+        return;
+    }
+
+    for (int start = begin; start < end; start += grain) {
+        Task task;
+        task.range = range;
+        task.context = context;
+        task.begin = start;
+        task.end = std::min(end, start + grain);
+        push(std::move(task));
+    }
+    wait();
+}
+
+std::vector<ThreadPool::WorkerStats> ThreadPool::stats() const {
+    double elapsed = (NowNanos() - statsEpochNanos_.load()) * 1e-9;
+
+    std::vector<WorkerStats> result;
+    for (const auto &queue : queues_) {
+        WorkerStats stats;
+        stats.tasks = queue->executed.load(std::memory_order_relaxed);
+        stats.steals = queue->steals.load(std::memory_order_relaxed);
+        stats.busySeconds =
+            queue->busyNanos.load(std::memory_order_relaxed) * 1e-9;
+        stats.utilization = elapsed > 0.0 ? stats.busySeconds / elapsed : 0.0;
+        result.push_back(stats);
+    }
+    return result;
+}
+
+void ThreadPool::resetStats() {
+    for (auto &queue : queues_) {
+        queue->executed = 0;
+        queue->steals = 0;
+        queue->busyNanos = 0;
+    }
+    statsEpochNanos_ = NowNanos();
+}
+
+} // namespace life
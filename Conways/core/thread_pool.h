@@ -0,0 +1,112 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace life {
+
+// Pool persistente com uma fila por worker: cada worker consome a própria
+// fila pelo fim (LIFO) e, quando ela esvazia, rouba do começo da fila dos
+// outros. O worker 0 é a thread que chama wait()/parallelFor(), que ajuda a
+// executar as tarefas em vez de ficar bloqueada; só uma thread externa deve
+// dirigir o pool por vez, e wait() não pode ser chamada de dentro de uma
+// tarefa.
+class ThreadPool {
+public:
+    struct WorkerStats {
+        uint64_t tasks = 0;
+        uint64_t steals = 0;
+        double busySeconds = 0.0;
+        double utilization = 0.0; // busySeconds / tempo desde resetStats()
+    };
+
+    // threads <= 0 usa std::thread::hardware_concurrency()
+    explicit ThreadPool(int threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    int threadCount() const { return (int)queues_.size(); }
+
+    // Pode ser chamada de dentro de uma tarefa: a nova tarefa vai para a
+    // fila do worker atual, de onde os outros podem roubá-la.
+    void submit(std::function<void()> task);
+
+    // Executa tarefas até todas as enviadas terminarem
+    void wait();
+
+    // Divide [begin, end) em blocos de até `grain` itens, executa
+    // body(blockBegin, blockEnd) em paralelo e espera todos terminarem. Cada
+    // bloco é só um ponteiro para o body de quem chamou e o intervalo: não
+    // aloca nada.
+    template <class Body>
+    void parallelFor(int begin, int end, int grain, const Body &body) {
+        parallelFor(begin, end, grain, &body,
+                    [](const void *context, int blockBegin, int blockEnd) {
+                        (*static_cast<const Body *>(context))(blockBegin,
+                                                              blockEnd);
+                    });
+    }
+
+    std::vector<WorkerStats> stats() const;
+    void resetStats();
+
+private:
+    using RangeFunction = void (*)(const void *context, int begin, int end);
+
+    // Um bloco de parallelFor (range com o body do chamador) ou uma função
+    // de submit()
+    struct Task {
+        RangeFunction range = nullptr;
+        const void *context = nullptr;
+        int begin = 0;
+        int end = 0;
+        std::function<void()> function;
+    };
+
+    // Fila circular: cresce dobrando e nunca encolhe, então depois dos
+    // primeiros passos empilhar e tirar tarefas não aloca
+    struct alignas(64) Queue {
+        std::mutex mutex;
+        std::vector<Task> ring;
+        size_t head = 0; // a tarefa mais antiga
+        size_t size = 0;
+        std::atomic<uint64_t> executed{0};
+        std::atomic<uint64_t> steals{0};
+        std::atomic<uint64_t> busyNanos{0};
+
+        // Com o mutex
+        void pushBack(Task task);
+        bool popBack(Task &task);
+        bool popFront(Task &task);
+    };
+
+    void parallelFor(int begin, int end, int grain, const void *context,
+                     RangeFunction range);
+    void push(Task task);
+    bool runOne(int worker);
+    void workerLoop(int worker);
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> threads_;
+
+    std::mutex sleepMutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    std::atomic<int64_t> queued_{0};
+    std::atomic<int64_t> pending_{0};
+    std::atomic<uint32_t> nextQueue_{0};
+    bool stop_ = false;
+
+    std::atomic<int64_t> statsEpochNanos_{0};
+};
+
+} // namespace life
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <atomic>
+
+namespace life {
+
+// Triple buffer sem lock entre um escritor e um leitor. O escritor preenche
+// back() e chama publish(); o leitor chama update() e lê front(). Os dois
+// nunca tocam o mesmo slot: a troca é um exchange atômico do índice do slot
+// do meio, que carrega um bit dizendo se ele tem um valor ainda não lido.
+// Publicar de novo antes do leitor pegar o anterior descarta o anterior.
+template <class T>
+class TripleBuffer {
+public:
+    // Escritor
+    T &back() { return slots_[back_]; }
+    void publish() {
+        back_ = middle_.exchange(back_ | kFresh, std::memory_order_acq_rel) &
+                kIndex;
+    }
+    // true se o leitor já pegou o último publicado
+    bool consumed() const {
+        return !(middle_.load(std::memory_order_relaxed) & kFresh);
+    }
+
+    // Leitor: troca para o último publicado, se houver um novo
+    bool update() {
+        if (consumed())
+            return false;
+        front_ = middle_.exchange(front_, std::memory_order_acq_rel) & kIndex;
+        return true;
+    }
+    T &front() { return slots_[front_]; }
+    const T &front() const { return slots_[front_]; }
+
+private:
+    static constexpr unsigned kIndex = 3;
+    static constexpr unsigned kFresh = 4;
+
+    T slots_[3];
+    unsigned front_ = 0;
+    unsigned back_ = 2;
+    // Índice do slot do meio | kFresh
+    alignas(64) std::atomic<unsigned> middle_{1};
+};
+
+} // namespace life
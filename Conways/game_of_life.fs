@@ -4,37 +4,29 @@ in vec4 fragColor;
 out vec4 finalColor;
 
 uniform sampler2D texture0;
-uniform vec2 resolution;
-uniform float time;
+uniform int birth;
+uniform int survival;
 
+// Lê pelo gl_FragCoord com texelFetch: o texel de saída é o mesmo da
+// entrada, sem depender das coordenadas do quad, e o wrap do toro é o mod
 void main(){
-    vec2 texelSize = vec2(1.0) / resolution;
-    vec2 pos = fragTexCoord;
-
-    float current = texture(texture0, pos).r;
-
-    float neighbors = 
-        texture(texture0, pos + vec2(-texelSize.x, -texelSize.y)).r + // top-left
-        texture(texture0, pos + vec2(0.0, -texelSize.y)).r +         // top
-        texture(texture0, pos + vec2(texelSize.x, -texelSize.y)).r +  // top-right
-        texture(texture0, pos + vec2(-texelSize.x, 0.0)).r +         // left
-        texture(texture0, pos + vec2(texelSize.x, 0.0)).r +          // right
-        texture(texture0, pos + vec2(-texelSize.x, texelSize.y)).r +  // bottom-left
-        texture(texture0, pos + vec2(0.0, texelSize.y)).r +          // bottom
-        texture(texture0, pos + vec2(texelSize.x, texelSize.y)).r;    // bottom-right
-    
-    int iCurrent = int(current + 0.5);
-    int iNeighbors = int(neighbors + 0.5);
-
-
-    float alive = float(iCurrent);
-    float survives = step(1.5, neighbors) * step(neighbors, 3.5) * alive;
-    float born = step(2.5, neighbors) * step(neighbors, 3.5) * (1.0 - alive);
-
-    float nextState = survives + born;
-
-   
-    nextState *= step(0.5, neighbors + current);
+    ivec2 size = textureSize(texture0, 0);
+    ivec2 pos = ivec2(gl_FragCoord.xy);
+
+    int neighbors = 0;
+    for (int dy = -1; dy <= 1; dy++) {
+        for (int dx = -1; dx <= 1; dx++) {
+            if (dx == 0 && dy == 0)
+                continue;
+            ivec2 p = (pos + ivec2(dx, dy) + size) % size;
+            neighbors += int(texelFetch(texture0, p, 0).r > 0.5);
+        }
+    }
+    int current = int(texelFetch(texture0, pos, 0).r > 0.5);
+
+    // Regra B/S: bit n de birth/survival liga o caso de n vizinhos
+    int mask = current == 1 ? survival : birth;
+    float nextState = float((mask >> neighbors) & 1);
 
     finalColor = vec4(nextState, nextState, nextState, 1.0);
 }
@@ -0,0 +1,73 @@
+#version 330
+in vec2 fragTexCoord;
+in vec4 fragColor;
+out vec4 finalColor;
+
+// 32 células por texel RGBA8: o bit j do canal k é a célula 32 * x + 8 * k + j
+uniform sampler2D texture0;
+uniform int width; // em células; o último texel pode estar incompleto
+uniform int birth;
+uniform int survival;
+
+uint Word(int x, int y) {
+    uvec4 b = uvec4(texelFetch(texture0, ivec2(x, y), 0) * 255.0 + 0.5);
+    return b.r | (b.g << 8) | (b.b << 16) | (b.a << 24);
+}
+
+// Somador bit a bit: (s3 s2 s1 s0) conta os vizinhos de cada célula
+uint s0, s1, s2, s3;
+
+void Add(uint x) {
+    uint c0 = s0 & x;
+    s0 ^= x;
+    uint c1 = s1 & c0;
+    s1 ^= c0;
+    uint c2 = s2 & c1;
+    s2 ^= c1;
+    s3 |= c2;
+}
+
+void main(){
+    ivec2 size = textureSize(texture0, 0);
+    ivec2 pos = ivec2(gl_FragCoord.xy);
+    int tail = width - 32 * (size.x - 1); // células no último texel
+    bool first = pos.x == 0;
+    bool last = pos.x == size.x - 1;
+    int left = first ? size.x - 1 : pos.x - 1;
+    int right = last ? 0 : pos.x + 1;
+
+    s0 = s1 = s2 = s3 = 0u;
+    uint center = 0u;
+    for (int dy = -1; dy <= 1; dy++) {
+        int y = (pos.y + dy + size.y) % size.y;
+        uint L = Word(left, y);
+        uint C = Word(pos.x, y);
+        uint R = Word(right, y);
+        // Vizinhos oeste e leste alinhados com cada célula; no toro o oeste
+        // da célula 0 é a célula width-1, no fim do último texel
+        uint west = (C << 1) | (first ? (L >> uint(tail - 1)) & 1u : L >> 31);
+        uint east = (C >> 1) | (last ? (R & 1u) << uint(tail - 1) : R << 31);
+        Add(west);
+        Add(east);
+        if (dy == 0)
+            center = C;
+        else
+            Add(C);
+    }
+
+    // Regra B/S: bit n de birth/survival liga o caso de n vizinhos
+    uint next = 0u;
+    for (int n = 0; n <= 8; n++) {
+        uint eq = ((n & 1) != 0 ? s0 : ~s0) & ((n & 2) != 0 ? s1 : ~s1) &
+                  ((n & 4) != 0 ? s2 : ~s2) & ((n & 8) != 0 ? s3 : ~s3);
+        uint alive = (((survival >> n) & 1) != 0 ? center : 0u) |
+                     (((birth >> n) & 1) != 0 ? ~center : 0u);
+        next |= eq & alive;
+    }
+    // Os bits além de width ficam mortos
+    if (last && tail < 32)
+        next &= (1u << uint(tail)) - 1u;
+
+    finalColor = vec4(uvec4(next, next >> 8, next >> 16, next >> 24) & 255u) /
+                 255.0;
+}
@@ -0,0 +1,17 @@
+#version 330
+in vec2 fragTexCoord;
+in vec4 fragColor;
+out vec4 finalColor;
+
+// Desenha a grade do game_of_life_packed.fs com uma cor por célula
+uniform sampler2D texture0;
+
+void main(){
+    ivec2 size = textureSize(texture0, 0);
+    ivec2 cell = ivec2(fragTexCoord * vec2(size.x * 32, size.y));
+    uvec4 b = uvec4(texelFetch(texture0, ivec2(cell.x >> 5, cell.y), 0) *
+                    255.0 + 0.5);
+    uint channel = b[(cell.x >> 3) & 3];
+    float alive = float((channel >> uint(cell.x & 7)) & 1u);
+    finalColor = vec4(alive, alive, alive, 1.0);
+}
@@ -0,0 +1,304 @@
+#include "gpu_life.h"
+
+#include "rlgl.h"
+
+#include "seed.h"
+#include "simulation.h"
+
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+const char *GpuLayoutName(GpuLayout layout) {
+    return layout == GpuLayout::Packed ? "packed" : "cells";
+}
+
+static bool Fail(std::string *error, const std::string &message) {
+    if (error)
+        *error = message;
+    return false;
+}
+
+// Alvo só com a textura de cor: o LoadRenderTexture também aloca um depth
+// buffer do tamanho da grade, que os passos nunca usam
+static RenderTexture2D LoadGridTarget(int width, int height) {
+    RenderTexture2D target = {};
+    target.id = rlLoadFramebuffer();
+    target.texture.id = rlLoadTexture(nullptr, width, height,
+                                      RL_PIXELFORMAT_UNCOMPRESSED_R8G8B8A8, 1);
+    target.texture.width = width;
+    target.texture.height = height;
+    target.texture.mipmaps = 1;
+    target.texture.format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+
+    rlEnableFramebuffer(target.id);
+    rlFramebufferAttach(target.id, target.texture.id,
+                        RL_ATTACHMENT_COLOR_CHANNEL0, RL_ATTACHMENT_TEXTURE2D,
+                        0);
+    rlFramebufferComplete(target.id); // avisa no log se falhar
+    rlDisableFramebuffer();
+    return target;
+}
+
+bool GpuLife::load(GpuLayout layout, std::string *error) {
+    layout_ = layout;
+    widthLoc_ = -1;
+    if (layout == GpuLayout::Packed) {
+        stepShader_ = LoadShader(0, "./game_of_life_packed.fs");
+        viewShader_ = LoadShader(0, "./packed_view.fs");
+        if (viewShader_.id == 0)
+            return Fail(error, "packed_view.fs não carregou");
+        widthLoc_ = GetShaderLocation(stepShader_, "width");
+    } else {
+        stepShader_ = LoadShader(0, "./game_of_life.fs");
+    }
+    if (stepShader_.id == 0)
+        return Fail(error, "o shader do passo não carregou");
+    birthLoc_ = GetShaderLocation(stepShader_, "birth");
+    survivalLoc_ = GetShaderLocation(stepShader_, "survival");
+    birth_ = survival_ = sentWidth_ = -1;
+    return true;
+}
+
+void GpuLife::resize(int width, int height) {
+    for (RenderTexture2D &target : targets_)
+        if (target.id)
+            UnloadRenderTexture(target);
+    width_ = width;
+    height_ = height;
+    int texels = layout_ == GpuLayout::Packed ? (width + 31) / 32 : width;
+    for (RenderTexture2D &target : targets_)
+        target = LoadGridTarget(texels, height);
+    current_ = 0;
+    next_ = 1;
+    aux_ = 2;
+
+    if (widthLoc_ >= 0 && sentWidth_ != width) {
+        SetShaderValue(stepShader_, widthLoc_, &width, SHADER_UNIFORM_INT);
+        sentWidth_ = width;
+    }
+}
+
+void GpuLife::unload() {
+    for (RenderTexture2D &target : targets_) {
+        if (target.id)
+            UnloadRenderTexture(target);
+        target = RenderTexture2D{};
+    }
+    if (stepShader_.id)
+        UnloadShader(stepShader_);
+    if (viewShader_.id)
+        UnloadShader(viewShader_);
+    stepShader_ = viewShader_ = Shader{};
+}
+
+void GpuLife::setRule(const life::Rule &rule) {
+    int birth = rule.birth;
+    int survival = rule.survival;
+    if (birth != birth_) {
+        SetShaderValue(stepShader_, birthLoc_, &birth, SHADER_UNIFORM_INT);
+        birth_ = birth;
+    }
+    if (survival != survival_) {
+        SetShaderValue(stepShader_, survivalLoc_, &survival,
+                       SHADER_UNIFORM_INT);
+        survival_ = survival;
+    }
+}
+
+void GpuLife::step(int generations) {
+    if (generations <= 0)
+        return;
+    BeginTextureMode(targets_[next_]);
+    // No layout Packed o alfa também é dado: o passo substitui o texel sem
+    // misturar com o destino
+    rlDisableColorBlend();
+    BeginShaderMode(stepShader_);
+    for (int g = 0; g < generations; g++) {
+        if (g > 0) {
+            // Manda o passo anterior e troca só o framebuffer: viewport e
+            // projeção são os mesmos nas três texturas
+            rlDrawRenderBatchActive();
+            rlEnableFramebuffer(targets_[next_].id);
+        }
+        // Os shaders leem pelo gl_FragCoord, então basta cobrir o alvo
+        const Texture2D &source = targets_[current_].texture;
+        DrawTextureRec(source,
+                       {0, 0, (float)source.width, (float)source.height},
+                       {0, 0}, WHITE);
+        if (tripleBuffering_) {
+            int temp = aux_;
+            aux_ = current_;
+            current_ = next_;
+            next_ = temp;
+        } else {
+            std::swap(current_, next_);
+        }
+    }
+    EndShaderMode();
+    rlEnableColorBlend();
+    EndTextureMode();
+}
+
+void GpuLife::clear() {
+    BeginTextureMode(targets_[current_]);
+    ClearBackground(layout_ == GpuLayout::Packed ? BLANK : BLACK);
+    EndTextureMode();
+}
+
+void GpuLife::upload(const life::Grid &grid, int x, int y) {
+    if (layout_ == GpuLayout::Cells) {
+        Image image = GenImageColor(grid.width(), grid.height(), BLACK);
+        Color *pixels = (Color *)image.data;
+        for (int gy = 0; gy < grid.height(); gy++)
+            for (int gx = 0; gx < grid.width(); gx++)
+                if (grid.get(gx, gy))
+                    pixels[(size_t)gy * grid.width() + gx] = WHITE;
+
+        Texture2D pattern = LoadTextureFromImage(image);
+        UnloadImage(image);
+
+        BeginTextureMode(targets_[current_]);
+        ClearBackground(BLACK);
+        DrawTexture(pattern, x, y, WHITE);
+        EndTextureMode();
+        UnloadTexture(pattern);
+        return;
+    }
+
+    // Packed: a grade vai pronta para o texel, palavra de 64 bits em dois
+    // texels, sem passar por desenho
+    life::Grid placed;
+    const life::Grid *source = &grid;
+    if (x != 0 || y != 0 || grid.width() != width_ ||
+        grid.height() != height_) {
+        placed = life::Grid(width_, height_);
+        for (int gy = 0; gy < grid.height(); gy++)
+            for (int gx = 0; gx < grid.width(); gx++)
+                if (grid.get(gx, gy) && x + gx >= 0 && x + gx < width_ &&
+                    y + gy >= 0 && y + gy < height_)
+                    placed.set(x + gx, y + gy, true);
+        source = &placed;
+    }
+    int texels = targets_[current_].texture.width;
+    std::vector<unsigned char> bytes((size_t)texels * height_ * 4);
+    for (int ty = 0; ty < height_; ty++) {
+        const uint64_t *row = source->row(ty);
+        unsigned char *out = &bytes[(size_t)ty * texels * 4];
+        for (int tx = 0; tx < texels; tx++) {
+            uint32_t word = (uint32_t)(row[tx >> 1] >> (32 * (tx & 1)));
+            for (int k = 0; k < 4; k++)
+                out[tx * 4 + k] = (unsigned char)(word >> (8 * k));
+        }
+    }
+    UpdateTexture(targets_[current_].texture, bytes.data());
+}
+
+life::Grid GpuLife::download() const {
+    Image image = LoadImageFromTexture(targets_[current_].texture);
+    ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    life::Grid grid(width_, height_);
+    const unsigned char *bytes = (const unsigned char *)image.data;
+
+    if (layout_ == GpuLayout::Cells) {
+        // A textura de render fica de cabeça para baixo em relação à tela
+        for (int y = 0; y < height_; y++) {
+            const unsigned char *row =
+                bytes + (size_t)(height_ - 1 - y) * width_ * 4;
+            for (int x = 0; x < width_; x++)
+                if (row[x * 4] > 127)
+                    grid.set(x, y, true);
+        }
+    } else {
+        int texels = image.width;
+        for (int y = 0; y < height_; y++) {
+            const unsigned char *in = bytes + (size_t)y * texels * 4;
+            uint64_t *row = grid.row(y);
+            for (int tx = 0; tx < texels; tx++) {
+                uint64_t word = (uint64_t)in[tx * 4] |
+                                (uint64_t)in[tx * 4 + 1] << 8 |
+                                (uint64_t)in[tx * 4 + 2] << 16 |
+                                (uint64_t)in[tx * 4 + 3] << 24;
+                row[tx >> 1] |= word << (32 * (tx & 1));
+            }
+            // O shader zera os bits além de width; a grade exige isso
+            if (width_ % 64)
+                row[grid.words() - 1] &= ~0ull >> (64 - width_ % 64);
+        }
+    }
+    UnloadImage(image);
+    return grid;
+}
+
+void GpuLife::draw() const {
+    const Texture2D &texture = targets_[current_].texture;
+    if (layout_ == GpuLayout::Cells) {
+        DrawTextureRec(texture,
+                       {0, 0, (float)texture.width, -(float)texture.height},
+                       {0, 0}, WHITE);
+        return;
+    }
+    // O packed_view.fs tira o bit da célula; a fonte cobre só as width
+    // células, sem o fim do último texel
+    BeginShaderMode(viewShader_);
+    DrawTexturePro(texture, {0, 0, width_ / 32.0f, (float)height_},
+                   {0, 0, (float)width_, (float)height_}, {0, 0}, 0.0f,
+                   WHITE);
+    EndShaderMode();
+}
+
+int RunGpuSelfTest(int width, int height) {
+    struct Size {
+        int width, height;
+    };
+    // A largura ímpar deixa o último texel do layout Packed pela metade
+    const Size sizes[] = {{width, height}, {1000, 777}};
+    life::Rule rules[2];
+    life::ParseRule("B36/S23", rules[1]); // HighLife
+    const int batches[] = {1, 10, 64};
+
+    int failures = 0;
+    for (GpuLayout layout : {GpuLayout::Cells, GpuLayout::Packed}) {
+        GpuLife gpu;
+        std::string error;
+        if (!gpu.load(layout, &error)) {
+            printf("ERRO: %s\n", error.c_str());
+            failures++;
+            gpu.unload();
+            continue;
+        }
+        for (const Size &size : sizes) {
+            gpu.resize(size.width, size.height);
+            // A grade ímpar também passa pelas três texturas
+            gpu.setTripleBuffering(&size != &sizes[0]);
+            for (const life::Rule &rule : rules) {
+                life::SeedOptions options;
+                options.seed = 1234;
+                options.density = 0.3f;
+                life::Grid grid(size.width, size.height);
+                life::SeedGrid(grid, options);
+
+                gpu.setRule(rule);
+                gpu.upload(grid, 0, 0);
+                life::Simulation sim(grid);
+                sim.setRule(rule);
+                const life::Simulation &view = sim;
+                for (int batch : batches) {
+                    gpu.step(batch);
+                    sim.step(batch);
+                    bool ok = gpu.download() == view.grid();
+                    printf("%-6s %5dx%-5d %-8s +%-2d -> gen %3llu: %s\n",
+                           GpuLayoutName(layout), size.width, size.height,
+                           life::RuleName(rule).c_str(), batch,
+                           (unsigned long long)sim.generation(),
+                           ok ? "OK" : "MISMATCH");
+                    failures += !ok;
+                }
+            }
+        }
+        gpu.unload();
+    }
+    printf("GPU self-test: %s (%d failures)\n", failures ? "FAILED" : "OK",
+           failures);
+    return failures;
+}
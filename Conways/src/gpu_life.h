@@ -0,0 +1,84 @@
+#pragma once
+
+#include "raylib.h"
+
+#include "grid.h"
+#include "rule.h"
+
+#include <string>
+
+// Layout da grade nas texturas da GPU:
+//  - Cells: um texel RGBA8 por célula (vermelho > 0.5 = viva), com a linha
+//    y da CPU na linha height-1-y da textura, como o desenho do raylib
+//    deixa as texturas de render;
+//  - Packed: 32 células por texel RGBA8, 8 por canal. O bit j do byte k do
+//    texel x é a célula 32 * x + 8 * k + j, e a linha y da textura é a
+//    linha y da CPU. Os bits além de width ficam zerados.
+enum class GpuLayout { Cells, Packed };
+
+const char *GpuLayoutName(GpuLayout layout);
+
+// A grade na GPU: três texturas persistentes (a atual, a próxima e a extra
+// do triple buffering) e os shaders, com as posições dos uniforms lidas uma
+// vez no load() e os valores reenviados só quando mudam. Os passos escrevem
+// todos os texels, então as texturas nunca são limpas antes de um passo.
+class GpuLife {
+public:
+    // Carrega os shaders do layout (./game_of_life.fs, ou
+    // ./game_of_life_packed.fs e ./packed_view.fs)
+    bool load(GpuLayout layout, std::string *error);
+    // Realoca as texturas para width x height; o conteúdo fica indefinido
+    // até um upload() ou clear()
+    void resize(int width, int height);
+    void unload();
+
+    GpuLayout layout() const { return layout_; }
+    int width() const { return width_; }
+    int height() const { return height_; }
+    // Textura com a geração atual (para desenhar nela no layout Cells)
+    RenderTexture2D *current() { return &targets_[current_]; }
+    const RenderTexture2D &current() const { return targets_[current_]; }
+
+    void setRule(const life::Rule &rule);
+    void setTripleBuffering(bool enabled) { tripleBuffering_ = enabled; }
+
+    // generations passos num único BeginTextureMode, alternando as
+    // texturas entre um passo e outro
+    void step(int generations);
+
+    void clear();
+    // Copia a grade com o canto superior esquerdo em (x, y); o resto fica
+    // morto e o que passar da borda é cortado
+    void upload(const life::Grid &grid, int x, int y);
+    life::Grid download() const;
+
+    // Desenha a grade em (0, 0) com uma unidade por célula
+    void draw() const;
+
+private:
+    GpuLayout layout_ = GpuLayout::Cells;
+    Shader stepShader_ = {};
+    Shader viewShader_ = {}; // só no layout Packed
+    int birthLoc_ = -1;
+    int survivalLoc_ = -1;
+    int widthLoc_ = -1;
+    // Valores já enviados aos shaders (-1: nenhum)
+    int birth_ = -1;
+    int survival_ = -1;
+    int sentWidth_ = -1;
+
+    RenderTexture2D targets_[3] = {};
+    int current_ = 0;
+    int next_ = 1;
+    int aux_ = 2;
+    int width_ = 0;
+    int height_ = 0;
+    bool tripleBuffering_ = false;
+};
+
+// Confere o shader de cada layout contra life::Simulation em grades do
+// tamanho dado e numa de largura ímpar, com Life e HighLife e lotes de 1,
+// 10 e 64 gerações. Imprime uma linha por caso e devolve o número de falhas.
+// Roda em qualquer contexto OpenGL 3.3, inclusive o llvmpipe
+// (LIBGL_ALWAYS_SOFTWARE=1).
+int RunGpuSelfTest(int width, int height);
@@ -0,0 +1,186 @@
+#include "lod_view.h"
+
+#include "rlgl.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Brilho de um bloco com count células vivas: a raiz da densidade, com um
+// mínimo para um bloco quase vazio ainda aparecer
+static unsigned char DensityByte(uint32_t count, float area) {
+    if (!count)
+        return 0;
+    float density = std::min(1.0f, count / area);
+    return (unsigned char)(48.0f + 207.0f * std::sqrt(density));
+}
+
+bool LodView::load(std::string *error) {
+    packedShader_ = LoadShader(0, "./packed_view.fs");
+    if (packedShader_.id == 0) {
+        if (error)
+            *error = "packed_view.fs não carregou";
+        return false;
+    }
+    return true;
+}
+
+void LodView::unload() {
+    if (texture_.id)
+        UnloadTexture(texture_);
+    if (packedShader_.id)
+        UnloadShader(packedShader_);
+    texture_ = Texture2D{};
+    packedShader_ = Shader{};
+    level_ = -2;
+}
+
+void LodView::sync(const life::DensityPyramid &pyramid,
+                   const Camera2D &camera, int screenWidth, int screenHeight,
+                   bool updated) {
+    uploaded_ = 0;
+    if (!pyramid.levels())
+        return;
+    const life::Grid &grid = *pyramid.grid();
+    gridWidth_ = grid.width();
+    gridHeight_ = grid.height();
+
+    // O nível cujo bloco ainda cabe num pixel; perto, as próprias células
+    const int base = life::DensityPyramid::kBaseBlock;
+    float cellsPerPixel = 1.0f / camera.zoom;
+    int level = -1;
+    if (cellsPerPixel >= base)
+        level = std::min((int)std::floor(std::log2(cellsPerPixel / base)),
+                         pyramid.levels() - 1);
+    // Tamanho do texel em células e do nível em texels
+    int unitX = level < 0 ? 32 : pyramid.blockSize(level);
+    int unitY = level < 0 ? 1 : unitX;
+    int width = level < 0 ? (gridWidth_ + 31) / 32 : pyramid.width(level);
+    int height = level < 0 ? gridHeight_ : pyramid.height(level);
+
+    Vector2 topLeft = GetScreenToWorld2D({0, 0}, camera);
+    Vector2 bottomRight = GetScreenToWorld2D(
+        {(float)screenWidth, (float)screenHeight}, camera);
+    auto tileFloor = [](float cells, int unit, int limit) {
+        int texel = (int)std::floor(cells / unit);
+        texel = std::clamp(texel, 0, limit);
+        return texel - texel % kTile;
+    };
+    auto tileCeil = [](float cells, int unit, int limit) {
+        int texel = (int)std::ceil(cells / unit);
+        texel = std::clamp(texel, 0, limit);
+        return std::min(limit, (texel + kTile - 1) / kTile * kTile);
+    };
+    int x0 = tileFloor(topLeft.x, unitX, width);
+    int y0 = tileFloor(topLeft.y, unitY, height);
+    int x1 = tileCeil(bottomRight.x, unitX, width);
+    int y1 = tileCeil(bottomRight.y, unitY, height);
+
+    bool fresh = level != level_ || x0 != x0_ || y0 != y0_ || x1 != x1_ ||
+                 y1 != y1_;
+    level_ = level;
+    block_ = unitX;
+    x0_ = x0;
+    y0_ = y0;
+    x1_ = x1;
+    y1_ = y1;
+    if (x0 >= x1 || y0 >= y1 || (!fresh && !updated))
+        return;
+
+    if (fresh) {
+        // A textura só cresce; uma maior que a região é usada em parte
+        int format = level < 0 ? PIXELFORMAT_UNCOMPRESSED_R8G8B8A8
+                               : PIXELFORMAT_UNCOMPRESSED_GRAYSCALE;
+        if (!texture_.id || texture_.format != format ||
+            texture_.width < x1 - x0 || texture_.height < y1 - y0) {
+            int textureWidth = std::max(x1 - x0, texture_.width);
+            int textureHeight = std::max(y1 - y0, texture_.height);
+            if (texture_.id)
+                UnloadTexture(texture_);
+            texture_.id =
+                rlLoadTexture(nullptr, textureWidth, textureHeight, format, 1);
+            texture_.width = textureWidth;
+            texture_.height = textureHeight;
+            texture_.mipmaps = 1;
+            texture_.format = format;
+            // A densidade tem até 2 texels por pixel: a média de 2x2 ajuda
+            SetTextureFilter(texture_, level < 0 ? TEXTURE_FILTER_POINT
+                                                 : TEXTURE_FILTER_BILINEAR);
+        }
+    }
+
+    for (int ty = y0; ty < y1; ty += kTile) {
+        for (int tx = x0; tx < x1; tx += kTile) {
+            if (!fresh) {
+                // Blocos de 8x8 do nível 0 que a tile de células cobre
+                bool dirty =
+                    level < 0
+                        ? pyramid.anyDirty(0, tx * 32 / base, ty / base,
+                                           (tx + kTile) * 32 / base,
+                                           (ty + kTile + base - 1) / base)
+                        : pyramid.anyDirty(level, tx, ty, tx + kTile,
+                                           ty + kTile);
+                if (!dirty)
+                    continue;
+            }
+            uploadTile(pyramid, tx, ty);
+        }
+    }
+}
+
+void LodView::uploadTile(const life::DensityPyramid &pyramid, int tx,
+                         int ty) {
+    int w = std::min(kTile, x1_ - tx);
+    int h = std::min(kTile, y1_ - ty);
+    int bytesPerTexel = level_ < 0 ? 4 : 1;
+    staging_.resize((size_t)w * h * bytesPerTexel);
+    unsigned char *out = staging_.data();
+
+    if (level_ < 0) {
+        // 32 células por texel, como o GpuLife::upload do layout Packed
+        const life::Grid &grid = *pyramid.grid();
+        for (int y = ty; y < ty + h; y++) {
+            const uint64_t *row = grid.row(y);
+            for (int x = tx; x < tx + w; x++) {
+                uint32_t word = (uint32_t)(row[x >> 1] >> (32 * (x & 1)));
+                for (int k = 0; k < 4; k++)
+                    *out++ = (unsigned char)(word >> (8 * k));
+            }
+        }
+    } else {
+        float area = (float)block_ * block_;
+        for (int y = ty; y < ty + h; y++) {
+            const uint32_t *counts = pyramid.counts(level_, y);
+            for (int x = tx; x < tx + w; x++)
+                *out++ = DensityByte(counts[x], area);
+        }
+    }
+    UpdateTextureRec(texture_,
+                     {(float)(tx - x0_), (float)(ty - y0_), (float)w,
+                      (float)h},
+                     staging_.data());
+    uploaded_ += staging_.size();
+}
+
+void LodView::draw() const {
+    if (level_ < -1 || !texture_.id || x0_ >= x1_ || y0_ >= y1_)
+        return;
+    if (level_ < 0) {
+        // Célula a célula pelo packed_view.fs, sem o fim do último texel
+        float left = (float)x0_ * 32;
+        float width = std::min((float)x1_ * 32, (float)gridWidth_) - left;
+        float height = (float)(y1_ - y0_);
+        BeginShaderMode(packedShader_);
+        DrawTexturePro(texture_, {0, 0, width / 32, height},
+                       {left, (float)y0_, width, height}, {0, 0}, 0.0f,
+                       WHITE);
+        EndShaderMode();
+        return;
+    }
+    // Os blocos da borda da grade ficam cortados no tamanho dela
+    float left = (float)x0_ * block_;
+    float top = (float)y0_ * block_;
+    float width = std::min((float)x1_ * block_, (float)gridWidth_) - left;
+    float height = std::min((float)y1_ * block_, (float)gridHeight_) - top;
+    DrawTexturePro(texture_, {0, 0, width / block_, height / block_},
+                   {left, top, width, height}, {0, 0}, 0.0f, WHITE);
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "raylib.h"
+
+#include "density.h"
+
+#include <string>
+#include <vector>
+
+// Desenho da grade da CPU (Conways --cpu) limitado pela tela: só a parte
+// visível sobe para a GPU, e na resolução que a tela usa. Com até 8 células
+// por pixel a região vai célula a célula, empacotada como no layout Packed
+// (packed_view.fs); mais longe, vai o nível da DensityPyramid cujo bloco
+// cabe num pixel, um byte de densidade por bloco. Assim a textura tem no
+// máximo uns 4 texels por pixel da tela, qualquer que seja a grade.
+//
+// A região é alinhada a tiles de kTile x kTile texels. Enquanto o nível e a
+// região não mudam, uma geração nova só reenvia as tiles com algum bloco
+// sujo na pirâmide.
+class LodView {
+public:
+    static constexpr int kTile = 64;
+
+    bool load(std::string *error);
+    void unload();
+
+    // Acerta a textura para a câmera. updated: a pirâmide recebeu uma
+    // geração nova desde a última chamada.
+    void sync(const life::DensityPyramid &pyramid, const Camera2D &camera,
+              int screenWidth, int screenHeight, bool updated);
+    // Desenha a região no espaço da grade (dentro do BeginMode2D)
+    void draw() const;
+
+    // -1 para células, ou o nível da pirâmide
+    int level() const { return level_; }
+    // Bytes enviados à GPU no último sync
+    size_t uploadedBytes() const { return uploaded_; }
+
+private:
+    void uploadTile(const life::DensityPyramid &pyramid, int tx, int ty);
+
+    Shader packedShader_ = {};
+    Texture2D texture_ = {};
+    std::vector<unsigned char> staging_;
+
+    int level_ = -2; // -2: nada carregado
+    // Região na textura, em texels do nível: [x0_, x1_) x [y0_, y1_)
+    int x0_ = 0;
+    int y0_ = 0;
+    int x1_ = 0;
+    int y1_ = 0;
+    int block_ = 1; // lado do bloco do nível, em células
+    int gridWidth_ = 0;
+    int gridHeight_ = 0;
+    size_t uploaded_ = 0;
+};
@@ -1,8 +1,25 @@
 #include "raylib.h"
+
+#include "bench.h"
+#include "checkpoint.h"
+#include "density.h"
+#include "gpu_life.h"
+#include "lod_view.h"
+#include "pattern_io.h"
+#include "profiler.h"
+#include "rule.h"
+#include "seed.h"
+#include "sim_thread.h"
+#include "simulation.h"
+
+#include <algorithm>
 #include <cmath>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <ctime>
+#include <functional>
+#include <memory>
 
 float GenerateRandomSeed() { return (float)rand() / RAND_MAX; }
 
@@ -36,7 +53,145 @@ void GenerateRandomGridGPU(RenderTexture2D *texture, Shader generationShader,
     EndTextureMode();
 }
 
-int main() {
+// Espera a GPU terminar o que foi enviado: desenha a textura num alvo 1x1 e
+// lê esse pixel de volta, o que só retorna depois dos comandos anteriores
+void WaitGPU(RenderTexture2D *probe, const RenderTexture2D &texture) {
+    BeginTextureMode(*probe);
+    DrawTexturePro(texture.texture,
+                   {0, 0, (float)texture.texture.width,
+                    (float)texture.texture.height},
+                   {0, 0, 1, 1}, {0, 0}, 0.0f, WHITE);
+    EndTextureMode();
+    Image pixel = LoadImageFromTexture(probe->texture);
+    UnloadImage(pixel);
+}
+
+// Conways --bench: as cargas do conways-bench no shader, na grade atual, com
+// o mesmo JSON. Cada geração é sincronizada para medir a latência.
+void RunGPUBench(const char *path, GpuLife &gpu, int generations) {
+    RenderTexture2D probe = LoadRenderTexture(1, 1);
+    life::ThreadPool pool;
+    std::string engine = gpu.layout() == GpuLayout::Packed ? "gpu-packed"
+                                                           : "gpu";
+
+    std::vector<life::BenchResult> results;
+    const life::BenchWorkload workloads[] = {
+        life::BenchWorkload::RPentomino, life::BenchWorkload::GosperField,
+        life::BenchWorkload::Soup, life::BenchWorkload::SettledSoup};
+    for (life::BenchWorkload workload : workloads) {
+        gpu.upload(life::MakeBenchGrid(workload, gpu.width(), gpu.height(),
+                                       1000, &pool),
+                   0, 0);
+
+        life::BenchResult result;
+        result.workload = life::BenchWorkloadName(workload);
+        result.engine = engine;
+        result.width = gpu.width();
+        result.height = gpu.height();
+        WaitGPU(&probe, *gpu.current());
+        double start = GetTime();
+        for (int g = 0; g < generations; g++) {
+            double t0 = GetTime();
+            gpu.step(1);
+            WaitGPU(&probe, *gpu.current());
+            result.stepSeconds.push_back(GetTime() - t0);
+        }
+        result.seconds = GetTime() - start;
+        result.generations = generations;
+        result.population = gpu.download().population();
+        result.peakRssBytes = life::PeakRssBytes();
+        printf("%-13s %dx%d %s: %.3e cells/s, p50 %.3f ms\n",
+               result.workload.c_str(), gpu.width(), gpu.height(),
+               engine.c_str(),
+               (double)gpu.width() * gpu.height() * generations /
+                   result.seconds,
+               life::Percentile(result.stepSeconds, 0.5) * 1e3);
+        results.push_back(std::move(result));
+    }
+
+    UnloadRenderTexture(probe);
+
+    FILE *out = fopen(path, "w");
+    if (!out) {
+        printf("ERRO: não foi possível abrir %s\n", path);
+        return;
+    }
+    life::WriteBenchJson(out, "", engine.c_str(), 1, results);
+    fclose(out);
+    printf("Benchmark salvo em %s\n", path);
+}
+
+// Destino das grades geradas e carregadas: a textura atual, ou a simulação
+// da CPU com --cpu. A grade vai com o canto superior esquerdo em (x, y).
+using PlaceGrid = std::function<void(const life::Grid &, int, int)>;
+
+// Mesmos padrões do generation.fs, sorteados na CPU a partir de uma semente:
+// a mesma semente dá a mesma sopa em qualquer máquina
+void GenerateSeededGrid(int gridWidth, int gridHeight, float density,
+                        int pattern, uint64_t seed, const PlaceGrid &place) {
+    life::SeedOptions options;
+    options.seed = seed;
+    options.density = density;
+    options.pattern = (life::SeedPattern)pattern;
+    life::Grid grid(gridWidth, gridHeight);
+    life::ThreadPool pool;
+    life::SeedGrid(grid, options, &pool);
+    place(grid, 0, 0);
+    printf("Seed: %llu (%s, density %.2f)\n", (unsigned long long)seed,
+           life::SeedPatternName(options.pattern), density);
+}
+
+// Carrega um .rle/.cells/.snap centralizado em (centerX, centerY). A regra
+// da janela não muda: um RLE que pede outra só gera um aviso.
+bool LoadPatternFile(const char *path, int gridWidth, int gridHeight,
+                     int centerX, int centerY, const life::Rule &rule,
+                     const PlaceGrid &place) {
+    life::Grid pattern;
+    std::string patternRule;
+    std::string error;
+    if (!life::LoadPattern(path, pattern, nullptr, &patternRule, &error)) {
+        printf("ERRO: %s\n", error.c_str());
+        return false;
+    }
+    life::Rule wanted;
+    if (!patternRule.empty() &&
+        (!life::ParseRule(patternRule.c_str(), wanted) || wanted != rule))
+        printf("AVISO: %s pede a regra %s; rodando %s\n", path,
+               patternRule.c_str(), life::RuleString(rule).c_str());
+    // Um snapshot do tamanho da grade volta na mesma posição
+    bool fullGrid = pattern.width() == gridWidth &&
+                    pattern.height() == gridHeight;
+    int x = fullGrid ? 0 : centerX - pattern.width() / 2;
+    int y = fullGrid ? 0 : centerY - pattern.height() / 2;
+    place(pattern, x, y);
+    printf("Padrão %s: %dx%d, população %llu\n", path, pattern.width(),
+           pattern.height(), (unsigned long long)pattern.population());
+    return true;
+}
+
+// Estado estável na janela: a cada kSteadySpacing gerações (no máximo uma
+// vez por segundo) a grade é lida da GPU e o hash comparado com o da amostra
+// anterior. Se a grade se repetiu, o período divide a distância entre as
+// duas; 60 cobre os períodos 1, 2, 3, 4, 5, 6, 10, 12, 15 e 30.
+const int kSteadySpacing = 60;
+
+// Gerações por lote no loop da janela
+const int kMaxBatch = 64;
+
+// Período exato de uma grade que já se repete, rodando na CPU até o
+// período aparecer e ser conferido (2 * maxPeriod gerações); 0 se for maior
+uint64_t FindPeriodCPU(const life::Grid &grid, const life::Rule &rule,
+                       int maxPeriod) {
+    life::Simulation sim(grid);
+    sim.setRule(rule);
+    sim.setThreadCount(0);
+    sim.setActivityTracking(true);
+    sim.setCycleDetection(maxPeriod);
+    sim.step(2 * (uint64_t)maxPeriod);
+    return sim.cycles().found() ? sim.cycles().period() : 0;
+}
+
+int main(int argc, char **argv) {
     const int screenWidth = 1200;
     const int screenHeight = 1000;
 
@@ -64,61 +219,229 @@ int main() {
     camera.rotation = 0.0f;
     camera.zoom = 1.0f;
 
-    // Usa formato otimizado para texturas (R8 ao invés de RGBA8)
-    // Economiza 75% da memória de vídeo
-    RenderTexture2D textureA = LoadRenderTexture(gridWidth, gridHeight);
-    RenderTexture2D textureB = LoadRenderTexture(gridWidth, gridHeight);
-    RenderTexture2D textureC = LoadRenderTexture(
-        gridWidth, gridHeight); // Buffer extra para triple buffering
-
-    RenderTexture2D *current = &textureA;
-    RenderTexture2D *next = &textureB;
-    RenderTexture2D *aux = &textureC;
-
-    // Carrega shaders otimizados
-    Shader gameShader = LoadShader(0, "./game_of_life.fs");
-    Shader generationShader = LoadShader(0, "./generation.fs");
+    // Linha de comando: [padrão] [--resume] [--seed N] [--rule RULE]
+    // [--bench FILE] [--packed] [--cpu] [--gpu-selftest]
+    // [--profile-trace FILE] [--metrics FILE]
+    const char *patternPath = nullptr;
+    const char *benchPath = nullptr;
+    const char *tracePath = nullptr;
+    const char *metricsPath = nullptr;
+    bool resume = false;
+    bool seeded = false;
+    uint64_t seed = 0;
+    life::Rule rule;
+    GpuLayout layout = GpuLayout::Cells;
+    bool selfTest = false;
+    bool cpuEngine = false;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--resume")) {
+            resume = true;
+        } else if (!strcmp(argv[i], "--rule") && i + 1 < argc) {
+            std::string error;
+            if (!life::ParseRule(argv[++i], rule, &error)) {
+                printf("ERRO: %s\n", error.c_str());
+                return -1;
+            }
+        } else if (!strcmp(argv[i], "--bench") && i + 1 < argc) {
+            benchPath = argv[++i];
+        } else if (!strcmp(argv[i], "--seed") && i + 1 < argc) {
+            seed = strtoull(argv[++i], nullptr, 0);
+            seeded = true;
+        } else if (!strcmp(argv[i], "--packed")) {
+            layout = GpuLayout::Packed;
+        } else if (!strcmp(argv[i], "--cpu")) {
+            cpuEngine = true;
+        } else if (!strcmp(argv[i], "--profile-trace") && i + 1 < argc) {
+            tracePath = argv[++i];
+        } else if (!strcmp(argv[i], "--metrics") && i + 1 < argc) {
+            metricsPath = argv[++i];
+        } else if (!strcmp(argv[i], "--gpu-selftest")) {
+            selfTest = true;
+        } else {
+            patternPath = argv[i];
+        }
+    }
 
-    if (gameShader.id == 0) {
-        printf("ERRO: Game shader não carregou!\n");
+    if (cpuEngine && benchPath) {
+        printf("ERRO: --bench mede os shaders e não combina com --cpu "
+               "(use conways-bench)\n");
         return -1;
     }
-    if (generationShader.id == 0) {
-        printf("ERRO: Generation shader não carregou!\n");
-        return -1;
+
+    // Shaders e as três texturas da grade, alocadas uma vez e reusadas a
+    // cada passo. No --cpu nada disso é usado: quem desenha é o LodView e as
+    // sopas saem da CPU, então nenhuma chamada à GpuLife passa do
+    // self-test.
+    GpuLife gpu;
+    Shader generationShader = {};
+    std::string shaderError;
+    if (!cpuEngine || selfTest) {
+        if (!gpu.load(layout, &shaderError)) {
+            printf("ERRO: %s\n", shaderError.c_str());
+            return -1;
+        }
+        generationShader = LoadShader(0, "./generation.fs");
+        if (generationShader.id == 0) {
+            printf("ERRO: Generation shader não carregou!\n");
+            return -1;
+        }
+        printf("Shaders carregados com sucesso!\n");
     }
 
-    printf("Shaders carregados com sucesso!\n");
+    if (selfTest) {
+        int failures = RunGpuSelfTest(gridWidth, gridHeight);
+        gpu.unload();
+        UnloadShader(generationShader);
+        CloseWindow();
+        return failures ? -1 : 0;
+    }
 
-    srand((unsigned int)time(NULL));
-    GenerateRandomGridGPU(current, generationShader, gridWidth, gridHeight,
-                          0.25f, 0);
+    if (!cpuEngine) {
+        gpu.resize(gridWidth, gridHeight);
+        gpu.setRule(rule);
+    }
 
-    BeginTextureMode(*next);
-    ClearBackground(BLACK);
-    EndTextureMode();
-    BeginTextureMode(*aux);
-    ClearBackground(BLACK);
-    EndTextureMode();
+    if (benchPath) {
+        RunGPUBench(benchPath, gpu, 200);
+        gpu.unload();
+        UnloadShader(generationShader);
+        CloseWindow();
+        return 0;
+    }
+
+    // Trechos render e upload aqui, e os da simulação no --cpu; o
+    // Prometheus é regravado a cada 5 s e o trace sai no fim
+    std::unique_ptr<life::MetricsExporter> metrics;
+    if (tracePath || metricsPath) {
+        life::SetProfileThreadName("main");
+        life::ProfileOptions options;
+        options.generations = true;
+        options.trace = tracePath != nullptr;
+        life::StartProfiling(options);
+    }
+    if (metricsPath)
+        metrics = std::make_unique<life::MetricsExporter>(metricsPath, 5.0);
 
     bool running = false;
     bool showGrid = true;
     bool showBounds = true;
     bool enableTripleBuffering = false;
+    bool unlimitedSpeed = false;
     float gameTimer = 0.0f;
     float gameSpeed = 240.0f; // Inicializa em 240 UPS
     float panSpeed = 200.0f;
     float randomDensity = 0.25f;
     int generationPattern = 0;
 
+    // --cpu: a simulação roda numa thread própria, o mais rápido que o alvo
+    // de UPS deixar, e a janela desenha a geração mais nova que ela
+    // publicou, sem nunca esperar por ela
+    std::unique_ptr<life::SimThread> simThread;
+    auto startSimThread = [&]() {
+        simThread.reset();
+        simThread = std::make_unique<life::SimThread>(
+            life::Grid(gridWidth, gridHeight), rule);
+        // Um glider leva 4 * lado gerações para dar a volta no toro
+        int maxPeriod = 4 * std::max(gridWidth, gridHeight);
+        simThread->edit([maxPeriod](life::Simulation &sim) {
+            sim.setCycleDetection(maxPeriod);
+        });
+    };
+    // No --cpu a janela desenha pela pirâmide de densidade, subindo só a
+    // parte visível da grade
+    life::DensityPyramid pyramid;
+    std::unique_ptr<life::ThreadPool> pyramidPool;
+    LodView lodView;
+    if (cpuEngine) {
+        if (!lodView.load(&shaderError)) {
+            printf("ERRO: %s\n", shaderError.c_str());
+            CloseWindow();
+            return -1;
+        }
+        pyramidPool = std::make_unique<life::ThreadPool>();
+        startSimThread();
+    }
+
+    PlaceGrid placeGrid = [&](const life::Grid &grid, int x, int y) {
+        if (!simThread) {
+            life::ProfileScope scope(life::ProfileZone::Upload);
+            gpu.upload(grid, x, y);
+            return;
+        }
+        life::Grid placed(gridWidth, gridHeight);
+        placed.paste(grid, x, y);
+        simThread->edit([placed = std::move(placed)](
+                            life::Simulation &sim) mutable {
+            sim.grid() = std::move(placed);
+        });
+    };
+    auto loadPattern = [&](const char *path, int centerX, int centerY) {
+        return LoadPatternFile(path, gridWidth, gridHeight, centerX, centerY,
+                               rule, placeGrid);
+    };
+
+    // Com --seed as sopas saem da CPU e são reproduzíveis; sem, a GPU gera
+    // com uma semente nova a cada vez. O generation.fs escreve uma célula por
+    // texel, então no layout Packed a sopa sai sempre da CPU; no --cpu
+    // também, direto para a SimThread.
+    auto regenerate = [&]() {
+        if (cpuEngine || seeded || layout == GpuLayout::Packed)
+            GenerateSeededGrid(gridWidth, gridHeight, randomDensity,
+                               generationPattern,
+                               seeded ? seed : life::RandomSeed(), placeGrid);
+        else
+            GenerateRandomGridGPU(gpu.current(), generationShader, gridWidth,
+                                  gridHeight, randomDensity,
+                                  generationPattern);
+    };
+
+    srand((unsigned int)time(NULL));
+    regenerate();
+    // Checkpoints periódicos em segundo plano. Um arquivo de padrão na linha
+    // de comando substitui a sopa aleatória; --resume continua do último
+    // checkpoint
+    life::Checkpointer::Options checkpointOptions;
+    checkpointOptions.everySeconds = 60.0;
+    life::Checkpointer checkpointer(checkpointOptions);
+    uint64_t resumeGeneration = 0;
+    if (resume) {
+        std::string path;
+        if (life::Checkpointer::FindLatest(checkpointOptions.directory,
+                                           checkpointOptions.prefix, path,
+                                           &resumeGeneration))
+            loadPattern(path.c_str(), gridWidth / 2, gridHeight / 2);
+        else
+            printf("ERRO: nenhum checkpoint em %s\n",
+                   checkpointOptions.directory.c_str());
+    } else if (patternPath) {
+        loadPattern(patternPath, gridWidth / 2, gridHeight / 2);
+    }
+    if (simThread)
+        simThread->edit([resumeGeneration](life::Simulation &sim) {
+            sim.setGeneration(resumeGeneration);
+        });
+    const char *snapshotPath = "snapshot.snap";
+
     Vector2 mousePos = {0};
+    Vector2 lastBrush = {0};
+    bool stroking = false; // lastBrush vale: o botão já estava apertado
 
     // Métricas de performance - CORRIGIDAS para medir UPS real
     double lastTime = GetTime();
     double currentTime = 0.0;
     double gameUpdateTime = 0.0;
-    int gameUpdates = 0;
+    uint64_t gameUpdates = resumeGeneration;
+    double lastCheckpoint = lastTime;
+    double lastSteadyCheck = lastTime;
+    bool steadySampled = false;
+    bool steadyShown = false;
+    uint64_t steadySampleGeneration = 0;
+    uint64_t steadySampleHash = 0;
+    char steadyText[128] = "";
     float realUPS = 0.0f;
+    // Com --cpu o UPS é a contagem de gerações da thread por segundo
+    double upsSampleTime = lastTime;
+    uint64_t upsSampleGeneration = resumeGeneration;
     float renderFPS = 0.0f;
 
     // Buffer para médias móveis separadas
@@ -207,42 +530,33 @@ int main() {
             showGrid = !showGrid;
         if (IsKeyPressed(KEY_B))
             showBounds = !showBounds;
-        if (IsKeyPressed(KEY_T))
+        if (IsKeyPressed(KEY_T) && !simThread) {
             enableTripleBuffering = !enableTripleBuffering;
+            gpu.setTripleBuffering(enableTripleBuffering);
+        }
+
+        if (IsKeyPressed(KEY_U))
+            unlimitedSpeed = !unlimitedSpeed;
 
         if (IsKeyPressed(KEY_R)) {
-            BeginTextureMode(*current);
-            ClearBackground(BLACK);
-            EndTextureMode();
+            if (simThread)
+                placeGrid(life::Grid(gridWidth, gridHeight), 0, 0);
+            else
+                gpu.clear();
         }
 
         // Grid size controls (otimizado)
         if (IsKeyPressed(KEY_LEFT_BRACKET)) {
             gridMultiplier = std::fmax(0.5f, gridMultiplier - 0.5f);
 
-            UnloadRenderTexture(textureA);
-            UnloadRenderTexture(textureB);
-            UnloadRenderTexture(textureC);
-
             gridWidth = (int)(screenWidth * gridMultiplier);
             gridHeight = (int)(screenHeight * gridMultiplier);
 
-            textureA = LoadRenderTexture(gridWidth, gridHeight);
-            textureB = LoadRenderTexture(gridWidth, gridHeight);
-            textureC = LoadRenderTexture(gridWidth, gridHeight);
-
-            current = &textureA;
-            next = &textureB;
-            aux = &textureC;
-
-            GenerateRandomGridGPU(current, generationShader, gridWidth,
-                                  gridHeight, randomDensity, generationPattern);
-            BeginTextureMode(*next);
-            ClearBackground(BLACK);
-            EndTextureMode();
-            BeginTextureMode(*aux);
-            ClearBackground(BLACK);
-            EndTextureMode();
+            if (simThread)
+                startSimThread();
+            else
+                gpu.resize(gridWidth, gridHeight);
+            regenerate();
 
             camera.target = {gridWidth / 2.0f, gridHeight / 2.0f};
             printf("Grid: %dx%d (%.1fM cells, %.1fx)\n", gridWidth, gridHeight,
@@ -253,29 +567,14 @@ int main() {
             gridMultiplier = fmin(
                 20.0f, gridMultiplier + 0.5f); // Até 20x para grids massivas
 
-            UnloadRenderTexture(textureA);
-            UnloadRenderTexture(textureB);
-            UnloadRenderTexture(textureC);
-
             gridWidth = (int)(screenWidth * gridMultiplier);
             gridHeight = (int)(screenHeight * gridMultiplier);
 
-            textureA = LoadRenderTexture(gridWidth, gridHeight);
-            textureB = LoadRenderTexture(gridWidth, gridHeight);
-            textureC = LoadRenderTexture(gridWidth, gridHeight);
-
-            current = &textureA;
-            next = &textureB;
-            aux = &textureC;
-
-            GenerateRandomGridGPU(current, generationShader, gridWidth,
-                                  gridHeight, randomDensity, generationPattern);
-            BeginTextureMode(*next);
-            ClearBackground(BLACK);
-            EndTextureMode();
-            BeginTextureMode(*aux);
-            ClearBackground(BLACK);
-            EndTextureMode();
+            if (simThread)
+                startSimThread();
+            else
+                gpu.resize(gridWidth, gridHeight);
+            regenerate();
 
             camera.target = {gridWidth / 2.0f, gridHeight / 2.0f};
             printf("Grid: %dx%d (%.1fM cells, %.1fx)\n", gridWidth, gridHeight,
@@ -285,23 +584,19 @@ int main() {
         // Generation controls
         if (IsKeyPressed(KEY_ONE)) {
             generationPattern = 0;
-            GenerateRandomGridGPU(current, generationShader, gridWidth,
-                                  gridHeight, randomDensity, generationPattern);
+            regenerate();
         }
         if (IsKeyPressed(KEY_TWO)) {
             generationPattern = 1;
-            GenerateRandomGridGPU(current, generationShader, gridWidth,
-                                  gridHeight, randomDensity, generationPattern);
+            regenerate();
         }
         if (IsKeyPressed(KEY_THREE)) {
             generationPattern = 2;
-            GenerateRandomGridGPU(current, generationShader, gridWidth,
-                                  gridHeight, randomDensity, generationPattern);
+            regenerate();
         }
         if (IsKeyPressed(KEY_FOUR)) {
             generationPattern = 3;
-            GenerateRandomGridGPU(current, generationShader, gridWidth,
-                                  gridHeight, randomDensity, generationPattern);
+            regenerate();
         }
 
         // Density controls
@@ -333,57 +628,133 @@ int main() {
         if (IsKeyPressed(KEY_C))
             camera.target = {gridWidth / 2.0f, gridHeight / 2.0f};
 
-        // Manual drawing otimizado
-        if (IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
-            BeginTextureMode(*current);
+        // Snapshots e biblioteca de padrões. Com --cpu a geração publicada
+        // já é uma grade pronta, entregue sem cópia
+        auto currentGrid = [&]() -> std::shared_ptr<const life::Grid> {
+            if (simThread)
+                return simThread->snapshot().grid;
+            return std::make_shared<const life::Grid>(gpu.download());
+        };
+        if (IsKeyPressed(KEY_F6)) {
+            std::string error;
+            if (life::SavePattern(snapshotPath, *currentGrid(),
+                                  life::RuleString(rule).c_str(), gameUpdates,
+                                  &error))
+                printf("Snapshot salvo em %s\n", snapshotPath);
+            else
+                printf("ERRO: %s\n", error.c_str());
+        }
+        // A leitura da textura é o único custo no loop; a gravação fica na
+        // thread do Checkpointer
+        if (running &&
+            currentTime - lastCheckpoint >= checkpointOptions.everySeconds) {
+            checkpointer.submit(currentGrid(), gameUpdates);
+            lastCheckpoint = currentTime;
+        }
+        if (IsKeyPressed(KEY_F7))
+            loadPattern(snapshotPath, gridWidth / 2, gridHeight / 2);
+        if (IsFileDropped()) {
+            FilePathList dropped = LoadDroppedFiles();
+            if (dropped.count > 0)
+                loadPattern(dropped.paths[0], (int)mousePos.x,
+                            (int)mousePos.y);
+            UnloadDroppedFiles(dropped);
+        }
+
+        // Manual drawing. Na thread da CPU o pincel vira CellEdits na fila
+        // (o botão direito apaga), aplicadas entre dois passos, e o traço
+        // desde o quadro anterior é preenchido
+        bool drawing = IsMouseButtonDown(MOUSE_LEFT_BUTTON);
+        bool erasing = IsMouseButtonDown(MOUSE_RIGHT_BUTTON);
+        // Pincel maior em zoom baixo
+        int brushSize = (camera.zoom < 1.0f) ? 100 : 1;
+        if (simThread && (drawing || erasing)) {
+            Vector2 from = stroking ? lastBrush : mousePos;
+            float dx = mousePos.x - from.x;
+            float dy = mousePos.y - from.y;
+            int steps = std::max(
+                1, (int)(std::max(fabsf(dx), fabsf(dy)) /
+                         std::max(1, brushSize / 2)));
+            for (int i = 1; i <= steps; i++) {
+                int x = (int)floorf(from.x + dx * i / steps);
+                int y = (int)floorf(from.y + dy * i / steps);
+                if (x < 0 || x >= gridWidth || y < 0 || y >= gridHeight)
+                    continue;
+                int left = x - brushSize / 2;
+                int top = y - brushSize / 2;
+                simThread->editCells(
+                    erasing ? life::CellEdit::Clear(left, top, brushSize,
+                                                    brushSize)
+                            : life::CellEdit::Fill(left, top, brushSize,
+                                                   brushSize));
+            }
+            lastBrush = mousePos;
+            stroking = true;
+        } else {
+            stroking = false;
+        }
+        // Na GPU só no layout Cells (no Packed cada texel guarda 32 células)
+        if (!simThread && gpu.layout() == GpuLayout::Cells && drawing) {
+            BeginTextureMode(*gpu.current());
             int x = (int)mousePos.x;
             int y = (int)mousePos.y;
             if (x >= 0 && x < gridWidth && y >= 0 && y < gridHeight) {
-                // Desenha pincel maior em zoom baixo
-                int brushSize = (camera.zoom < 1.0f) ? 100 : 1;
                 DrawRectangle(x - brushSize / 2, y - brushSize / 2, brushSize,
                               brushSize, WHITE);
             }
             EndTextureMode();
         }
 
-        // Game logic com medição PRECISA de UPS
-        if (running && gameTimer >= 1.0f) {
+        // Game logic com medição PRECISA de UPS. Todas as gerações devidas
+        // no quadro vão num lote só, até kMaxBatch, parando no próximo
+        // múltiplo de kSteadySpacing para a verificação de estado estável
+        if (simThread) {
+            simThread->setTargetRate(unlimitedSpeed ? 0.0 : gameSpeed);
+            simThread->setRunning(running);
+            // A pirâmide só anda quando a thread publicou uma geração nova
+            bool updated = simThread->acquire();
+            life::ProfileScope upload(life::ProfileZone::Upload);
+            if (updated) {
+                const life::SimSnapshot &snapshot = simThread->snapshot();
+                pyramid.update(snapshot.grid, pyramidPool.get());
+                gameUpdates = snapshot.generation;
+                // A thread acha o ciclo exato; a janela só pausa
+                if (snapshot.period && !steadyShown) {
+                    snprintf(steadyText, sizeof(steadyText),
+                             "STEADY: period %llu since generation %llu",
+                             (unsigned long long)snapshot.period,
+                             (unsigned long long)snapshot.cycleStart);
+                    printf("%s\n", steadyText);
+                    running = false;
+                    simThread->setRunning(false);
+                    steadyShown = true;
+                } else if (!snapshot.period) {
+                    steadyText[0] = '\0';
+                    steadyShown = false;
+                }
+            }
+            if (currentTime - upsSampleTime >= 0.5) {
+                uint64_t generation = simThread->generation();
+                realUPS = (float)((generation - upsSampleGeneration) /
+                                  (currentTime - upsSampleTime));
+                upsSampleGeneration = generation;
+                upsSampleTime = currentTime;
+            }
+            lodView.sync(pyramid, camera, screenWidth, screenHeight, updated);
+        } else if (running && (gameTimer >= 1.0f || unlimitedSpeed)) {
             double updateStartTime = GetTime();
 
-            int resolutionLoc = GetShaderLocation(gameShader, "resolution");
-            int timeLoc = GetShaderLocation(gameShader, "time");
-
-            float resolution[2] = {(float)gridWidth, (float)gridHeight};
-            float time = GetTime();
+            int steps =
+                unlimitedSpeed ? kMaxBatch : (int)fmin(gameTimer, kMaxBatch);
+            int untilSample =
+                kSteadySpacing - (int)(gameUpdates % kSteadySpacing);
+            if (steps > untilSample)
+                steps = untilSample;
+            gpu.step(steps);
 
-            SetShaderValue(gameShader, resolutionLoc, resolution,
-                           SHADER_UNIFORM_VEC2);
-            SetShaderValue(gameShader, timeLoc, &time, SHADER_UNIFORM_FLOAT);
-
-            BeginTextureMode(*next);
-            ClearBackground(BLACK);
-            BeginShaderMode(gameShader);
-            DrawTextureRec(current->texture,
-                           {0, 0, (float)current->texture.width,
-                            -(float)current->texture.height},
-                           {0, 0}, WHITE);
-            EndShaderMode();
-            EndTextureMode();
-
-            if (enableTripleBuffering) {
-                RenderTexture2D *temp = aux;
-                aux = current;
-                current = next;
-                next = temp;
-            } else {
-                RenderTexture2D *temp = current;
-                current = next;
-                next = temp;
-            }
-
-            gameTimer = 0.0f;
-            gameUpdates++;
+            // Atraso maior que um lote é descartado em vez de acumular
+            gameTimer = fmin(gameTimer - steps, 1.0f);
+            gameUpdates += steps;
 
             // Calcula UPS real baseado no tempo de update
             double updateEndTime = GetTime();
@@ -391,7 +762,7 @@ int main() {
 
             // Armazena UPS instantâneo
             if (updateDuration > 0.0) {
-                upsBuffer[upsBufferIndex] = (float)(1.0 / updateDuration);
+                upsBuffer[upsBufferIndex] = (float)(steps / updateDuration);
                 upsBufferIndex = (upsBufferIndex + 1) % FRAME_BUFFER_SIZE;
 
                 float totalUPS = 0.0f;
@@ -402,7 +773,42 @@ int main() {
             }
         }
 
+        // Pausa quando a grade se repete, uma vez por estado estável
+        if (!simThread && running && gameUpdates % kSteadySpacing == 0 &&
+            gameUpdates != steadySampleGeneration &&
+            currentTime - lastSteadyCheck >= 1.0) {
+            life::Grid grid = gpu.download();
+            uint64_t hash = life::HashGrid(grid);
+            bool repeated = steadySampled && hash == steadySampleHash;
+            if (repeated && !steadyShown) {
+                uint64_t period = FindPeriodCPU(grid, rule, kSteadySpacing);
+                if (period)
+                    snprintf(steadyText, sizeof(steadyText),
+                             "STEADY: period %llu since generation <= %llu",
+                             (unsigned long long)period,
+                             (unsigned long long)steadySampleGeneration);
+                else
+                    snprintf(steadyText, sizeof(steadyText),
+                             "STEADY: period divides %llu since generation "
+                             "<= %llu",
+                             (unsigned long long)(gameUpdates -
+                                                  steadySampleGeneration),
+                             (unsigned long long)steadySampleGeneration);
+                printf("%s\n", steadyText);
+                running = false;
+                steadyShown = true;
+            } else if (!repeated) {
+                steadyText[0] = '\0';
+                steadyShown = false;
+            }
+            steadySampled = true;
+            steadySampleHash = hash;
+            steadySampleGeneration = gameUpdates;
+            lastSteadyCheck = currentTime;
+        }
+
         // Rendering otimizado
+        uint64_t renderStart = life::Profiling() ? life::ProfileClock() : 0;
         BeginDrawing();
         ClearBackground(DARKGRAY);
         BeginMode2D(camera);
@@ -422,10 +828,10 @@ int main() {
         }
 
         // Draw grid
-        DrawTextureRec(current->texture,
-                       {0, 0, (float)current->texture.width,
-                        -(float)current->texture.height},
-                       {0, 0}, WHITE);
+        if (simThread)
+            lodView.draw();
+        else
+            gpu.draw();
 
         // Grid lines ultra otimizadas
         if (showGrid && camera.zoom > 0.5f) {
@@ -464,48 +870,78 @@ int main() {
                  realUPS, renderFPS);
         DrawText(titleBuffer, 10, 10, 20, WHITE);
 
+        char speedBuffer[32];
+        if (unlimitedSpeed)
+            snprintf(speedBuffer, sizeof(speedBuffer), "unlimited");
+        else
+            snprintf(speedBuffer, sizeof(speedBuffer), "%.0f UPS", gameSpeed);
+        char lodText[32] = "";
+        if (simThread && lodView.level() >= 0) {
+            int block = pyramid.blockSize(lodView.level());
+            snprintf(lodText, sizeof(lodText), "density %dx%d", block, block);
+        } else if (simThread) {
+            snprintf(lodText, sizeof(lodText), "cells");
+        }
         char infoBuffer[512];
         snprintf(
             infoBuffer, sizeof(infoBuffer),
-            "Target Speed: %.0f UPS | Zoom: %.3fx | Grid: %dx%d (%.1fM cells)\n"
-            "Density: %.2f | Pattern: %d | Triple Buffer: %s | Monitor: %dHz",
-            gameSpeed, camera.zoom, gridWidth, gridHeight,
+            "Target Speed: %s | Zoom: %.3fx | Grid: %dx%d (%.1fM cells)\n"
+            "Density: %.2f | Pattern: %d | Triple Buffer: %s | Monitor: %dHz\n"
+            "Rule: %s | Engine: %s %s",
+            speedBuffer, camera.zoom, gridWidth, gridHeight,
             (gridWidth * gridHeight) / 1000000.0f, randomDensity,
-            generationPattern, enableTripleBuffering ? "ON" : "OFF",
-            GetMonitorRefreshRate(GetCurrentMonitor()));
+            generationPattern,
+            simThread || enableTripleBuffering ? "ON" : "OFF",
+            GetMonitorRefreshRate(GetCurrentMonitor()),
+            life::RuleName(rule).c_str(), simThread ? "cpu thread" : "gpu",
+            simThread ? lodText : GpuLayoutName(layout));
         DrawText(infoBuffer, 10, 40, 12, WHITE);
 
-        DrawText(running ? "RUNNING" : "PAUSED", 10, 80, 16,
+        DrawText(running ? "RUNNING" : "PAUSED", 10, 90, 16,
                  running ? GREEN : YELLOW);
 
-        // Aviso se UPS está limitado
-        if (running && realUPS > 0 &&
+        // Aviso se UPS está limitado (a thread da CPU não depende do VSync)
+        if (!simThread && running && realUPS > 0 &&
             fabs(realUPS - GetMonitorRefreshRate(GetCurrentMonitor())) < 5) {
             DrawText(
                 "AVISO: UPS limitado pelo VSync! Desabilite no painel da GPU",
-                10, 100, 14, RED);
+                10, 110, 14, RED);
         }
+        if (steadyText[0])
+            DrawText(steadyText, 10, 130, 14, SKYBLUE);
 
         // Controles compactos
         static int blinkCounter = 0;
         blinkCounter++;
         if ((blinkCounter / 30) % 2 == 0) { // Pisca a cada segundo
             DrawText(
-                "F1-F5: Speed Presets | T: Triple Buffer | O: Optimized Shader",
+                "F1-F5: Speed Presets | U: Unlimited | T: Triple Buffer",
                 10, screenHeight - 40, 12, YELLOW);
             DrawText(
                 "SPACE: Play/Pause | 1-4: Patterns | []: Grid Size | C: Center",
                 10, screenHeight - 25, 12, LIGHTGRAY);
+            DrawText("F6: Save Snapshot | F7: Load Snapshot | Drop .rle/.cells/"
+                     ".snap to load",
+                     10, screenHeight - 55, 12, LIGHTGRAY);
         }
 
         EndDrawing();
+        if (renderStart)
+            life::EndProfileScope(life::ProfileZone::Render, renderStart);
     }
 
-    UnloadShader(gameShader);
-    UnloadShader(generationShader);
-    UnloadRenderTexture(textureA);
-    UnloadRenderTexture(textureB);
-    UnloadRenderTexture(textureC);
+    simThread.reset();
+    if (tracePath) {
+        std::string error;
+        if (!life::WriteChromeTrace(tracePath, &error))
+            printf("ERRO: %s\n", error.c_str());
+    }
+    metrics.reset();
+    lodView.unload();
+    if (!cpuEngine) {
+        gpu.unload();
+        UnloadShader(generationShader);
+    }
     CloseWindow();
 
     return 0;
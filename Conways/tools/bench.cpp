@@ -0,0 +1,273 @@
+#include "bench.h"
+#include "chunk_life.h"
+#include "hashlife.h"
+#include "kernel.h"
+#include "multistate.h"
+#include "simulation.h"
+#include "sparse_life.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Suíte de benchmark: cargas fixas x tamanhos da janela (gridMultiplier) x
+// motores, com o resultado em JSON para acompanhar regressões entre commits.
+// O motor da GPU roda no próprio Conways (--bench), no mesmo formato.
+
+static const char *const kEngines[] = {
+    "hashset",      "bitboard", "simd",       "threaded",
+    "active-tiles", "chunked",  "hashlife",   "multistate"};
+
+struct Options {
+    std::vector<life::BenchWorkload> workloads;
+    std::vector<std::string> engines;
+    std::vector<std::pair<int, int>> sizes;
+    uint64_t generations = 100;
+    double seconds = 5.0;
+    int settle = 1000;
+    int threads = 0;
+    uint64_t maxSparsePopulation = 1000000;
+    std::string label;
+    const char *output = nullptr;
+};
+
+static void PrintUsage() {
+    printf("Usage: conways-bench [options]\n"
+           "  --workloads LIST      r-pentomino,gosper-field,soup,settled-soup "
+           "(default: all)\n"
+           "  --engines LIST        hashset,bitboard,simd,threaded,"
+           "active-tiles,chunked,\n"
+           "                        hashlife,multistate\n"
+           "                        (default: all)\n"
+           "  --multipliers LIST    window grid multipliers, 1200x1000 each "
+           "(default 1,2,5)\n"
+           "  --size WxH            a single grid size instead\n"
+           "  -n N                  generations per run (default 100)\n"
+           "  --seconds T           stop a run after T seconds (default 5)\n"
+           "  --settle N            generations to settle the soup (default "
+           "1000)\n"
+           "  --threads N           threads for the threaded engines (default: "
+           "all cores)\n"
+           "  --max-sparse-population N  skip hashset/hashlife above N live "
+           "cells\n"
+           "                        (default 1000000)\n"
+           "  --label TEXT          stored in the JSON (a commit hash, for "
+           "example)\n"
+           "  -o FILE               write the JSON to FILE instead of "
+           "stdout\n");
+}
+
+static std::vector<std::string> Split(const char *text) {
+    std::vector<std::string> items;
+    std::string item;
+    for (const char *c = text;; c++) {
+        if (*c == ',' || *c == '\0') {
+            if (!item.empty())
+                items.push_back(item);
+            item.clear();
+            if (*c == '\0')
+                break;
+        } else {
+            item += *c;
+        }
+    }
+    return items;
+}
+
+// Roda até options.generations gerações ou options.seconds segundos, uma
+// geração por amostra de latência. A primeira geração aquece caches e
+// tabelas e fica fora da medida.
+static void Measure(life::BenchResult &result, const Options &options,
+                    const std::function<void()> &step) {
+    using Clock = std::chrono::steady_clock;
+    step();
+    auto start = Clock::now();
+    for (uint64_t g = 0; g < options.generations; g++) {
+        auto t0 = Clock::now();
+        step();
+        auto t1 = Clock::now();
+        result.stepSeconds.push_back(
+            std::chrono::duration<double>(t1 - t0).count());
+        result.generations++;
+        if (std::chrono::duration<double>(t1 - start).count() >=
+            options.seconds)
+            break;
+    }
+    result.seconds =
+        std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+static life::BenchResult Run(const std::string &engine,
+                             const life::Grid &initial,
+                             const Options &options) {
+    life::BenchResult result;
+    result.engine = engine;
+    result.width = initial.width();
+    result.height = initial.height();
+
+    if (engine == "hashset" || engine == "hashlife") {
+        // O custo deles cresce com a população, não com a área
+        uint64_t population = initial.population();
+        if (population > options.maxSparsePopulation) {
+            char reason[128];
+            snprintf(reason, sizeof(reason),
+                     "population %llu over --max-sparse-population",
+                     (unsigned long long)population);
+            result.skipped = reason;
+            return result;
+        }
+    }
+
+    if (engine == "hashset") {
+        life::SparseLife sparse(initial);
+        Measure(result, options, [&] { sparse.step(); });
+        result.population = sparse.population();
+    } else if (engine == "chunked") {
+        // Plano ilimitado: a sopa se espalha além da grade
+        life::ChunkLife chunked(initial);
+        chunked.setThreadCount(options.threads);
+        Measure(result, options, [&] { chunked.step(); });
+        result.population = chunked.population();
+    } else if (engine == "hashlife") {
+        life::HashLife hashlife;
+        hashlife.load(initial);
+        Measure(result, options, [&] { hashlife.step(1); });
+        result.population = hashlife.population();
+    } else if (engine == "multistate") {
+        // B3/S23 no motor de um byte por célula, com todas as threads
+        life::MultiStateLife multi(initial, life::MultiStateRule());
+        multi.setThreadCount(options.threads);
+        Measure(result, options, [&] { multi.step(); });
+        result.population = multi.population();
+    } else {
+        bool scalar = engine == "bitboard";
+        bool threaded = engine == "threaded" || engine == "active-tiles";
+        life::Simulation sim(initial, scalar ? life::KernelIsa::Scalar
+                                             : life::DetectKernelIsa());
+        sim.setThreadCount(threaded ? options.threads : 1);
+        sim.setActivityTracking(engine == "active-tiles");
+        Measure(result, options, [&] { sim.step(); });
+        result.population = sim.grid().population();
+    }
+    result.peakRssBytes = life::PeakRssBytes();
+    return result;
+}
+
+int main(int argc, char **argv) {
+    Options options;
+    std::vector<double> multipliers = {1.0, 2.0, 5.0};
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(arg, "--workloads") && hasValue) {
+            for (const std::string &name : Split(argv[++i])) {
+                life::BenchWorkload workload;
+                if (!life::ParseBenchWorkload(name.c_str(), workload)) {
+                    printf("ERRO: carga desconhecida: %s\n", name.c_str());
+                    return -1;
+                }
+                options.workloads.push_back(workload);
+            }
+        } else if (!strcmp(arg, "--engines") && hasValue) {
+            for (const std::string &name : Split(argv[++i])) {
+                bool known = false;
+                for (const char *engine : kEngines)
+                    known = known || name == engine;
+                if (!known) {
+                    printf("ERRO: motor desconhecido: %s\n", name.c_str());
+                    return -1;
+                }
+                options.engines.push_back(name);
+            }
+        } else if (!strcmp(arg, "--multipliers") && hasValue) {
+            multipliers.clear();
+            for (const std::string &value : Split(argv[++i]))
+                multipliers.push_back(atof(value.c_str()));
+        } else if (!strcmp(arg, "--size") && hasValue) {
+            int width, height;
+            if (sscanf(argv[++i], "%dx%d", &width, &height) != 2 ||
+                width <= 0 || height <= 0) {
+                printf("ERRO: tamanho inválido: %s\n", argv[i]);
+                return -1;
+            }
+            options.sizes.push_back({width, height});
+        } else if (!strcmp(arg, "-n") && hasValue) {
+            options.generations = strtoull(argv[++i], nullptr, 10);
+        } else if (!strcmp(arg, "--seconds") && hasValue) {
+            options.seconds = atof(argv[++i]);
+        } else if (!strcmp(arg, "--settle") && hasValue) {
+            options.settle = atoi(argv[++i]);
+        } else if (!strcmp(arg, "--threads") && hasValue) {
+            options.threads = atoi(argv[++i]);
+        } else if (!strcmp(arg, "--max-sparse-population") && hasValue) {
+            options.maxSparsePopulation = strtoull(argv[++i], nullptr, 10);
+        } else if (!strcmp(arg, "--label") && hasValue) {
+            options.label = argv[++i];
+        } else if (!strcmp(arg, "-o") && hasValue) {
+            options.output = argv[++i];
+        } else if (!strcmp(arg, "-h") || !strcmp(arg, "--help")) {
+            PrintUsage();
+            return 0;
+        } else {
+            printf("ERRO: argumento desconhecido: %s\n", arg);
+            PrintUsage();
+            return -1;
+        }
+    }
+
+    if (options.workloads.empty())
+        options.workloads = {
+            life::BenchWorkload::RPentomino, life::BenchWorkload::GosperField,
+            life::BenchWorkload::Soup, life::BenchWorkload::SettledSoup};
+    if (options.engines.empty())
+        options.engines.assign(std::begin(kEngines), std::end(kEngines));
+    if (options.sizes.empty())
+        for (double m : multipliers)
+            options.sizes.push_back({(int)(1200 * m), (int)(1000 * m)});
+
+    life::ThreadPool pool(options.threads);
+    std::vector<life::BenchResult> results;
+    for (const auto &size : options.sizes) {
+        for (life::BenchWorkload workload : options.workloads) {
+            life::Grid initial = life::MakeBenchGrid(
+                workload, size.first, size.second, options.settle, &pool);
+            for (const std::string &engine : options.engines) {
+                life::BenchResult result = Run(engine, initial, options);
+                result.workload = life::BenchWorkloadName(workload);
+                // O progresso vai para stderr, o JSON pode ir para stdout
+                if (!result.skipped.empty())
+                    fprintf(stderr, "%-13s %6dx%-6d %-12s skipped: %s\n",
+                            result.workload.c_str(), size.first, size.second,
+                            engine.c_str(), result.skipped.c_str());
+                else
+                    fprintf(stderr,
+                            "%-13s %6dx%-6d %-12s %.3e cells/s, p50 %.3f ms, "
+                            "p99 %.3f ms\n",
+                            result.workload.c_str(), size.first, size.second,
+                            engine.c_str(),
+                            (double)initial.cells() * result.generations /
+                                result.seconds,
+                            life::Percentile(result.stepSeconds, 0.5) * 1e3,
+                            life::Percentile(result.stepSeconds, 0.99) * 1e3);
+                results.push_back(std::move(result));
+            }
+        }
+    }
+
+    FILE *out = options.output ? fopen(options.output, "w") : stdout;
+    if (!out) {
+        printf("ERRO: não foi possível abrir %s\n", options.output);
+        return -1;
+    }
+    life::WriteBenchJson(out, options.label,
+                         life::KernelIsaName(life::DetectKernelIsa()),
+                         pool.threadCount(), results);
+    if (out != stdout)
+        fclose(out);
+    return 0;
+}
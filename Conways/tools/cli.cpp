@@ -0,0 +1,771 @@
+#include "census.h"
+#include "checkpoint.h"
+#include "chunk_life.h"
+#include "grid.h"
+#include "hashlife.h"
+#include "multistate.h"
+#include "pattern_io.h"
+#include "profiler.h"
+#include "recorder.h"
+#include "seed.h"
+#include "simulation.h"
+#include "snapshot.h"
+#include "sparse_life.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+
+// Células-passo, no máximo, da conferência dos motores ilimitados
+static constexpr double kMaxUnboundedVerify = 2e11;
+
+static void PrintUsage() {
+    printf("Usage: conways-cli [options] [pattern.cells|.rle|.snap]\n"
+           "  -n, --generations N   generations to run (default 1000)\n"
+           "  --size WxH            grid size (default: pattern size, or "
+           "2400x2000 for a random soup)\n"
+           "  --density D           random soup density (default 0.25)\n"
+           "  --seed N              random soup seed (default: new, printed)\n"
+           "  --pattern NAME        random soup pattern: random (default), "
+           "blocks, noise\n"
+           "                        or hotspots\n"
+           "  --at X,Y              place the pattern with its top-left corner "
+           "at X,Y (default: centered)\n"
+           "  -o, --output FILE     write the final grid (.cells, .rle or "
+           ".snap)\n"
+           "  --compress            compress .snap output with zstd\n"
+           "  --engine NAME         bitboard (default), reference, hashset, "
+           "chunked, hashlife\n"
+           "                        or multistate; hashset, chunked and "
+           "hashlife run on the\n"
+           "                        unbounded plane and write back the grid's "
+           "window\n"
+           "  --rule RULE           B/S rulestring (B36/S23) or life, "
+           "highlife, daynight, seeds\n"
+           "                        (default B3/S23); Generations (B2/S/C3) "
+           "and Larger than\n"
+           "                        Life (R5,C0,M1,S34..58,B34..45,NM) rules "
+           "use multistate\n"
+           "  --verify              check the result against the reference "
+           "engine; hashset,\n"
+           "                        chunked and hashlife against the bitboard "
+           "on a torus\n"
+           "                        padded by n + 1 cells, which is the plane "
+           "for n generations\n"
+           "  --isa NAME            bitboard kernel: scalar, sse2, avx2, avx512 "
+           "(default: best available)\n"
+           "  --threads N           worker threads (default: all cores)\n"
+           "  --active-tiles        skip tiles whose neighbourhood is stable "
+           "(bitboard)\n"
+           "  --max-period N        detect cycles up to period N and skip the "
+           "rest of the\n"
+           "                        run once the grid repeats (bitboard)\n"
+           "  --checkpoint-every N  write a checkpoint every N generations "
+           "(bitboard)\n"
+           "  --checkpoint-seconds T  write a checkpoint every T seconds "
+           "(bitboard)\n"
+           "  --checkpoint-dir DIR  checkpoint directory (default "
+           "checkpoints)\n"
+           "  --resume              continue from the latest checkpoint in "
+           "DIR; -n counts\n"
+           "                        from generation 0, so only the missing "
+           "generations run\n"
+           "  --record PATH         record frames while it runs (bitboard): "
+           "out.y4m (raw\n"
+           "                        grey video), out.apng or "
+           "frames/f-{generation}.png\n"
+           "  --record-every N      one frame every N generations (default 1)\n"
+           "  --record-scale S      one pixel per SxS cells, grey = density "
+           "(default 1)\n"
+           "  --record-queue N      frames in flight before dropping "
+           "(default 8)\n"
+           "  --record-wait         make the stepper wait for room instead of "
+           "dropping\n"
+           "  --record-threads N    encoder threads (default 2)\n"
+           "  --fps N               frame rate of .apng and .y4m (default 30)\n"
+           "  --census              count the objects of the final grid "
+           "(blocks, blinkers,\n"
+           "                        gliders, ...) by shape and period\n"
+           "  --profile             print the time spent per zone (p50/p99/"
+           "max) at the end\n"
+           "  --profile-trace FILE  write a Chrome trace (chrome://tracing, "
+           "Perfetto) of every\n"
+           "                        zone and generation\n"
+           "  --metrics FILE        keep Prometheus text metrics in FILE, "
+           "rewritten every\n"
+           "                        --metrics-seconds T (default 5)\n"
+           "                        Profiling also measures population, "
+           "births and deaths,\n"
+           "                        one extra pass over the grid per "
+           "generation\n"
+           "  --selftest            check that cycle detection survives "
+           "forced hash collisions\n");
+}
+
+// Detecção de ciclos com o hash truncado: as colisões forçadas não podem
+// pular nenhuma geração, e a grade final tem de ser a de uma simulação sem
+// detecção. Com o hash inteiro a sopa assenta num ciclo e pula o resto.
+static int RunSelfTest() {
+    const uint64_t kGenerations = 10000;
+    life::SeedOptions seed;
+    seed.seed = 11; // assenta em p2 na geração 7035
+    life::Grid soup(128, 128);
+    life::SeedGrid(soup, seed);
+
+    life::Simulation plain(soup);
+    plain.step(kGenerations);
+    const life::Simulation &expected = plain;
+
+    struct Case {
+        int bits;
+        bool tiles;
+    };
+    const Case cases[] = {{0, false},  {0, true},  {12, false},
+                          {12, true},  {64, false}, {64, true}};
+    int failures = 0;
+    for (const Case &c : cases) {
+        life::Simulation sim(soup);
+        sim.setActivityTracking(c.tiles);
+        sim.setCycleDetection(60);
+        sim.setHashBits(c.bits);
+        sim.step(kGenerations);
+        const life::Simulation &view = sim;
+        const life::CycleDetector &cycles = sim.cycles();
+
+        bool ok = sim.generation() == kGenerations &&
+                  view.grid() == expected.grid();
+        // Com 0 bits todo candidato é período 1, e a sopa não é estática
+        if (c.bits == 0)
+            ok = ok && !cycles.found() && sim.skippedGenerations() == 0;
+        if (c.bits == 64)
+            ok = ok && cycles.found() && sim.skippedGenerations() > 0;
+        printf("%2d hash bits%s: cycle %s, %llu generations skipped: %s\n",
+               c.bits, c.tiles ? ", active tiles" : "",
+               cycles.found()
+                   ? ("p" + std::to_string(cycles.period())).c_str()
+                   : "none",
+               (unsigned long long)sim.skippedGenerations(),
+               ok ? "OK" : "FAILED");
+        failures += !ok;
+    }
+    printf("Cycle self-test: %s (%d failures)\n", failures ? "FAILED" : "OK",
+           failures);
+    return failures;
+}
+
+static bool ParseSize(const char *text, int &width, int &height) {
+    return sscanf(text, "%dx%d", &width, &height) == 2 && width > 0 &&
+           height > 0;
+}
+
+// As duas regras dão o mesmo autômato ("life" e "B3/S23", por exemplo)
+static bool SameRule(const char *a, const char *b) {
+    life::Rule ruleA;
+    life::Rule ruleB;
+    if (life::ParseRule(a, ruleA) && life::ParseRule(b, ruleB))
+        return ruleA == ruleB;
+    life::MultiStateRule multiA;
+    life::MultiStateRule multiB;
+    return life::ParseMultiStateRule(a, multiA) &&
+           life::ParseMultiStateRule(b, multiB) &&
+           life::MultiStateRuleString(multiA) ==
+               life::MultiStateRuleString(multiB);
+}
+
+int main(int argc, char **argv) {
+    long long generations = 1000;
+    int width = 0;
+    int height = 0;
+    life::SeedOptions seed;
+    bool seeded = false;
+    const char *input = nullptr;
+    const char *output = nullptr;
+    bool placed = false;
+    int atX = 0;
+    int atY = 0;
+    bool compress = false;
+    std::string engine;
+    const char *ruleText = nullptr;
+    life::Rule rule;
+    life::MultiStateRule multiRule;
+    bool verify = false;
+    life::KernelIsa isa = life::DetectKernelIsa();
+    int threads = 0;
+    bool activeTiles = false;
+    int maxPeriod = 0;
+    life::Checkpointer::Options checkpoint;
+    bool resume = false;
+    bool profile = false;
+    bool census = false;
+    life::RecorderOptions record;
+    const char *tracePath = nullptr;
+    const char *metricsPath = nullptr;
+    double metricsSeconds = 5.0;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if ((!strcmp(arg, "-n") || !strcmp(arg, "--generations")) &&
+            hasValue) {
+            generations = atoll(argv[++i]);
+        } else if (!strcmp(arg, "--size") && hasValue) {
+            if (!ParseSize(argv[++i], width, height)) {
+                printf("ERRO: tamanho inválido: %s\n", argv[i]);
+                return -1;
+            }
+        } else if (!strcmp(arg, "--density") && hasValue) {
+            seed.density = (float)atof(argv[++i]);
+        } else if (!strcmp(arg, "--seed") && hasValue) {
+            seed.seed = strtoull(argv[++i], nullptr, 0);
+            seeded = true;
+        } else if (!strcmp(arg, "--pattern") && hasValue) {
+            if (!life::ParseSeedPattern(argv[++i], seed.pattern)) {
+                printf("ERRO: padrão desconhecido: %s\n", argv[i]);
+                return -1;
+            }
+        } else if ((!strcmp(arg, "-o") || !strcmp(arg, "--output")) &&
+                   hasValue) {
+            output = argv[++i];
+        } else if (!strcmp(arg, "--at") && hasValue) {
+            if (sscanf(argv[++i], "%d,%d", &atX, &atY) != 2) {
+                printf("ERRO: posição inválida: %s\n", argv[i]);
+                return -1;
+            }
+            placed = true;
+        } else if (!strcmp(arg, "--compress")) {
+            compress = true;
+        } else if (!strcmp(arg, "--engine") && hasValue) {
+            engine = argv[++i];
+        } else if (!strcmp(arg, "--rule") && hasValue) {
+            ruleText = argv[++i];
+        } else if (!strcmp(arg, "--isa") && hasValue) {
+            const char *name = argv[++i];
+            const life::KernelIsa isas[] = {
+                life::KernelIsa::Scalar, life::KernelIsa::Sse2,
+                life::KernelIsa::Avx2, life::KernelIsa::Avx512};
+            bool found = false;
+            for (life::KernelIsa candidate : isas) {
+                if (!strcmp(name, life::KernelIsaName(candidate))) {
+                    isa = candidate;
+                    found = true;
+                }
+            }
+            if (!found || !life::GetRowKernel(isa)) {
+                printf("ERRO: ISA indisponível: %s\n", name);
+                return -1;
+            }
+        } else if (!strcmp(arg, "--threads") && hasValue) {
+            threads = atoi(argv[++i]);
+        } else if (!strcmp(arg, "--active-tiles")) {
+            activeTiles = true;
+        } else if (!strcmp(arg, "--max-period") && hasValue) {
+            maxPeriod = atoi(argv[++i]);
+        } else if (!strcmp(arg, "--checkpoint-every") && hasValue) {
+            checkpoint.everyGenerations = strtoull(argv[++i], nullptr, 10);
+        } else if (!strcmp(arg, "--checkpoint-seconds") && hasValue) {
+            checkpoint.everySeconds = atof(argv[++i]);
+        } else if (!strcmp(arg, "--checkpoint-dir") && hasValue) {
+            checkpoint.directory = argv[++i];
+        } else if (!strcmp(arg, "--resume")) {
+            resume = true;
+        } else if (!strcmp(arg, "--profile")) {
+            profile = true;
+        } else if (!strcmp(arg, "--census")) {
+            census = true;
+        } else if (!strcmp(arg, "--selftest")) {
+            return RunSelfTest() ? -1 : 0;
+        } else if (!strcmp(arg, "--record") && hasValue) {
+            record.path = argv[++i];
+        } else if (!strcmp(arg, "--record-every") && hasValue) {
+            record.every = strtoull(argv[++i], nullptr, 10);
+        } else if (!strcmp(arg, "--record-scale") && hasValue) {
+            record.scale = atoi(argv[++i]);
+        } else if (!strcmp(arg, "--record-queue") && hasValue) {
+            record.queue = atoi(argv[++i]);
+        } else if (!strcmp(arg, "--record-wait")) {
+            record.dropWhenFull = false;
+        } else if (!strcmp(arg, "--record-threads") && hasValue) {
+            record.threads = atoi(argv[++i]);
+        } else if (!strcmp(arg, "--fps") && hasValue) {
+            record.fps = atoi(argv[++i]);
+        } else if (!strcmp(arg, "--profile-trace") && hasValue) {
+            tracePath = argv[++i];
+        } else if (!strcmp(arg, "--metrics") && hasValue) {
+            metricsPath = argv[++i];
+        } else if (!strcmp(arg, "--metrics-seconds") && hasValue) {
+            metricsSeconds = atof(argv[++i]);
+        } else if (!strcmp(arg, "--verify")) {
+            verify = true;
+        } else if (!strcmp(arg, "-h") || !strcmp(arg, "--help")) {
+            PrintUsage();
+            return 0;
+        } else if (arg[0] != '-' && !input) {
+            input = arg;
+        } else {
+            printf("ERRO: argumento desconhecido: %s\n", arg);
+            PrintUsage();
+            return -1;
+        }
+    }
+
+    // Regras com mais estados ou raio maior só rodam no motor multistate.
+    // Sem --rule vale a do cabeçalho de um .rle, escolhida depois de carregar.
+    bool multiState = false;
+    auto selectRule = [&](const char *text) {
+        if (life::ParseRule(text, rule)) {
+            multiRule = life::MultiStateRuleFrom(rule);
+            return true;
+        }
+        std::string error;
+        if (!life::ParseMultiStateRule(text, multiRule, &error)) {
+            printf("ERRO: %s\n", error.c_str());
+            return false;
+        }
+        multiState = true;
+        if (engine.empty())
+            engine = "multistate";
+        if (engine != "multistate") {
+            printf("ERRO: a regra %s precisa do motor multistate\n", text);
+            return false;
+        }
+        if (census) {
+            printf("ERRO: --census só com regras B/S de dois estados\n");
+            return false;
+        }
+        return true;
+    };
+    if (ruleText && !selectRule(ruleText))
+        return -1;
+    if (!ruleText)
+        multiRule = life::MultiStateRuleFrom(rule);
+
+    // Liga antes de semear, para o trecho seed entrar
+    std::unique_ptr<life::MetricsExporter> metrics;
+    if (profile || tracePath || metricsPath) {
+        life::SetProfileThreadName("main");
+        life::ProfileOptions options;
+        options.generations = true;
+        options.trace = tracePath != nullptr;
+        life::StartProfiling(options);
+    }
+    if (metricsPath)
+        metrics = std::make_unique<life::MetricsExporter>(metricsPath,
+                                                          metricsSeconds);
+
+    std::string resumePath;
+    if (resume) {
+        if (!life::Checkpointer::FindLatest(checkpoint.directory,
+                                            checkpoint.prefix, resumePath)) {
+            printf("ERRO: nenhum checkpoint em %s\n",
+                   checkpoint.directory.c_str());
+            return -1;
+        }
+        input = resumePath.c_str();
+    }
+
+    life::Grid grid;
+    uint64_t startGeneration = 0;
+    if (input) {
+        life::Grid pattern;
+        std::string error;
+        auto loadStart = std::chrono::steady_clock::now();
+        std::string patternRule;
+        if (!life::LoadPattern(input, pattern, &startGeneration,
+                               &patternRule, &error)) {
+            printf("ERRO: %s\n", error.c_str());
+            return -1;
+        }
+        printf("Loaded %s in %.3f s\n", input,
+               std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                             loadStart)
+                   .count());
+        if (!patternRule.empty() && !ruleText) {
+            if (!selectRule(patternRule.c_str()))
+                return -1;
+        } else if (!patternRule.empty() &&
+                   !SameRule(patternRule.c_str(), ruleText)) {
+            printf("Warning: %s asks for rule %s, running --rule %s\n", input,
+                   patternRule.c_str(), ruleText);
+        }
+        if (width == 0) {
+            grid = std::move(pattern);
+        } else {
+            // Centraliza o padrão na grade pedida, ou põe em --at
+            grid = life::Grid(width, height);
+            if (!placed) {
+                atX = (width - pattern.width()) / 2;
+                atY = (height - pattern.height()) / 2;
+            }
+            grid.paste(pattern, atX, atY);
+        }
+    } else {
+        if (width == 0) {
+            width = 2400;
+            height = 2000;
+        }
+        if (!seeded)
+            seed.seed = life::RandomSeed();
+        seed.isa = isa;
+        grid = life::Grid(width, height);
+        // Pool só para semear; a simulação cria o seu logo abaixo
+        std::unique_ptr<life::ThreadPool> pool;
+        if (threads != 1)
+            pool = std::make_unique<life::ThreadPool>(threads);
+        auto seedStart = std::chrono::steady_clock::now();
+        life::SeedGrid(grid, seed, pool.get());
+        printf("Seed: %llu (%s, density %.2f) in %.3f s\n",
+               (unsigned long long)seed.seed,
+               life::SeedPatternName(seed.pattern), seed.density,
+               std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                             seedStart)
+                   .count());
+    }
+
+    if (engine.empty())
+        engine = "bitboard";
+    if (!record.path.empty() && engine != "bitboard") {
+        printf("ERRO: --record só com o motor bitboard\n");
+        return -1;
+    }
+
+    printf("Grid Size: %dx%d (%.1fM cells), population %llu\n", grid.width(),
+           grid.height(), grid.cells() / 1000000.0f,
+           (unsigned long long)grid.population());
+
+    if (engine != "bitboard" && engine != "reference" && engine != "hashset" &&
+        engine != "chunked" && engine != "hashlife" &&
+        engine != "multistate") {
+        printf("ERRO: motor desconhecido: %s\n", engine.c_str());
+        return -1;
+    }
+    if (resume) {
+        generations = std::max(0LL, generations - (long long)startGeneration);
+        printf("Resuming at generation %llu, %lld to go\n",
+               (unsigned long long)startGeneration, generations);
+    }
+
+    life::Grid initial = verify ? grid : life::Grid();
+    bool unbounded =
+        engine == "hashset" || engine == "chunked" || engine == "hashlife";
+    if (unbounded && (rule.birth & 1)) {
+        printf("ERRO: a regra %s (B0) precisa de uma grade finita\n",
+               life::RuleString(rule).c_str());
+        return -1;
+    }
+    // Os motores ilimitados são conferidos num toro com margem de n + 1
+    // células de cada lado (veja abaixo); acima disso a conferência
+    // demoraria mais que qualquer execução razoável
+    int pad = (int)std::min<long long>(generations + 1, INT_MAX / 4);
+    if (verify && unbounded &&
+        (double)(initial.width() + 2.0 * pad) * (initial.height() + 2.0 * pad) *
+                generations >
+            kMaxUnboundedVerify) {
+        printf("ERRO: --verify com %s confere o plano num toro com margem de "
+               "n + 1 células; %lld gerações numa grade de %dx%d passam do "
+               "limite de %.0e células\n",
+               engine.c_str(), generations, initial.width(), initial.height(),
+               kMaxUnboundedVerify);
+        return -1;
+    }
+
+    life::Simulation sim(std::move(grid), isa);
+    sim.setRule(rule);
+    sim.setGeneration(startGeneration);
+    sim.setThreadCount(engine == "multistate" ? 1 : threads);
+    sim.setActivityTracking(activeTiles);
+    if (engine == "bitboard")
+        sim.setCycleDetection(maxPeriod);
+    life::SparseLife sparse;
+    if (engine == "hashset")
+        sparse = life::SparseLife(sim.grid());
+    sparse.setRule(rule);
+    life::ChunkLife chunked(isa);
+    chunked.setRule(rule);
+    if (engine == "chunked") {
+        chunked.load(sim.grid());
+        chunked.setThreadCount(threads);
+    }
+    life::HashLife hashlife;
+    hashlife.setRule(rule);
+    if (engine == "hashlife")
+        hashlife.load(sim.grid());
+    life::MultiStateLife multi;
+    if (engine == "multistate") {
+        multi = life::MultiStateLife(sim.grid(), multiRule);
+        multi.setThreadCount(threads);
+    }
+
+    if (engine == "multistate")
+        printf("Rule: %s (%d states, range %d), %d threads\n",
+               life::MultiStateRuleString(multiRule).c_str(), multiRule.states,
+               multiRule.range, multi.threadCount());
+    else
+        printf("Rule: %s\n", life::RuleName(rule).c_str());
+    if (engine == "bitboard")
+        printf("Kernel: %s (%s), %d threads\n",
+               life::KernelIsaName(sim.kernelIsa()),
+               life::RuleKernelName(sim.ruleKernel()), sim.threadCount());
+    if (sim.threadPool())
+        sim.threadPool()->resetStats();
+
+    std::unique_ptr<life::Checkpointer> checkpointer;
+    if (engine == "bitboard" &&
+        (checkpoint.everyGenerations || checkpoint.everySeconds > 0.0)) {
+        checkpoint.snapshot.compress = compress;
+        checkpointer = std::make_unique<life::Checkpointer>(checkpoint);
+        checkpointer->maybeCheckpoint(sim);
+    }
+
+    life::FrameRecorder recorder;
+    if (!record.path.empty()) {
+        std::string error;
+        if (!recorder.open(record, sim.grid().width(), sim.grid().height(),
+                           &error)) {
+            printf("ERRO: %s\n", error.c_str());
+            return -1;
+        }
+        recorder.maybeRecord(sim);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    if (checkpointer || recorder.isOpen()) {
+        // Geração a geração: o checkpoint e a gravação só recebem um
+        // ponteiro para a geração
+        for (long long i = 0; i < generations; i++) {
+            sim.step();
+            if (checkpointer)
+                checkpointer->maybeCheckpoint(sim);
+            recorder.maybeRecord(sim);
+        }
+    } else if (engine == "bitboard") {
+        sim.step((uint64_t)generations);
+    } else if (engine == "reference") {
+        life::Grid scratch(sim.grid().width(), sim.grid().height());
+        for (long long i = 0; i < generations; i++) {
+            life::StepReference(sim.grid(), scratch, rule);
+            std::swap(sim.grid(), scratch);
+        }
+    } else if (engine == "hashset") {
+        sparse.step((uint64_t)generations);
+    } else if (engine == "chunked") {
+        chunked.step((uint64_t)generations);
+    } else if (engine == "multistate") {
+        multi.step((uint64_t)generations);
+    } else {
+        hashlife.step((uint64_t)generations);
+    }
+    auto end = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(end - start).count();
+    // Cópia: as leituras de sim.grid() abaixo contam como edição
+    life::CycleDetector cycles = sim.cycles();
+
+    if (recorder.isOpen()) {
+        std::string error;
+        bool ok = recorder.close(&error);
+        auto stats = recorder.stats();
+        printf("Recording: %llu frames of %dx%d written (%.1f MB), %llu "
+               "dropped, %llu failed, stepper waited %.3f s, encoding %.3f "
+               "s\n",
+               (unsigned long long)stats.written, recorder.frameWidth(),
+               recorder.frameHeight(), stats.bytes / 1e6,
+               (unsigned long long)stats.dropped,
+               (unsigned long long)stats.failed, stats.waitSeconds,
+               stats.encodeSeconds);
+        if (!ok)
+            printf("ERRO: %s\n", error.c_str());
+    }
+
+    if (checkpointer) {
+        checkpointer->flush();
+        auto stats = checkpointer->stats();
+        printf("Checkpoints: %llu written, %llu superseded, %llu failed, last "
+               "at generation %llu (%.3f s)\n",
+               (unsigned long long)stats.written,
+               (unsigned long long)stats.dropped,
+               (unsigned long long)stats.failed,
+               (unsigned long long)stats.lastGeneration,
+               stats.lastWriteSeconds);
+        if (stats.failed)
+            printf("ERRO: %s\n", stats.lastError.c_str());
+        checkpointer.reset();
+    }
+
+    if (engine == "hashset") {
+        // O hash-set não tem bordas: só as células dentro da grade voltam
+        sim.grid().clear();
+        for (const auto &pos : sparse.cells())
+            if (pos.x >= 0 && pos.x < sim.grid().width() && pos.y >= 0 &&
+                pos.y < sim.grid().height())
+                sim.grid().set(pos.x, pos.y, true);
+    } else if (engine == "multistate") {
+        // Os estados de decaimento não cabem na grade de bits: só as vivas
+        sim.grid() = multi.toGrid();
+    } else if (engine == "chunked") {
+        // Do plano volta só a janela da grade; a população e a área
+        // incluem o que saiu dela
+        chunked.writeTo(sim.grid(), 0, 0);
+        auto stats = chunked.stats();
+        int64_t x0 = 0;
+        int64_t y0 = 0;
+        int64_t x1 = 0;
+        int64_t y1 = 0;
+        chunked.bounds(x0, y0, x1, y1);
+        printf("Chunked: population %llu in [%lld, %lld) x [%lld, %lld), "
+               "%zu chunks, %zu pooled, %.1f MB\n",
+               (unsigned long long)chunked.population(), (long long)x0,
+               (long long)x1, (long long)y0, (long long)y1, stats.chunks,
+               stats.pooled, stats.bytes / 1048576.0);
+    } else if (engine == "hashlife") {
+        // Idem para o HashLife; a população total inclui o que saiu da grade
+        hashlife.writeTo(sim.grid(), 0, 0);
+        auto stats = hashlife.stats();
+        printf("HashLife: population %llu, root level %d, %zu nodes, %zu "
+               "collections\n",
+               (unsigned long long)hashlife.population(), hashlife.rootLevel(),
+               stats.nodes, stats.collections);
+    }
+
+    double cellUpdates = (double)sim.grid().cells() * generations;
+    printf("Generations: %lld in %.3f s (%.1f gen/s)\n", generations, seconds,
+           seconds > 0.0 ? generations / seconds : 0.0);
+    printf("Throughput: %.3e cells/s\n",
+           seconds > 0.0 ? cellUpdates / seconds : 0.0);
+    printf("Final population: %llu\n",
+           (unsigned long long)sim.grid().population());
+
+    if (engine == "bitboard" && sim.activityTracking()) {
+        const auto &activity = sim.activityStats();
+        printf("Active tiles: %.1f%% skipped overall, %.1f%% in the last "
+               "generation (%llu tiles), %llu generations on full bands\n",
+               activity.skippedFraction() * 100.0,
+               activity.tiles ? activity.skipped * 100.0 / activity.tiles : 0.0,
+               (unsigned long long)activity.tiles,
+               (unsigned long long)activity.bandSteps);
+    }
+
+    if (engine == "bitboard" && maxPeriod > 0) {
+        if (cycles.found())
+            printf("Cycle: period %llu from generation %s%llu, detected at "
+                   "%llu, %llu generations skipped\n",
+                   (unsigned long long)cycles.period(),
+                   cycles.startExact() ? "" : "<= ",
+                   (unsigned long long)cycles.start(),
+                   (unsigned long long)cycles.detectedAt(),
+                   (unsigned long long)sim.skippedGenerations());
+        else
+            printf("Cycle: none up to period %d\n", maxPeriod);
+    }
+
+    if (engine == "bitboard" && sim.threadPool()) {
+        auto stats = sim.threadPool()->stats();
+        for (size_t t = 0; t < stats.size(); t++)
+            printf("  thread %2zu: %6.1f%% busy, %llu tasks, %llu stolen\n", t,
+                   stats[t].utilization * 100.0,
+                   (unsigned long long)stats[t].tasks,
+                   (unsigned long long)stats[t].steals);
+    }
+
+    if (profile)
+        life::PrintProfile(stdout, life::CollectProfile());
+    if (tracePath) {
+        std::string error;
+        if (!life::WriteChromeTrace(tracePath, &error)) {
+            printf("ERRO: %s\n", error.c_str());
+            return -1;
+        }
+    }
+    if (metrics) {
+        std::string error;
+        if (!metrics->writeNow(&error)) {
+            printf("ERRO: %s\n", error.c_str());
+            return -1;
+        }
+    }
+
+    if (verify && engine == "multistate") {
+        life::MultiStateLife expected(initial, multiRule);
+        life::MultiStateLife scratch(initial.width(), initial.height(),
+                                     multiRule);
+        for (long long i = 0; i < generations; i++) {
+            life::StepMultiStateReference(expected, scratch);
+            std::swap(expected, scratch);
+        }
+        bool match = expected == multi;
+        printf("Verify: %s\n", match ? "OK" : "MISMATCH");
+        if (!match)
+            return 1;
+    } else if (verify && unbounded) {
+        // Em n gerações nada anda mais que n células, então o bitboard num
+        // toro com margem de n + 1 não dá a volta e é o plano: a janela da
+        // grade e a população total têm que bater
+        life::Grid padded(initial.width() + 2 * pad,
+                          initial.height() + 2 * pad);
+        padded.paste(initial, pad, pad);
+        life::Simulation plane(std::move(padded), isa);
+        plane.setRule(rule);
+        plane.setThreadCount(threads);
+        plane.step((uint64_t)generations);
+        const life::Grid &result = static_cast<const life::Simulation &>(plane)
+                                       .grid();
+        life::Grid window(initial.width(), initial.height());
+        for (int y = 0; y < window.height(); y++)
+            for (int x = 0; x < window.width(); x++)
+                if (result.get(x + pad, y + pad))
+                    window.set(x, y, true);
+        uint64_t population = engine == "hashset"   ? sparse.population()
+                              : engine == "chunked" ? chunked.population()
+                                                    : hashlife.population();
+        bool match =
+            window == sim.grid() && population == result.population();
+        printf("Verify: %s (unbounded plane, %llu cells in total)\n",
+               match ? "OK" : "MISMATCH",
+               (unsigned long long)result.population());
+        if (!match)
+            return 1;
+    } else if (verify) {
+        life::Grid scratch(initial.width(), initial.height());
+        for (long long i = 0; i < generations; i++) {
+            life::StepReference(initial, scratch, rule);
+            std::swap(initial, scratch);
+        }
+        bool match = initial == sim.grid();
+        printf("Verify: %s\n", match ? "OK" : "MISMATCH");
+        if (!match)
+            return 1;
+    }
+
+    if (output) {
+        // O .rle grava a regra que rodou no cabeçalho
+        std::string ruleString = multiState
+                                     ? life::MultiStateRuleString(multiRule)
+                                     : life::RuleString(rule);
+        std::string error;
+        life::SnapshotOptions options;
+        options.compress = compress;
+        bool saved =
+            compress ? life::SaveSnapshot(output, sim.grid(),
+                                          startGeneration + generations,
+                                          options, &error)
+                     : life::SavePattern(output, sim.grid(),
+                                         ruleString.c_str(),
+                                         startGeneration + generations, &error);
+        if (!saved) {
+            printf("ERRO: %s\n", error.c_str());
+            return -1;
+        }
+    }
+
+    // Por último: o recenseamento anda mais uma geração para juntar as
+    // fases dos osciladores
+    if (census) {
+        life::Census objects(rule);
+        life::PrintCensus(stdout, objects.take(sim));
+    }
+
+    return 0;
+}
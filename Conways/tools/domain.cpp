@@ -0,0 +1,424 @@
+#include "cycle.h"
+#include "domain.h"
+#include "halo_channel.h"
+#include "rule.h"
+#include "seed.h"
+#include "simulation.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+// Uma grade toroidal dividida em faixas horizontais entre processos, com o
+// halo trocado por memória compartilhada ou TCP. Sem --rank, os ranks são
+// processos filhos nesta máquina; com --rank, cada nó roda o seu e os
+// resultados se juntam somando as populações e fazendo XOR dos hashes.
+
+static void PrintUsage() {
+    printf("Usage: conways-domain [options]\n"
+           "  --size WxH            grid size, W a multiple of 64 "
+           "(default 2560x2048)\n"
+           "  --seed N              soup seed (default 0)\n"
+           "  --density D           soup density (default 0.25)\n"
+           "  --pattern NAME        random (default), blocks, noise or "
+           "hotspots\n"
+           "  --rule RULE           B/S rule (default B3/S23)\n"
+           "  -n N                  generations (default 1000)\n"
+           "  --ranks N             processes, one horizontal strip each "
+           "(default 2)\n"
+           "  --halo K              halo rows: neighbours exchange every K "
+           "generations\n"
+           "                        (default 1)\n"
+           "  --threads N           threads per process (default 1)\n"
+           "  --transport T         shm (default) or tcp\n"
+           "  --rank R              run only rank R, for one process per "
+           "node; without it\n"
+           "                        all ranks are forked on this machine\n"
+           "  --peers LIST          tcp: host:port of every rank, in rank "
+           "order\n"
+           "                        (default 127.0.0.1:47000, :47001, ...)\n"
+           "  --name NAME           shm: segment name prefix "
+           "(default conways-<pid>,\n"
+           "                        or conways-domain with --rank)\n"
+           "  --timeout S           seconds to wait for a neighbour "
+           "(default 60)\n"
+           "  --verify              also run the whole grid in one process "
+           "and compare\n");
+}
+
+static int ProcessId() {
+#if defined(_WIN32)
+    return _getpid();
+#else
+    return (int)getpid();
+#endif
+}
+
+struct Peer {
+    std::string host;
+    int port = 0;
+};
+
+struct Config {
+    life::DomainOptions domain;
+    life::SeedOptions seed;
+    uint64_t generations = 1000;
+    bool tcp = false;
+    std::vector<Peer> peers;
+    std::string name;
+    double timeout = 60.0;
+};
+
+// O que cada rank devolve ao processo que lançou os filhos
+struct RankResult {
+    int ok = 0;
+    uint64_t population = 0;
+    uint64_t hash = 0;
+    double seconds = 0.0;
+    double computeSeconds = 0.0;
+    double waitSeconds = 0.0;
+    uint64_t bytesSent = 0;
+};
+
+// host:port,host:port,...; o host pode ser um IPv6 entre colchetes
+static bool ParsePeers(const char *text, std::vector<Peer> &peers) {
+    peers.clear();
+    std::string list = text;
+    size_t start = 0;
+    while (start < list.size()) {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos)
+            end = list.size();
+        std::string item = list.substr(start, end - start);
+        size_t colon = item.rfind(':');
+        if (colon == std::string::npos || colon == 0)
+            return false;
+        Peer peer;
+        peer.host = item.substr(0, colon);
+        peer.port = atoi(item.c_str() + colon + 1);
+        if (peer.host.size() > 2 && peer.host.front() == '[' &&
+            peer.host.back() == ']')
+            peer.host = peer.host.substr(1, peer.host.size() - 2);
+        if (peer.port <= 0 || peer.port > 65535)
+            return false;
+        peers.push_back(peer);
+        start = end + 1;
+    }
+    return !peers.empty();
+}
+
+// O canal de cima do rank r é o de baixo do r - 1. Na memória compartilhada
+// quem fica acima cria o segmento; no TCP quem fica abaixo escuta.
+static bool Connect(const Config &config,
+                    std::unique_ptr<life::HaloChannel> &up,
+                    std::unique_ptr<life::HaloChannel> &down,
+                    std::string *error) {
+    const life::DomainOptions &domain = config.domain;
+    if (domain.ranks == 1)
+        return true;
+    size_t bytes = life::DomainHaloBytes(domain);
+    int above = (domain.rank + domain.ranks - 1) % domain.ranks;
+    int below = (domain.rank + 1) % domain.ranks;
+
+    if (!config.tcp) {
+        down = life::OpenShmChannel(config.name + "-" +
+                                        std::to_string(domain.rank),
+                                    true, bytes, config.timeout, error);
+        if (!down)
+            return false;
+        up = life::OpenShmChannel(config.name + "-" + std::to_string(above),
+                                  false, bytes, config.timeout, error);
+        return up != nullptr;
+    }
+
+    // Todos escutam antes de alguém aceitar: a conexão para baixo corre
+    // numa thread enquanto esta espera o vizinho de cima
+    const Peer &next = config.peers[below];
+    std::string downError;
+    std::thread connector([&] {
+        down = life::ConnectTcpChannel(next.host, next.port, bytes,
+                                       config.timeout, &downError);
+    });
+    up = life::AcceptTcpChannel(config.peers[domain.rank].port, bytes,
+                                config.timeout, error);
+    connector.join();
+    if (!up)
+        return false;
+    if (!down) {
+        if (error)
+            *error = downError;
+        return false;
+    }
+    return true;
+}
+
+static bool RunRank(const Config &config, RankResult &result,
+                    std::string *error) {
+    const life::DomainOptions &domain = config.domain;
+    int y0 = life::DomainStripBegin(domain.height, domain.ranks, domain.rank);
+    int y1 = life::DomainStripBegin(domain.height, domain.ranks,
+                                    domain.rank + 1);
+    life::Grid strip(domain.width, y1 - y0);
+    life::SeedStrip(strip, config.seed, y0, domain.height);
+
+    std::unique_ptr<life::HaloChannel> up;
+    std::unique_ptr<life::HaloChannel> down;
+    if (!Connect(config, up, down, error))
+        return false;
+
+    life::DomainWorker worker(domain, strip, std::move(up), std::move(down));
+    auto start = std::chrono::steady_clock::now();
+    if (!worker.step(config.generations, error))
+        return false;
+    result.seconds = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+
+    result.ok = 1;
+    result.population = worker.population();
+    result.hash = worker.hash();
+    result.computeSeconds = worker.stats().computeSeconds;
+    result.waitSeconds = worker.stats().waitSeconds;
+    result.bytesSent = worker.stats().bytesSent;
+    return true;
+}
+
+static void PrintRank(const Config &config, int rank,
+                      const RankResult &result) {
+    const life::DomainOptions &domain = config.domain;
+    printf("Rank %d: rows %d-%d, population %llu, hash %016llx, %.3f s "
+           "(compute %.3f s, halo wait %.3f s, %.1f MB sent)\n",
+           rank, life::DomainStripBegin(domain.height, domain.ranks, rank),
+           life::DomainStripBegin(domain.height, domain.ranks, rank + 1) - 1,
+           (unsigned long long)result.population,
+           (unsigned long long)result.hash, result.seconds,
+           result.computeSeconds, result.waitSeconds,
+           result.bytesSent / 1e6);
+}
+
+#if !defined(_WIN32)
+// Um filho por rank; cada um devolve o RankResult por um pipe
+static bool RunLocal(const Config &config, RankResult &total) {
+    int ranks = config.domain.ranks;
+    std::vector<pid_t> children;
+    std::vector<int> pipes;
+    fflush(stdout);
+    for (int rank = 0; rank < ranks; rank++) {
+        int fds[2];
+        if (pipe(fds) != 0) {
+            printf("ERRO: pipe falhou\n");
+            return false;
+        }
+        pid_t pid = fork();
+        if (pid < 0) {
+            printf("ERRO: fork falhou\n");
+            return false;
+        }
+        if (pid == 0) {
+            close(fds[0]);
+            Config own = config;
+            own.domain.rank = rank;
+            RankResult result;
+            std::string error;
+            if (!RunRank(own, result, &error))
+                printf("ERRO: rank %d: %s\n", rank, error.c_str());
+            fflush(stdout);
+            bool written = write(fds[1], &result, sizeof(result)) ==
+                           (ssize_t)sizeof(result);
+            _exit(written && result.ok ? 0 : 1);
+        }
+        close(fds[1]);
+        children.push_back(pid);
+        pipes.push_back(fds[0]);
+    }
+
+    bool ok = true;
+    for (int rank = 0; rank < ranks; rank++) {
+        RankResult result;
+        if (read(pipes[rank], &result, sizeof(result)) !=
+            (ssize_t)sizeof(result))
+            result.ok = 0;
+        close(pipes[rank]);
+        int status = 0;
+        waitpid(children[rank], &status, 0);
+        if (!result.ok) {
+            ok = false;
+            continue;
+        }
+        PrintRank(config, rank, result);
+        total.population += result.population;
+        total.hash ^= result.hash;
+        total.seconds = std::max(total.seconds, result.seconds);
+        total.computeSeconds += result.computeSeconds;
+        total.waitSeconds += result.waitSeconds;
+        total.bytesSent += result.bytesSent;
+    }
+    return ok;
+}
+#endif
+
+int main(int argc, char **argv) {
+    Config config;
+    config.domain.width = 2560;
+    config.domain.height = 2048;
+    config.domain.ranks = 2;
+    int rank = -1;
+    int threads = 1;
+    const char *transport = "shm";
+    const char *peers = nullptr;
+    bool verify = false;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(arg, "--size") && hasValue) {
+            if (sscanf(argv[++i], "%dx%d", &config.domain.width,
+                       &config.domain.height) != 2) {
+                printf("ERRO: tamanho inválido: %s\n", argv[i]);
+                return -1;
+            }
+        } else if (!strcmp(arg, "--seed") && hasValue) {
+            config.seed.seed = strtoull(argv[++i], nullptr, 0);
+        } else if (!strcmp(arg, "--density") && hasValue) {
+            config.seed.density = (float)atof(argv[++i]);
+        } else if (!strcmp(arg, "--pattern") && hasValue) {
+            if (!life::ParseSeedPattern(argv[++i], config.seed.pattern)) {
+                printf("ERRO: padrão desconhecido: %s\n", argv[i]);
+                return -1;
+            }
+        } else if (!strcmp(arg, "--rule") && hasValue) {
+            std::string error;
+            if (!life::ParseRule(argv[++i], config.domain.rule, &error)) {
+                printf("ERRO: %s\n", error.c_str());
+                return -1;
+            }
+        } else if (!strcmp(arg, "-n") && hasValue) {
+            config.generations = strtoull(argv[++i], nullptr, 10);
+        } else if (!strcmp(arg, "--ranks") && hasValue) {
+            config.domain.ranks = atoi(argv[++i]);
+        } else if (!strcmp(arg, "--halo") && hasValue) {
+            config.domain.halo = atoi(argv[++i]);
+        } else if (!strcmp(arg, "--threads") && hasValue) {
+            threads = atoi(argv[++i]);
+        } else if (!strcmp(arg, "--transport") && hasValue) {
+            transport = argv[++i];
+        } else if (!strcmp(arg, "--rank") && hasValue) {
+            rank = atoi(argv[++i]);
+        } else if (!strcmp(arg, "--peers") && hasValue) {
+            peers = argv[++i];
+        } else if (!strcmp(arg, "--name") && hasValue) {
+            config.name = argv[++i];
+        } else if (!strcmp(arg, "--timeout") && hasValue) {
+            config.timeout = atof(argv[++i]);
+        } else if (!strcmp(arg, "--verify")) {
+            verify = true;
+        } else {
+            PrintUsage();
+            return !strcmp(arg, "-h") || !strcmp(arg, "--help") ? 0 : -1;
+        }
+    }
+
+    config.domain.threads = threads;
+    config.domain.rank = rank < 0 ? 0 : rank;
+    std::string error;
+    if (!life::CheckDomainOptions(config.domain, &error)) {
+        printf("ERRO: %s\n", error.c_str());
+        return -1;
+    }
+    if (!strcmp(transport, "tcp")) {
+        config.tcp = true;
+    } else if (strcmp(transport, "shm")) {
+        printf("ERRO: transporte desconhecido: %s\n", transport);
+        return -1;
+    }
+    if (config.tcp) {
+        if (peers && !ParsePeers(peers, config.peers)) {
+            printf("ERRO: lista de vizinhos inválida: %s\n", peers);
+            return -1;
+        }
+        for (int r = 0; !peers && r < config.domain.ranks; r++)
+            config.peers.push_back({"127.0.0.1", 47000 + r});
+        if ((int)config.peers.size() != config.domain.ranks) {
+            printf("ERRO: --peers precisa de %d endereços\n",
+                   config.domain.ranks);
+            return -1;
+        }
+    }
+    if (config.name.empty())
+        config.name = rank < 0 ? "conways-" + std::to_string(ProcessId())
+                               : "conways-domain";
+    if (config.name[0] != '/')
+        config.name = "/" + config.name;
+
+    printf("Domain: %dx%d in %d strips of ~%d rows, halo %d, %s, %d "
+           "thread(s) per rank, rule %s\n",
+           config.domain.width, config.domain.height, config.domain.ranks,
+           config.domain.height / config.domain.ranks, config.domain.halo,
+           config.tcp ? "tcp" : "shm", threads,
+           life::RuleString(config.domain.rule).c_str());
+
+    if (rank >= 0) {
+        RankResult result;
+        if (!RunRank(config, result, &error)) {
+            printf("ERRO: %s\n", error.c_str());
+            return -1;
+        }
+        PrintRank(config, rank, result);
+        return 0;
+    }
+
+#if defined(_WIN32)
+    printf("ERRO: sem fork no Windows; rode um processo por rank com "
+           "--rank\n");
+    return -1;
+#else
+    RankResult total;
+    if (!RunLocal(config, total))
+        return -1;
+    double cells = (double)config.domain.width * config.domain.height *
+                   config.generations;
+    printf("Total: population %llu, hash %016llx, %llu generations in "
+           "%.3f s (%.1f Mcells/s), halo wait %.1f%% of rank time\n",
+           (unsigned long long)total.population,
+           (unsigned long long)total.hash,
+           (unsigned long long)config.generations, total.seconds,
+           total.seconds > 0.0 ? cells / total.seconds / 1e6 : 0.0,
+           total.computeSeconds + total.waitSeconds > 0.0
+               ? 100.0 * total.waitSeconds /
+                     (total.computeSeconds + total.waitSeconds)
+               : 0.0);
+
+    if (verify) {
+        life::Grid grid(config.domain.width, config.domain.height);
+        life::SeedGrid(grid, config.seed);
+        life::Simulation simulation(std::move(grid));
+        simulation.setRule(config.domain.rule);
+        simulation.setThreadCount(threads);
+        simulation.step(config.generations);
+        uint64_t population = simulation.grid().population();
+        uint64_t hash = life::HashGrid(simulation.grid());
+        if (population != total.population || hash != total.hash) {
+            printf("ERRO: diverge da simulação num processo só "
+                   "(population %llu, hash %016llx)\n",
+                   (unsigned long long)population, (unsigned long long)hash);
+            return -1;
+        }
+        printf("Verify: OK\n");
+    }
+    return 0;
+#endif
+}
@@ -0,0 +1,223 @@
+#include "eca.h"
+#include "thread_pool.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Versão nativa do Web/ElementaryCellularAutomaton: roda uma ou muitas
+// regras elementares (e sementes) em paralelo, grava os diagramas
+// espaço-tempo e imprime um levantamento com densidade, entropia e ciclo de
+// cada execução.
+
+struct Job {
+    life::EcaOptions options;
+    life::EcaResult result;
+    std::string error;
+};
+
+static void PrintUsage() {
+    printf("Usage: conways-eca [options]\n"
+           "  --rules LIST          30, 0-255, 30,90,110 or all (default 30)\n"
+           "  --width N             cells per row (default 4096)\n"
+           "  -n N                  generations (default 4096)\n"
+           "  --init single|random  one live cell in the middle (default) or "
+           "a random row\n"
+           "  --seed N              first random seed (default 0)\n"
+           "  --seeds N             random rows per rule, seeds N..N+count-1 "
+           "(default 1)\n"
+           "  --density D           live fraction of a random row "
+           "(default 0.5)\n"
+           "  --boundary periodic|fixed  ring (default) or frozen edge cells "
+           "like the\n"
+           "                        Web demo\n"
+           "  --threads N           parallel runs (default: all cores)\n"
+           "  --full                keep going after the first cycle\n"
+           "  -o FILE               space-time diagram, .pbm or .pbm.zst; "
+           "{rule} and\n"
+           "                        {seed} are replaced in the name\n");
+}
+
+// "all", "30", "0-255" ou uma lista separada por vírgulas
+static bool ParseRules(const char *text, std::vector<int> &rules) {
+    rules.clear();
+    if (!strcmp(text, "all"))
+        text = "0-255";
+    const char *c = text;
+    while (*c) {
+        char *end;
+        long first = strtol(c, &end, 10);
+        long last = first;
+        if (end == c)
+            return false;
+        if (*end == '-') {
+            c = end + 1;
+            last = strtol(c, &end, 10);
+            if (end == c)
+                return false;
+        }
+        if (first < 0 || last > 255 || first > last)
+            return false;
+        for (long rule = first; rule <= last; rule++)
+            rules.push_back((int)rule);
+        c = end;
+        if (*c == ',')
+            c++;
+        else if (*c)
+            return false;
+    }
+    return !rules.empty();
+}
+
+static std::string Replace(std::string text, const char *key,
+                           const std::string &value) {
+    for (size_t at; (at = text.find(key)) != std::string::npos;)
+        text.replace(at, strlen(key), value);
+    return text;
+}
+
+int main(int argc, char **argv) {
+    life::EcaOptions base;
+    std::vector<int> rules = {30};
+    int seeds = 1;
+    int threads = 0;
+    const char *output = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(arg, "--rules") && hasValue) {
+            if (!ParseRules(argv[++i], rules)) {
+                printf("ERRO: lista de regras inválida: %s\n", argv[i]);
+                return -1;
+            }
+        } else if (!strcmp(arg, "--width") && hasValue) {
+            base.width = atoi(argv[++i]);
+        } else if (!strcmp(arg, "-n") && hasValue) {
+            base.generations = strtoull(argv[++i], nullptr, 10);
+        } else if (!strcmp(arg, "--init") && hasValue) {
+            const char *init = argv[++i];
+            if (strcmp(init, "single") && strcmp(init, "random")) {
+                printf("ERRO: linha inicial desconhecida: %s\n", init);
+                return -1;
+            }
+            base.random = !strcmp(init, "random");
+        } else if (!strcmp(arg, "--seed") && hasValue) {
+            base.seed = strtoull(argv[++i], nullptr, 10);
+        } else if (!strcmp(arg, "--seeds") && hasValue) {
+            seeds = atoi(argv[++i]);
+        } else if (!strcmp(arg, "--density") && hasValue) {
+            base.density = (float)atof(argv[++i]);
+        } else if (!strcmp(arg, "--boundary") && hasValue) {
+            const char *boundary = argv[++i];
+            if (!strcmp(boundary, "periodic")) {
+                base.boundary = life::EcaBoundary::Periodic;
+            } else if (!strcmp(boundary, "fixed")) {
+                base.boundary = life::EcaBoundary::Fixed;
+            } else {
+                printf("ERRO: borda desconhecida: %s\n", boundary);
+                return -1;
+            }
+        } else if (!strcmp(arg, "--threads") && hasValue) {
+            threads = atoi(argv[++i]);
+        } else if (!strcmp(arg, "--full")) {
+            base.stopAtCycle = false;
+        } else if (!strcmp(arg, "-o") && hasValue) {
+            output = argv[++i];
+        } else {
+            PrintUsage();
+            return strcmp(arg, "-h") && strcmp(arg, "--help") ? -1 : 0;
+        }
+    }
+    if (base.width < 1 || seeds < 1) {
+        printf("ERRO: --width e --seeds devem ser positivos\n");
+        return -1;
+    }
+    if (!base.random)
+        seeds = 1; // a linha inicial não depende da semente
+
+    std::vector<Job> jobs;
+    for (int rule : rules) {
+        for (int s = 0; s < seeds; s++) {
+            Job job;
+            job.options = base;
+            job.options.rule = rule;
+            job.options.seed = base.seed + s;
+            jobs.push_back(job);
+        }
+    }
+    if (output && jobs.size() > 1) {
+        std::string path = output;
+        bool perRule = path.find("{rule}") != std::string::npos;
+        bool perSeed = path.find("{seed}") != std::string::npos;
+        if ((rules.size() > 1 && !perRule) || (seeds > 1 && !perSeed)) {
+            printf("ERRO: com várias execuções o nome de -o precisa de "
+                   "{rule} e/ou {seed}\n");
+            return -1;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    life::ThreadPool pool(threads);
+    pool.parallelFor(0, (int)jobs.size(), 1, [&](int j0, int j1) {
+        for (int j = j0; j < j1; j++) {
+            Job &job = jobs[j];
+            life::EcaDiagramWriter writer;
+            life::EcaDiagramWriter *diagram = nullptr;
+            if (output) {
+                std::string path = output;
+                path = Replace(path, "{rule}",
+                               std::to_string(job.options.rule));
+                path = Replace(path, "{seed}",
+                               std::to_string(job.options.seed));
+                if (!writer.open(path, job.options.width,
+                                 job.options.generations + 1, &job.error))
+                    continue;
+                diagram = &writer;
+            }
+            if (life::RunEca(job.options, job.result, diagram, &job.error) &&
+                diagram)
+                diagram->close(&job.error);
+        }
+    });
+    double seconds = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+
+    printf("Width: %d, %llu generations, %s boundary, %s start\n", base.width,
+           (unsigned long long)base.generations,
+           base.boundary == life::EcaBoundary::Fixed ? "fixed" : "periodic",
+           base.random ? "random" : "single cell");
+    printf("%4s %8s %8s %8s %10s %10s %12s\n", "rule", "seed", "density",
+           "entropy", "transient", "period", "cells/ns");
+    int failures = 0;
+    double cells = 0.0;
+    for (const Job &job : jobs) {
+        if (!job.error.empty()) {
+            printf("ERRO: regra %d: %s\n", job.options.rule,
+                   job.error.c_str());
+            failures++;
+            continue;
+        }
+        const life::EcaResult &r = job.result;
+        double jobCells = (double)r.generations * job.options.width;
+        cells += jobCells;
+        char transient[32] = "-", period[32] = "-";
+        if (r.period) {
+            snprintf(transient, sizeof(transient), "%llu",
+                     (unsigned long long)r.transient);
+            snprintf(period, sizeof(period), "%llu",
+                     (unsigned long long)r.period);
+        }
+        printf("%4d %8llu %8.4f %8.4f %10s %10s %12.2f\n", job.options.rule,
+               (unsigned long long)job.options.seed, r.density, r.entropy,
+               transient, period,
+               r.seconds > 0.0 ? jobCells / r.seconds / 1e9 : 0.0);
+    }
+    printf("%zu runs, %.3f s, %.2f cells/ns overall\n", jobs.size(), seconds,
+           seconds > 0.0 ? cells / seconds / 1e9 : 0.0);
+    return failures ? -1 : 0;
+}
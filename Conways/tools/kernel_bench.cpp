@@ -0,0 +1,100 @@
+#include "grid.h"
+#include "kernel.h"
+#include "seed.h"
+#include "simulation.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+// Micro-benchmark dos kernels de passo: roda o mesmo soup em cada ISA
+// disponível, confere o resultado com o escalar e mede a vazão.
+
+int main(int argc, char **argv) {
+    // Padrão: a maior grade do main.cpp (gridMultiplier = 20)
+    int width = 24000;
+    int height = 20000;
+    int generations = 20;
+    life::Rule rule;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "--size") && hasValue) {
+            if (sscanf(argv[++i], "%dx%d", &width, &height) != 2) {
+                printf("ERRO: tamanho inválido: %s\n", argv[i]);
+                return -1;
+            }
+        } else if (!strcmp(argv[i], "--multiplier") && hasValue) {
+            float multiplier = (float)atof(argv[++i]);
+            width = (int)(1200 * multiplier);
+            height = (int)(1000 * multiplier);
+        } else if (!strcmp(argv[i], "-n") && hasValue) {
+            generations = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--rule") && hasValue) {
+            std::string error;
+            if (!life::ParseRule(argv[++i], rule, &error)) {
+                printf("ERRO: %s\n", error.c_str());
+                return -1;
+            }
+        } else {
+            printf("Usage: conways-kernel-bench [--size WxH | --multiplier M] "
+                   "[-n generations]\n"
+                   "                            [--rule RULE]\n");
+            return strcmp(argv[i], "-h") && strcmp(argv[i], "--help") ? -1 : 0;
+        }
+    }
+
+    life::Grid initial(width, height);
+    life::SeedOptions seed;
+    seed.seed = 42;
+    life::SeedGrid(initial, seed);
+
+    // Cada passo lê a grade inteira e escreve outra do mesmo tamanho; as
+    // linhas vizinhas já estão no cache, então contamos uma leitura só.
+    double bytesPerStep = 2.0 * height * initial.words() * sizeof(uint64_t);
+    double cells = (double)initial.cells();
+
+    printf("Grid: %dx%d (%.1fM cells), %d generations, best ISA: %s\n", width,
+           height, cells / 1e6, generations,
+           life::KernelIsaName(life::DetectKernelIsa()));
+    printf("Rule: %s (%s kernel)\n", life::RuleName(rule).c_str(),
+           life::RuleKernelName(life::RuleKernelFor(rule)));
+    printf("%-8s %10s %10s %10s %8s\n", "kernel", "ms/gen", "GB/s", "cells/ns",
+           "check");
+
+    life::Grid expected;
+    const life::KernelIsa isas[] = {life::KernelIsa::Scalar,
+                                    life::KernelIsa::Sse2,
+                                    life::KernelIsa::Avx2,
+                                    life::KernelIsa::Avx512};
+    for (life::KernelIsa isa : isas) {
+        if (!life::GetRowKernel(isa)) {
+            printf("%-8s %10s\n", life::KernelIsaName(isa), "n/a");
+            continue;
+        }
+
+        life::Simulation sim(initial, isa);
+        sim.setRule(rule);
+        sim.step(1); // aquece caches e páginas
+
+        auto start = std::chrono::steady_clock::now();
+        sim.step(generations);
+        auto end = std::chrono::steady_clock::now();
+        double seconds = std::chrono::duration<double>(end - start).count();
+
+        const char *check = "ref";
+        if (isa == life::KernelIsa::Scalar)
+            expected = sim.grid();
+        else
+            check = sim.grid() == expected ? "OK" : "MISMATCH";
+
+        printf("%-8s %10.3f %10.2f %10.3f %8s\n", life::KernelIsaName(isa),
+               seconds * 1e3 / generations,
+               bytesPerStep * generations / seconds / 1e9,
+               cells * generations / seconds / 1e9, check);
+    }
+
+    return 0;
+}
@@ -0,0 +1,213 @@
+#include "pattern_io.h"
+#include "rule.h"
+#include "search.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Procura osciladores e naves que caibam numa caixa, no estilo do lifesrc,
+// e imprime cada um em RLE assim que aparece. A busca pode ser interrompida
+// por tempo e retomada do arquivo gravado com --save.
+
+static void PrintUsage() {
+    printf("Usage: conways-search [options]\n"
+           "  --size WxH            box every phase must fit in "
+           "(default 16x16, W <= 60)\n"
+           "  --period N            period (default 2)\n"
+           "  --shift DX,DY         displacement per period, for spaceships "
+           "(default 0,0)\n"
+           "  --rule RULE           B/S rule without B0 (default B3/S23)\n"
+           "  --threads N           worker threads (default: all cores)\n"
+           "  --max N               stop after N solutions, 0 for all "
+           "(default 1)\n"
+           "  --time S              stop after S seconds\n"
+           "  --progress S          progress line every S seconds "
+           "(default 10, 0 off)\n"
+           "  --save FILE           write the pending search to FILE every "
+           "--save-every\n"
+           "                        seconds and when it stops\n"
+           "  --save-every S        default 60\n"
+           "  --resume FILE         continue a saved search; size, period, "
+           "shift and rule\n"
+           "                        come from FILE, which is also where it "
+           "keeps saving\n"
+           "  -o FILE               append the solutions to FILE as RLE "
+           "(default stdout)\n"
+           "  --selftest            run small known searches and check "
+           "their results\n");
+}
+
+// Buscas pequenas de resposta conhecida: cada solução precisa sair com a
+// contagem global de nós (não zero, sem voltar atrás e até o total final)
+static int RunSelfTest() {
+    struct Case {
+        int width, height, period, dx, dy, threads;
+    };
+    const Case cases[] = {
+        {5, 5, 2, 0, 0, 1}, // o blinker
+        {5, 5, 2, 0, 0, 4},
+        {5, 5, 4, 1, 1, 1}, // o glider
+        {5, 5, 4, 1, 1, 4},
+    };
+
+    int failures = 0;
+    for (const Case &c : cases) {
+        life::SearchOptions options;
+        options.width = c.width;
+        options.height = c.height;
+        options.period = c.period;
+        options.dx = c.dx;
+        options.dy = c.dy;
+        options.threads = c.threads;
+        options.maxSolutions = 3;
+        options.progressEvery = 0.0;
+
+        std::vector<uint64_t> nodes;
+        life::SearchProgress result;
+        std::string error;
+        bool ok = life::RunSearch(
+            options,
+            [&](const life::SearchSolution &solution) {
+                nodes.push_back(solution.nodes);
+            },
+            [](const life::SearchProgress &) {}, &result, &error);
+        if (!ok)
+            printf("ERRO: %s\n", error.c_str());
+
+        ok = ok && !nodes.empty();
+        for (size_t i = 0; ok && i < nodes.size(); i++)
+            ok = nodes[i] > 0 && nodes[i] <= result.nodes &&
+                 (i == 0 || nodes[i] >= nodes[i - 1]);
+        printf("p%d (%d, %d) in %dx%d, %d threads: %zu solutions, first "
+               "after %llu of %llu nodes: %s\n",
+               c.period, c.dx, c.dy, c.width, c.height, c.threads,
+               nodes.size(),
+               (unsigned long long)(nodes.empty() ? 0 : nodes[0]),
+               (unsigned long long)result.nodes, ok ? "OK" : "FAILED");
+        failures += !ok;
+    }
+    printf("Search self-test: %s (%d failures)\n", failures ? "FAILED" : "OK",
+           failures);
+    return failures;
+}
+
+int main(int argc, char **argv) {
+    life::SearchOptions options;
+    const char *output = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(arg, "--size") && hasValue) {
+            if (sscanf(argv[++i], "%dx%d", &options.width,
+                       &options.height) != 2) {
+                printf("ERRO: tamanho inválido: %s\n", argv[i]);
+                return -1;
+            }
+        } else if (!strcmp(arg, "--period") && hasValue) {
+            options.period = atoi(argv[++i]);
+        } else if (!strcmp(arg, "--shift") && hasValue) {
+            if (sscanf(argv[++i], "%d,%d", &options.dx, &options.dy) != 2) {
+                printf("ERRO: deslocamento inválido: %s\n", argv[i]);
+                return -1;
+            }
+        } else if (!strcmp(arg, "--rule") && hasValue) {
+            std::string error;
+            if (!life::ParseRule(argv[++i], options.rule, &error)) {
+                printf("ERRO: %s\n", error.c_str());
+                return -1;
+            }
+        } else if (!strcmp(arg, "--threads") && hasValue) {
+            options.threads = atoi(argv[++i]);
+        } else if (!strcmp(arg, "--max") && hasValue) {
+            options.maxSolutions = strtoull(argv[++i], nullptr, 10);
+        } else if (!strcmp(arg, "--time") && hasValue) {
+            options.seconds = atof(argv[++i]);
+        } else if (!strcmp(arg, "--progress") && hasValue) {
+            options.progressEvery = atof(argv[++i]);
+        } else if (!strcmp(arg, "--save") && hasValue) {
+            options.savePath = argv[++i];
+        } else if (!strcmp(arg, "--save-every") && hasValue) {
+            options.saveEvery = atof(argv[++i]);
+        } else if (!strcmp(arg, "--resume") && hasValue) {
+            options.resumePath = argv[++i];
+        } else if (!strcmp(arg, "-o") && hasValue) {
+            output = argv[++i];
+        } else if (!strcmp(arg, "--selftest")) {
+            return RunSelfTest() ? -1 : 0;
+        } else {
+            PrintUsage();
+            return strcmp(arg, "-h") && strcmp(arg, "--help") ? -1 : 0;
+        }
+    }
+
+    std::string error;
+    if (!options.resumePath.empty()) {
+        if (!life::LoadSearchOptions(options.resumePath.c_str(), options,
+                                     &error)) {
+            printf("ERRO: %s\n", error.c_str());
+            return -1;
+        }
+        if (options.savePath.empty())
+            options.savePath = options.resumePath;
+    }
+    if (!life::CheckSearchOptions(options, &error)) {
+        printf("ERRO: %s\n", error.c_str());
+        return -1;
+    }
+
+    FILE *out = stdout;
+    if (output) {
+        out = fopen(output, "a");
+        if (!out) {
+            printf("ERRO: não foi possível abrir %s\n", output);
+            return -1;
+        }
+    }
+    FILE *log = out == stdout ? stderr : stdout;
+
+    std::string rule = life::RuleString(options.rule);
+    fprintf(log, "Search: p%d, shift (%d, %d) in %dx%d, rule %s%s\n",
+            options.period, options.dx, options.dy, options.width,
+            options.height, rule.c_str(),
+            options.resumePath.empty() ? "" : " (resumed)");
+
+    auto onSolution = [&](const life::SearchSolution &solution) {
+        fprintf(out, "#C p%d, shift (%d, %d), after %llu nodes\n",
+                solution.period, solution.dx, solution.dy,
+                (unsigned long long)solution.nodes);
+        life::WriteRle(out, solution.phase, rule.c_str());
+        fflush(out);
+    };
+    auto onProgress = [&](const life::SearchProgress &progress) {
+        fprintf(log, "  %8.1f s  %14llu nodes  %.3e nodes/s  %llu pending  "
+                     "%llu found\n",
+                progress.seconds, (unsigned long long)progress.nodes,
+                progress.nodesPerSecond, (unsigned long long)progress.pending,
+                (unsigned long long)progress.solutions);
+        fflush(log);
+    };
+
+    life::SearchProgress result;
+    bool ok = life::RunSearch(options, onSolution, onProgress, &result,
+                              &error);
+    if (out != stdout)
+        fclose(out);
+    if (!ok) {
+        printf("ERRO: %s\n", error.c_str());
+        return -1;
+    }
+
+    fprintf(log, "%s: %llu nodes in %.2f s (%.3e nodes/s), %llu solutions",
+            result.complete ? "Search complete" : "Search stopped",
+            (unsigned long long)result.nodes, result.seconds,
+            result.nodesPerSecond, (unsigned long long)result.solutions);
+    if (!result.complete && !options.savePath.empty())
+        fprintf(log, ", %llu subtrees saved to %s",
+                (unsigned long long)result.pending, options.savePath.c_str());
+    fprintf(log, "\n");
+    return 0;
+}
@@ -0,0 +1,290 @@
+#include "sweep.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Varredura de sopas em lote: densidades x padrões x sementes, muitas grades
+// pequenas por núcleo, com o resultado de cada sopa gravado em CSV assim que
+// ela termina.
+
+static void PrintUsage() {
+    printf("Usage: conways-sweep [options]\n"
+           "  --spec FILE           read options from FILE, one \"name value\" "
+           "per line\n"
+           "                        (densities 0.05:0.8:0.05), # for "
+           "comments\n"
+           "  --densities LIST      0.1,0.25 or start:stop:step "
+           "(default 0.25)\n"
+           "  --patterns LIST       random,blocks,noise,hotspots or all "
+           "(default random)\n"
+           "  --seeds N             soups per density and pattern "
+           "(default 100)\n"
+           "  --seed N              first seed (default 0)\n"
+           "  --size WxH            grid size (default 256x256)\n"
+           "  -n N                  generation limit per soup "
+           "(default 10000)\n"
+           "  --max-period N        longest cycle looked for "
+           "(default 4 * max(W, H))\n"
+           "  --rule RULE           B/S rule (default B3/S23)\n"
+           "  --threads N           worker threads (default: all cores)\n"
+           "  --census              count the objects each soup settles into "
+           "(CSV column\n"
+           "                        name:count ..., totals at the end)\n"
+           "  -o FILE               CSV output (default stdout)\n");
+}
+
+static std::vector<std::string> Split(const std::string &text) {
+    std::vector<std::string> items;
+    size_t start = 0;
+    while (start <= text.size()) {
+        size_t end = text.find(',', start);
+        if (end == std::string::npos)
+            end = text.size();
+        if (end > start)
+            items.push_back(text.substr(start, end - start));
+        start = end + 1;
+    }
+    return items;
+}
+
+static bool ParseDensities(const std::string &text,
+                           std::vector<float> &densities) {
+    densities.clear();
+    double first, last, step;
+    if (sscanf(text.c_str(), "%lf:%lf:%lf", &first, &last, &step) == 3) {
+        if (step <= 0.0 || first > last)
+            return false;
+        // Contagem inteira para a última densidade não se perder no
+        // arredondamento
+        int count = (int)((last - first) / step + 1e-6) + 1;
+        for (int i = 0; i < count; i++)
+            densities.push_back((float)(first + i * step));
+    } else {
+        for (const std::string &item : Split(text))
+            densities.push_back((float)atof(item.c_str()));
+    }
+    for (float density : densities)
+        if (density < 0.0f || density > 1.0f)
+            return false;
+    return !densities.empty();
+}
+
+static bool ParsePatterns(const std::string &text,
+                          std::vector<life::SeedPattern> &patterns) {
+    patterns.clear();
+    if (text == "all") {
+        patterns = {life::SeedPattern::Random, life::SeedPattern::Blocks,
+                    life::SeedPattern::Noise, life::SeedPattern::Hotspots};
+        return true;
+    }
+    for (const std::string &item : Split(text)) {
+        life::SeedPattern pattern;
+        if (!life::ParseSeedPattern(item.c_str(), pattern))
+            return false;
+        patterns.push_back(pattern);
+    }
+    return !patterns.empty();
+}
+
+// "name value" por linha vira "--name value" ("-n value" para um nome de uma
+// letra)
+static bool ReadSpec(const char *path, std::vector<std::string> &args) {
+    FILE *file = fopen(path, "r");
+    if (!file)
+        return false;
+    char line[1024];
+    while (fgets(line, sizeof(line), file)) {
+        char name[256], value[768];
+        if (line[0] == '#')
+            continue;
+        int fields = sscanf(line, "%255s %767s", name, value);
+        if (fields < 1)
+            continue;
+        if (name[0] == '-')
+            args.push_back(name);
+        else
+            args.push_back((name[1] ? "--" : "-") + std::string(name));
+        if (fields == 2)
+            args.push_back(value);
+    }
+    fclose(file);
+    return true;
+}
+
+int main(int argc, char **argv) {
+    life::SweepSpec spec;
+    std::string output;
+
+    std::vector<std::string> args(argv + 1, argv + argc);
+    for (size_t i = 0; i < args.size(); i++) {
+        std::string arg = args[i]; // --spec insere em args
+        bool hasValue = i + 1 < args.size();
+        if (arg == "--spec" && hasValue) {
+            std::vector<std::string> lines;
+            if (!ReadSpec(args[++i].c_str(), lines)) {
+                printf("ERRO: não foi possível ler %s\n", args[i].c_str());
+                return -1;
+            }
+            args.insert(args.begin() + i + 1, lines.begin(), lines.end());
+        } else if (arg == "--densities" && hasValue) {
+            if (!ParseDensities(args[++i], spec.densities)) {
+                printf("ERRO: densidades inválidas: %s\n", args[i].c_str());
+                return -1;
+            }
+        } else if (arg == "--patterns" && hasValue) {
+            if (!ParsePatterns(args[++i], spec.patterns)) {
+                printf("ERRO: padrões inválidos: %s\n", args[i].c_str());
+                return -1;
+            }
+        } else if (arg == "--seeds" && hasValue) {
+            spec.seeds = atoi(args[++i].c_str());
+        } else if (arg == "--seed" && hasValue) {
+            spec.firstSeed = strtoull(args[++i].c_str(), nullptr, 10);
+        } else if (arg == "--size" && hasValue) {
+            if (sscanf(args[++i].c_str(), "%dx%d", &spec.width,
+                       &spec.height) != 2 ||
+                spec.width <= 0 || spec.height <= 0) {
+                printf("ERRO: tamanho inválido: %s\n", args[i].c_str());
+                return -1;
+            }
+        } else if (arg == "-n" && hasValue) {
+            spec.maxGenerations = strtoull(args[++i].c_str(), nullptr, 10);
+        } else if (arg == "--max-period" && hasValue) {
+            spec.maxPeriod = atoi(args[++i].c_str());
+        } else if (arg == "--rule" && hasValue) {
+            std::string error;
+            if (!life::ParseRule(args[++i].c_str(), spec.rule, &error)) {
+                printf("ERRO: %s\n", error.c_str());
+                return -1;
+            }
+        } else if (arg == "--threads" && hasValue) {
+            spec.threads = atoi(args[++i].c_str());
+        } else if (arg == "--census") {
+            spec.census = true;
+        } else if (arg == "-o" && hasValue) {
+            output = args[++i];
+        } else {
+            PrintUsage();
+            return arg == "-h" || arg == "--help" ? 0 : -1;
+        }
+    }
+    if (spec.seeds < 1) {
+        printf("ERRO: --seeds deve ser positivo\n");
+        return -1;
+    }
+
+    FILE *csv = stdout;
+    if (!output.empty()) {
+        csv = fopen(output.c_str(), "w");
+        if (!csv) {
+            printf("ERRO: não foi possível criar %s\n", output.c_str());
+            return -1;
+        }
+    }
+    // Com o CSV na saída padrão, o resumo vai para a de erro
+    FILE *log = csv == stdout ? stderr : stdout;
+    fprintf(log, "Sweep: %zu soups (%zu densities x %zu patterns x %d seeds) "
+                 "on %dx%d, up to %llu generations, rule %s\n",
+            spec.soups(), spec.densities.size(), spec.patterns.size(),
+            spec.seeds, spec.width, spec.height,
+            (unsigned long long)spec.maxGenerations,
+            life::RuleString(spec.rule).c_str());
+
+    fprintf(csv, "index,pattern,density,seed,width,height,"
+                 "initial_population,lifespan,period,final_population,"
+                 "generations,seconds%s\n",
+            spec.census ? ",census" : "");
+
+    // Médias por padrão x densidade, na ordem da varredura
+    struct Summary {
+        size_t soups = 0;
+        size_t settled = 0;
+        double lifespan = 0.0;
+        double population = 0.0;
+    };
+    size_t perPattern = spec.densities.size();
+    std::vector<Summary> summaries(spec.patterns.size() * perPattern);
+    uint64_t generations = 0;
+    size_t done = 0;
+    // Soma dos recenseamentos, na ordem em que cada tipo apareceu
+    life::CensusResult census;
+
+    auto start = std::chrono::steady_clock::now();
+    life::RunSweep(spec, [&](const life::SoupResult &r) {
+        fprintf(csv, "%zu,%s,%.4f,%llu,%d,%d,%llu,%llu,%llu,%llu,%llu,%.6f",
+                r.index, life::SeedPatternName(r.pattern), r.density,
+                (unsigned long long)r.seed, spec.width, spec.height,
+                (unsigned long long)r.initialPopulation,
+                (unsigned long long)r.lifespan, (unsigned long long)r.period,
+                (unsigned long long)r.population,
+                (unsigned long long)r.generations, r.seconds);
+        if (spec.census)
+            fputc(',', csv);
+        census.seconds += r.census.seconds;
+        for (size_t i = 0; i < r.census.entries.size(); i++) {
+            const life::CensusEntry &entry = r.census.entries[i];
+            fprintf(csv, "%s%s:%llu", i ? " " : "", entry.name.c_str(),
+                    (unsigned long long)entry.count);
+
+            auto same = [&](const life::CensusEntry &e) {
+                return e.name == entry.name;
+            };
+            auto found = std::find_if(census.entries.begin(),
+                                      census.entries.end(), same);
+            if (found == census.entries.end())
+                census.entries.push_back(entry);
+            else
+                found->count += entry.count;
+            census.objects += entry.count;
+            census.cells += entry.count * (uint64_t)entry.cells;
+        }
+        fputc('\n', csv);
+        fflush(csv);
+
+        Summary &summary = summaries[r.index / spec.seeds];
+        summary.soups++;
+        summary.settled += r.period != 0;
+        summary.lifespan += (double)r.lifespan;
+        summary.population += (double)r.population;
+        generations += r.generations;
+        done++;
+    });
+    double seconds = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+    if (csv != stdout)
+        fclose(csv);
+
+    fprintf(log, "%-9s %8s %8s %12s %12s\n", "pattern", "density", "settled",
+            "lifespan", "population");
+    for (size_t s = 0; s < summaries.size(); s++) {
+        const Summary &summary = summaries[s];
+        if (!summary.soups)
+            continue;
+        fprintf(log, "%-9s %8.3f %7.1f%% %12.1f %12.1f\n",
+                life::SeedPatternName(spec.patterns[s / perPattern]),
+                spec.densities[s % perPattern],
+                summary.settled * 100.0 / summary.soups,
+                summary.lifespan / summary.soups,
+                summary.population / summary.soups);
+    }
+    if (spec.census) {
+        std::stable_sort(census.entries.begin(), census.entries.end(),
+                         [](const life::CensusEntry &a,
+                            const life::CensusEntry &b) {
+                             return a.count > b.count;
+                         });
+        life::PrintCensus(log, census, 20);
+    }
+    fprintf(log, "%zu soups in %.2f s: %.0f soups/hour, %.3e cells/s\n",
+            done, seconds, seconds > 0.0 ? done * 3600.0 / seconds : 0.0,
+            seconds > 0.0 ? (double)generations * spec.width * spec.height /
+                                seconds
+                          : 0.0);
+    return 0;
+}